@@ -0,0 +1,172 @@
+//
+// Copyright (c) 2004-2020 Jean-Luc Thiffeault <jeanluc@mailaps.org>
+//
+// See the file LICENSE for copying permission.
+//
+
+#ifndef JLT_ALIGNED_ALLOCATOR_HPP
+#define JLT_ALIGNED_ALLOCATOR_HPP
+
+//
+// aligned_allocator.hpp
+//
+
+// Standard-conforming allocator returning storage aligned to a cache
+// line (or any power of two), so that SIMD code can use aligned loads
+// on the data of a jlt::matrix.
+//
+// Two optional behaviours are selected by the Flags template argument:
+//
+//   alloc_hugepages     Large buffers (at least JLT_HUGEPAGE_THRESHOLD
+//                       bytes) are aligned on a huge page boundary and
+//                       the kernel is advised to back them with
+//                       transparent huge pages (Linux only, ignored
+//                       elsewhere).
+//
+//   alloc_default_init  Elements constructed without arguments are
+//                       default-initialised rather than
+//                       value-initialised, so jlt::vector<double>(n)
+//                       does not zero-fill a scratch buffer that is
+//                       about to be overwritten anyway.
+
+#include <cstddef>
+#include <new>
+#include <limits>
+#include <utility>
+#include <jlt/exceptions.hpp>
+
+#if defined(__linux__)
+#  include <sys/mman.h>
+#endif
+
+// Default alignment in bytes: one cache line, which is also enough for
+// AVX-512 aligned loads.
+#ifndef JLT_DEFAULT_ALIGNMENT
+#  define JLT_DEFAULT_ALIGNMENT 64
+#endif
+
+// Size in bytes above which alloc_hugepages takes effect.
+#ifndef JLT_HUGEPAGE_THRESHOLD
+#  define JLT_HUGEPAGE_THRESHOLD (2*1024*1024)
+#endif
+
+namespace jlt {
+
+enum : unsigned {
+  alloc_default = 0,
+  alloc_hugepages = 1,
+  alloc_default_init = 2
+};
+
+template<class T,
+	 std::size_t Align = JLT_DEFAULT_ALIGNMENT,
+	 unsigned Flags = alloc_default>
+class aligned_allocator
+{
+  static_assert((Align & (Align-1)) == 0,
+		"aligned_allocator: alignment must be a power of two.");
+
+public:
+  using value_type = T;
+  using pointer = T *;
+  using const_pointer = const T *;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+
+  template<class U>
+  struct rebind { using other = aligned_allocator<U,Align,Flags>; };
+
+  static constexpr std::size_t alignment =
+    (Align < alignof(T) ? alignof(T) : Align);
+
+  aligned_allocator() noexcept {}
+
+  template<class U>
+  aligned_allocator(const aligned_allocator<U,Align,Flags>&) noexcept {}
+
+  pointer allocate(size_type n)
+    {
+      if (n > std::numeric_limits<size_type>::max() / sizeof(T))
+	JLT_THROW(std::bad_alloc());
+
+      size_type bytes = n*sizeof(T);
+      void *p = ::operator new(bytes, std::align_val_t(align_for(bytes)));
+
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+      if ((Flags & alloc_hugepages) && bytes >= JLT_HUGEPAGE_THRESHOLD)
+	{
+	  // Only a hint: failure just means we get normal pages.
+	  madvise(p, bytes, MADV_HUGEPAGE);
+	}
+#endif
+
+      return static_cast<pointer>(p);
+    }
+
+  void deallocate(pointer p, size_type n) noexcept
+    {
+      ::operator delete(p, std::align_val_t(align_for(n*sizeof(T))));
+    }
+
+  // Construction without arguments: default-initialise if requested.
+  template<class U>
+  void construct(U* p)
+    {
+      if (Flags & alloc_default_init)
+	::new(static_cast<void*>(p)) U;
+      else
+	::new(static_cast<void*>(p)) U();
+    }
+
+  template<class U, class... Args>
+  void construct(U* p, Args&&... args)
+    {
+      ::new(static_cast<void*>(p)) U(std::forward<Args>(args)...);
+    }
+
+private:
+  // Alignment actually used for a buffer of a given size.  This must
+  // be a pure function of the size, since deallocate has to pass the
+  // same value back.
+  static constexpr std::size_t align_for(size_type bytes)
+    {
+      if ((Flags & alloc_hugepages) && bytes >= JLT_HUGEPAGE_THRESHOLD
+	  && alignment < JLT_HUGEPAGE_THRESHOLD)
+	return JLT_HUGEPAGE_THRESHOLD;
+
+      return alignment;
+    }
+};
+
+// All aligned_allocators with the same parameters are interchangeable.
+template<class T, class U, std::size_t Align, unsigned Flags>
+inline bool operator==(const aligned_allocator<T,Align,Flags>&,
+		       const aligned_allocator<U,Align,Flags>&) noexcept
+{
+  return true;
+}
+
+template<class T, class U, std::size_t Align, unsigned Flags>
+inline bool operator!=(const aligned_allocator<T,Align,Flags>&,
+		       const aligned_allocator<U,Align,Flags>&) noexcept
+{
+  return false;
+}
+
+// Convenience aliases.
+template<class T>
+using hugepage_allocator =
+  aligned_allocator<T,JLT_DEFAULT_ALIGNMENT,alloc_hugepages>;
+
+template<class T>
+using default_init_allocator =
+  aligned_allocator<T,JLT_DEFAULT_ALIGNMENT,alloc_default_init>;
+
+// Tag to request default-initialised (i.e. for built-in types,
+// uninitialised) storage from a constructor, for scratch buffers.
+struct default_init_t { explicit default_init_t() = default; };
+inline constexpr default_init_t default_init{};
+
+} // namespace jlt
+
+#endif // JLT_ALIGNED_ALLOCATOR_HPP
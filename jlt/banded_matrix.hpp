@@ -0,0 +1,421 @@
+//
+// Copyright (c) 2004-2020 Jean-Luc Thiffeault <jeanluc@mailaps.org>
+//
+// See the file LICENSE for copying permission.
+//
+
+#ifndef JLT_BANDED_MATRIX_HPP
+#define JLT_BANDED_MATRIX_HPP
+
+//
+// banded_matrix.hpp
+//
+
+// m by n matrix with kl subdiagonals and ku superdiagonals, such as
+// the finite-difference operators of finitediff.hpp.  Only the band is
+// stored, so memory and the cost of products and solves scale with
+// (kl+ku+1)*n rather than m*n.  Element access is as for jlt::matrix,
+// with A(i,j); elements outside the band read as zero and cannot be
+// written to.
+//
+// The storage is LAPACK's band storage: column j holds A(j-ku,j) to
+// A(j+kl,j), with A(i,j) at data()[j*ld + ku + i - j] and ld = kl+ku+1
+// the leading dimension.  banded_solve() and banded_spd_solve() call
+// the LAPACK drivers gbsv and pbsv on a copy of the band, and must be
+// linked with -lblas -llapack.
+
+#include <iostream>
+#include <cassert>
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+#include <jlt/aligned_allocator.hpp>
+#include <jlt/matrix_view.hpp>
+#include <jlt/mathvector.hpp>
+#include <jlt/mathmatrix.hpp>
+#include <jlt/lapack.hpp>
+#include <jlt/exceptions.hpp>
+
+namespace jlt {
+
+template<class T, class Alloc = aligned_allocator<T>>
+class banded_matrix
+{
+public:
+  using value_type = T;
+  using allocator_type = Alloc;
+  using pointer = T *;
+  using const_pointer = const T *;
+  using iterator = pointer;
+  using const_iterator = const_pointer;
+  using reference = T &;
+  using const_reference = const T &;
+  using size_type = std::size_t;
+
+private:
+  size_type m{0}, n{0};			// Number of rows, columns.
+  size_type kl{0}, ku{0};		// Number of sub-, superdiagonals.
+  std::vector<T,Alloc> a;
+
+  size_type index(size_type i, size_type j) const
+    {
+      return j*(kl+ku+1) + ku + i - j;
+    }
+
+public:
+  // Is (i,j) in the band?
+  [[nodiscard]] bool inBand(size_type i, size_type j) const
+    {
+      return (i <= j + kl && j <= i + ku);
+    }
+
+  //
+  // Constructors
+  //
+
+  banded_matrix() {}
+
+  // Matrix of size _m*_n with _kl subdiagonals and _ku superdiagonals,
+  // with the band filled with _x.
+  banded_matrix(size_type _m, size_type _n, size_type _kl, size_type _ku,
+		const_reference _x = T())
+    : m(_m), n(_n), kl(_kl), ku(_ku), a((_kl+_ku+1)*_n,_x) {}
+
+  // The band of a matrix, mathmatrix or view.  Elements outside the
+  // band are not referenced.
+  template<class Alloc2, class Order>
+  banded_matrix(const matrix<T,Alloc2,Order>& A, size_type _kl, size_type _ku)
+    : kl(_kl), ku(_ku)
+    {
+      assign(A);
+    }
+
+  template<class U>
+  banded_matrix(const matrix_view<U>& A, size_type _kl, size_type _ku)
+    : kl(_kl), ku(_ku)
+    {
+      assign(A);
+    }
+
+  //
+  // Element access.
+  //
+
+  // Only elements in the band can be written, or read through a
+  // non-const object: use a const reference, e.g. std::as_const(A)(i,j),
+  // to read the zeros outside it.
+  reference operator()(size_type i, size_type j)
+    {
+#ifdef MATRIX_CHECK_BOUNDS
+      return at(i,j);
+#else
+      assert(inBand(i,j));
+      return a[index(i,j)];
+#endif
+    }
+
+  // Elements outside the band are zero.
+  value_type operator()(size_type i, size_type j) const
+    {
+#ifdef MATRIX_CHECK_BOUNDS
+      return at(i,j);
+#else
+      return (inBand(i,j) ? a[index(i,j)] : T());
+#endif
+    }
+
+  reference at(size_type i, size_type j)
+    {
+      if (i >= m || j >= n || !inBand(i,j))
+	JLT_THROW(std::out_of_range("Out of range exception in jlt::banded_matrix."));
+      return a[index(i,j)];
+    }
+
+  [[nodiscard]] value_type at(size_type i, size_type j) const
+    {
+      if (i >= m || j >= n)
+	JLT_THROW(std::out_of_range("Out of range exception in jlt::banded_matrix."));
+      return (inBand(i,j) ? a[index(i,j)] : T());
+    }
+
+  // The band storage, leading_dimension()*columns() elements.  Some of
+  // these (the corners above and below the band) are unused.
+  pointer data() { return a.data(); }
+  [[nodiscard]] const_pointer data() const { return a.data(); }
+  [[nodiscard]] size_type storage_size() const { return a.size(); }
+  [[nodiscard]] size_type leading_dimension() const { return kl+ku+1; }
+
+  [[nodiscard]] size_type size() const { return m*n; }
+  [[nodiscard]] size_type dim() const { return n; }
+  [[nodiscard]] size_type rows() const { return m; }
+  [[nodiscard]] size_type columns() const { return n; }
+  [[nodiscard]] size_type subdiagonals() const { return kl; }
+  [[nodiscard]] size_type superdiagonals() const { return ku; }
+  [[nodiscard]] bool empty() const { return (m == 0 || n == 0); }
+  [[nodiscard]] bool isSquare() const { return (m == n); }
+
+  //
+  // Matrix Operations
+  //
+
+  banded_matrix& operator+=(const banded_matrix& A)
+    {
+      MATRIX_ASSERT(m == A.m && n == A.n && kl == A.kl && ku == A.ku);
+      for (size_type k = 0; k < a.size(); ++k) a[k] += A.a[k];
+      return *this;
+    }
+
+  banded_matrix& operator-=(const banded_matrix& A)
+    {
+      MATRIX_ASSERT(m == A.m && n == A.n && kl == A.kl && ku == A.ku);
+      for (size_type k = 0; k < a.size(); ++k) a[k] -= A.a[k];
+      return *this;
+    }
+
+  banded_matrix& operator*=(const_reference x)
+    {
+      for (auto& y : a) y *= x;
+      return *this;
+    }
+
+  banded_matrix& operator/=(const_reference x)
+    {
+      for (auto& y : a) y /= x;
+      return *this;
+    }
+
+  // Unpack into a full mathmatrix.
+  [[nodiscard]] mathmatrix<T> full() const
+    {
+      mathmatrix<T> A(m,n);
+      for (size_type j = 0; j < n; ++j)
+	for (size_type i = first_row(j); i < last_row(j); ++i)
+	  A(i,j) = a[index(i,j)];
+      return A;
+    }
+
+  // The rows of column j in the band are first_row(j) to last_row(j)-1.
+  [[nodiscard]] size_type first_row(size_type j) const
+    {
+      return (j > ku ? j - ku : 0);
+    }
+
+  [[nodiscard]] size_type last_row(size_type j) const
+    {
+      return std::min(m,j + kl + 1);
+    }
+
+  //
+  // Output
+  //
+
+  // As for matrix, the whole matrix is printed.
+  std::ostream& printOn(std::ostream& strm) const
+    {
+      if (empty()) return strm;
+
+      for (size_type i = 0; i < m; ++i)
+	for (size_type j = 0; j < n; ++j)
+	  {
+	    strm << (*this)(i,j);
+	    if (i != m-1 || j != n-1) strm << "\t";	// No dangling tab.
+	  }
+
+      return strm;
+    }
+
+  std::ostream& printMatrixForm(std::ostream& strm) const
+    {
+      if (empty()) return strm;
+
+      for (size_type i = 0; i < m; ++i)
+	{
+	  for (size_type j = 0; j < n-1; ++j) strm << (*this)(i,j) << "\t";
+	  strm << (*this)(i,n-1) << std::endl;	// To avoid dangling tab.
+	}
+
+      return strm;
+    }
+
+private:
+  template<class Matrix>
+  void assign(const Matrix& A)
+    {
+      m = A.rows();
+      n = A.columns();
+      a.assign((kl+ku+1)*n,T());
+      for (size_type j = 0; j < n; ++j)
+	for (size_type i = first_row(j); i < last_row(j); ++i)
+	  a[index(i,j)] = A(i,j);
+    }
+};
+
+
+//
+// Products
+//
+
+// As in packed_matrix.hpp, the result must already have the right
+// size and must not overlap the arguments.  Both kernels go through
+// the band column by column, adding multiples of x[j] (or of row j of
+// B) to the rows it touches.
+
+// y = A*x
+template<class V_Y, class T, class Alloc, class V_X>
+inline void matrix_vector_product(V_Y&& y, const banded_matrix<T,Alloc>& A,
+				  const V_X& x)
+{
+  auto m = A.rows();
+  auto n = A.columns();
+  auto ld = A.leading_dimension();
+  auto ku = A.superdiagonals();
+
+  MATRIX_ASSERT(n == x.size() && y.size() == m);
+
+  for (decltype(m) i = 0; i < m; ++i) y[i] = 0;
+
+  const T *p = A.data();
+  for (decltype(n) j = 0; j < n; ++j, p += ld)
+    {
+      auto xj = x[j];
+      for (auto i = A.first_row(j); i < A.last_row(j); ++i)
+	y[i] += p[ku + i - j]*xj;
+    }
+}
+
+// C = A*B
+template<class M_C, class T, class Alloc, class M_B>
+inline void matrix_product(M_C&& C, const banded_matrix<T,Alloc>& A,
+			   const M_B& B)
+{
+  auto m = A.rows();
+  auto n = A.columns();
+  auto nb = B.columns();
+  auto ld = A.leading_dimension();
+  auto ku = A.superdiagonals();
+
+  MATRIX_ASSERT(n == B.rows() && C.rows() == m && C.columns() == nb);
+
+  for (decltype(m) i = 0; i < m; ++i)
+    for (decltype(nb) k = 0; k < nb; ++k) C(i,k) = 0;
+
+  const T *p = A.data();
+  for (decltype(n) j = 0; j < n; ++j, p += ld)
+    {
+      for (auto i = A.first_row(j); i < A.last_row(j); ++i)
+	{
+	  auto aij = p[ku + i - j];
+	  for (decltype(nb) k = 0; k < nb; ++k) C(i,k) += aij*B(j,k);
+	}
+    }
+}
+
+template<class T, class Alloc, class S, class A_M, class O_M>
+inline mathmatrix<T,S,A_M,O_M>
+operator*(const banded_matrix<T,Alloc>& A, const mathmatrix<T,S,A_M,O_M>& B)
+{
+  mathmatrix<T,S,A_M,O_M> res(A.rows(),B.columns(),default_init);
+  matrix_product(res,A,B);
+  return res;
+}
+
+template<class T, class Alloc, class U>
+inline mathmatrix<T>
+operator*(const banded_matrix<T,Alloc>& A, const matrix_view<U>& B)
+{
+  mathmatrix<T> res(A.rows(),B.columns(),default_init);
+  matrix_product(res,A,B);
+  return res;
+}
+
+template<class T, class Alloc, class S_V, class A_V>
+inline mathvector<T,S_V,A_V>
+operator*(const banded_matrix<T,Alloc>& A, const mathvector<T,S_V,A_V>& x)
+{
+  mathvector<T,S_V,A_V> res(A.rows());
+  matrix_vector_product(res,A,x);
+  return res;
+}
+
+template<class T, class Alloc, class U>
+inline mathvector<T>
+operator*(const banded_matrix<T,Alloc>& A, const vector_view<U>& x)
+{
+  mathvector<T> res(A.rows());
+  matrix_vector_product(res,A,x);
+  return res;
+}
+
+template<class T, class Alloc>
+std::ostream& operator<<(std::ostream& strm, const banded_matrix<T,Alloc>& A)
+{
+  return A.printOn(strm);
+}
+
+//
+// Solvers
+//
+
+// Solve A x = b for square A with LU factorisation (LAPACK gbsv).  b
+// is overwritten by x.  A is left untouched: the factors, which need
+// kl extra superdiagonals for the fill-in, go in a workspace of size
+// (2*kl+ku+1)*n.  Returns the LAPACK info: 0 on success, i > 0 if
+// U(i-1,i-1) is exactly zero.
+template<class T, class Alloc, class A_V>
+int banded_solve(const banded_matrix<T,Alloc>& A, std::vector<T,A_V>& b)
+{
+  int N = A.rows();
+  int kl = A.subdiagonals(), ku = A.superdiagonals();
+  int ld = A.leading_dimension(), ldAB = kl + ld;
+  int nrhs = 1, info;
+
+  MATRIX_ASSERT(A.isSquare() && b.size() == A.rows());
+
+  // Copy the band below the kl rows left for the fill-in.
+  std::vector<T> AB((size_t)ldAB*N);
+  for (int j = 0; j < N; ++j)
+    std::copy(A.data() + (size_t)j*ld, A.data() + (size_t)(j+1)*ld,
+	      AB.begin() + (size_t)j*ldAB + kl);
+
+  std::vector<int> ipiv(N);
+
+  lapack::gbsv(&N, &kl, &ku, &nrhs, AB.data(), &ldAB, ipiv.data(),
+	       b.data(), &N, &info);
+
+  return info;
+}
+
+// Solve A x = b for symmetric positive-definite A, with Cholesky
+// factorisation (LAPACK pbsv).  A must have kl = ku, and only its
+// diagonal and superdiagonals are referenced.  b is overwritten by x,
+// and A is left untouched.  Returns the LAPACK info: 0 on success,
+// i > 0 if A is not positive-definite.
+template<class T, class Alloc, class A_V>
+int banded_spd_solve(const banded_matrix<T,Alloc>& A, std::vector<T,A_V>& b)
+{
+  char uplo = 'U';
+  int N = A.rows();
+  int kd = A.superdiagonals(), kd1 = kd + 1;
+  int ld = A.leading_dimension();
+  int nrhs = 1, info;
+
+  MATRIX_ASSERT(A.isSquare() && b.size() == A.rows());
+
+  if (A.subdiagonals() != A.superdiagonals())
+    JLT_THROW(std::invalid_argument("jlt::banded_spd_solve: kl and ku must be equal."));
+
+  // The upper triangle of the band is the first kd+1 rows of each
+  // column of the band storage.
+  std::vector<T> AB((size_t)kd1*N);
+  for (int j = 0; j < N; ++j)
+    std::copy(A.data() + (size_t)j*ld, A.data() + (size_t)j*ld + kd1,
+	      AB.begin() + (size_t)j*kd1);
+
+  lapack::pbsv(&uplo, &N, &kd, &nrhs, AB.data(), &kd1, b.data(), &N, &info);
+
+  return info;
+}
+
+} // namespace jlt
+
+#endif // JLT_BANDED_MATRIX_HPP
@@ -0,0 +1,440 @@
+//
+// Copyright (c) 2004-2020 Jean-Luc Thiffeault <jeanluc@mailaps.org>
+//
+// See the file LICENSE for copying permission.
+//
+
+#ifndef JLT_BIT_MATRIX_HPP
+#define JLT_BIT_MATRIX_HPP
+
+//
+// bit_matrix.hpp
+//
+
+// Boolean matrices packed one bit per element, row by row in 64-bit
+// words, for nonzero patterns, adjacency matrices and reachability.
+// A bit_matrix takes 1/64th of the memory of a mathmatrix<double> of
+// the same size, and its operations work a word at a time:
+//
+//   A*B           Boolean product: row i of the result is the OR of the
+//                 rows k of B for which A(i,k) is set.  The cost is
+//                 nnz(A)*n/64 word operations, and rows of the result
+//                 are independent, so they are split across threads.
+//   boolean_product_t(C,A,Bt)
+//                 C = A*trans(Bt): C(i,j) is set if rows i of A and j
+//                 of Bt share a set bit, found by AND-ing their words.
+//   path_count(C,A,Bt)
+//                 C(i,j) = number of k with A(i,k) and Bt(j,k) set,
+//                 by popcount of the AND.
+//   A | B, A & B  Element-wise OR and AND.
+//   count()       Number of set elements, by popcount.
+//   reachable()   Nodes reachable from a node of the directed graph
+//                 whose adjacency matrix this is, by breadth-first
+//                 search with bit-set frontiers.
+//
+// The bits past the last column of each row are kept zero.
+//
+// A bit_matrix can be built from the nonzero pattern of any matrix
+// with operator()(i,j), rows() and columns(), e.g. a mathmatrix:
+//
+//   jlt::bit_matrix P(A);		// P(i,j) = (A(i,j) != 0)
+//
+// See semiring.hpp for the matrix product over other semirings.
+
+#include <iostream>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+#include <type_traits>
+#include <jlt/exceptions.hpp>
+#include <jlt/thread_pool.hpp>
+
+#ifndef MATRIX_ASSERT
+#  define MATRIX_ASSERT(x)
+#endif
+
+namespace jlt {
+
+class bit_matrix
+{
+public:
+  using word = std::uint64_t;
+  using size_type = std::size_t;
+
+  static constexpr size_type word_bits = 64;
+
+private:
+  size_type m{0}, n{0};		// Number of rows, columns.
+  size_type nw{0};		// Words per row.
+  std::vector<word> w;
+
+  static size_type words(size_type _n) { return (_n + word_bits - 1)/word_bits; }
+
+  // Mask of the valid bits of the last word of a row.
+  [[nodiscard]] word last_mask() const
+    {
+      size_type r = n % word_bits;
+      return (r == 0 ? ~word(0) : (word(1) << r) - 1);
+    }
+
+public:
+  // Set bits in a word, and index of the lowest set bit.
+  static int popcount(word x) { return __builtin_popcountll(x); }
+  static int ctz(word x) { return __builtin_ctzll(x); }
+
+  //
+  // Constructors
+  //
+
+  bit_matrix() {}
+
+  // _m by _n matrix of zeros (false).
+  bit_matrix(size_type _m, size_type _n)
+    : m(_m), n(_n), nw(words(_n)), w(_m*nw) {}
+
+  // The nonzero pattern of A.
+  template<class Matrix,
+	   class = decltype(std::declval<const Matrix&>()(0,0))>
+  explicit bit_matrix(const Matrix& A)
+    : bit_matrix(A.rows(),A.columns())
+    {
+      using T = typename std::decay<decltype(A(0,0))>::type;
+
+      for (size_type i = 0; i < m; ++i)
+	{
+	  word *r = row_data(i);
+	  for (size_type j = 0; j < n; ++j)
+	    if (A(i,j) != T()) r[j/word_bits] |= word(1) << (j % word_bits);
+	}
+    }
+
+  //
+  // Element access
+  //
+
+  [[nodiscard]] bool operator()(size_type i, size_type j) const
+    {
+#ifdef MATRIX_CHECK_BOUNDS
+      return at(i,j);
+#else
+      return (w[i*nw + j/word_bits] >> (j % word_bits)) & 1;
+#endif
+    }
+
+  [[nodiscard]] bool at(size_type i, size_type j) const
+    {
+      if (i >= m || j >= n)
+	JLT_THROW(std::out_of_range("Out of range exception in jlt::bit_matrix."));
+      return (w[i*nw + j/word_bits] >> (j % word_bits)) & 1;
+    }
+
+  void set(size_type i, size_type j, bool x = true)
+    {
+      word b = word(1) << (j % word_bits);
+      word& r = w[i*nw + j/word_bits];
+      r = (x ? r | b : r & ~b);
+    }
+
+  void reset(size_type i, size_type j) { set(i,j,false); }
+
+  // The words of row i.
+  word* row_data(size_type i) { return w.data() + i*nw; }
+  [[nodiscard]] const word* row_data(size_type i) const { return w.data() + i*nw; }
+
+  [[nodiscard]] size_type words_per_row() const { return nw; }
+
+  [[nodiscard]] size_type size() const { return m*n; }
+  [[nodiscard]] size_type dim() const { return n; }
+  [[nodiscard]] size_type rows() const { return m; }
+  [[nodiscard]] size_type columns() const { return n; }
+  [[nodiscard]] bool empty() const { return (m == 0 || n == 0); }
+  [[nodiscard]] bool isSquare() const { return (m == n); }
+
+  void swap(bit_matrix& A)
+    {
+      std::swap(m,A.m);
+      std::swap(n,A.n);
+      std::swap(nw,A.nw);
+      w.swap(A.w);
+    }
+
+  //
+  // Whole-matrix queries
+  //
+
+  // Number of set elements.
+  [[nodiscard]] size_type count() const
+    {
+      size_type c = 0;
+      for (auto x : w) c += popcount(x);
+      return c;
+    }
+
+  [[nodiscard]] size_type count_row(size_type i) const
+    {
+      size_type c = 0;
+      const word *r = row_data(i);
+      for (size_type k = 0; k < nw; ++k) c += popcount(r[k]);
+      return c;
+    }
+
+  // All elements set?
+  [[nodiscard]] bool all() const
+    {
+      if (empty()) return true;
+
+      const word last = last_mask();
+      for (size_type i = 0; i < m; ++i)
+	{
+	  const word *r = row_data(i);
+	  for (size_type k = 0; k+1 < nw; ++k)
+	    if (r[k] != ~word(0)) return false;
+	  if (r[nw-1] != last) return false;
+	}
+      return true;
+    }
+
+  // No element set?
+  [[nodiscard]] bool none() const
+    {
+      for (auto x : w) if (x) return false;
+      return true;
+    }
+
+  bool operator==(const bit_matrix& A) const
+    {
+      return (m == A.m && n == A.n && w == A.w);
+    }
+
+  bool operator!=(const bit_matrix& A) const { return !operator==(A); }
+
+  //
+  // Element-wise operations
+  //
+
+  bit_matrix& operator|=(const bit_matrix& A)
+    {
+      MATRIX_ASSERT(m == A.m && n == A.n);
+      for (size_type k = 0; k < w.size(); ++k) w[k] |= A.w[k];
+      return *this;
+    }
+
+  bit_matrix& operator&=(const bit_matrix& A)
+    {
+      MATRIX_ASSERT(m == A.m && n == A.n);
+      for (size_type k = 0; k < w.size(); ++k) w[k] &= A.w[k];
+      return *this;
+    }
+
+  // Set the diagonal.
+  bit_matrix& identity()
+    {
+      MATRIX_ASSERT(isSquare());
+      std::fill(w.begin(),w.end(),word(0));
+      for (size_type i = 0; i < n; ++i) set(i,i);
+      return *this;
+    }
+
+  [[nodiscard]] bit_matrix transpose() const
+    {
+      bit_matrix At(n,m);
+      for (size_type i = 0; i < m; ++i)
+	{
+	  const word *r = row_data(i);
+	  for (size_type k = 0; k < nw; ++k)
+	    for (word x = r[k]; x; x &= x-1)
+	      At.set(k*word_bits + ctz(x),i);
+	}
+      return At;
+    }
+
+  //
+  // Graphs
+  //
+
+  // Nodes reachable from node i (including i itself) along the edges
+  // j -> k for which (j,k) is set, as a 1 by n bit_matrix.
+  [[nodiscard]] bit_matrix reachable(size_type i) const
+    {
+      MATRIX_ASSERT(isSquare());
+
+      bit_matrix seen(1,n), frontier(1,n), next(1,n);
+      seen.set(0,i);
+      frontier.set(0,i);
+
+      word *s = seen.row_data(0), *f = frontier.row_data(0);
+      word *x = next.row_data(0);
+
+      for (;;)
+	{
+	  // next = union of the rows of the frontier, minus seen.
+	  std::fill(x,x+nw,word(0));
+	  for (size_type k = 0; k < nw; ++k)
+	    for (word b = f[k]; b; b &= b-1)
+	      {
+		const word *r = row_data(k*word_bits + ctz(b));
+		for (size_type l = 0; l < nw; ++l) x[l] |= r[l];
+	      }
+	  bool grew = false;
+	  for (size_type l = 0; l < nw; ++l)
+	    {
+	      x[l] &= ~s[l];
+	      s[l] |= x[l];
+	      grew = grew || x[l];
+	    }
+	  if (!grew) break;
+	  std::swap(f,x);
+	}
+
+      return seen;
+    }
+
+  //
+  // Output
+  //
+
+  std::ostream& printMatrixForm(std::ostream& strm) const
+    {
+      for (size_type i = 0; i < m; ++i)
+	{
+	  for (size_type j = 0; j < n; ++j) strm << ((*this)(i,j) ? '1' : '0');
+	  strm << std::endl;
+	}
+      return strm;
+    }
+};
+
+// C = A*B over the Boolean semiring.  C must not be A or B.
+inline void boolean_product(bit_matrix& C, const bit_matrix& A,
+			    const bit_matrix& B)
+{
+  using word = bit_matrix::word;
+  using size_type = bit_matrix::size_type;
+
+  MATRIX_ASSERT(A.columns() == B.rows());
+
+  if (C.rows() != A.rows() || C.columns() != B.columns())
+    {
+      bit_matrix tmp(A.rows(),B.columns());
+      C.swap(tmp);
+    }
+
+  const size_type nw = C.words_per_row();
+  const size_type grain = JLT_PARALLEL_GRAIN/(A.words_per_row()*nw + 1) + 1;
+
+  parallel_for(0,A.rows(),grain,[&](size_type i0, size_type i1)
+	       {
+		 for (size_type i = i0; i < i1; ++i)
+		   {
+		     word *c = C.row_data(i);
+		     std::fill(c,c+nw,word(0));
+		     const word *a = A.row_data(i);
+		     for (size_type k = 0; k < A.words_per_row(); ++k)
+		       for (word x = a[k]; x; x &= x-1)
+			 {
+			   const word *b =
+			     B.row_data(k*bit_matrix::word_bits +
+					bit_matrix::ctz(x));
+			   for (size_type l = 0; l < nw; ++l) c[l] |= b[l];
+			 }
+		   }
+	       });
+}
+
+// C = A*trans(Bt) over the Boolean semiring.  C must not be A or Bt.
+inline void boolean_product_t(bit_matrix& C, const bit_matrix& A,
+			      const bit_matrix& Bt)
+{
+  using word = bit_matrix::word;
+  using size_type = bit_matrix::size_type;
+
+  MATRIX_ASSERT(A.columns() == Bt.columns());
+
+  if (C.rows() != A.rows() || C.columns() != Bt.rows())
+    {
+      bit_matrix tmp(A.rows(),Bt.rows());
+      C.swap(tmp);
+    }
+
+  const size_type nw = A.words_per_row();
+  const size_type grain = JLT_PARALLEL_GRAIN/(Bt.rows()*nw + 1) + 1;
+
+  parallel_for(0,A.rows(),grain,[&](size_type i0, size_type i1)
+	       {
+		 for (size_type i = i0; i < i1; ++i)
+		   {
+		     const word *a = A.row_data(i);
+		     for (size_type j = 0; j < Bt.rows(); ++j)
+		       {
+			 const word *b = Bt.row_data(j);
+			 bool any = false;
+			 for (size_type k = 0; k < nw && !any; ++k)
+			   any = (a[k] & b[k]) != 0;
+			 C.set(i,j,any);
+		       }
+		   }
+	       });
+}
+
+// C(i,j) = number of k with A(i,k) and Bt(j,k) both set, that is the
+// integer product A*trans(Bt) of the 0-1 matrices.  C is any matrix of
+// the right size with integer elements, e.g. mathmatrix<int>.
+template<class M_C>
+void path_count(M_C& C, const bit_matrix& A, const bit_matrix& Bt)
+{
+  using word = bit_matrix::word;
+  using size_type = bit_matrix::size_type;
+
+  MATRIX_ASSERT(A.columns() == Bt.columns() &&
+		C.rows() == A.rows() && C.columns() == Bt.rows());
+
+  const size_type nw = A.words_per_row();
+  const size_type grain = JLT_PARALLEL_GRAIN/(Bt.rows()*nw + 1) + 1;
+
+  parallel_for(0,A.rows(),grain,[&](size_type i0, size_type i1)
+	       {
+		 for (size_type i = i0; i < i1; ++i)
+		   {
+		     const word *a = A.row_data(i);
+		     for (size_type j = 0; j < Bt.rows(); ++j)
+		       {
+			 const word *b = Bt.row_data(j);
+			 size_type c = 0;
+			 for (size_type k = 0; k < nw; ++k)
+			   c += bit_matrix::popcount(a[k] & b[k]);
+			 C(i,j) = c;
+		       }
+		   }
+	       });
+}
+
+inline bit_matrix operator*(const bit_matrix& A, const bit_matrix& B)
+{
+  bit_matrix C(A.rows(),B.columns());
+  boolean_product(C,A,B);
+  return C;
+}
+
+inline bit_matrix operator|(bit_matrix A, const bit_matrix& B)
+{
+  A |= B;
+  return A;
+}
+
+inline bit_matrix operator&(bit_matrix A, const bit_matrix& B)
+{
+  A &= B;
+  return A;
+}
+
+inline std::ostream& operator<<(std::ostream& strm, const bit_matrix& A)
+{
+  return A.printMatrixForm(strm);
+}
+
+} // namespace jlt
+
+#endif // JLT_BIT_MATRIX_HPP
@@ -0,0 +1,96 @@
+//
+// Copyright (c) 2004-2020 Jean-Luc Thiffeault <jeanluc@mailaps.org>
+//
+// See the file LICENSE for copying permission.
+//
+
+#ifndef JLT_BLAS_H
+#define JLT_BLAS_H
+
+//
+// Fortran routines from BLAS
+//
+
+// This header file can be included from a C program (as for
+// lapack.h, the complex types are std::complex when included from
+// blas.hpp).  All matrices are column-major, as in Fortran.
+
+//
+// Level 1: vector operations
+//
+
+// xSCAL - x = alpha*x
+void sscal_(const int* N, const float* alpha, float* x, const int* incx);
+void dscal_(const int* N, const double* alpha, double* x, const int* incx);
+void cscal_(const int* N, const std::complex<float>* alpha,
+	    std::complex<float>* x, const int* incx);
+void zscal_(const int* N, const std::complex<double>* alpha,
+	    std::complex<double>* x, const int* incx);
+
+// xAXPY - y = alpha*x + y
+void saxpy_(const int* N, const float* alpha, const float* x, const int* incx,
+	    float* y, const int* incy);
+void daxpy_(const int* N, const double* alpha, const double* x, const int* incx,
+	    double* y, const int* incy);
+void caxpy_(const int* N, const std::complex<float>* alpha,
+	    const std::complex<float>* x, const int* incx,
+	    std::complex<float>* y, const int* incy);
+void zaxpy_(const int* N, const std::complex<double>* alpha,
+	    const std::complex<double>* x, const int* incx,
+	    std::complex<double>* y, const int* incy);
+
+//
+// Level 2: matrix-vector operations
+//
+
+// xGEMV - y = alpha*op(A)*x + beta*y, with op(A) = A, A**T or A**H
+// for trans = 'N', 'T' or 'C', and A M-by-N.
+void sgemv_(const char* trans, const int* M, const int* N,
+	    const float* alpha, const float* A, const int* ldA,
+	    const float* x, const int* incx,
+	    const float* beta, float* y, const int* incy);
+void dgemv_(const char* trans, const int* M, const int* N,
+	    const double* alpha, const double* A, const int* ldA,
+	    const double* x, const int* incx,
+	    const double* beta, double* y, const int* incy);
+void cgemv_(const char* trans, const int* M, const int* N,
+	    const std::complex<float>* alpha, const std::complex<float>* A,
+	    const int* ldA, const std::complex<float>* x, const int* incx,
+	    const std::complex<float>* beta, std::complex<float>* y,
+	    const int* incy);
+void zgemv_(const char* trans, const int* M, const int* N,
+	    const std::complex<double>* alpha, const std::complex<double>* A,
+	    const int* ldA, const std::complex<double>* x, const int* incx,
+	    const std::complex<double>* beta, std::complex<double>* y,
+	    const int* incy);
+
+//
+// Level 3: matrix-matrix operations
+//
+
+// xGEMM - C = alpha*op(A)*op(B) + beta*C, with op(A) M-by-K, op(B)
+// K-by-N and C M-by-N.
+void sgemm_(const char* transA, const char* transB,
+	    const int* M, const int* N, const int* K,
+	    const float* alpha, const float* A, const int* ldA,
+	    const float* B, const int* ldB,
+	    const float* beta, float* C, const int* ldC);
+void dgemm_(const char* transA, const char* transB,
+	    const int* M, const int* N, const int* K,
+	    const double* alpha, const double* A, const int* ldA,
+	    const double* B, const int* ldB,
+	    const double* beta, double* C, const int* ldC);
+void cgemm_(const char* transA, const char* transB,
+	    const int* M, const int* N, const int* K,
+	    const std::complex<float>* alpha, const std::complex<float>* A,
+	    const int* ldA, const std::complex<float>* B, const int* ldB,
+	    const std::complex<float>* beta, std::complex<float>* C,
+	    const int* ldC);
+void zgemm_(const char* transA, const char* transB,
+	    const int* M, const int* N, const int* K,
+	    const std::complex<double>* alpha, const std::complex<double>* A,
+	    const int* ldA, const std::complex<double>* B, const int* ldB,
+	    const std::complex<double>* beta, std::complex<double>* C,
+	    const int* ldC);
+
+#endif // JLT_BLAS_H
@@ -0,0 +1,281 @@
+//
+// Copyright (c) 2004-2020 Jean-Luc Thiffeault <jeanluc@mailaps.org>
+//
+// See the file LICENSE for copying permission.
+//
+
+#ifndef JLT_BLAS_HPP
+#define JLT_BLAS_HPP
+
+#include <complex>
+#include <cstddef>
+#include <climits>
+#include <type_traits>
+
+//
+// Fortran routines from BLAS
+//
+
+// C++ declarations, overloaded on the element type as in lapack.hpp.
+//
+// If JLT_USE_BLAS is defined before including mathvector.hpp or
+// mathmatrix.hpp, matrix-matrix and matrix-vector products (gemm and
+// gemv), and in-place updates such as v += w and v *= a (axpy and
+// scal), call these for float, double and complex elements instead of
+// the code in gemm.hpp and mathmatrix.hpp.  Link with -lblas, or with
+// a tuned BLAS (OpenBLAS, MKL, BLIS...) for vendor performance.
+// BLAS is column-major; row-major operands are passed as transposes.
+
+namespace jlt {
+namespace blas {
+
+  extern "C" {
+# include <jlt/blas.h>
+  }
+
+  // Element types that BLAS handles.
+  template<class T> struct is_blas_type : std::false_type {};
+  template<> struct is_blas_type<float> : std::true_type {};
+  template<> struct is_blas_type<double> : std::true_type {};
+  template<> struct is_blas_type<std::complex<float>> : std::true_type {};
+  template<> struct is_blas_type<std::complex<double>> : std::true_type {};
+
+  //
+  // Overloaded Versions
+  //
+
+  inline void scal(const int* N, const float* alpha, float* x, const int* incx)
+  {
+    sscal_(N,alpha,x,incx);
+  }
+
+  inline void scal(const int* N, const double* alpha, double* x, const int* incx)
+  {
+    dscal_(N,alpha,x,incx);
+  }
+
+  inline void scal(const int* N, const std::complex<float>* alpha,
+		   std::complex<float>* x, const int* incx)
+  {
+    cscal_(N,alpha,x,incx);
+  }
+
+  inline void scal(const int* N, const std::complex<double>* alpha,
+		   std::complex<double>* x, const int* incx)
+  {
+    zscal_(N,alpha,x,incx);
+  }
+
+  inline void axpy(const int* N, const float* alpha, const float* x,
+		   const int* incx, float* y, const int* incy)
+  {
+    saxpy_(N,alpha,x,incx,y,incy);
+  }
+
+  inline void axpy(const int* N, const double* alpha, const double* x,
+		   const int* incx, double* y, const int* incy)
+  {
+    daxpy_(N,alpha,x,incx,y,incy);
+  }
+
+  inline void axpy(const int* N, const std::complex<float>* alpha,
+		   const std::complex<float>* x, const int* incx,
+		   std::complex<float>* y, const int* incy)
+  {
+    caxpy_(N,alpha,x,incx,y,incy);
+  }
+
+  inline void axpy(const int* N, const std::complex<double>* alpha,
+		   const std::complex<double>* x, const int* incx,
+		   std::complex<double>* y, const int* incy)
+  {
+    zaxpy_(N,alpha,x,incx,y,incy);
+  }
+
+  inline void gemv(const char* trans, const int* M, const int* N,
+		   const float* alpha, const float* A, const int* ldA,
+		   const float* x, const int* incx,
+		   const float* beta, float* y, const int* incy)
+  {
+    sgemv_(trans,M,N,alpha,A,ldA,x,incx,beta,y,incy);
+  }
+
+  inline void gemv(const char* trans, const int* M, const int* N,
+		   const double* alpha, const double* A, const int* ldA,
+		   const double* x, const int* incx,
+		   const double* beta, double* y, const int* incy)
+  {
+    dgemv_(trans,M,N,alpha,A,ldA,x,incx,beta,y,incy);
+  }
+
+  inline void gemv(const char* trans, const int* M, const int* N,
+		   const std::complex<float>* alpha,
+		   const std::complex<float>* A, const int* ldA,
+		   const std::complex<float>* x, const int* incx,
+		   const std::complex<float>* beta,
+		   std::complex<float>* y, const int* incy)
+  {
+    cgemv_(trans,M,N,alpha,A,ldA,x,incx,beta,y,incy);
+  }
+
+  inline void gemv(const char* trans, const int* M, const int* N,
+		   const std::complex<double>* alpha,
+		   const std::complex<double>* A, const int* ldA,
+		   const std::complex<double>* x, const int* incx,
+		   const std::complex<double>* beta,
+		   std::complex<double>* y, const int* incy)
+  {
+    zgemv_(trans,M,N,alpha,A,ldA,x,incx,beta,y,incy);
+  }
+
+  inline void gemm(const char* transA, const char* transB,
+		   const int* M, const int* N, const int* K,
+		   const float* alpha, const float* A, const int* ldA,
+		   const float* B, const int* ldB,
+		   const float* beta, float* C, const int* ldC)
+  {
+    sgemm_(transA,transB,M,N,K,alpha,A,ldA,B,ldB,beta,C,ldC);
+  }
+
+  inline void gemm(const char* transA, const char* transB,
+		   const int* M, const int* N, const int* K,
+		   const double* alpha, const double* A, const int* ldA,
+		   const double* B, const int* ldB,
+		   const double* beta, double* C, const int* ldC)
+  {
+    dgemm_(transA,transB,M,N,K,alpha,A,ldA,B,ldB,beta,C,ldC);
+  }
+
+  inline void gemm(const char* transA, const char* transB,
+		   const int* M, const int* N, const int* K,
+		   const std::complex<float>* alpha,
+		   const std::complex<float>* A, const int* ldA,
+		   const std::complex<float>* B, const int* ldB,
+		   const std::complex<float>* beta,
+		   std::complex<float>* C, const int* ldC)
+  {
+    cgemm_(transA,transB,M,N,K,alpha,A,ldA,B,ldB,beta,C,ldC);
+  }
+
+  inline void gemm(const char* transA, const char* transB,
+		   const int* M, const int* N, const int* K,
+		   const std::complex<double>* alpha,
+		   const std::complex<double>* A, const int* ldA,
+		   const std::complex<double>* B, const int* ldB,
+		   const std::complex<double>* beta,
+		   std::complex<double>* C, const int* ldC)
+  {
+    zgemm_(transA,transB,M,N,K,alpha,A,ldA,B,ldB,beta,C,ldC);
+  }
+
+  //
+  // Strided operands
+  //
+
+  // The BLAS description of an m by n matrix whose element (i,j) is at
+  // i*rs + j*cs: trans = 'N' if its columns are contiguous, 'T' if its
+  // rows are (it is then the transpose of a column-major n by m
+  // matrix), with leading dimension ld.  Returns false if neither, or
+  // if a size does not fit in an int.
+  inline bool layout(std::size_t m, std::size_t n,
+		     std::ptrdiff_t rs, std::ptrdiff_t cs, char* trans, int* ld)
+  {
+    if (m > INT_MAX || n > INT_MAX || rs > INT_MAX || cs > INT_MAX)
+      return false;
+
+    const std::ptrdiff_t mm = (m > 0 ? m : 1), nn = (n > 0 ? n : 1);
+
+    if ((rs == 1 || m <= 1) && (n <= 1 || cs >= mm))
+      {
+	*trans = 'N';
+	*ld = (n <= 1 ? mm : cs);
+	return true;
+      }
+    if ((cs == 1 || n <= 1) && (m <= 1 || rs >= nn))
+      {
+	*trans = 'T';
+	*ld = (m <= 1 ? nn : rs);
+	return true;
+      }
+    return false;
+  }
+
+  // y = alpha*x + y for n elements with positive strides.  Returns
+  // false if n or a stride does not fit in an int.
+  template<class T>
+  bool strided_axpy(std::size_t n, const T& alpha,
+		    const T* x, std::ptrdiff_t incx, T* y, std::ptrdiff_t incy)
+  {
+    if (n > INT_MAX || incx <= 0 || incy <= 0 || incx > INT_MAX ||
+	incy > INT_MAX)
+      return false;
+
+    const int N = n, ix = incx, iy = incy;
+    axpy(&N,&alpha,x,&ix,y,&iy);
+    return true;
+  }
+
+  // x = alpha*x for n elements with a positive stride.
+  template<class T>
+  bool strided_scal(std::size_t n, const T& alpha, T* x, std::ptrdiff_t incx)
+  {
+    if (n > INT_MAX || incx <= 0 || incx > INT_MAX) return false;
+
+    const int N = n, ix = incx;
+    scal(&N,&alpha,x,&ix);
+    return true;
+  }
+
+  // C = alpha*A*B + beta*C for strided A (m by k), B (k by n) and C (m
+  // by n), as in jlt::gemm().  Returns false (and does nothing) if an
+  // operand has no BLAS layout.
+  template<class T>
+  bool strided_gemm(std::size_t m, std::size_t n, std::size_t k,
+		    const T& alpha,
+		    const T* A, std::ptrdiff_t rsA, std::ptrdiff_t csA,
+		    const T* B, std::ptrdiff_t rsB, std::ptrdiff_t csB,
+		    const T& beta, T* C, std::ptrdiff_t rsC, std::ptrdiff_t csC)
+  {
+    char tA, tB, tC;
+    int ldA, ldB, ldC;
+
+    if (k > INT_MAX || !layout(m,n,rsC,csC,&tC,&ldC)) return false;
+
+    // Row-major C: compute its transpose, trans(B)*trans(A).
+    if (tC == 'T')
+      return strided_gemm(n,m,k,alpha,B,csB,rsB,A,csA,rsA,beta,C,csC,rsC);
+
+    if (!layout(m,k,rsA,csA,&tA,&ldA) || !layout(k,n,rsB,csB,&tB,&ldB))
+      return false;
+
+    const int M = m, N = n, K = k;
+    gemm(&tA,&tB,&M,&N,&K,&alpha,A,&ldA,B,&ldB,&beta,C,&ldC);
+    return true;
+  }
+
+  // y = alpha*A*x + beta*y for strided A (m by n) and vectors with
+  // positive strides.  Returns false if A has no BLAS layout.
+  template<class T>
+  bool strided_gemv(std::size_t m, std::size_t n, const T& alpha,
+		    const T* A, std::ptrdiff_t rsA, std::ptrdiff_t csA,
+		    const T* x, std::ptrdiff_t incx,
+		    const T& beta, T* y, std::ptrdiff_t incy)
+  {
+    char tA;
+    int ldA;
+
+    if (incx <= 0 || incy <= 0 || incx > INT_MAX || incy > INT_MAX ||
+	!layout(m,n,rsA,csA,&tA,&ldA))
+      return false;
+
+    // For 'T', A is stored as a column-major n by m matrix.
+    const int M = (tA == 'N' ? m : n), N = (tA == 'N' ? n : m);
+    const int ix = incx, iy = incy;
+    gemv(&tA,&M,&N,&alpha,A,&ldA,x,&ix,&beta,y,&iy);
+    return true;
+  }
+
+} // namespace blas
+} // namespace jlt
+
+#endif // JLT_BLAS_HPP
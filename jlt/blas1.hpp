@@ -0,0 +1,465 @@
+//
+// Copyright (c) 2004-2020 Jean-Luc Thiffeault <jeanluc@mailaps.org>
+//
+// See the file LICENSE for copying permission.
+//
+
+#ifndef JLT_BLAS1_HPP
+#define JLT_BLAS1_HPP
+
+//
+// blas1.hpp
+//
+
+// Fused in-place updates in the style of level-1 BLAS, for mathvector,
+// mathmatrix, vector_view and matrix_view operands:
+//
+//   axpy(a, x, y)                 y = a*x + y
+//   axpby(a, x, b, y)             y = a*x + b*y
+//   scal(a, x)                    x = a*x
+//   fma(x, y, z)                  z = x.*y + z   (element-wise)
+//   lincomb(a, x, b, y, out)      out = a*x + b*y
+//   dot(x, y)                     sum of x.*y    (not conjugated)
+//   nrm2(x)                       sqrt of the sum of |x|^2
+//
+// Each is a single pass over its operands, which must all have the
+// same shape; vectors and vector views count as one-column matrices.
+// The output may be one of the inputs.  When every operand is
+// contiguous in the same order (e.g. whole mathvectors, or whole
+// mathmatrices of the same storage order) the loop runs over raw
+// pointers with unit stride, which the compiler vectorises; views with
+// other strides are looped over by rows or columns, whichever has the
+// smaller stride in the output.  Loops over more than
+// 2*JLT_PARALLEL_GRAIN elements run in parallel (see thread_pool.hpp).
+//
+// nrm2 accumulates in three ranges, as in Blue's algorithm (see
+// LAPACK's dnrm2), so that it neither overflows nor underflows, with
+// no division in the loop.  dot and nrm2 sum in blocks of fixed size,
+// so their results do not depend on the number of threads.
+//
+// With JLT_USE_BLAS, axpy and scal of contiguous float, double and
+// complex operands call the linked BLAS instead.
+
+#include <cstddef>
+#include <cmath>
+#include <complex>
+#include <limits>
+#include <vector>
+#include <tuple>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+#include <jlt/matrix.hpp>
+#include <jlt/vector.hpp>
+#include <jlt/matrix_view.hpp>
+#include <jlt/thread_pool.hpp>
+#ifdef JLT_USE_BLAS
+#  include <jlt/blas.hpp>
+#endif
+
+namespace jlt {
+
+//
+// Operands
+//
+
+// Every operand is seen as a matrix_view; vectors have one column.
+
+template<class T, class Alloc, class Order>
+inline matrix_view<T> blas1_view(matrix<T,Alloc,Order>& A)
+{
+  return A.view();
+}
+
+template<class T, class Alloc, class Order>
+inline matrix_view<const T> blas1_view(const matrix<T,Alloc,Order>& A)
+{
+  return A.view();
+}
+
+template<class U>
+inline matrix_view<U> blas1_view(const matrix_view<U>& A)
+{
+  return A;
+}
+
+template<class T, class Alloc>
+inline matrix_view<T> blas1_view(vector<T,Alloc>& v)
+{
+  return matrix_view<T>(v.data(),v.size(),1,1,1);
+}
+
+template<class T, class Alloc>
+inline matrix_view<const T> blas1_view(const vector<T,Alloc>& v)
+{
+  return matrix_view<const T>(v.data(),v.size(),1,1,1);
+}
+
+template<class U>
+inline matrix_view<U> blas1_view(const vector_view<U>& v)
+{
+  return matrix_view<U>(v.data(),v.size(),1,v.stride(),1);
+}
+
+template<class X, class = void>
+struct is_blas1_operand : std::false_type {};
+
+template<class X>
+struct is_blas1_operand<X,
+			std::void_t<decltype(blas1_view(std::declval<X&>()))>>
+  : std::true_type {};
+
+template<class... X>
+using enable_if_blas1_t =
+  typename std::enable_if<(is_blas1_operand<typename std::remove_reference<X>::type>::value && ...)>::type;
+
+namespace blas1_detail {
+
+// 1 if V is dense in row-major order, 2 if in column-major order.
+template<class U>
+inline unsigned dense_order(const matrix_view<U>& V)
+{
+  const std::ptrdiff_t m = V.rows(), n = V.columns();
+  const std::ptrdiff_t rs = V.row_stride(), cs = V.column_stride();
+
+  return ((cs == 1 && (rs == n || m <= 1)) ? 1u : 0u) |
+    ((rs == 1 && (cs == m || n <= 1)) ? 2u : 0u);
+}
+
+// f(y(i,j), x(i,j)...) with the inner loop along the columns.
+template<class F, class Y, class... X>
+void for_each_strided(F& f, const matrix_view<Y>& y, const matrix_view<X>&... x)
+{
+  using std::size_t;
+
+  const size_t m = y.rows(), n = y.columns();
+  parallel_for(0,m,JLT_PARALLEL_GRAIN/n + 1,
+	       [&](size_t i0, size_t i1)
+	       {
+		 for (size_t i = i0; i < i1; ++i)
+		   {
+		     Y* py = y.data() + i*y.row_stride();
+		     const auto sy = y.column_stride();
+		     for (size_t j = 0; j < n; ++j)
+		       f(py[j*sy],x.data()[i*x.row_stride() + j*x.column_stride()]...);
+		   }
+	       });
+}
+
+// f(y(i,j), x(i,j)...) for every element of y.
+template<class F, class Y, class... X>
+void for_each(F f, const matrix_view<Y>& y, const matrix_view<X>&... x)
+{
+  using std::size_t;
+
+  MATRIX_ASSERT(((x.rows() == y.rows() && x.columns() == y.columns()) && ...));
+
+  const size_t len = y.size();
+  if (len == 0) return;
+
+  unsigned order = dense_order(y);
+  ((order &= dense_order(x)), ...);
+
+  if (order)
+    {
+      // Everything contiguous in the same order: one flat loop.
+      Y* py = y.data();
+      auto px = std::make_tuple(x.data()...);
+      parallel_for(0,len,JLT_PARALLEL_GRAIN,
+		   [&](size_t k0, size_t k1)
+		   {
+		     std::apply([&](auto... p)
+				{
+				  for (size_t k = k0; k < k1; ++k) f(py[k],p[k]...);
+				},px);
+		   });
+    }
+  else if (std::abs(y.row_stride()) < std::abs(y.column_stride()))
+    {
+      // Loop along the smaller stride of y.
+      for_each_strided(f,y.transpose(),x.transpose()...);
+    }
+  else
+    {
+      for_each_strided(f,y,x...);
+    }
+}
+
+// Block size of the reductions, independent of the thread count.
+constexpr std::size_t reduce_block = 4096;
+
+// Accumulate f(part[b], x(i,j)...) over blocks b of whole rows.
+template<class Acc, class F, class X0, class... X>
+void reduce_strided(std::vector<Acc>& part, const Acc& init, F& f,
+		    const matrix_view<X0>& x0, const matrix_view<X>&... x)
+{
+  using std::size_t;
+
+  const size_t m = x0.rows(), n = x0.columns();
+  const size_t rb = reduce_block/n + 1;	// Rows per block.
+  const size_t nb = (m + rb - 1)/rb;
+  part.assign(nb,init);
+  parallel_for(0,nb,JLT_PARALLEL_GRAIN/(rb*n) + 1,
+	       [&](size_t b0, size_t b1)
+	       {
+		 for (size_t b = b0; b < b1; ++b)
+		   {
+		     Acc& a = part[b];
+		     const size_t i1 = std::min(m,(b+1)*rb);
+		     for (size_t i = b*rb; i < i1; ++i)
+		       for (size_t j = 0; j < n; ++j)
+			 f(a,x0.data()[i*x0.row_stride() + j*x0.column_stride()],
+			   x.data()[i*x.row_stride() + j*x.column_stride()]...);
+		   }
+	       });
+}
+
+// Accumulate f(acc, x0(i,j), x(i,j)...) over all elements, in blocks
+// of reduce_block elements (or of whole rows), and combine the partial
+// accumulators in order with c(acc, partial).
+template<class Acc, class F, class C, class X0, class... X>
+Acc reduce(const Acc& init, F f, C c,
+	   const matrix_view<X0>& x0, const matrix_view<X>&... x)
+{
+  using std::size_t;
+
+  const size_t len = x0.size();
+  if (len == 0) return init;
+
+  unsigned order = dense_order(x0);
+  ((order &= dense_order(x)), ...);
+
+  std::vector<Acc> part;
+
+  if (order)
+    {
+      const size_t nb = (len + reduce_block - 1)/reduce_block;
+      part.assign(nb,init);
+      auto px = std::make_tuple(x0.data(),x.data()...);
+      parallel_for(0,nb,JLT_PARALLEL_GRAIN/reduce_block + 1,
+		   [&](size_t b0, size_t b1)
+		   {
+		     std::apply([&](auto... p)
+				{
+				  for (size_t b = b0; b < b1; ++b)
+				    {
+				      const size_t k1 =
+					std::min(len,(b+1)*reduce_block);
+				      Acc& a = part[b];
+				      for (size_t k = b*reduce_block; k < k1; ++k)
+					f(a,p[k]...);
+				    }
+				},px);
+		   });
+    }
+  else if (std::abs(x0.row_stride()) < std::abs(x0.column_stride()))
+    {
+      reduce_strided(part,init,f,x0.transpose(),x.transpose()...);
+    }
+  else
+    {
+      reduce_strided(part,init,f,x0,x...);
+    }
+
+  Acc acc = init;
+  for (const auto& a : part) c(acc,a);
+  return acc;
+}
+
+// Accumulators for Blue's algorithm, for a real type R.
+template<class R>
+struct nrm2_acc
+{
+  R sml{0}, med{0}, big{0};
+
+  // Thresholds and scalings: squares of elements between tsml and tbig
+  // are summed as they are, smaller ones scaled up by ssml and larger
+  // ones scaled down by sbig.
+  static R tsml()
+    {
+      using L = std::numeric_limits<R>;
+      return std::pow(R(L::radix),std::ceil((L::min_exponent - 1)*R(0.5)));
+    }
+  static R tbig()
+    {
+      using L = std::numeric_limits<R>;
+      return std::pow(R(L::radix),
+		      std::floor((L::max_exponent - L::digits + 1)*R(0.5)));
+    }
+  static R ssml()
+    {
+      using L = std::numeric_limits<R>;
+      return std::pow(R(L::radix),
+		      -std::floor((L::min_exponent - L::digits)*R(0.5)));
+    }
+  static R sbig()
+    {
+      using L = std::numeric_limits<R>;
+      return std::pow(R(L::radix),
+		      -std::ceil((L::max_exponent + L::digits - 1)*R(0.5)));
+    }
+
+  R value() const
+    {
+      using std::sqrt;
+
+      if (big > 0)
+	{
+	  R s = big;
+	  if (med > 0 || std::isnan(med)) s += (med*sbig())*sbig();
+	  return sqrt(s)/sbig();
+	}
+      if (sml > 0)
+	{
+	  if (med > 0 || std::isnan(med))
+	    {
+	      const R a = sqrt(med), b = sqrt(sml)/ssml();
+	      const R ymin = std::min(a,b), ymax = std::max(a,b);
+	      return ymax*sqrt(1 + (ymin/ymax)*(ymin/ymax));
+	    }
+	  return sqrt(sml)/ssml();
+	}
+      return sqrt(med);
+    }
+};
+
+} // namespace blas1_detail
+
+//
+// Updates
+//
+
+// y = a*x + y.
+template<class A, class X, class Y, class = enable_if_blas1_t<X,Y>>
+inline void axpy(const A& a, const X& x, Y&& y)
+{
+  auto vx = blas1_view(x);
+  auto vy = blas1_view(y);
+
+#ifdef JLT_USE_BLAS
+  using T = typename decltype(vy)::value_type;
+  if constexpr (blas::is_blas_type<T>::value &&
+		std::is_same<typename decltype(vx)::value_type,T>::value)
+    {
+      if ((blas1_detail::dense_order(vx) & blas1_detail::dense_order(vy)) &&
+	  blas::strided_axpy(vy.size(),T(a),vx.data(),1,vy.data(),1))
+	return;
+    }
+#endif
+
+  blas1_detail::for_each([&a](auto& yk, const auto& xk) { yk += a*xk; },
+			 vy,vx);
+}
+
+// y = a*x + b*y.
+template<class A, class X, class B, class Y, class = enable_if_blas1_t<X,Y>>
+inline void axpby(const A& a, const X& x, const B& b, Y&& y)
+{
+  blas1_detail::for_each([&a,&b](auto& yk, const auto& xk)
+			 { yk = a*xk + b*yk; },
+			 blas1_view(y),blas1_view(x));
+}
+
+// x = a*x.
+template<class A, class X, class = enable_if_blas1_t<X>>
+inline void scal(const A& a, X&& x)
+{
+  auto vx = blas1_view(x);
+
+#ifdef JLT_USE_BLAS
+  using T = typename decltype(vx)::value_type;
+  if constexpr (blas::is_blas_type<T>::value)
+    {
+      if (blas1_detail::dense_order(vx) &&
+	  blas::strided_scal(vx.size(),T(a),vx.data(),1))
+	return;
+    }
+#endif
+
+  blas1_detail::for_each([&a](auto& xk) { xk *= a; },vx);
+}
+
+// z = x.*y + z, element by element.
+template<class X, class Y, class Z, class = enable_if_blas1_t<X,Y,Z>>
+inline void fma(const X& x, const Y& y, Z&& z)
+{
+  blas1_detail::for_each([](auto& zk, const auto& xk, const auto& yk)
+			 { zk += xk*yk; },
+			 blas1_view(z),blas1_view(x),blas1_view(y));
+}
+
+// out = a*x + b*y.  out must already have the right shape.
+template<class A, class X, class B, class Y, class Out,
+	 class = enable_if_blas1_t<X,Y,Out>>
+inline void lincomb(const A& a, const X& x, const B& b, const Y& y, Out&& out)
+{
+  blas1_detail::for_each([&a,&b](auto& ok, const auto& xk, const auto& yk)
+			 { ok = a*xk + b*yk; },
+			 blas1_view(out),blas1_view(x),blas1_view(y));
+}
+
+//
+// Reductions
+//
+
+// Sum of x.*y, without conjugation.  (Two mathvectors use the overload
+// in mathvector.hpp.)
+template<class X, class Y,
+	 typename std::enable_if<is_blas1_operand<X>::value &&
+				 is_blas1_operand<Y>::value,int>::type = 0>
+inline auto dot(const X& x, const Y& y)
+{
+  auto vx = blas1_view(x);
+  auto vy = blas1_view(y);
+  using T = decltype(vx(0,0)*vy(0,0));
+
+  MATRIX_ASSERT(vx.rows() == vy.rows() && vx.columns() == vy.columns());
+
+  return blas1_detail::reduce(T(),
+			      [](T& s, const auto& xk, const auto& yk)
+			      { s += xk*yk; },
+			      [](T& s, const T& p) { s += p; },
+			      vx,vy);
+}
+
+// Euclidean (Frobenius) norm.
+template<class X, class = enable_if_blas1_t<X>>
+inline auto nrm2(const X& x)
+{
+  using std::abs;
+
+  auto vx = blas1_view(x);
+  using R = decltype(abs(vx(0,0)));
+  using Acc = blas1_detail::nrm2_acc<R>;
+
+  const R tsml = Acc::tsml(), tbig = Acc::tbig();
+  const R ssml = Acc::ssml(), sbig = Acc::sbig();
+
+  auto add = [=](Acc& s, R a)
+    {
+      a = abs(a);
+      if (a > tbig) { a *= sbig; s.big += a*a; }
+      else if (a < tsml) { a *= ssml; s.sml += a*a; }
+      else s.med += a*a;
+    };
+
+  auto acc = blas1_detail::reduce(Acc(),
+				  [&add](Acc& s, const auto& xk)
+				  {
+				    if constexpr (std::is_same<
+						  typename std::decay<decltype(xk)>::type,
+						  R>::value)
+				      add(s,xk);
+				    else
+				      { add(s,xk.real()); add(s,xk.imag()); }
+				  },
+				  [](Acc& s, const Acc& p)
+				  { s.sml += p.sml; s.med += p.med; s.big += p.big; },
+				  vx);
+
+  return acc.value();
+}
+
+} // namespace jlt
+
+#endif // JLT_BLAS1_HPP
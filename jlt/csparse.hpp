@@ -21,6 +21,7 @@
 #include <cstdio>
 #include <memory>
 #include <jlt/mathmatrix.hpp>
+#include <jlt/graph.hpp>
 
 namespace csparse
 {
@@ -151,6 +152,26 @@ mathmatrix<T> cs_sparse_matrix_to_mathmatrix(const cs_unique_ptr& csM)
   return M;
 }
 
+// Irreducibility and primitivity of a square column-compressed matrix,
+// in O(n + nnz) (see graph.hpp).  The columns are read as the
+// successor lists of the graph of the transpose, which has the same
+// strong components and period, so no copy is made.  Explicitly
+// stored zeros count as nonzero: use csparse::cs_dropzeros first if
+// the matrix may contain some.
+inline bool cs_isIrreducible(const csparse::cs* A)
+{
+  if (!A || A->nz >= 0 || A->m != A->n) return false;
+
+  return strongly_connected(A->n,A->p,A->i);
+}
+
+inline bool cs_isPrimitive(const csparse::cs* A)
+{
+  if (!A || A->nz >= 0 || A->m != A->n) return false;
+
+  return primitive_graph(A->n,A->p,A->i);
+}
+
 } // namespace jlt
 
 #endif // JLT_CSPARSE_HPP
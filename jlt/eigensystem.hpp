@@ -11,6 +11,7 @@
 #include <cmath>
 #include <complex>
 #include <jlt/matrix.hpp>
+#include <jlt/packed_matrix.hpp>
 #include <jlt/lapack.hpp>
 
 #include <cassert>
@@ -24,11 +25,18 @@
 //
 // All these routines destroy the data in A!
 //
+// They work directly on the storage of A, whatever its storage order:
+// no copy of A is made.
+//
 
 namespace jlt {
 
-template<class T>
-int symmetric_matrix_eigensystem(matrix<T>& A,
+// On return the eigenvalues are in descending order, and A holds the
+// corresponding orthonormal eigenvectors: as its rows if A is
+// row-major, as its columns if A is column-major.  (In both cases each
+// eigenvector is contiguous in memory, which is what LAPACK returns.)
+template<class T, class Alloc, class Order>
+int symmetric_matrix_eigensystem(matrix<T,Alloc,Order>& A,
 				 std::vector<T>& eigvals)
 {
   char jobz = 'V';	// 'N'-eigenvalues only, 'V'-eigenvalues and vectors
@@ -39,20 +47,16 @@ int symmetric_matrix_eigensystem(matrix<T>& A,
 
   int info;
 
-  // Use temporary vector and copy of A, since we need to reverse the order.
-  std::vector<T> eigs(N);
-  matrix<T> U(A);
-
   // Call the routine with worksize = -1, to get the ideal size of workspace.
   int worksize = -1;
   T tmpwork[1];
 
 # if !defined(JLT_NO_VECTOR_DATA_METHOD)
-  lapack::syev(&jobz, &uplo, &N, U.data(), &N, eigs.data(),
+  lapack::syev(&jobz, &uplo, &N, A.data(), &N, eigvals.data(),
 	       tmpwork, &worksize, &info);
 # else
-  lapack::syev(&jobz, &uplo, &N, &(*U.begin()), &N,
-	       &(*eigs.begin()), tmpwork, &worksize, &info);
+  lapack::syev(&jobz, &uplo, &N, &(*A.begin()), &N,
+	       &(*eigvals.begin()), tmpwork, &worksize, &info);
 # endif
 
   // Now allocate the memory for the workspace.
@@ -60,30 +64,88 @@ int symmetric_matrix_eigensystem(matrix<T>& A,
   std::vector<T> work(worksize);
 
 # if !defined(JLT_NO_VECTOR_DATA_METHOD)
-  lapack::syev(&jobz, &uplo, &N, U.data(), &N, eigs.data(),
+  lapack::syev(&jobz, &uplo, &N, A.data(), &N, eigvals.data(),
 	       work.data(), &worksize, &info);
 # else
-  lapack::syev(&jobz, &uplo, &N, &(*U.begin()), &N,
-	       &(*eigs.begin()), &(*work.begin()), &worksize, &info);
+  lapack::syev(&jobz, &uplo, &N, &(*A.begin()), &N,
+	       &(*eigvals.begin()), &(*work.begin()), &worksize, &info);
 # endif
 
   // Output eigenvalues in *descending* order.
-  for (int i = 0; i < N; ++i) eigvals[i] = eigs[N-i-1];
-  // Also need to reverse the eigenvectors, stored as row vectors.
-  for (int i = 0; i < N; ++i)
+  std::reverse(eigvals.begin(),eigvals.end());
+  // Also need to reverse the eigenvectors, which are contiguous.
+  // Swap them in place rather than going through a copy of A.
+  T *Ap = A.data();
+  for (int i = 0; i < N/2; ++i)
+    {
+      std::swap_ranges(Ap + i*N, Ap + (i+1)*N, Ap + (N-i-1)*N);
+    }
+
+  return info;
+}
+
+
+// Packed symmetric matrix (LAPACK spev), with the same conventions:
+// eigenvalues in descending order, and the eigenvectors as the rows of
+// Z if Z is row-major, its columns if Z is column-major.  Z must be of
+// the same size as A.
+template<class T, class Alloc, class Alloc2, class Order>
+int symmetric_matrix_eigensystem(symmetric_matrix<T,Alloc>& A,
+				 std::vector<T>& eigvals,
+				 matrix<T,Alloc2,Order>& Z)
+{
+  char jobz = 'V';	// 'N'-eigenvalues only, 'V'-eigenvalues and vectors
+  char uplo = 'U';	// Packed lower triangle by rows is upper by columns.
+  int N = A.rows();	// Dimensions of matrix.
+
+  assert(N == (int)eigvals.size());
+  assert(N == (int)Z.rows() && N == (int)Z.columns());
+
+  int info;
+  std::vector<T> work(3*N);
+
+  lapack::spev(&jobz, &uplo, &N, A.data(), eigvals.data(), Z.data(), &N,
+	       work.data(), &info);
+
+  // Output eigenvalues in *descending* order, and the contiguous
+  // eigenvectors to match.
+  std::reverse(eigvals.begin(),eigvals.end());
+  T *Zp = Z.data();
+  for (int i = 0; i < N/2; ++i)
     {
-      for (int j = 0; j < N; ++j)
-	{
-	  A(i,j) = U(N-i-1,j);
-	}
+      std::swap_ranges(Zp + i*N, Zp + (i+1)*N, Zp + (N-i-1)*N);
     }
 
   return info;
 }
 
 
-template<class T>
-int matrix_eigenvalues(matrix<T>& A,
+// Eigenvalues only of a packed symmetric matrix, in descending order.
+template<class T, class Alloc>
+int symmetric_matrix_eigenvalues(symmetric_matrix<T,Alloc>& A,
+				 std::vector<T>& eigvals)
+{
+  char jobz = 'N';	// 'N'-eigenvalues only, 'V'-eigenvalues and vectors
+  char uplo = 'U';	// Packed lower triangle by rows is upper by columns.
+  int N = A.rows();	// Dimensions of matrix.
+  int ldZ = 1;
+
+  assert(N == (int)eigvals.size());
+
+  int info;
+  std::vector<T> work(3*N);
+
+  lapack::spev(&jobz, &uplo, &N, A.data(), eigvals.data(), nullptr, &ldZ,
+	       work.data(), &info);
+
+  std::reverse(eigvals.begin(),eigvals.end());
+
+  return info;
+}
+
+
+template<class T, class Alloc, class Order>
+int matrix_eigenvalues(matrix<T,Alloc,Order>& A,
 		       std::vector<std::complex<T>>& eigvals)
 {
   char jobVL = 'N';	// 'N'-eigenvalues only, 'V'-eigenvalues and vectors
@@ -133,8 +195,8 @@ int matrix_eigenvalues(matrix<T>& A,
 }
 
 
-template<class T>
-int matrix_eigenvalues(matrix<std::complex<T>>& A,
+template<class T, class Alloc, class Order>
+int matrix_eigenvalues(matrix<std::complex<T>,Alloc,Order>& A,
 		       std::vector<std::complex<T>>& eigvals)
 {
   char jobVL = 'N';	// 'N'-eigenvalues only, 'V'-eigenvalues and vectors
@@ -181,8 +243,8 @@ int matrix_eigenvalues(matrix<std::complex<T>>& A,
 
 /* The spectral_radius function is inefficient: should only require
    the largest eigenvalue in magniture, but it finds them all. */
-template<class T>
-T spectral_radius(matrix<T>& A)
+template<class T, class Alloc, class Order>
+T spectral_radius(matrix<T,Alloc,Order>& A)
 {
   std::vector<std::complex<T>> ev(A.rows());
   matrix_eigenvalues(A,ev);
@@ -198,8 +260,8 @@ T spectral_radius(matrix<T>& A)
 }
 
 
-template<class T>
-T spectral_radius(matrix<std::complex<T>>& A)
+template<class T, class Alloc, class Order>
+T spectral_radius(matrix<std::complex<T>,Alloc,Order>& A)
 {
   std::vector<std::complex<T>> ev(A.rows());
   matrix_eigenvalues(A,ev);
@@ -0,0 +1,545 @@
+//
+// Copyright (c) 2004-2020 Jean-Luc Thiffeault <jeanluc@mailaps.org>
+//
+// See the file LICENSE for copying permission.
+//
+
+#ifndef JLT_EXPRESSION_HPP
+#define JLT_EXPRESSION_HPP
+
+//
+// expression.hpp
+//
+
+// Expression templates for the element-wise arithmetic of mathvector
+// and mathmatrix: +, -, multiplication and division by a scalar, and
+// component-wise division of vectors.  An expression such as
+//
+//   mathvector<double> r = a*x + b*y - z;
+//
+// does not compute anything until it is assigned: it builds a small
+// tree of the operations, which is then evaluated in a single loop
+// over the elements, with no temporaries.  Assigning to a vector or
+// matrix of the right size reuses its storage, and so does an operand
+// that is itself a temporary (e.g. the result of a matrix product),
+// so that
+//
+//   r = A*x - b;
+//
+// writes the difference straight into the vector returned by A*x.
+// Since every element of the result depends only on the same element
+// of the operands, it is fine for the result to appear on the right
+// (x = x + dt*v).
+//
+// The expression types are an implementation detail.  They convert
+// implicitly to the vector or matrix type, can be printed, and can be
+// passed to dot(), mag2() and abs(), and to products, but functions
+// templated on mathvector or mathmatrix will not deduce their
+// arguments from them: assign the expression to a mathvector or
+// mathmatrix first, or call eval().  Operands that are not temporaries
+// are held by reference, so do not store an expression in an auto
+// variable beyond the lifetime of its operands.
+//
+// The single loop of an assignment runs in parallel over ranges of
+// elements once it exceeds 2*JLT_PARALLEL_GRAIN (see thread_pool.hpp).
+
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <utility>
+#include <type_traits>
+#include <jlt/vector.hpp>
+#include <jlt/thread_pool.hpp>
+
+namespace jlt {
+
+//
+// Containers that take part in expressions
+//
+
+// Specialised in mathvector.hpp and mathmatrix.hpp.  is_vector
+// selects the vector-only operations (component-wise division, dot
+// products).
+template<class C>
+struct expr_container_traits
+{
+  static constexpr bool is_container = false;
+  static constexpr bool is_vector = false;
+};
+
+template<class X> struct is_expr_node : std::false_type {};
+
+// The vector or matrix type that an operand (a container or an
+// expression node) evaluates to.
+template<class X, class = void>
+struct expr_result {};
+
+template<class X>
+struct expr_result<X,
+		   typename std::enable_if<expr_container_traits<X>::is_container>::type>
+{
+  using type = X;
+};
+
+template<class X>
+struct expr_result<X, typename std::enable_if<is_expr_node<X>::value>::type>
+{
+  using type = typename X::result_type;
+};
+
+template<class X>
+using expr_result_t = typename expr_result<typename std::decay<X>::type>::type;
+
+template<class X, class = void>
+struct is_expr_operand : std::false_type {};
+
+template<class X>
+struct is_expr_operand<X, std::void_t<expr_result_t<X>>> : std::true_type {};
+
+// Two operands of an element-wise operation must evaluate to the same
+// type.
+template<class X, class Y, class = void>
+struct expr_same_result : std::false_type {};
+
+template<class X, class Y>
+struct expr_same_result<X, Y,
+			typename std::enable_if<is_expr_operand<X>::value &&
+						is_expr_operand<Y>::value>::type>
+  : std::is_same<expr_result_t<X>,expr_result_t<Y>> {};
+
+template<class X, class = void>
+struct is_vector_expr_operand : std::false_type {};
+
+template<class X>
+struct is_vector_expr_operand<X,
+			      typename std::enable_if<is_expr_operand<X>::value>::type>
+  : std::integral_constant<bool,
+			   expr_container_traits<expr_result_t<X>>::is_vector> {};
+
+//
+// Operations
+//
+
+struct expr_identity
+{
+  template<class X>
+  static X apply(const X& x) { return x; }
+};
+
+struct expr_negate
+{
+  template<class X>
+  static auto apply(const X& x) { return -x; }
+};
+
+struct expr_plus
+{
+  template<class X, class Y>
+  static auto apply(const X& x, const Y& y) { return x + y; }
+};
+
+struct expr_minus
+{
+  template<class X, class Y>
+  static auto apply(const X& x, const Y& y) { return x - y; }
+};
+
+struct expr_divides
+{
+  template<class X, class Y>
+  static auto apply(const X& x, const Y& y) { return x / y; }
+};
+
+// Multiplication by a scalar a, always as a*x, for both a*v and v*a.
+struct expr_scale
+{
+  template<class S, class X>
+  static auto apply(const S& a, const X& x) { return a * x; }
+};
+
+struct expr_scale_divides
+{
+  template<class S, class X>
+  static auto apply(const S& a, const X& x) { return x / a; }
+};
+
+//
+// Leaves
+//
+
+// A container that outlives the expression, held by reference.
+template<class C>
+class expr_ref
+{
+  const C& c;
+
+public:
+  using result_type = C;
+  using size_type = typename C::size_type;
+
+  explicit expr_ref(const C& _c) : c(_c) {}
+
+  decltype(auto) operator[](size_type k) const { return c.cbegin()[k]; }
+  [[nodiscard]] size_type size() const { return c.size(); }
+  [[nodiscard]] const C& shape() const { return c; }
+  C* owned() { return nullptr; }
+};
+
+// A temporary container, moved into the expression so that it lives
+// as long as the expression, and whose storage can hold the result.
+template<class C>
+class expr_temp
+{
+  C c;
+
+public:
+  using result_type = C;
+  using size_type = typename C::size_type;
+
+  explicit expr_temp(C&& _c) : c(std::move(_c)) {}
+
+  decltype(auto) operator[](size_type k) const { return c.cbegin()[k]; }
+  [[nodiscard]] size_type size() const { return c.size(); }
+  [[nodiscard]] const C& shape() const { return c; }
+  C* owned() { return &c; }
+};
+
+//
+// Nodes
+//
+
+template<class Op, class E>
+class expr_unary
+{
+  E e;
+
+public:
+  using result_type = typename E::result_type;
+  using size_type = typename result_type::size_type;
+
+  explicit expr_unary(E&& _e) : e(std::move(_e)) {}
+
+  auto operator[](size_type k) const { return Op::apply(e[k]); }
+  [[nodiscard]] size_type size() const { return e.size(); }
+  [[nodiscard]] const result_type& shape() const { return e.shape(); }
+  result_type* owned() { return e.owned(); }
+  [[nodiscard]] result_type eval() const { return result_type(*this); }
+};
+
+template<class Op, class L, class R>
+class expr_binary
+{
+  L l;
+  R r;
+
+public:
+  using result_type = typename L::result_type;
+  using size_type = typename result_type::size_type;
+
+  expr_binary(L&& _l, R&& _r) : l(std::move(_l)), r(std::move(_r))
+    {
+      VECTOR_ASSERT(l.size() == r.size());
+    }
+
+  auto operator[](size_type k) const { return Op::apply(l[k],r[k]); }
+  [[nodiscard]] size_type size() const { return l.size(); }
+  [[nodiscard]] const result_type& shape() const { return l.shape(); }
+
+  result_type* owned()
+    {
+      if (auto t = l.owned()) return t;
+      return r.owned();
+    }
+
+  [[nodiscard]] result_type eval() const { return result_type(*this); }
+};
+
+template<class Op, class E>
+class expr_scalar
+{
+public:
+  using result_type = typename E::result_type;
+  using scalar_type = typename result_type::scalar_type;
+  using size_type = typename result_type::size_type;
+
+private:
+  E e;
+  scalar_type a;
+
+public:
+  expr_scalar(E&& _e, const scalar_type& _a) : e(std::move(_e)), a(_a) {}
+
+  auto operator[](size_type k) const { return Op::apply(a,e[k]); }
+  [[nodiscard]] size_type size() const { return e.size(); }
+  [[nodiscard]] const result_type& shape() const { return e.shape(); }
+  result_type* owned() { return e.owned(); }
+  [[nodiscard]] result_type eval() const { return result_type(*this); }
+};
+
+template<class Op, class E>
+struct is_expr_node<expr_unary<Op,E>> : std::true_type {};
+template<class Op, class L, class R>
+struct is_expr_node<expr_binary<Op,L,R>> : std::true_type {};
+template<class Op, class E>
+struct is_expr_node<expr_scalar<Op,E>> : std::true_type {};
+
+template<class X>
+using is_expr_node_t = is_expr_node<typename std::decay<X>::type>;
+
+//
+// Building expressions
+//
+
+// Turn an operand into a leaf or node, moving temporaries in.
+template<class X>
+inline auto make_expr(X&& x)
+{
+  using D = typename std::decay<X>::type;
+
+  if constexpr (is_expr_node<D>::value)
+    return D(std::forward<X>(x));
+  else if constexpr (std::is_lvalue_reference<X>::value)
+    return expr_ref<D>(x);
+  else
+    return expr_temp<D>(std::move(x));
+}
+
+template<class Op, class X>
+inline auto make_unary_expr(X&& x)
+{
+  auto e = make_expr(std::forward<X>(x));
+  return expr_unary<Op,decltype(e)>(std::move(e));
+}
+
+template<class Op, class X, class Y>
+inline auto make_binary_expr(X&& x, Y&& y)
+{
+  auto l = make_expr(std::forward<X>(x));
+  auto r = make_expr(std::forward<Y>(y));
+  return expr_binary<Op,decltype(l),decltype(r)>(std::move(l),std::move(r));
+}
+
+template<class Op, class X>
+inline auto make_scalar_expr(X&& x,
+			     const typename expr_result_t<X>::scalar_type& a)
+{
+  auto e = make_expr(std::forward<X>(x));
+  return expr_scalar<Op,decltype(e)>(std::move(e),a);
+}
+
+//
+// Evaluation
+//
+
+// out[k] op= e[k] for k < e.size(), with op one of the functions
+// below, in parallel for long loops.
+template<class C, class E, class Op>
+inline void expr_evaluate(C& c, const E& e, Op op)
+{
+  auto out = c.begin();
+  parallel_for(0,e.size(),JLT_PARALLEL_GRAIN,
+	       [&](std::size_t k0, std::size_t k1)
+	       {
+		 for (auto k = k0; k < k1; ++k) op(out[k],e[k]);
+	       });
+}
+
+// c[k] = e[k].  c must already have the right size.
+template<class C, class E>
+inline void expr_assign(C& c, const E& e)
+{
+  expr_evaluate(c,e,[](auto& x, const auto& y) { x = y; });
+}
+
+template<class C, class E>
+inline void expr_plus_assign(C& c, const E& e)
+{
+  expr_evaluate(c,e,[](auto& x, const auto& y) { x += y; });
+}
+
+template<class C, class E>
+inline void expr_minus_assign(C& c, const E& e)
+{
+  expr_evaluate(c,e,[](auto& x, const auto& y) { x -= y; });
+}
+
+// If e is a temporary expression with a temporary operand, evaluate
+// it into that operand and swap the storage into c.  Returns false
+// (and does nothing) otherwise.
+template<class C, class E>
+inline bool expr_steal(C& c, E&& e)
+{
+  if constexpr (std::is_lvalue_reference<E>::value)
+    {
+      return false;
+    }
+  else
+    {
+      auto t = e.owned();
+      if (!t) return false;
+      expr_assign(*t,e);
+      c.swap(*t);
+      return true;
+    }
+}
+
+//
+// Element-wise operators
+//
+
+template<class X, class = typename std::enable_if<is_expr_operand<X>::value>::type>
+inline auto operator+(X&& x)
+{
+  return make_unary_expr<expr_identity>(std::forward<X>(x));
+}
+
+template<class X, class = typename std::enable_if<is_expr_operand<X>::value>::type>
+inline auto operator-(X&& x)
+{
+  return make_unary_expr<expr_negate>(std::forward<X>(x));
+}
+
+template<class X, class Y,
+	 class = typename std::enable_if<expr_same_result<X,Y>::value>::type>
+inline auto operator+(X&& x, Y&& y)
+{
+  return make_binary_expr<expr_plus>(std::forward<X>(x),std::forward<Y>(y));
+}
+
+template<class X, class Y,
+	 class = typename std::enable_if<expr_same_result<X,Y>::value>::type>
+inline auto operator-(X&& x, Y&& y)
+{
+  return make_binary_expr<expr_minus>(std::forward<X>(x),std::forward<Y>(y));
+}
+
+// Component-wise division, for vectors only.
+template<class X, class Y,
+	 class = typename std::enable_if<expr_same_result<X,Y>::value &&
+					 is_vector_expr_operand<X>::value>::type>
+inline auto operator/(X&& x, Y&& y)
+{
+  return make_binary_expr<expr_divides>(std::forward<X>(x),std::forward<Y>(y));
+}
+
+template<class X, class = typename std::enable_if<is_expr_operand<X>::value>::type>
+inline auto operator*(const typename expr_result_t<X>::scalar_type& a, X&& x)
+{
+  return make_scalar_expr<expr_scale>(std::forward<X>(x),a);
+}
+
+template<class X, class = typename std::enable_if<is_expr_operand<X>::value>::type>
+inline auto operator*(X&& x, const typename expr_result_t<X>::scalar_type& a)
+{
+  return make_scalar_expr<expr_scale>(std::forward<X>(x),a);
+}
+
+template<class X, class = typename std::enable_if<is_expr_operand<X>::value>::type>
+inline auto operator/(X&& x, const typename expr_result_t<X>::scalar_type& a)
+{
+  return make_scalar_expr<expr_scale_divides>(std::forward<X>(x),a);
+}
+
+//
+// Reductions of vector expressions, in one pass without evaluating
+// the expression.  (The overloads for two mathvectors are in
+// mathvector.hpp.)
+//
+
+template<class X, class Y,
+	 class = typename std::enable_if<expr_same_result<X,Y>::value &&
+					 is_vector_expr_operand<X>::value &&
+					 (is_expr_node_t<X>::value ||
+					  is_expr_node_t<Y>::value)>::type>
+inline auto dot(const X& x, const Y& y)
+{
+  using S = typename expr_result_t<X>::scalar_type;
+
+  VECTOR_ASSERT(x.size() == y.size());
+
+  auto l = make_expr(x);
+  auto r = make_expr(y);
+  S dotp = S();
+  for (typename decltype(l)::size_type k = 0; k < l.size(); ++k)
+    dotp += l[k]*r[k];
+
+  return dotp;
+}
+
+// Dot product (not component-wise multiplication).
+template<class X, class Y,
+	 class = typename std::enable_if<expr_same_result<X,Y>::value &&
+					 is_vector_expr_operand<X>::value &&
+					 (is_expr_node_t<X>::value ||
+					  is_expr_node_t<Y>::value)>::type>
+inline auto operator*(const X& x, const Y& y)
+{
+  return dot(x,y);
+}
+
+template<class T>
+inline auto expr_norm(const T& x) { return x*x; }
+
+template<class T>
+inline T expr_norm(const std::complex<T>& x) { return std::norm(x); }
+
+template<class E,
+	 class = typename std::enable_if<is_expr_node_t<E>::value &&
+					 is_vector_expr_operand<E>::value>::type>
+inline auto mag2(const E& e)
+{
+  using S = typename expr_result_t<E>::scalar_type;
+
+  S magn = S();
+  for (typename E::size_type k = 0; k < e.size(); ++k) magn += expr_norm(e[k]);
+
+  return magn;
+}
+
+template<class E,
+	 class = typename std::enable_if<is_expr_node_t<E>::value &&
+					 is_vector_expr_operand<E>::value>::type>
+inline auto abs(const E& e)
+{
+  return std::sqrt(mag2(e));
+}
+
+//
+// Anything else evaluates the expression first
+//
+
+// Products other than by a scalar or a dot product (for instance
+// matrix-matrix and matrix-vector products) need all the elements of
+// their operands, so they evaluate any expression operand first.
+template<class X, class Y,
+	 class = typename std::enable_if<
+	   is_expr_node_t<X>::value &&
+	   !std::is_convertible<Y,typename expr_result_t<X>::scalar_type>::value &&
+	   !(is_vector_expr_operand<X>::value && expr_same_result<X,Y>::value)>::type>
+inline auto operator*(const X& x, const Y& y)
+  -> decltype(std::declval<const expr_result_t<X>&>() * y)
+{
+  return expr_result_t<X>(x) * y;
+}
+
+template<class X, class Y,
+	 class = typename std::enable_if<
+	   !is_expr_node_t<X>::value && is_expr_node_t<Y>::value &&
+	   !std::is_convertible<X,typename expr_result_t<Y>::scalar_type>::value &&
+	   !(is_vector_expr_operand<Y>::value && expr_same_result<X,Y>::value)>::type,
+	 class = void>
+inline auto operator*(const X& x, const Y& y)
+  -> decltype(x * std::declval<const expr_result_t<Y>&>())
+{
+  return x * expr_result_t<Y>(y);
+}
+
+template<class E, class = typename std::enable_if<is_expr_node_t<E>::value>::type>
+inline std::ostream& operator<<(std::ostream& strm, const E& e)
+{
+  return strm << expr_result_t<E>(e);
+}
+
+} // namespace jlt
+
+#endif // JLT_EXPRESSION_HPP
@@ -13,6 +13,11 @@
 //
 // Finite-differentiation of discrete data.
 //
+// The abscissas x are a std::vector.  The data y and the outputs dydx
+// and err can be any random-access containers with a value_type, for
+// instance std::vector or a row or column view of a jlt::matrix (see
+// matrix_view.hpp), which are written through.
+//
 
 //
 // To do:
@@ -30,23 +35,23 @@ namespace jlt {
 // Stencils
 //
 
-template<class T, class S>
-inline
-S ForwardDiff1Stencil(const std::vector<T>& dx, const std::vector<S>& y, int i)
+template<class T, class Y>
+inline typename Y::value_type
+ForwardDiff1Stencil(const std::vector<T>& dx, const Y& y, int i)
 {
   return (y[i+1] - y[i])/dx[i+1];
 }
 
-template<class T, class S>
-inline
-S BackwardDiff1Stencil(const std::vector<T>& dx, const std::vector<S>& y, int i)
+template<class T, class Y>
+inline typename Y::value_type
+BackwardDiff1Stencil(const std::vector<T>& dx, const Y& y, int i)
 {
   return (y[i] - y[i-1])/dx[i];
 }
 
-template<class T, class S>
-inline
-S CentralDiff2Stencil(const std::vector<T>& dx, const std::vector<S>& y, int i)
+template<class T, class Y>
+inline typename Y::value_type
+CentralDiff2Stencil(const std::vector<T>& dx, const Y& y, int i)
 {
   T a2 = dx[i]*dx[i], b2 = dx[i+1]*dx[i+1];
 
@@ -54,9 +59,9 @@ S CentralDiff2Stencil(const std::vector<T>& dx, const std::vector<S>& y, int i)
     (dx[i+1]*dx[i]*(dx[i] + dx[i+1]));
 }
 
-template<class T, class S>
-inline
-S ForwardDiff2Stencil(const std::vector<T>& dx, const std::vector<S>& y, int i)
+template<class T, class Y>
+inline typename Y::value_type
+ForwardDiff2Stencil(const std::vector<T>& dx, const Y& y, int i)
 {
   T a = (dx[i+1] + dx[i+2]);
 
@@ -64,9 +69,9 @@ S ForwardDiff2Stencil(const std::vector<T>& dx, const std::vector<S>& y, int i)
 	  - y[i]*dx[i+2]*(2*dx[i+1] + dx[i+2])) / (dx[i+1]*dx[i+2]*a);
 }
 
-template<class T, class S>
-inline
-S BackwardDiff2Stencil(const std::vector<T>& dx, const std::vector<S>& y, int i)
+template<class T, class Y>
+inline typename Y::value_type
+BackwardDiff2Stencil(const std::vector<T>& dx, const Y& y, int i)
 {
   T a = (dx[i-1] + dx[i]);
 
@@ -74,9 +79,9 @@ S BackwardDiff2Stencil(const std::vector<T>& dx, const std::vector<S>& y, int i)
 	  + y[i]*dx[i-1]*(2*dx[i] + dx[i-1])) / (dx[i-1]*dx[i]*a);
 }
 
-template<class T, class S>
-inline
-S ForwardDiff3Stencil(const std::vector<T>& dx, const std::vector<S>& y, int i)
+template<class T, class Y>
+inline typename Y::value_type
+ForwardDiff3Stencil(const std::vector<T>& dx, const Y& y, int i)
 {
   return
       y[i+3] * (dx[i+1]*(dx[i+1] + dx[i+2])) /
@@ -90,9 +95,9 @@ S ForwardDiff3Stencil(const std::vector<T>& dx, const std::vector<S>& y, int i)
               (dx[i+1]*(dx[i+1] + dx[i+2])*(dx[i+1] + dx[i+2] + dx[i+3]));
 }
 
-template<class T, class S>
-inline
-S BackwardDiff3Stencil(const std::vector<T>& dx, const std::vector<S>& y, int i)
+template<class T, class Y>
+inline typename Y::value_type
+BackwardDiff3Stencil(const std::vector<T>& dx, const Y& y, int i)
 {
   return
     - y[i-3] * (dx[i]*(dx[i] + dx[i-1])) /
@@ -106,9 +111,9 @@ S BackwardDiff3Stencil(const std::vector<T>& dx, const std::vector<S>& y, int i)
               (dx[i]*(dx[i] + dx[i-1])*(dx[i] + dx[i-1] + dx[i-2]));
 }
 
-template<class T, class S>
-inline
-S CentralDiff4Stencil(const std::vector<T>& dx, const std::vector<S>& y, int i)
+template<class T, class Y>
+inline typename Y::value_type
+CentralDiff4Stencil(const std::vector<T>& dx, const Y& y, int i)
 {
   return
     y[i+1] * (dx[i]*(dx[i-1] + dx[i])*(dx[i+1] + dx[i+2])) /
@@ -128,9 +133,9 @@ S CentralDiff4Stencil(const std::vector<T>& dx, const std::vector<S>& y, int i)
     (dx[i]*dx[i+1]*(dx[i-1] + dx[i])*(dx[i+1] + dx[i+2]));
 }
 
-template<class T, class S>
-inline
-S ForwardDiff4Stencil(const std::vector<T>& dx, const std::vector<S>& y, int i)
+template<class T, class Y>
+inline typename Y::value_type
+ForwardDiff4Stencil(const std::vector<T>& dx, const Y& y, int i)
 {
   return
     -y[i+4] * (dx[i+1]*(dx[i+1] + dx[i+2])*(dx[i+1] + dx[i+2] + dx[i+3])) /
@@ -154,9 +159,9 @@ S ForwardDiff4Stencil(const std::vector<T>& dx, const std::vector<S>& y, int i)
      *(dx[i+1] + dx[i+2] + dx[i+3] + dx[i+4]));
 }
 
-template<class T, class S>
-inline
-S BackwardDiff4Stencil(const std::vector<T>& dx, const std::vector<S>& y, int i)
+template<class T, class Y>
+inline typename Y::value_type
+BackwardDiff4Stencil(const std::vector<T>& dx, const Y& y, int i)
 {
   return
     y[i-4] * (dx[i]*(dx[i-1] + dx[i])*(dx[i-2] + dx[i-1] + dx[i])) /
@@ -181,9 +186,8 @@ S BackwardDiff4Stencil(const std::vector<T>& dx, const std::vector<S>& y, int i)
      *(dx[i] + dx[i-1] + dx[i-2] + dx[i-3]));
 }
 
-template<class T, class S>
-void finitediff1(const std::vector<T>& x, const std::vector<S>& y,
-		 std::vector<S>& dydx)
+template<class T, class Y, class DY>
+void finitediff1(const std::vector<T>& x, const Y& y, DY&& dydx)
 {
   int n = x.size();
   std::vector<T> dx(n);
@@ -199,9 +203,8 @@ void finitediff1(const std::vector<T>& x, const std::vector<S>& y,
   dydx[n-1] = BackwardDiff1Stencil(dx,y,n-1);
 }
 
-template<class T, class S>
-void finitediff2(const std::vector<T>& x, const std::vector<S>& y,
-		 std::vector<S>& dydx)
+template<class T, class Y, class DY>
+void finitediff2(const std::vector<T>& x, const Y& y, DY&& dydx)
 {
   int n = x.size();
   std::vector<T> dx(n);
@@ -219,12 +222,12 @@ void finitediff2(const std::vector<T>& x, const std::vector<S>& y,
   dydx[n-1] = BackwardDiff2Stencil(dx,y,n-1);
 }
 
-template<class T, class S>
-void finitediff2(const std::vector<T>& x, const std::vector<S>& y,
-		 std::vector<S>& dydx, std::vector<S>& err)
+template<class T, class Y, class DY, class E>
+void finitediff2(const std::vector<T>& x, const Y& y,
+		 DY&& dydx, E&& err)
 {
   int n = x.size();
-  S dydx2;
+  typename Y::value_type dydx2;
   std::vector<T> dx(n);
 
   for (int i = 1; i < n; ++i) {
@@ -254,9 +257,8 @@ void finitediff2(const std::vector<T>& x, const std::vector<S>& y,
   err[n-1] = dydx[n-1] - dydx2;
 }
 
-template<class T, class S>
-void finitediff4(const std::vector<T>& x, const std::vector<S>& y,
-		 std::vector<S>& dydx)
+template<class T, class Y, class DY>
+void finitediff4(const std::vector<T>& x, const Y& y, DY&& dydx)
 {
   int n = x.size();
   std::vector<T> dx(n);
@@ -272,12 +274,12 @@ void finitediff4(const std::vector<T>& x, const std::vector<S>& y,
   dydx[n-1] = BackwardDiff4Stencil(dx,y,n-1);
 }
 
-template<class T, class S>
-void finitediff4(const std::vector<T>& x, const std::vector<S>& y,
-		 std::vector<S>& dydx, std::vector<S>& err)
+template<class T, class Y, class DY, class E>
+void finitediff4(const std::vector<T>& x, const Y& y,
+		 DY&& dydx, E&& err)
 {
   int n = x.size();
-  S dydx2;
+  typename Y::value_type dydx2;
   std::vector<T> dx(n);
 
   for (int i = 1; i < n; ++i) {
@@ -0,0 +1,639 @@
+//
+// Copyright (c) 2004-2020 Jean-Luc Thiffeault <jeanluc@mailaps.org>
+//
+// See the file LICENSE for copying permission.
+//
+
+#ifndef JLT_FIXED_MATHMATRIX_HPP
+#define JLT_FIXED_MATHMATRIX_HPP
+
+//
+// fixed_mathmatrix.hpp
+//
+
+// M by N matrix of compile-time size with inline (row-major) storage,
+// the companion of fixed_mathvector.  Meant for the 2x2 and 3x3
+// tangent maps and Jacobians that are multiplied millions of times,
+// where a heap-backed mathmatrix with runtime loop bounds is mostly
+// overhead.
+//
+// The sums in products are expanded at compile time, and det(),
+// inverse() and charpoly() use closed forms up to 3x3 (4x4 for det),
+// falling back to Gaussian elimination and Faddeev-LeVerrier with
+// fixed loop bounds beyond that.  Everything except abs() can be
+// evaluated in a constant expression.
+//
+// To interoperate with mathmatrix: construct a fixed_mathmatrix from a
+// matrix, mathmatrix or matrix_view of the right size, and construct a
+// mathmatrix from a fixed_mathmatrix through its view():
+//
+//   fixed_mathmatrix<double,3> J(A);	// A is a 3x3 mathmatrix.
+//   mathmatrix<double> B(J.view());
+//
+// A fixed_mathmatrix can also multiply a mathvector of the right size.
+
+#include <iostream>
+#include <cstddef>
+#include <utility>
+#include <initializer_list>
+#include <jlt/fixed_mathvector.hpp>
+#include <jlt/mathmatrix.hpp>
+#include <jlt/polynomial.hpp>
+#include <jlt/exceptions.hpp>
+
+namespace jlt {
+
+template<class T, std::size_t M, std::size_t N = M>
+class fixed_mathmatrix
+{
+  static_assert(M > 0 && N > 0,
+		"jlt::fixed_mathmatrix: dimensions must be positive.");
+
+public:
+  using value_type = T;
+  using size_type = std::size_t;
+  using reference = T &;
+  using const_reference = const T &;
+  using pointer = T *;
+  using const_pointer = const T *;
+  using iterator = T *;
+  using const_iterator = const T *;
+
+  using scalar_type = T;
+  using const_scalar_reference = const T &;
+
+private:
+  T a[M*N];
+
+  // |x| for real x, usable in constant expressions.
+  static constexpr T magnitude(const T& x) { return (x < T() ? -x : x); }
+
+public:
+  //
+  // Constructors
+  //
+
+  // Zero matrix.
+  constexpr fixed_mathmatrix() : a{} {}
+
+  // Matrix filled with x.
+  constexpr explicit fixed_mathmatrix(const_reference x) : a{}
+    {
+      for (size_type k = 0; k < M*N; ++k) a[k] = x;
+    }
+
+  // The elements are listed row by row.
+  // example: fixed_mathmatrix<double,2> A{1,2,3,4}
+  constexpr fixed_mathmatrix(std::initializer_list<T> _l) : a{}
+    {
+      if (_l.size() != M*N)
+	JLT_THROW(std::length_error("Size mismatch in jlt::fixed_mathmatrix."));
+
+      size_type k = 0;
+      for (auto x : _l) a[k++] = x;
+    }
+
+  // From a matrix or mathmatrix of size M by N.
+  template<class Alloc, class Order>
+  explicit fixed_mathmatrix(const matrix<T,Alloc,Order>& A) : a{}
+    {
+      assign(A);
+    }
+
+  // From a view (e.g. a block of a larger matrix) of size M by N.
+  template<class U>
+  explicit fixed_mathmatrix(const matrix_view<U>& A) : a{}
+    {
+      assign(A);
+    }
+
+  //
+  // Element access.
+  //
+
+  constexpr reference operator()(size_type i, size_type j)
+    {
+      MATRIX_ASSERT(i < M && j < N);
+      return a[N*i + j];
+    }
+
+  constexpr const_reference operator()(size_type i, size_type j) const
+    {
+      MATRIX_ASSERT(i < M && j < N);
+      return a[N*i + j];
+    }
+
+  constexpr reference at(size_type i, size_type j)
+    {
+      if (i >= M || j >= N)
+	JLT_THROW(std::out_of_range("Out of range exception in jlt::fixed_mathmatrix."));
+      return a[N*i + j];
+    }
+
+  [[nodiscard]] constexpr const_reference at(size_type i, size_type j) const
+    {
+      if (i >= M || j >= N)
+	JLT_THROW(std::out_of_range("Out of range exception in jlt::fixed_mathmatrix."));
+      return a[N*i + j];
+    }
+
+  // Pointer to row i, for A[i][j].
+  constexpr pointer operator[](size_type i) { return a + N*i; }
+  constexpr const_pointer operator[](size_type i) const { return a + N*i; }
+
+  constexpr pointer data() { return a; }
+  [[nodiscard]] constexpr const_pointer data() const { return a; }
+
+  [[nodiscard]] constexpr fixed_mathvector<T,N> row(size_type i) const
+    {
+      fixed_mathvector<T,N> r;
+      for (size_type j = 0; j < N; ++j) r[j] = a[N*i + j];
+      return r;
+    }
+
+  [[nodiscard]] constexpr fixed_mathvector<T,M> column(size_type j) const
+    {
+      fixed_mathvector<T,M> c;
+      for (size_type i = 0; i < M; ++i) c[i] = a[N*i + j];
+      return c;
+    }
+
+  // View of the data (see matrix_view.hpp), to pass a fixed_mathmatrix
+  // to code written for matrices and views.
+  matrix_view<T> view() { return matrix_view<T>(a,M,N,N,1); }
+
+  [[nodiscard]] matrix_view<const T> view() const
+    {
+      return matrix_view<const T>(a,M,N,N,1);
+    }
+
+  [[nodiscard]] static constexpr size_type size() { return M*N; }
+  [[nodiscard]] static constexpr size_type dim() { return N; }
+  [[nodiscard]] static constexpr size_type rows() { return M; }
+  [[nodiscard]] static constexpr size_type columns() { return N; }
+  [[nodiscard]] static constexpr bool empty() { return false; }
+  [[nodiscard]] static constexpr bool isSquare() { return (M == N); }
+
+  //
+  // Iterators
+  //
+
+  constexpr iterator begin() { return a; }
+  [[nodiscard]] constexpr const_iterator begin() const { return a; }
+  [[nodiscard]] constexpr const_iterator cbegin() const { return a; }
+  constexpr iterator end() { return a + M*N; }
+  [[nodiscard]] constexpr const_iterator end() const { return a + M*N; }
+  [[nodiscard]] constexpr const_iterator cend() const { return a + M*N; }
+
+  //
+  // Matrix Operations
+  //
+
+  constexpr fixed_mathmatrix& operator+=(const fixed_mathmatrix& A)
+    {
+      for (size_type k = 0; k < M*N; ++k) a[k] += A.a[k];
+      return *this;
+    }
+
+  constexpr fixed_mathmatrix& operator-=(const fixed_mathmatrix& A)
+    {
+      for (size_type k = 0; k < M*N; ++k) a[k] -= A.a[k];
+      return *this;
+    }
+
+  constexpr fixed_mathmatrix& operator*=(const_scalar_reference x)
+    {
+      for (size_type k = 0; k < M*N; ++k) a[k] *= x;
+      return *this;
+    }
+
+  constexpr fixed_mathmatrix& operator/=(const_scalar_reference x)
+    {
+      for (size_type k = 0; k < M*N; ++k) a[k] /= x;
+      return *this;
+    }
+
+  constexpr bool operator==(const fixed_mathmatrix& A) const
+    {
+      for (size_type k = 0; k < M*N; ++k) if (a[k] != A.a[k]) return false;
+      return true;
+    }
+
+  constexpr bool operator!=(const fixed_mathmatrix& A) const
+    {
+      return !(*this == A);
+    }
+
+  //
+  // Some common matrices
+  //
+
+  constexpr void identity(const_scalar_reference x = 1)
+    {
+      static_assert(M == N, "jlt::fixed_mathmatrix: matrix must be square.");
+
+      for (size_type i = 0; i < M; ++i)
+	for (size_type j = 0; j < N; ++j) a[N*i + j] = (i == j ? x : T());
+    }
+
+  // Transpose in place (square only; see also the free function
+  // transpose()).
+  constexpr const fixed_mathmatrix& transpose()
+    {
+      static_assert(M == N, "jlt::fixed_mathmatrix: matrix must be square.");
+
+      for (size_type i = 0; i < N; ++i)
+	for (size_type j = i+1; j < N; ++j)
+	  {
+	    T tmp = a[N*i + j];
+	    a[N*i + j] = a[N*j + i];
+	    a[N*j + i] = tmp;
+	  }
+      return *this;
+    }
+
+  //
+  // Determinant and trace
+  //
+
+  [[nodiscard]] constexpr T trace() const
+    {
+      static_assert(M == N, "jlt::fixed_mathmatrix: matrix must be square.");
+
+      T tr = T();
+      for (size_type i = 0; i < N; ++i) tr += a[N*i + i];
+      return tr;
+    }
+
+  [[nodiscard]] constexpr T det() const
+    {
+      static_assert(M == N, "jlt::fixed_mathmatrix: matrix must be square.");
+      const fixed_mathmatrix& A = *this;
+
+      if constexpr (N == 1)
+	{
+	  return A(0,0);
+	}
+      else if constexpr (N == 2)
+	{
+	  return A(0,0)*A(1,1) - A(0,1)*A(1,0);
+	}
+      else if constexpr (N == 3)
+	{
+	  return A(0,0)*(A(1,1)*A(2,2) - A(1,2)*A(2,1))
+	    -    A(0,1)*(A(1,0)*A(2,2) - A(1,2)*A(2,0))
+	    +    A(0,2)*(A(1,0)*A(2,1) - A(1,1)*A(2,0));
+	}
+      else if constexpr (N == 4)
+	{
+	  // Laplace expansion in the 2x2 minors of the first two rows
+	  // and of the last two rows.
+	  T s0 = A(0,0)*A(1,1) - A(1,0)*A(0,1);
+	  T s1 = A(0,0)*A(1,2) - A(1,0)*A(0,2);
+	  T s2 = A(0,0)*A(1,3) - A(1,0)*A(0,3);
+	  T s3 = A(0,1)*A(1,2) - A(1,1)*A(0,2);
+	  T s4 = A(0,1)*A(1,3) - A(1,1)*A(0,3);
+	  T s5 = A(0,2)*A(1,3) - A(1,2)*A(0,3);
+
+	  T c5 = A(2,2)*A(3,3) - A(3,2)*A(2,3);
+	  T c4 = A(2,1)*A(3,3) - A(3,1)*A(2,3);
+	  T c3 = A(2,1)*A(3,2) - A(3,1)*A(2,2);
+	  T c2 = A(2,0)*A(3,3) - A(3,0)*A(2,3);
+	  T c1 = A(2,0)*A(3,2) - A(3,0)*A(2,2);
+	  T c0 = A(2,0)*A(3,1) - A(3,0)*A(2,1);
+
+	  return s0*c5 - s1*c4 + s2*c3 + s3*c2 - s4*c1 + s5*c0;
+	}
+      else
+	{
+	  // Gaussian elimination with partial pivoting, on a copy.
+	  fixed_mathmatrix U(A);
+	  T d = 1;
+	  for (size_type k = 0; k < N; ++k)
+	    {
+	      size_type p = k;
+	      for (size_type i = k+1; i < N; ++i)
+		if (magnitude(U(i,k)) > magnitude(U(p,k))) p = i;
+	      if (U(p,k) == T()) return T();
+	      if (p != k)
+		{
+		  for (size_type j = k; j < N; ++j)
+		    {
+		      T tmp = U(k,j); U(k,j) = U(p,j); U(p,j) = tmp;
+		    }
+		  d = -d;
+		}
+	      d *= U(k,k);
+	      for (size_type i = k+1; i < N; ++i)
+		{
+		  T f = U(i,k)/U(k,k);
+		  for (size_type j = k+1; j < N; ++j) U(i,j) -= f*U(k,j);
+		}
+	    }
+	  return d;
+	}
+    }
+
+  //
+  // Matrix Inverse
+  //
+
+  // As for mathmatrix, invert() replaces the matrix by its inverse and
+  // inverse() leaves it untouched.
+  constexpr void invert() { *this = inverse(); }
+
+  [[nodiscard]] constexpr fixed_mathmatrix inverse() const
+    {
+      static_assert(M == N, "jlt::fixed_mathmatrix: matrix must be square.");
+      const fixed_mathmatrix& A = *this;
+      fixed_mathmatrix Ainv;
+
+      if constexpr (N <= 3)
+	{
+	  // Adjugate over determinant.
+	  T d = det();
+	  if (d == T())
+	    JLT_THROW(std::runtime_error("Singular Matrix in jlt::fixed_mathmatrix."));
+
+	  if constexpr (N == 1)
+	    {
+	      Ainv(0,0) = T(1)/d;
+	    }
+	  else if constexpr (N == 2)
+	    {
+	      Ainv(0,0) =  A(1,1)/d; Ainv(0,1) = -A(0,1)/d;
+	      Ainv(1,0) = -A(1,0)/d; Ainv(1,1) =  A(0,0)/d;
+	    }
+	  else
+	    {
+	      Ainv(0,0) = (A(1,1)*A(2,2) - A(1,2)*A(2,1))/d;
+	      Ainv(0,1) = (A(0,2)*A(2,1) - A(0,1)*A(2,2))/d;
+	      Ainv(0,2) = (A(0,1)*A(1,2) - A(0,2)*A(1,1))/d;
+	      Ainv(1,0) = (A(1,2)*A(2,0) - A(1,0)*A(2,2))/d;
+	      Ainv(1,1) = (A(0,0)*A(2,2) - A(0,2)*A(2,0))/d;
+	      Ainv(1,2) = (A(0,2)*A(1,0) - A(0,0)*A(1,2))/d;
+	      Ainv(2,0) = (A(1,0)*A(2,1) - A(1,1)*A(2,0))/d;
+	      Ainv(2,1) = (A(0,1)*A(2,0) - A(0,0)*A(2,1))/d;
+	      Ainv(2,2) = (A(0,0)*A(1,1) - A(0,1)*A(1,0))/d;
+	    }
+	}
+      else
+	{
+	  // Gauss-Jordan elimination with partial pivoting.
+	  fixed_mathmatrix U(A);
+	  Ainv.identity();
+	  for (size_type k = 0; k < N; ++k)
+	    {
+	      size_type p = k;
+	      for (size_type i = k+1; i < N; ++i)
+		if (magnitude(U(i,k)) > magnitude(U(p,k))) p = i;
+	      if (U(p,k) == T())
+		JLT_THROW(std::runtime_error("Singular Matrix in jlt::fixed_mathmatrix."));
+	      if (p != k)
+		{
+		  for (size_type j = 0; j < N; ++j)
+		    {
+		      T tmp = U(k,j); U(k,j) = U(p,j); U(p,j) = tmp;
+		      tmp = Ainv(k,j); Ainv(k,j) = Ainv(p,j); Ainv(p,j) = tmp;
+		    }
+		}
+	      T piv = U(k,k);
+	      for (size_type j = 0; j < N; ++j)
+		{
+		  U(k,j) /= piv;
+		  Ainv(k,j) /= piv;
+		}
+	      for (size_type i = 0; i < N; ++i)
+		{
+		  if (i == k) continue;
+		  T f = U(i,k);
+		  for (size_type j = 0; j < N; ++j)
+		    {
+		      U(i,j) -= f*U(k,j);
+		      Ainv(i,j) -= f*Ainv(k,j);
+		    }
+		}
+	    }
+	}
+
+      return Ainv;
+    }
+
+  //
+  // Characteristic polynomial
+  //
+
+  // Same convention as mathmatrix::charpoly(): p[k] is the
+  // coefficient of x^(N-k) in det(A - x I).
+  [[nodiscard]] polynomial<T> charpoly() const
+    {
+      fixed_mathvector<T,N+1> c = charpoly_coefficients();
+      polynomial<T> p;
+
+      for (size_type k = 0; k <= N; ++k) p[k] = c[k];
+
+      return p;
+    }
+
+  // The coefficients of charpoly(), as a fixed_mathvector.
+  [[nodiscard]] constexpr fixed_mathvector<T,N+1> charpoly_coefficients() const
+    {
+      static_assert(M == N, "jlt::fixed_mathmatrix: matrix must be square.");
+      const fixed_mathmatrix& A = *this;
+
+      // Coefficients of det(x I - A) = x^N + c[1] x^(N-1) + ... + c[N].
+      fixed_mathvector<T,N+1> c;
+      c[0] = 1;
+
+      if constexpr (N == 1)
+	{
+	  c[1] = -A(0,0);
+	}
+      else if constexpr (N == 2)
+	{
+	  c[1] = -trace();
+	  c[2] = det();
+	}
+      else if constexpr (N == 3)
+	{
+	  // The middle coefficient is the sum of the principal 2x2 minors.
+	  c[1] = -trace();
+	  c[2] = (A(0,0)*A(1,1) - A(0,1)*A(1,0))
+	    +    (A(0,0)*A(2,2) - A(0,2)*A(2,0))
+	    +    (A(1,1)*A(2,2) - A(1,2)*A(2,1));
+	  c[3] = -det();
+	}
+      else
+	{
+	  // Faddeev-LeVerrier: B_1 = A, B_k = A (B_(k-1) + c[k-1] I),
+	  // c[k] = -trace(B_k)/k.
+	  fixed_mathmatrix B(A);
+	  for (size_type k = 1; k <= N; ++k)
+	    {
+	      if (k > 1)
+		{
+		  for (size_type i = 0; i < N; ++i) B(i,i) += c[k-1];
+		  B = A*B;
+		}
+	      c[k] = -B.trace()/T(k);
+	    }
+	}
+
+      // Convert to det(A - x I) = (-1)^N det(x I - A).
+      if (N % 2 == 1) for (size_type k = 0; k <= N; ++k) c[k] = -c[k];
+
+      return c;
+    }
+
+  //
+  // Output
+  //
+
+  std::ostream& printOn(std::ostream& strm) const
+    {
+      return view().printOn(strm);
+    }
+
+  std::ostream& printMatrixForm(std::ostream& strm) const
+    {
+      return view().printMatrixForm(strm);
+    }
+
+private:
+  template<class Matrix>
+  void assign(const Matrix& A)
+    {
+      if (A.rows() != M || A.columns() != N)
+	JLT_THROW(std::length_error("Size mismatch in jlt::fixed_mathmatrix."));
+
+      for (size_type i = 0; i < M; ++i)
+	for (size_type j = 0; j < N; ++j) a[N*i + j] = A(i,j);
+    }
+};
+
+
+//
+// Function definitions
+//
+
+template<class T, std::size_t M, std::size_t N>
+constexpr fixed_mathmatrix<T,M,N> operator+(const fixed_mathmatrix<T,M,N>& A)
+{
+  return A;
+}
+
+template<class T, std::size_t M, std::size_t N>
+constexpr fixed_mathmatrix<T,M,N> operator-(fixed_mathmatrix<T,M,N> A)
+{
+  for (auto& x : A) x = -x;
+  return A;
+}
+
+template<class T, std::size_t M, std::size_t N>
+constexpr fixed_mathmatrix<T,M,N> operator+(fixed_mathmatrix<T,M,N> A,
+					    const fixed_mathmatrix<T,M,N>& B)
+{
+  return A += B;
+}
+
+template<class T, std::size_t M, std::size_t N>
+constexpr fixed_mathmatrix<T,M,N> operator-(fixed_mathmatrix<T,M,N> A,
+					    const fixed_mathmatrix<T,M,N>& B)
+{
+  return A -= B;
+}
+
+template<class T, std::size_t M, std::size_t N>
+constexpr fixed_mathmatrix<T,M,N> operator*(const T& x,
+					    fixed_mathmatrix<T,M,N> A)
+{
+  return A *= x;
+}
+
+template<class T, std::size_t M, std::size_t N>
+constexpr fixed_mathmatrix<T,M,N> operator*(fixed_mathmatrix<T,M,N> A,
+					    const T& x)
+{
+  return A *= x;
+}
+
+template<class T, std::size_t M, std::size_t N>
+constexpr fixed_mathmatrix<T,M,N> operator/(fixed_mathmatrix<T,M,N> A,
+					    const T& x)
+{
+  return A /= x;
+}
+
+// Sum of A(i,k)*B(k,j) over k, expanded at compile time.
+template<class T, std::size_t M, std::size_t K, std::size_t N,
+	 std::size_t... k>
+constexpr T fixed_product_element(const fixed_mathmatrix<T,M,K>& A,
+				  const fixed_mathmatrix<T,K,N>& B,
+				  std::size_t i, std::size_t j,
+				  std::index_sequence<k...>)
+{
+  return ((A(i,k)*B(k,j)) + ...);
+}
+
+template<class T, std::size_t M, std::size_t K, std::size_t N>
+constexpr fixed_mathmatrix<T,M,N> operator*(const fixed_mathmatrix<T,M,K>& A,
+					    const fixed_mathmatrix<T,K,N>& B)
+{
+  fixed_mathmatrix<T,M,N> C;
+
+  for (std::size_t i = 0; i < M; ++i)
+    for (std::size_t j = 0; j < N; ++j)
+      C(i,j) = fixed_product_element(A,B,i,j,std::make_index_sequence<K>());
+
+  return C;
+}
+
+template<class T, std::size_t M, std::size_t N, std::size_t... k>
+constexpr T fixed_product_element(const fixed_mathmatrix<T,M,N>& A,
+				  const fixed_mathvector<T,N>& v,
+				  std::size_t i, std::index_sequence<k...>)
+{
+  return ((A(i,k)*v[k]) + ...);
+}
+
+template<class T, std::size_t M, std::size_t N>
+constexpr fixed_mathvector<T,M> operator*(const fixed_mathmatrix<T,M,N>& A,
+					  const fixed_mathvector<T,N>& v)
+{
+  fixed_mathvector<T,M> res;
+
+  for (std::size_t i = 0; i < M; ++i)
+    res[i] = fixed_product_element(A,v,i,std::make_index_sequence<N>());
+
+  return res;
+}
+
+// Product with a mathvector, which must have size N.
+template<class T, std::size_t M, std::size_t N, class S, class Alloc>
+inline fixed_mathvector<T,M> operator*(const fixed_mathmatrix<T,M,N>& A,
+				       const mathvector<T,S,Alloc>& v)
+{
+  return A*fixed_mathvector<T,N>(v);
+}
+
+// Transpose of any shape, as a new matrix.
+template<class T, std::size_t M, std::size_t N>
+constexpr fixed_mathmatrix<T,N,M> transpose(const fixed_mathmatrix<T,M,N>& A)
+{
+  fixed_mathmatrix<T,N,M> At;
+
+  for (std::size_t i = 0; i < M; ++i)
+    for (std::size_t j = 0; j < N; ++j) At(j,i) = A(i,j);
+
+  return At;
+}
+
+template<class T, std::size_t M, std::size_t N>
+std::ostream& operator<<(std::ostream& strm, const fixed_mathmatrix<T,M,N>& A)
+{
+  return A.printOn(strm);
+}
+
+} // namespace jlt
+
+#endif // JLT_FIXED_MATHMATRIX_HPP
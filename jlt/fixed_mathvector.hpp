@@ -0,0 +1,351 @@
+//
+// Copyright (c) 2004-2020 Jean-Luc Thiffeault <jeanluc@mailaps.org>
+//
+// See the file LICENSE for copying permission.
+//
+
+#ifndef JLT_FIXED_MATHVECTOR_HPP
+#define JLT_FIXED_MATHVECTOR_HPP
+
+//
+// fixed_mathvector.hpp
+//
+
+// Vector of compile-time size N with inline storage, for the small
+// vectors (N = 2, 3, ...) of tangent-map and Lyapunov computations,
+// where allocating a mathvector on the heap for every operation costs
+// more than the arithmetic.  The operations mirror those of
+// mathvector, but involve no allocation and have loops of fixed
+// length which the compiler unrolls; they can also be used in
+// constant expressions.
+//
+// To interoperate with mathvector (or any std::vector), construct a
+// fixed_mathvector from it (the size is checked), or go the other way
+// with mathvector<T>(v.begin(),v.end()).
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <cstddef>
+#include <initializer_list>
+#include <jlt/mathvector.hpp>
+#include <jlt/matrix_view.hpp>
+#include <jlt/stlio.hpp>
+#include <jlt/exceptions.hpp>
+
+namespace jlt {
+
+template<class T, std::size_t N>
+class fixed_mathvector
+{
+  static_assert(N > 0, "jlt::fixed_mathvector: size must be positive.");
+
+public:
+  using value_type = T;
+  using size_type = std::size_t;
+  using reference = T &;
+  using const_reference = const T &;
+  using pointer = T *;
+  using const_pointer = const T *;
+  using iterator = T *;
+  using const_iterator = const T *;
+
+  using scalar_type = T;
+  using const_scalar_reference = const T &;
+
+private:
+  T v[N];
+
+public:
+  //
+  // Constructors
+  //
+
+  // Zero vector.
+  constexpr fixed_mathvector() : v{} {}
+
+  // Vector filled with x.
+  constexpr explicit fixed_mathvector(const_reference x) : v{}
+    {
+      for (size_type i = 0; i < N; ++i) v[i] = x;
+    }
+
+  // example: fixed_mathvector<double,3> v{1,2,3}
+  constexpr fixed_mathvector(std::initializer_list<T> _l) : v{}
+    {
+      if (_l.size() != N)
+	JLT_THROW(std::length_error("Size mismatch in jlt::fixed_mathvector."));
+
+      size_type i = 0;
+      for (auto x : _l) v[i++] = x;
+    }
+
+  // From a mathvector or std::vector of size N.
+  template<class Alloc>
+  explicit fixed_mathvector(const std::vector<T,Alloc>& w) : v{}
+    {
+      if (w.size() != N)
+	JLT_THROW(std::length_error("Size mismatch in jlt::fixed_mathvector."));
+
+      for (size_type i = 0; i < N; ++i) v[i] = w[i];
+    }
+
+  // From a row, column or diagonal of a matrix.
+  template<class U>
+  explicit fixed_mathvector(const vector_view<U>& w) : v{}
+    {
+      if (w.size() != N)
+	JLT_THROW(std::length_error("Size mismatch in jlt::fixed_mathvector."));
+
+      for (size_type i = 0; i < N; ++i) v[i] = w[i];
+    }
+
+  //
+  // Element access.
+  //
+
+  constexpr reference operator[](size_type i)
+    {
+      VECTOR_ASSERT(i < N);
+      return v[i];
+    }
+
+  constexpr const_reference operator[](size_type i) const
+    {
+      VECTOR_ASSERT(i < N);
+      return v[i];
+    }
+
+  constexpr reference at(size_type i)
+    {
+      if (i >= N)
+	JLT_THROW(std::out_of_range("Out of range exception in jlt::fixed_mathvector."));
+      return v[i];
+    }
+
+  [[nodiscard]] constexpr const_reference at(size_type i) const
+    {
+      if (i >= N)
+	JLT_THROW(std::out_of_range("Out of range exception in jlt::fixed_mathvector."));
+      return v[i];
+    }
+
+  constexpr pointer data() { return v; }
+  [[nodiscard]] constexpr const_pointer data() const { return v; }
+
+  [[nodiscard]] static constexpr size_type size() { return N; }
+  [[nodiscard]] static constexpr bool empty() { return false; }
+
+  //
+  // Iterators
+  //
+
+  constexpr iterator begin() { return v; }
+  [[nodiscard]] constexpr const_iterator begin() const { return v; }
+  [[nodiscard]] constexpr const_iterator cbegin() const { return v; }
+  constexpr iterator end() { return v + N; }
+  [[nodiscard]] constexpr const_iterator end() const { return v + N; }
+  [[nodiscard]] constexpr const_iterator cend() const { return v + N; }
+
+  //
+  // Vector Operations
+  //
+
+  constexpr fixed_mathvector& operator+=(const fixed_mathvector& w)
+    {
+      for (size_type i = 0; i < N; ++i) v[i] += w.v[i];
+      return *this;
+    }
+
+  constexpr fixed_mathvector& operator-=(const fixed_mathvector& w)
+    {
+      for (size_type i = 0; i < N; ++i) v[i] -= w.v[i];
+      return *this;
+    }
+
+  constexpr fixed_mathvector& operator*=(const_scalar_reference a)
+    {
+      for (size_type i = 0; i < N; ++i) v[i] *= a;
+      return *this;
+    }
+
+  constexpr fixed_mathvector& operator/=(const_scalar_reference a)
+    {
+      for (size_type i = 0; i < N; ++i) v[i] /= a;
+      return *this;
+    }
+
+  // Component-wise division.
+  constexpr fixed_mathvector& operator/=(const fixed_mathvector& w)
+    {
+      for (size_type i = 0; i < N; ++i) v[i] /= w.v[i];
+      return *this;
+    }
+
+  [[nodiscard]] constexpr T sum() const
+    {
+      T _sum = T();
+      for (size_type i = 0; i < N; ++i) _sum += v[i];
+      return _sum;
+    }
+
+  //
+  // Queries
+  //
+
+  [[nodiscard]] constexpr bool isZero() const
+    {
+      for (size_type i = 0; i < N; ++i) if (v[i] != T()) return false;
+      return true;
+    }
+
+  constexpr bool operator==(const fixed_mathvector& w) const
+    {
+      for (size_type i = 0; i < N; ++i) if (v[i] != w.v[i]) return false;
+      return true;
+    }
+
+  constexpr bool operator!=(const fixed_mathvector& w) const
+    {
+      return !(*this == w);
+    }
+};
+
+
+//
+// Function definitions
+//
+
+template<class T, std::size_t N>
+constexpr fixed_mathvector<T,N> operator+(const fixed_mathvector<T,N>& v)
+{
+  return v;
+}
+
+template<class T, std::size_t N>
+constexpr fixed_mathvector<T,N> operator-(const fixed_mathvector<T,N>& v)
+{
+  fixed_mathvector<T,N> res;
+  for (std::size_t i = 0; i < N; ++i) res[i] = -v[i];
+  return res;
+}
+
+template<class T, std::size_t N>
+constexpr fixed_mathvector<T,N> operator+(fixed_mathvector<T,N> v,
+					  const fixed_mathvector<T,N>& w)
+{
+  return v += w;
+}
+
+template<class T, std::size_t N>
+constexpr fixed_mathvector<T,N> operator-(fixed_mathvector<T,N> v,
+					  const fixed_mathvector<T,N>& w)
+{
+  return v -= w;
+}
+
+template<class T, std::size_t N>
+constexpr fixed_mathvector<T,N> operator*(const T& a, fixed_mathvector<T,N> v)
+{
+  return v *= a;
+}
+
+template<class T, std::size_t N>
+constexpr fixed_mathvector<T,N> operator*(fixed_mathvector<T,N> v, const T& a)
+{
+  return v *= a;
+}
+
+template<class T, std::size_t N>
+constexpr fixed_mathvector<T,N> operator/(fixed_mathvector<T,N> v, const T& a)
+{
+  return v /= a;
+}
+
+// Component-wise division.
+template<class T, std::size_t N>
+constexpr fixed_mathvector<T,N> operator/(fixed_mathvector<T,N> v,
+					  const fixed_mathvector<T,N>& w)
+{
+  return v /= w;
+}
+
+template<class T, std::size_t N>
+constexpr T dot(const fixed_mathvector<T,N>& v, const fixed_mathvector<T,N>& w)
+{
+  T dotp = T();
+  for (std::size_t i = 0; i < N; ++i) dotp += v[i]*w[i];
+  return dotp;
+}
+
+// Dot product (not component-wise multiplication).
+template<class T, std::size_t N>
+constexpr T operator*(const fixed_mathvector<T,N>& v,
+		      const fixed_mathvector<T,N>& w)
+{
+  return dot(v,w);
+}
+
+template<class T, std::size_t N>
+constexpr T mag2(const fixed_mathvector<T,N>& v)
+{
+  return dot(v,v);
+}
+
+template<class T, std::size_t N>
+inline T abs(const fixed_mathvector<T,N>& v)
+{
+  return std::sqrt(mag2(v));
+}
+
+// Cross product, for N = 3 only.
+template<class T, std::size_t N>
+constexpr fixed_mathvector<T,N> cross(const fixed_mathvector<T,N>& v,
+				      const fixed_mathvector<T,N>& w)
+{
+  static_assert(N == 3, "jlt::cross: vectors must be of size 3.");
+
+  return fixed_mathvector<T,N>{v[1] * w[2] - v[2] * w[1],
+			       v[2] * w[0] - v[0] * w[2],
+			       v[0] * w[1] - v[1] * w[0]};
+}
+
+// Same format as std::vector in stlio.hpp.
+template<class T, std::size_t N>
+std::ostream& operator<<(std::ostream& strm, const fixed_mathvector<T,N>& vv)
+{
+  std::ios::fmtflags old_options = strm.flags();
+  const int prec = strm.precision();	// Precision (number of digits - 1).
+  int wid = format_traits<T>::field_width;	// Width of output field.
+
+  strm.setf(std::ios::showpoint);		// Print trailing zeros.
+  strm.setf(std::ios::right,std::ios::adjustfield);	// Adjust to the right.
+
+  // If the notation is scientific we can predict the width, so adjust
+  // accordingly.
+  if (strm.flags() & std::ios::scientific)
+      wid = prec + format_traits<T>::extra_width_scientific;
+
+  for (std::size_t i = 0; i < N-1; ++i)
+    {
+      strm << std::setw(wid) << vv[i]
+#ifdef JLT_FIELD_SEP_STRING
+	   << format_traits<T>::field_sep;
+#else
+	   << std::string(format_traits<T>::field_sep,' ');
+#endif
+    }
+
+  strm << std::setw(wid) << vv[N-1];	// To avoid dangling tab.
+
+  // Restore format flags.
+  strm.flags(old_options);
+
+  return strm;
+}
+
+} // namespace jlt
+
+#endif // JLT_FIXED_MATHVECTOR_HPP
@@ -0,0 +1,642 @@
+//
+// Copyright (c) 2004-2020 Jean-Luc Thiffeault <jeanluc@mailaps.org>
+//
+// See the file LICENSE for copying permission.
+//
+
+#ifndef JLT_GEMM_HPP
+#define JLT_GEMM_HPP
+
+//
+// gemm.hpp
+//
+
+// General matrix multiply, C = alpha*A*B + beta*C, for float, double
+// and complex element types, in the style of GotoBLAS/BLIS:
+//
+//   - B is split into blocks of JLT_GEMM_KC rows by JLT_GEMM_NC
+//     columns, and A into blocks of JLT_GEMM_MC rows by JLT_GEMM_KC
+//     columns, sized so that a block of A stays in L2 cache and a
+//     block of B in L3.
+//   - Each block is copied ("packed") into a contiguous buffer, in
+//     thin panels of MR rows of A or NR columns of B, so that the
+//     innermost loop reads memory sequentially whatever the layout or
+//     strides of the operands (row-major, column-major, views, trans).
+//   - A micro-kernel computes an MR by NR tile of C in registers, as a
+//     sum of JLT_GEMM_KC outer products of a column of the A panel and
+//     a row of the B panel.
+//
+// The micro-kernels for float and double use SSE2, AVX (with FMA if
+// available) or AVX-512, whichever the compiler is allowed to emit
+// (e.g. with -march=native).  Other element types, and other
+// architectures, use a generic kernel that relies on the compiler to
+// vectorise it.  Products too small to be worth packing use a plain
+// loop.  If JLT_USE_BLAS is defined, gemm() calls the BLAS xGEMM
+// instead for float, double and complex operands with unit stride
+// along rows or columns (see blas.hpp).
+//
+// Products with more than JLT_GEMM_PARALLEL multiply-adds run on the
+// thread pool (see thread_pool.hpp).  Each block of B is packed once
+// and shared by all the threads, which then split the rows of C (or
+// its columns, if C is wider than tall), each packing its own blocks
+// of A.
+//
+// The operator* products of mathmatrix.hpp call gemm() when the
+// element type is float, double or complex; it can also be called
+// directly to accumulate into an existing matrix or view:
+//
+//   gemm(1.0, A, trans(B), 1.0, C.block(0,0,m,n));   // C += A*B'
+//
+// The operands may be matrix, mathmatrix, matrix_view, or trans() of
+// these; C must not overlap A or B.
+
+#include <cstddef>
+#include <algorithm>
+#include <complex>
+#include <vector>
+#include <type_traits>
+#include <jlt/aligned_allocator.hpp>
+#include <jlt/matrix.hpp>
+#include <jlt/matrix_view.hpp>
+#include <jlt/transposed.hpp>
+#include <jlt/thread_pool.hpp>
+
+#if defined(__AVX__) || defined(__SSE2__)
+#  include <immintrin.h>
+#endif
+
+#ifdef JLT_USE_BLAS
+#  include <jlt/blas.hpp>
+#endif
+
+// Cache blocking, in elements.  MC and NC are rounded to a multiple of
+// the micro-kernel's MR and NR.
+#ifndef JLT_GEMM_KC
+#  define JLT_GEMM_KC 256
+#endif
+
+#ifndef JLT_GEMM_MC
+#  define JLT_GEMM_MC 96
+#endif
+
+#ifndef JLT_GEMM_NC
+#  define JLT_GEMM_NC 4096
+#endif
+
+// Products with m*n*k below this use a plain loop.
+#ifndef JLT_GEMM_SMALL
+#  define JLT_GEMM_SMALL 32768
+#endif
+
+// Products with m*n*k below this use a single thread.
+#ifndef JLT_GEMM_PARALLEL
+#  define JLT_GEMM_PARALLEL (128*128*128)
+#endif
+
+// Smallest slice of rows or columns of C given to a thread.
+#ifndef JLT_GEMM_PARALLEL_GRAIN
+#  define JLT_GEMM_PARALLEL_GRAIN 32
+#endif
+
+namespace jlt {
+
+// Element types handled by gemm().
+template<class T>
+struct is_gemm_type : std::is_floating_point<T> {};
+
+template<class T>
+struct is_gemm_type<std::complex<T>> : std::is_floating_point<T> {};
+
+namespace gemm_detail {
+
+//
+// Micro-kernels
+//
+
+// Generic kernel: ab (MR by NR, row-major) = sum over l < kc of
+// a[l*MR + i] * b[l*NR + j].
+template<class T, class = void>
+struct micro_kernel
+{
+  static constexpr std::size_t MR = 4, NR = 4;
+
+  static void run(std::size_t kc, const T *a, const T *b, T *ab)
+    {
+      T c[MR*NR] = {};
+
+      for (std::size_t l = 0; l < kc; ++l, a += MR, b += NR)
+	{
+	  for (std::size_t i = 0; i < MR; ++i)
+	    {
+	      const T ai = a[i];
+	      for (std::size_t j = 0; j < NR; ++j) c[i*NR + j] += ai*b[j];
+	    }
+	}
+
+      std::copy(c, c + MR*NR, ab);
+    }
+};
+
+// SIMD registers: V::width elements of T, with loads and stores
+// (unaligned), broadcast and multiply-add.
+template<class T> struct simd;
+
+// Kernel with MR rows and NV registers per row, so NR = NV*width.  The
+// MR*NV accumulators stay in registers once the loops are unrolled.
+template<class T, std::size_t MR_, std::size_t NV>
+struct simd_kernel
+{
+  using V = simd<T>;
+  using reg = typename V::reg;
+
+  static constexpr std::size_t MR = MR_, NR = NV*V::width;
+
+  static void run(std::size_t kc, const T *a, const T *b, T *ab)
+    {
+      reg c[MR][NV];
+
+      for (std::size_t i = 0; i < MR; ++i)
+	for (std::size_t v = 0; v < NV; ++v) c[i][v] = V::zero();
+
+      for (std::size_t l = 0; l < kc; ++l, a += MR, b += NR)
+	{
+	  reg bv[NV];
+	  for (std::size_t v = 0; v < NV; ++v) bv[v] = V::load(b + v*V::width);
+
+	  for (std::size_t i = 0; i < MR; ++i)
+	    {
+	      const reg ai = V::broadcast(a[i]);
+	      for (std::size_t v = 0; v < NV; ++v)
+		c[i][v] = V::fmadd(ai,bv[v],c[i][v]);
+	    }
+	}
+
+      for (std::size_t i = 0; i < MR; ++i)
+	for (std::size_t v = 0; v < NV; ++v)
+	  V::store(ab + i*NR + v*V::width,c[i][v]);
+    }
+};
+
+#if defined(__AVX512F__)
+
+template<> struct simd<double>
+{
+  using reg = __m512d;
+  static constexpr std::size_t width = 8;
+  static reg zero() { return _mm512_setzero_pd(); }
+  static reg load(const double *p) { return _mm512_loadu_pd(p); }
+  static void store(double *p, reg x) { _mm512_storeu_pd(p,x); }
+  static reg broadcast(double x) { return _mm512_set1_pd(x); }
+  static reg fmadd(reg a, reg b, reg c) { return _mm512_fmadd_pd(a,b,c); }
+};
+
+template<> struct simd<float>
+{
+  using reg = __m512;
+  static constexpr std::size_t width = 16;
+  static reg zero() { return _mm512_setzero_ps(); }
+  static reg load(const float *p) { return _mm512_loadu_ps(p); }
+  static void store(float *p, reg x) { _mm512_storeu_ps(p,x); }
+  static reg broadcast(float x) { return _mm512_set1_ps(x); }
+  static reg fmadd(reg a, reg b, reg c) { return _mm512_fmadd_ps(a,b,c); }
+};
+
+// 32 registers: 16 accumulators, 2 for B and one broadcast.
+template<> struct micro_kernel<double> : simd_kernel<double,8,2> {};
+template<> struct micro_kernel<float> : simd_kernel<float,8,2> {};
+
+#elif defined(__AVX__)
+
+template<> struct simd<double>
+{
+  using reg = __m256d;
+  static constexpr std::size_t width = 4;
+  static reg zero() { return _mm256_setzero_pd(); }
+  static reg load(const double *p) { return _mm256_loadu_pd(p); }
+  static void store(double *p, reg x) { _mm256_storeu_pd(p,x); }
+  static reg broadcast(double x) { return _mm256_set1_pd(x); }
+  static reg fmadd(reg a, reg b, reg c)
+    {
+#  if defined(__FMA__)
+      return _mm256_fmadd_pd(a,b,c);
+#  else
+      return _mm256_add_pd(_mm256_mul_pd(a,b),c);
+#  endif
+    }
+};
+
+template<> struct simd<float>
+{
+  using reg = __m256;
+  static constexpr std::size_t width = 8;
+  static reg zero() { return _mm256_setzero_ps(); }
+  static reg load(const float *p) { return _mm256_loadu_ps(p); }
+  static void store(float *p, reg x) { _mm256_storeu_ps(p,x); }
+  static reg broadcast(float x) { return _mm256_set1_ps(x); }
+  static reg fmadd(reg a, reg b, reg c)
+    {
+#  if defined(__FMA__)
+      return _mm256_fmadd_ps(a,b,c);
+#  else
+      return _mm256_add_ps(_mm256_mul_ps(a,b),c);
+#  endif
+    }
+};
+
+// 16 registers: 12 accumulators, 2 for B and one broadcast.
+template<> struct micro_kernel<double> : simd_kernel<double,6,2> {};
+template<> struct micro_kernel<float> : simd_kernel<float,6,2> {};
+
+#elif defined(__SSE2__)
+
+template<> struct simd<double>
+{
+  using reg = __m128d;
+  static constexpr std::size_t width = 2;
+  static reg zero() { return _mm_setzero_pd(); }
+  static reg load(const double *p) { return _mm_loadu_pd(p); }
+  static void store(double *p, reg x) { _mm_storeu_pd(p,x); }
+  static reg broadcast(double x) { return _mm_set1_pd(x); }
+  static reg fmadd(reg a, reg b, reg c) { return _mm_add_pd(_mm_mul_pd(a,b),c); }
+};
+
+template<> struct simd<float>
+{
+  using reg = __m128;
+  static constexpr std::size_t width = 4;
+  static reg zero() { return _mm_setzero_ps(); }
+  static reg load(const float *p) { return _mm_loadu_ps(p); }
+  static void store(float *p, reg x) { _mm_storeu_ps(p,x); }
+  static reg broadcast(float x) { return _mm_set1_ps(x); }
+  static reg fmadd(reg a, reg b, reg c) { return _mm_add_ps(_mm_mul_ps(a,b),c); }
+};
+
+// 16 registers: 8 accumulators, 2 for B and one broadcast.
+template<> struct micro_kernel<double> : simd_kernel<double,4,2> {};
+template<> struct micro_kernel<float> : simd_kernel<float,4,2> {};
+
+#endif
+
+//
+// Packing
+//
+
+inline std::size_t round_up(std::size_t x, std::size_t r)
+{
+  return ((x + r - 1)/r)*r;
+}
+
+// Copy the mc by kc block of A at a (row stride rs, column stride cs)
+// into panels of MR rows: panel p holds A(p*MR+i,l) at
+// buf[p*MR*kc + l*MR + i].  Rows past mc are padded with zeros.
+template<std::size_t MR, class T>
+inline void pack_a(std::size_t mc, std::size_t kc,
+		   const T *a, std::ptrdiff_t rs, std::ptrdiff_t cs, T *buf)
+{
+  for (std::size_t i0 = 0; i0 < mc; i0 += MR)
+    {
+      const std::size_t mr = std::min(MR,mc - i0);
+      const T *p = a + i0*rs;
+      for (std::size_t l = 0; l < kc; ++l, p += cs)
+	{
+	  std::size_t i = 0;
+	  for (; i < mr; ++i) *buf++ = p[i*rs];
+	  for (; i < MR; ++i) *buf++ = T();
+	}
+    }
+}
+
+// Copy the kc by nc block of B into panels of NR columns: panel p
+// holds B(l,p*NR+j) at buf[p*NR*kc + l*NR + j], padded with zeros.
+template<std::size_t NR, class T>
+inline void pack_b(std::size_t kc, std::size_t nc,
+		   const T *b, std::ptrdiff_t rs, std::ptrdiff_t cs, T *buf)
+{
+  for (std::size_t j0 = 0; j0 < nc; j0 += NR)
+    {
+      const std::size_t nr = std::min(NR,nc - j0);
+      const T *p = b + j0*cs;
+      for (std::size_t l = 0; l < kc; ++l, p += rs)
+	{
+	  std::size_t j = 0;
+	  for (; j < nr; ++j) *buf++ = p[j*cs];
+	  for (; j < NR; ++j) *buf++ = T();
+	}
+    }
+}
+
+// C = beta*C (C is not read if beta is zero, so it may be
+// uninitialised).
+template<class T>
+inline void scale(std::size_t m, std::size_t n, const T& beta,
+		  T *C, std::ptrdiff_t rsC, std::ptrdiff_t csC)
+{
+  for (std::size_t i = 0; i < m; ++i)
+    for (std::size_t j = 0; j < n; ++j)
+      {
+	T& c = C[i*rsC + j*csC];
+	c = (beta == T() ? T() : beta*c);
+      }
+}
+
+// Packing buffers, aligned and left uninitialised.
+template<class T>
+using gemm_buffer = std::vector<T,aligned_allocator<T,JLT_DEFAULT_ALIGNMENT,
+						    alloc_default_init>>;
+
+// C = alpha*A*B + beta*C for an mc by nc block of C, from A packed by
+// pack_a and B packed by pack_b, both with kc columns (rows) of k.
+template<class T>
+void macro_kernel(std::size_t mc, std::size_t nc, std::size_t kc,
+		  const T& alpha, const T *abuf, const T *bbuf,
+		  const T& beta, T *C, std::ptrdiff_t rsC, std::ptrdiff_t csC)
+{
+  using kernel = micro_kernel<T>;
+  using std::size_t;
+
+  constexpr size_t MR = kernel::MR, NR = kernel::NR;
+  alignas(JLT_DEFAULT_ALIGNMENT) T ab[MR*NR];
+
+  for (size_t jr = 0; jr < nc; jr += NR)
+    {
+      const size_t nr = std::min(NR,nc - jr);
+
+      for (size_t ir = 0; ir < mc; ir += MR)
+	{
+	  const size_t mr = std::min(MR,mc - ir);
+
+	  kernel::run(kc,abuf + ir*kc,bbuf + jr*kc,ab);
+
+	  T *c = C + ir*rsC + jr*csC;
+	  if (beta == T())
+	    {
+	      for (size_t i = 0; i < mr; ++i)
+		for (size_t j = 0; j < nr; ++j)
+		  c[i*rsC + j*csC] = alpha*ab[i*NR + j];
+	    }
+	  else
+	    {
+	      for (size_t i = 0; i < mr; ++i)
+		for (size_t j = 0; j < nr; ++j)
+		  {
+		    T& cij = c[i*rsC + j*csC];
+		    cij = alpha*ab[i*NR + j] + beta*cij;
+		  }
+	    }
+	}
+    }
+}
+
+// The packed, blocked product, for one thread.  beta is applied to C
+// during the first pass over k.
+template<class T>
+void gemm_blocked(std::size_t m, std::size_t n, std::size_t k,
+		  const T& alpha, const T *A, std::ptrdiff_t rsA, std::ptrdiff_t csA,
+		  const T *B, std::ptrdiff_t rsB, std::ptrdiff_t csB,
+		  const T& beta, T *C, std::ptrdiff_t rsC, std::ptrdiff_t csC)
+{
+  using std::size_t;
+
+  constexpr size_t MR = micro_kernel<T>::MR, NR = micro_kernel<T>::NR;
+  constexpr size_t KC = JLT_GEMM_KC;
+  constexpr size_t MC = ((JLT_GEMM_MC + MR - 1)/MR)*MR;
+  constexpr size_t NC = ((JLT_GEMM_NC + NR - 1)/NR)*NR;
+
+  const size_t kcmax = std::min(k,KC);
+  gemm_buffer<T> abuf(round_up(std::min(m,MC),MR)*kcmax);
+  gemm_buffer<T> bbuf(round_up(std::min(n,NC),NR)*kcmax);
+
+  for (size_t jc = 0; jc < n; jc += NC)
+    {
+      const size_t nc = std::min(NC,n - jc);
+
+      for (size_t pc = 0; pc < k; pc += KC)
+	{
+	  const size_t kc = std::min(KC,k - pc);
+	  // Only the first block of k sees the original C.
+	  const T betap = (pc == 0 ? beta : T(1));
+
+	  pack_b<NR>(kc,nc,B + pc*rsB + jc*csB,rsB,csB,bbuf.data());
+
+	  for (size_t ic = 0; ic < m; ic += MC)
+	    {
+	      const size_t mc = std::min(MC,m - ic);
+
+	      pack_a<MR>(mc,kc,A + ic*rsA + pc*csA,rsA,csA,abuf.data());
+
+	      macro_kernel(mc,nc,kc,alpha,abuf.data(),bbuf.data(),
+			   betap,C + ic*rsC + jc*csC,rsC,csC);
+	    }
+	}
+    }
+}
+
+// The blocked product on the thread pool.  Each block of B is packed
+// once, by all the threads, into a buffer that they then share.  The
+// threads then split the rows of C, each packing its own blocks of A;
+// if C is wider than tall they split the columns of the block of B
+// instead, and each packs all the rows of A.
+template<class T>
+void gemm_parallel(std::size_t m, std::size_t n, std::size_t k,
+		   const T& alpha, const T *A, std::ptrdiff_t rsA, std::ptrdiff_t csA,
+		   const T *B, std::ptrdiff_t rsB, std::ptrdiff_t csB,
+		   const T& beta, T *C, std::ptrdiff_t rsC, std::ptrdiff_t csC)
+{
+  using std::size_t;
+
+  // Slices are whole micro-kernel tiles, so that only the last one has
+  // a ragged edge.
+  constexpr size_t MR = micro_kernel<T>::MR, NR = micro_kernel<T>::NR;
+  constexpr size_t KC = JLT_GEMM_KC;
+  constexpr size_t MC = ((JLT_GEMM_MC + MR - 1)/MR)*MR;
+  constexpr size_t NC = ((JLT_GEMM_NC + NR - 1)/NR)*NR;
+  constexpr size_t mgrain = (JLT_GEMM_PARALLEL_GRAIN + MR - 1)/MR;
+  constexpr size_t ngrain = (JLT_GEMM_PARALLEL_GRAIN + NR - 1)/NR;
+
+  const size_t kcmax = std::min(k,KC);
+  gemm_buffer<T> bbuf(round_up(std::min(n,NC),NR)*kcmax);
+
+  for (size_t jc = 0; jc < n; jc += NC)
+    {
+      const size_t nc = std::min(NC,n - jc);
+      const size_t npanels = (nc + NR - 1)/NR;
+
+      for (size_t pc = 0; pc < k; pc += KC)
+	{
+	  const size_t kc = std::min(KC,k - pc);
+	  const T betap = (pc == 0 ? beta : T(1));
+	  const T *b = B + pc*rsB + jc*csB;
+	  T *bp = bbuf.data();
+
+	  parallel_for(0,npanels,ngrain,
+		       [&](size_t t0, size_t t1)
+		       {
+			 size_t j0 = t0*NR, j1 = std::min(nc,t1*NR);
+			 pack_b<NR>(kc,j1-j0,b + j0*csB,rsB,csB,bp + j0*kc);
+		       });
+
+	  if (m >= n)
+	    {
+	      parallel_for(0,(m + MR - 1)/MR,mgrain,
+			   [&](size_t t0, size_t t1)
+			   {
+			     size_t i0 = t0*MR, i1 = std::min(m,t1*MR);
+			     gemm_buffer<T> abuf(round_up(std::min(i1-i0,MC),MR)*kc);
+			     for (size_t ic = i0; ic < i1; ic += MC)
+			       {
+				 const size_t mc = std::min(MC,i1 - ic);
+				 pack_a<MR>(mc,kc,A + ic*rsA + pc*csA,rsA,csA,
+					    abuf.data());
+				 macro_kernel(mc,nc,kc,alpha,abuf.data(),bp,
+					      betap,C + ic*rsC + jc*csC,rsC,csC);
+			       }
+			   });
+	    }
+	  else
+	    {
+	      parallel_for(0,npanels,ngrain,
+			   [&](size_t t0, size_t t1)
+			   {
+			     size_t j0 = t0*NR, j1 = std::min(nc,t1*NR);
+			     gemm_buffer<T> abuf(round_up(std::min(m,MC),MR)*kc);
+			     for (size_t ic = 0; ic < m; ic += MC)
+			       {
+				 const size_t mc = std::min(MC,m - ic);
+				 pack_a<MR>(mc,kc,A + ic*rsA + pc*csA,rsA,csA,
+					    abuf.data());
+				 macro_kernel(mc,j1-j0,kc,alpha,abuf.data(),
+					      bp + j0*kc,betap,
+					      C + ic*rsC + (jc + j0)*csC,rsC,csC);
+			       }
+			   });
+	    }
+	}
+    }
+}
+
+} // namespace gemm_detail
+
+//
+// C = alpha*A*B + beta*C
+//
+
+// A is m by k, B is k by n and C is m by n, each given by a pointer to
+// its (0,0) element and its row and column strides.  If beta is zero C
+// is only written to.
+template<class T>
+void gemm(std::size_t m, std::size_t n, std::size_t k,
+	  const T& alpha, const T *A, std::ptrdiff_t rsA, std::ptrdiff_t csA,
+	  const T *B, std::ptrdiff_t rsB, std::ptrdiff_t csB,
+	  const T& beta, T *C, std::ptrdiff_t rsC, std::ptrdiff_t csC)
+{
+  using namespace gemm_detail;
+  using std::size_t;
+
+  static_assert(is_gemm_type<T>::value,
+		"jlt::gemm: element type must be floating-point or complex.");
+
+  if (m == 0 || n == 0) return;
+
+  if (k == 0 || alpha == T())
+    {
+      scale(m,n,beta,C,rsC,csC);
+      return;
+    }
+
+#ifdef JLT_USE_BLAS
+  if constexpr (blas::is_blas_type<T>::value)
+    {
+      if (blas::strided_gemm(m,n,k,alpha,A,rsA,csA,B,rsB,csB,beta,C,rsC,csC))
+	return;
+    }
+#endif
+
+  // Small products: dot products in the order of the plain triple loop.
+  if (m*n*k < JLT_GEMM_SMALL)
+    {
+      for (size_t i = 0; i < m; ++i)
+	for (size_t j = 0; j < n; ++j)
+	  {
+	    T s = T();
+	    for (size_t l = 0; l < k; ++l) s += A[i*rsA + l*csA]*B[l*rsB + j*csB];
+	    T& c = C[i*rsC + j*csC];
+	    c = (beta == T() ? alpha*s : alpha*s + beta*c);
+	  }
+      return;
+    }
+
+  if (m*n*k < JLT_GEMM_PARALLEL)
+    {
+      gemm_blocked(m,n,k,alpha,A,rsA,csA,B,rsB,csB,beta,C,rsC,csC);
+      return;
+    }
+
+  gemm_parallel(m,n,k,alpha,A,rsA,csA,B,rsB,csB,beta,C,rsC,csC);
+}
+
+//
+// Matrices, views and trans() of them
+//
+
+// The strided view that gemm() works on.
+template<class T, class Alloc, class Order>
+inline matrix_view<const T> gemm_operand(const matrix<T,Alloc,Order>& A)
+{
+  return A.view();
+}
+
+template<class T, class Alloc, class Order>
+inline matrix_view<T> gemm_operand(matrix<T,Alloc,Order>& A)
+{
+  return A.view();
+}
+
+template<class U>
+inline matrix_view<U> gemm_operand(const matrix_view<U>& A)
+{
+  return A;
+}
+
+// Only plain transposes: adj() of a complex matrix would need the
+// packing to conjugate.
+template<class Matrix, bool Conj,
+	 class = typename std::enable_if<!transposed<Matrix,Conj>::conjugated>::type>
+inline auto gemm_operand(const transposed<Matrix,Conj>& A)
+  -> decltype(gemm_operand(A.base()).transpose())
+{
+  return gemm_operand(A.base()).transpose();
+}
+
+// Can gemm() take M as an operand?
+template<class M, class = void>
+struct is_gemm_operand : std::false_type {};
+
+template<class M>
+struct is_gemm_operand<M,
+		       std::void_t<decltype(gemm_operand(std::declval<const M&>()))>>
+  : is_gemm_type<typename std::remove_const<
+		   typename decltype(gemm_operand(std::declval<const M&>()))::value_type>::type>
+{};
+
+// C = alpha*A*B + beta*C.  C may be a matrix or a (non-const) view.
+template<class S, class M_A, class M_B, class M_C>
+inline void gemm(const S& alpha, const M_A& A, const M_B& B, const S& beta,
+		 M_C&& C)
+{
+  auto a = gemm_operand(A);
+  auto b = gemm_operand(B);
+  auto c = gemm_operand(C);
+  using T = typename decltype(c)::value_type;
+
+  MATRIX_ASSERT(a.columns() == b.rows() &&
+		c.rows() == a.rows() && c.columns() == b.columns());
+
+  gemm<T>(c.rows(),c.columns(),a.columns(),
+	  alpha,a.data(),a.row_stride(),a.column_stride(),
+	  b.data(),b.row_stride(),b.column_stride(),
+	  beta,c.data(),c.row_stride(),c.column_stride());
+}
+
+} // namespace jlt
+
+#endif // JLT_GEMM_HPP
@@ -0,0 +1,186 @@
+//
+// Copyright (c) 2004-2020 Jean-Luc Thiffeault <jeanluc@mailaps.org>
+//
+// See the file LICENSE for copying permission.
+//
+
+#ifndef JLT_GRAM_HPP
+#define JLT_GRAM_HPP
+
+//
+// gram.hpp
+//
+
+// Symmetric rank-k products, as in BLAS's syrk:
+//
+//   gram(A)       A*trans(A), as a symmetric_matrix
+//   gram_t(A)     trans(A)*A, as a symmetric_matrix
+//   gram(A,G)     into a square matrix or view G, or a symmetric_matrix
+//   gram_t(A,G)
+//   syrk(alpha,A,beta,G)     G = alpha*A*trans(A) + beta*G
+//
+// Only the lower triangle is computed, which takes half the
+// multiply-adds of A*trans(A).  With a dense G the upper triangle is
+// then filled in by symmetry, unless mirror is false, in which case it
+// is not touched.  A symmetric_matrix result can be passed directly to
+// symmetric_matrix_eigensystem (eigensystem.hpp), e.g. for the singular
+// values of A or the eigenvalues of a Cauchy-Green tensor.
+//
+// The triangle is cut into tiles of JLT_GRAM_BLOCK rows and columns.
+// Each tile is a product of two row blocks of A computed by
+// gemm_product(), so that float, double and complex elements use the
+// packed SIMD kernel of gemm.hpp (or BLAS with JLT_USE_BLAS).  The
+// tiles do not overlap, so they are the unit of parallel work.  A may be
+// a mathmatrix, a view or a vector (giving the outer product x x^T).
+// Complex products are not conjugated.
+
+#include <cstddef>
+#include <vector>
+#include <utility>
+#include <type_traits>
+#include <jlt/mathmatrix.hpp>
+#include <jlt/packed_matrix.hpp>
+#include <jlt/blas1.hpp>
+#include <jlt/gemm.hpp>
+#include <jlt/thread_pool.hpp>
+
+// Rows and columns of the tiles of the triangle.
+#ifndef JLT_GRAM_BLOCK
+#  define JLT_GRAM_BLOCK 96
+#endif
+
+namespace jlt {
+
+template<class T> struct is_symmetric_matrix : std::false_type {};
+template<class T, class Alloc>
+struct is_symmetric_matrix<symmetric_matrix<T,Alloc>> : std::true_type {};
+
+namespace gram_detail {
+
+// Lower triangle of G = alpha*A*trans(A) + beta*G, for a view A.
+template<class S, class U, class M_G>
+void lower(const S& alpha, const matrix_view<U>& A, const S& beta, M_G& G)
+{
+  using std::size_t;
+  using T = typename std::remove_const<U>::type;
+
+  const size_t n = A.rows(), k = A.columns();
+  const size_t nb = JLT_GRAM_BLOCK;
+  const size_t nt = (n + nb - 1)/nb;
+
+  MATRIX_ASSERT(G.rows() == n && G.columns() == n);
+
+  if (n == 0) return;
+
+  // Tile t = I(I+1)/2 + J is (I,J), J <= I, in row order.
+  std::vector<std::pair<size_t,size_t>> tiles;
+  tiles.reserve(nt*(nt+1)/2);
+  for (size_t I = 0; I < nt; ++I)
+    for (size_t J = 0; J <= I; ++J) tiles.emplace_back(I,J);
+
+  const size_t grain = (n*n*k/2 < JLT_GEMM_PARALLEL ? tiles.size() : 1);
+
+  parallel_for(0,tiles.size(),grain,
+	       [&](size_t t0, size_t t1)
+	       {
+		 std::vector<T> buf(nb*nb);
+
+		 for (size_t t = t0; t < t1; ++t)
+		   {
+		     const size_t i0 = tiles[t].first*nb, j0 = tiles[t].second*nb;
+		     const size_t mi = std::min(nb,n - i0), mj = std::min(nb,n - j0);
+		     const bool diag = (i0 == j0);
+
+		     matrix_view<T> C(buf.data(),mi,mj,mj);
+		     gemm_product(C,A.block(i0,0,mi,k),
+				  A.block(j0,0,mj,k).transpose());
+
+		     for (size_t r = 0; r < mi; ++r)
+		       {
+			 const size_t cmax = (diag ? r+1 : mj);
+			 if (beta == S(0))
+			   for (size_t c = 0; c < cmax; ++c)
+			     G(i0+r,j0+c) = alpha*C(r,c);
+			 else
+			   for (size_t c = 0; c < cmax; ++c)
+			     G(i0+r,j0+c) = alpha*C(r,c) + beta*G(i0+r,j0+c);
+		       }
+		   }
+	       });
+}
+
+template<class M_G>
+void mirror(M_G& G)
+{
+  for (std::size_t i = 0; i < G.rows(); ++i)
+    for (std::size_t j = 0; j < i; ++j) G(j,i) = G(i,j);
+}
+
+} // namespace gram_detail
+
+// G = alpha*A*trans(A) + beta*G, for G a symmetric_matrix or a square
+// matrix or view.  A dense G gets its upper triangle from the lower if
+// mirror is true.
+template<class S, class M_A, class M_G, class = enable_if_blas1_t<M_A>>
+inline void syrk(const S& alpha, const M_A& A, const S& beta, M_G&& G,
+		 bool mirror = true)
+{
+  auto a = blas1_view(A);
+
+  if constexpr (is_symmetric_matrix<typename std::decay<M_G>::type>::value)
+    {
+      gram_detail::lower(alpha,a,beta,G);
+    }
+  else
+    {
+      auto g = blas1_view(G);
+      gram_detail::lower(alpha,a,beta,g);
+      if (mirror) gram_detail::mirror(g);
+    }
+}
+
+// G = A*trans(A).  A symmetric_matrix G is resized if need be; a dense
+// G must already be square with as many rows as A.
+template<class M_A, class M_G, class = enable_if_blas1_t<M_A>>
+inline void gram(const M_A& A, M_G&& G, bool mirror = true)
+{
+  using G_t = typename std::decay<M_G>::type;
+  using T = typename G_t::value_type;
+
+  if constexpr (is_symmetric_matrix<G_t>::value)
+    {
+      if (G.rows() != blas1_view(A).rows())
+	{
+	  G_t tmp(blas1_view(A).rows());
+	  G = std::move(tmp);
+	}
+    }
+  syrk(T(1),A,T(0),G,mirror);
+}
+
+// G = trans(A)*A.
+template<class M_A, class M_G, class = enable_if_blas1_t<M_A>>
+inline void gram_t(const M_A& A, M_G&& G, bool mirror = true)
+{
+  gram(blas1_view(A).transpose(),std::forward<M_G>(G),mirror);
+}
+
+template<class M_A, class = enable_if_blas1_t<M_A>>
+[[nodiscard]] inline auto gram(const M_A& A)
+{
+  using T = typename decltype(blas1_view(A))::value_type;
+
+  symmetric_matrix<T> G(blas1_view(A).rows());
+  gram(A,G);
+  return G;
+}
+
+template<class M_A, class = enable_if_blas1_t<M_A>>
+[[nodiscard]] inline auto gram_t(const M_A& A)
+{
+  return gram(blas1_view(A).transpose());
+}
+
+} // namespace jlt
+
+#endif // JLT_GRAM_HPP
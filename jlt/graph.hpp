@@ -0,0 +1,254 @@
+//
+// Copyright (c) 2004-2020 Jean-Luc Thiffeault <jeanluc@mailaps.org>
+//
+// See the file LICENSE for copying permission.
+//
+
+#ifndef JLT_GRAPH_HPP
+#define JLT_GRAPH_HPP
+
+//
+// graph.hpp
+//
+
+// Irreducibility and primitivity of nonnegative matrices from their
+// nonzero pattern, read as a directed graph with an edge i -> j
+// whenever A(i,j) != 0:
+//
+//   - A is irreducible if the graph is strongly connected.
+//   - The period of an irreducible A is the gcd of the lengths of the
+//     cycles of the graph.  It is also the gcd of level(i) + 1 -
+//     level(j) over all edges i -> j, where level is the distance
+//     from any fixed node in a breadth-first search.
+//   - A is primitive (some power of A is positive) if it is
+//     irreducible with period 1.
+//
+// All of these take O(n + nnz) operations, against O(n^3 log n) for
+// testing powers of A.  They work on a graph in compressed form: the
+// successors of node u are index[start[u]] to index[start[u+1]-1].
+// This is the compressed-row layout of A, or the compressed-column
+// layout of trans(A), which has the same strong components and period,
+// so CSparse matrices can be tested without conversion (see
+// csparse.hpp).  nonzero_graph builds the compressed form of any dense
+// matrix; mathmatrix::isIrreducible() and isPrimitive() use it.
+//
+// A 1 by 1 matrix is irreducible, and primitive if its element is
+// nonzero.
+
+#include <cstddef>
+#include <vector>
+#include <numeric>
+#include <algorithm>
+#include <type_traits>
+
+namespace jlt {
+
+//
+// Algorithms on compressed graphs
+//
+
+// Label the strongly connected components of the graph, in comp[u],
+// by Tarjan's algorithm without recursion.  Returns the number of
+// components.  Components are numbered in reverse topological order:
+// no edge leads from a component to one with a larger number.
+template<class Index>
+std::size_t strong_components(std::size_t n, const Index *start,
+			      const Index *index,
+			      std::vector<std::size_t>& comp)
+{
+  using std::size_t;
+  const size_t unvisited = (size_t)-1;
+
+  std::vector<size_t> order(n,unvisited), low(n), stack, calls;
+  std::vector<Index> next(n);	// Next edge to explore, per node.
+  std::vector<bool> onstack(n);
+  comp.assign(n,unvisited);
+
+  size_t counter = 0, ncomp = 0;
+
+  for (size_t root = 0; root < n; ++root)
+    {
+      if (order[root] != unvisited) continue;
+
+      calls.push_back(root);
+      order[root] = low[root] = counter++;
+      next[root] = start[root];
+      stack.push_back(root);
+      onstack[root] = true;
+
+      while (!calls.empty())
+	{
+	  size_t u = calls.back();
+
+	  if (next[u] < start[u+1])
+	    {
+	      size_t v = index[next[u]++];
+	      if (order[v] == unvisited)
+		{
+		  // Descend into v.
+		  order[v] = low[v] = counter++;
+		  next[v] = start[v];
+		  stack.push_back(v);
+		  onstack[v] = true;
+		  calls.push_back(v);
+		}
+	      else if (onstack[v])
+		{
+		  low[u] = std::min(low[u],order[v]);
+		}
+	      continue;
+	    }
+
+	  // All edges of u explored: pop a component if u is its root.
+	  if (low[u] == order[u])
+	    {
+	      size_t v;
+	      do
+		{
+		  v = stack.back();
+		  stack.pop_back();
+		  onstack[v] = false;
+		  comp[v] = ncomp;
+		}
+	      while (v != u);
+	      ++ncomp;
+	    }
+
+	  calls.pop_back();
+	  if (!calls.empty())
+	    {
+	      size_t p = calls.back();
+	      low[p] = std::min(low[p],low[u]);
+	    }
+	}
+    }
+
+  return ncomp;
+}
+
+// Is every node reachable from every other?
+template<class Index>
+bool strongly_connected(std::size_t n, const Index *start, const Index *index)
+{
+  if (n == 0) return false;
+
+  std::vector<std::size_t> comp;
+  return (strong_components(n,start,index,comp) == 1);
+}
+
+// Period of a strongly connected graph: the gcd of its cycle lengths,
+// or 0 if it has none (a single node without a loop).
+template<class Index>
+std::size_t graph_period(std::size_t n, const Index *start, const Index *index)
+{
+  using std::size_t;
+
+  if (n == 0) return 0;
+
+  // Breadth-first levels from node 0.
+  const size_t unvisited = (size_t)-1;
+  std::vector<size_t> level(n,unvisited), queue;
+  queue.reserve(n);
+  level[0] = 0;
+  queue.push_back(0);
+  for (size_t q = 0; q < queue.size(); ++q)
+    {
+      size_t u = queue[q];
+      for (Index e = start[u]; e < start[u+1]; ++e)
+	{
+	  size_t v = index[e];
+	  if (level[v] == unvisited)
+	    {
+	      level[v] = level[u] + 1;
+	      queue.push_back(v);
+	    }
+	}
+    }
+
+  // Every edge u -> v closes a walk of length level[u] + 1 - level[v]
+  // back to a node at the same level.
+  size_t d = 0;
+  for (size_t u = 0; u < n && d != 1; ++u)
+    {
+      if (level[u] == unvisited) continue;
+      for (Index e = start[u]; e < start[u+1]; ++e)
+	{
+	  size_t v = index[e];
+	  d = std::gcd(d,level[u] + 1 - level[v]);
+	}
+    }
+
+  return d;
+}
+
+template<class Index>
+bool primitive_graph(std::size_t n, const Index *start, const Index *index)
+{
+  return (strongly_connected(n,start,index) &&
+	  graph_period(n,start,index) == 1);
+}
+
+//
+// class nonzero_graph
+//
+
+// The graph of the nonzero pattern of a dense matrix, in compressed
+// form.
+class nonzero_graph
+{
+public:
+  using size_type = std::size_t;
+
+private:
+  size_type n{0};
+  std::vector<size_type> start_, index_;
+
+public:
+  nonzero_graph() {}
+
+  // From any square matrix with operator()(i,j), rows() and columns().
+  template<class Matrix>
+  explicit nonzero_graph(const Matrix& A)
+    : n(A.rows()), start_(A.rows()+1)
+    {
+      using T = typename std::decay<decltype(A(0,0))>::type;
+
+      for (size_type i = 0; i < n; ++i)
+	{
+	  start_[i] = index_.size();
+	  for (size_type j = 0; j < A.columns(); ++j)
+	    if (A(i,j) != T()) index_.push_back(j);
+	}
+      start_[n] = index_.size();
+    }
+
+  [[nodiscard]] size_type nodes() const { return n; }
+  [[nodiscard]] size_type edges() const { return index_.size(); }
+
+  [[nodiscard]] const size_type* start() const { return start_.data(); }
+  [[nodiscard]] const size_type* index() const { return index_.data(); }
+
+  [[nodiscard]] bool strongly_connected() const
+    {
+      return jlt::strongly_connected(n,start(),index());
+    }
+
+  [[nodiscard]] size_type period() const
+    {
+      return graph_period(n,start(),index());
+    }
+
+  [[nodiscard]] bool primitive() const
+    {
+      return primitive_graph(n,start(),index());
+    }
+
+  size_type strong_components(std::vector<size_type>& comp) const
+    {
+      return jlt::strong_components(n,start(),index(),comp);
+    }
+};
+
+} // namespace jlt
+
+#endif // JLT_GRAPH_HPP
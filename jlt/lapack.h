@@ -115,6 +115,32 @@ void zgeev_(char* jobVL,
 	    double* rwork,
 	    int* info);
 
+// SSPEV - compute all the eigenvalues and, optionally, eigenvectors of a
+//    real symmetric matrix A in packed storage.
+// (single precision)
+void sspev_(char* jobz,
+	    char* uplo,
+	    int* N,
+	    float* AP,
+	    float* W,
+	    float* Z,
+	    int* ldZ,
+	    float* work,
+	    int* info);
+
+// DSPEV - compute all the eigenvalues and, optionally, eigenvectors of a
+//    real symmetric matrix A in packed storage.
+// (double precision)
+void dspev_(char* jobz,
+	    char* uplo,
+	    int* N,
+	    double* AP,
+	    double* W,
+	    double* Z,
+	    int* ldZ,
+	    double* work,
+	    int* info);
+
 //
 // Singular value decomposition routines
 //
@@ -191,4 +217,244 @@ void dgesdd_(char* jobz,
 	     int* iwork,
 	     int* info);
 
+//
+// Linear equations routines
+//
+
+// SGETRF - compute an LU factorization of a general M-by-N real
+//    matrix A using partial pivoting with row interchanges.
+// (single precision)
+void sgetrf_(int* M,
+	     int* N,
+	     float* A,
+	     int* ldA,
+	     int* ipiv,
+	     int* info);
+
+// DGETRF - compute an LU factorization of a general M-by-N real
+//    matrix A using partial pivoting with row interchanges.
+// (double precision)
+void dgetrf_(int* M,
+	     int* N,
+	     double* A,
+	     int* ldA,
+	     int* ipiv,
+	     int* info);
+
+// CGETRF - compute an LU factorization of a general M-by-N complex
+//    matrix A using partial pivoting with row interchanges.
+// (single precision)
+void cgetrf_(int* M,
+	     int* N,
+	     std::complex<float>* A,
+	     int* ldA,
+	     int* ipiv,
+	     int* info);
+
+// ZGETRF - compute an LU factorization of a general M-by-N complex
+//    matrix A using partial pivoting with row interchanges.
+// (double precision)
+void zgetrf_(int* M,
+	     int* N,
+	     std::complex<double>* A,
+	     int* ldA,
+	     int* ipiv,
+	     int* info);
+
+// SGETRS - solve a system of linear equations A X = B, A**T X = B,
+//    or A**H X = B with a general N-by-N real matrix A using the LU
+//    factorization computed by SGETRF.
+// (single precision)
+void sgetrs_(char* trans,
+	     int* N,
+	     int* nrhs,
+	     float* A,
+	     int* ldA,
+	     int* ipiv,
+	     float* B,
+	     int* ldB,
+	     int* info);
+
+// DGETRS - solve a system of linear equations A X = B, A**T X = B,
+//    or A**H X = B with a general N-by-N real matrix A using the LU
+//    factorization computed by DGETRF.
+// (double precision)
+void dgetrs_(char* trans,
+	     int* N,
+	     int* nrhs,
+	     double* A,
+	     int* ldA,
+	     int* ipiv,
+	     double* B,
+	     int* ldB,
+	     int* info);
+
+// CGETRS - solve a system of linear equations A X = B, A**T X = B,
+//    or A**H X = B with a general N-by-N complex matrix A using the LU
+//    factorization computed by CGETRF.
+// (single precision)
+void cgetrs_(char* trans,
+	     int* N,
+	     int* nrhs,
+	     std::complex<float>* A,
+	     int* ldA,
+	     int* ipiv,
+	     std::complex<float>* B,
+	     int* ldB,
+	     int* info);
+
+// ZGETRS - solve a system of linear equations A X = B, A**T X = B,
+//    or A**H X = B with a general N-by-N complex matrix A using the LU
+//    factorization computed by ZGETRF.
+// (double precision)
+void zgetrs_(char* trans,
+	     int* N,
+	     int* nrhs,
+	     std::complex<double>* A,
+	     int* ldA,
+	     int* ipiv,
+	     std::complex<double>* B,
+	     int* ldB,
+	     int* info);
+
+// SPOTRF - compute the Cholesky factorization of a real symmetric
+//    positive definite matrix A.
+// (single precision)
+void spotrf_(char* uplo,
+	     int* N,
+	     float* A,
+	     int* ldA,
+	     int* info);
+
+// DPOTRF - compute the Cholesky factorization of a real symmetric
+//    positive definite matrix A.
+// (double precision)
+void dpotrf_(char* uplo,
+	     int* N,
+	     double* A,
+	     int* ldA,
+	     int* info);
+
+// CPOTRF - compute the Cholesky factorization of a complex Hermitian
+//    positive definite matrix A.
+// (single precision)
+void cpotrf_(char* uplo,
+	     int* N,
+	     std::complex<float>* A,
+	     int* ldA,
+	     int* info);
+
+// ZPOTRF - compute the Cholesky factorization of a complex Hermitian
+//    positive definite matrix A.
+// (double precision)
+void zpotrf_(char* uplo,
+	     int* N,
+	     std::complex<double>* A,
+	     int* ldA,
+	     int* info);
+
+// SSYTRF - compute the factorization of a real symmetric matrix A
+//    using the Bunch-Kaufman diagonal pivoting method.
+// (single precision)
+void ssytrf_(char* uplo,
+	     int* N,
+	     float* A,
+	     int* ldA,
+	     int* ipiv,
+	     float* work,
+	     int* lwork,
+	     int* info);
+
+// DSYTRF - compute the factorization of a real symmetric matrix A
+//    using the Bunch-Kaufman diagonal pivoting method.
+// (double precision)
+void dsytrf_(char* uplo,
+	     int* N,
+	     double* A,
+	     int* ldA,
+	     int* ipiv,
+	     double* work,
+	     int* lwork,
+	     int* info);
+
+// CSYTRF - compute the factorization of a complex symmetric matrix A
+//    using the Bunch-Kaufman diagonal pivoting method.
+// (single precision)
+void csytrf_(char* uplo,
+	     int* N,
+	     std::complex<float>* A,
+	     int* ldA,
+	     int* ipiv,
+	     std::complex<float>* work,
+	     int* lwork,
+	     int* info);
+
+// ZSYTRF - compute the factorization of a complex symmetric matrix A
+//    using the Bunch-Kaufman diagonal pivoting method.
+// (double precision)
+void zsytrf_(char* uplo,
+	     int* N,
+	     std::complex<double>* A,
+	     int* ldA,
+	     int* ipiv,
+	     std::complex<double>* work,
+	     int* lwork,
+	     int* info);
+
+// SPBSV - compute the solution to a real system of linear equations
+//    A X = B, where A is an N-by-N symmetric positive definite band matrix.
+// (single precision)
+void spbsv_(char* uplo,
+	    int* N,
+	    int* kd,
+	    int* nrhs,
+	    float* AB,
+	    int* ldAB,
+	    float* B,
+	    int* ldB,
+	    int* info);
+
+// DPBSV - compute the solution to a real system of linear equations
+//    A X = B, where A is an N-by-N symmetric positive definite band matrix.
+// (double precision)
+void dpbsv_(char* uplo,
+	    int* N,
+	    int* kd,
+	    int* nrhs,
+	    double* AB,
+	    int* ldAB,
+	    double* B,
+	    int* ldB,
+	    int* info);
+
+// SGBSV - compute the solution to a real system of linear equations
+//    A X = B, where A is a band matrix of order N with KL subdiagonals and
+//    KU superdiagonals.
+// (single precision)
+void sgbsv_(int* N,
+	    int* kl,
+	    int* ku,
+	    int* nrhs,
+	    float* AB,
+	    int* ldAB,
+	    int* ipiv,
+	    float* B,
+	    int* ldB,
+	    int* info);
+
+// DGBSV - compute the solution to a real system of linear equations
+//    A X = B, where A is a band matrix of order N with KL subdiagonals and
+//    KU superdiagonals.
+// (double precision)
+void dgbsv_(int* N,
+	    int* kl,
+	    int* ku,
+	    int* nrhs,
+	    double* AB,
+	    int* ldAB,
+	    int* ipiv,
+	    double* B,
+	    int* ldB,
+	    int* info);
+
 #endif // JLT_LAPACK_H
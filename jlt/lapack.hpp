@@ -8,6 +8,12 @@
 #define JLT_LAPACK_HPP
 
 #include <complex>
+#include <cstddef>
+#include <algorithm>
+#include <climits>
+#include <vector>
+#include <utility>
+#include <type_traits>
 
 //
 // Fortran routines from LAPACK
@@ -183,6 +189,46 @@ namespace lapack {
     zgeev_(jobVL,jobVR,N,A,ldA,W,VL,ldVL,VR,ldVR,cwork,lwork,rwork,info);
   }
 
+  // Symmetric real matrix in packed storage
+  template<class T>
+  void spev(char* jobz,
+	    char* uplo,
+	    int* N,
+	    T* AP,
+	    T* W,
+	    T* Z,
+	    int* ldZ,
+	    T* work,
+	    int* info);
+
+  inline
+  void spev(char* jobz,
+	    char* uplo,
+	    int* N,
+	    float* AP,
+	    float* W,
+	    float* Z,
+	    int* ldZ,
+	    float* work,
+	    int* info)
+  {
+    sspev_(jobz,uplo,N,AP,W,Z,ldZ,work,info);
+  }
+
+  inline
+  void spev(char* jobz,
+	    char* uplo,
+	    int* N,
+	    double* AP,
+	    double* W,
+	    double* Z,
+	    int* ldZ,
+	    double* work,
+	    int* info)
+  {
+    dspev_(jobz,uplo,N,AP,W,Z,ldZ,work,info);
+  }
+
   //
   // Singular value decomposition routines
   //
@@ -299,6 +345,428 @@ namespace lapack {
     dgesdd_(jobz,M,N,A,ldA,S,U,ldU,VT,ldVT,work,lwork,iwork,info);
   }
 
+  //
+  // Linear equations routines
+  //
+
+  // LU factorization of an M by N matrix
+  template<class T>
+  void getrf(int* M,
+	     int* N,
+	     T* A,
+	     int* ldA,
+	     int* ipiv,
+	     int* info);
+
+  inline
+  void getrf(int* M,
+	     int* N,
+	     float* A,
+	     int* ldA,
+	     int* ipiv,
+	     int* info)
+  {
+    sgetrf_(M,N,A,ldA,ipiv,info);
+  }
+
+  inline
+  void getrf(int* M,
+	     int* N,
+	     double* A,
+	     int* ldA,
+	     int* ipiv,
+	     int* info)
+  {
+    dgetrf_(M,N,A,ldA,ipiv,info);
+  }
+
+  inline
+  void getrf(int* M,
+	     int* N,
+	     std::complex<float>* A,
+	     int* ldA,
+	     int* ipiv,
+	     int* info)
+  {
+    cgetrf_(M,N,A,ldA,ipiv,info);
+  }
+
+  inline
+  void getrf(int* M,
+	     int* N,
+	     std::complex<double>* A,
+	     int* ldA,
+	     int* ipiv,
+	     int* info)
+  {
+    zgetrf_(M,N,A,ldA,ipiv,info);
+  }
+
+  // Solve op(A) X = B from the factors computed by getrf, with op
+  // given by trans ('N', 'T' or 'C').  See lapack_trans() in
+  // transposed.hpp for the flag to use with row-major data.
+  template<class T>
+  void getrs(char* trans,
+	     int* N,
+	     int* nrhs,
+	     T* A,
+	     int* ldA,
+	     int* ipiv,
+	     T* B,
+	     int* ldB,
+	     int* info);
+
+  inline
+  void getrs(char* trans,
+	     int* N,
+	     int* nrhs,
+	     float* A,
+	     int* ldA,
+	     int* ipiv,
+	     float* B,
+	     int* ldB,
+	     int* info)
+  {
+    sgetrs_(trans,N,nrhs,A,ldA,ipiv,B,ldB,info);
+  }
+
+  inline
+  void getrs(char* trans,
+	     int* N,
+	     int* nrhs,
+	     double* A,
+	     int* ldA,
+	     int* ipiv,
+	     double* B,
+	     int* ldB,
+	     int* info)
+  {
+    dgetrs_(trans,N,nrhs,A,ldA,ipiv,B,ldB,info);
+  }
+
+  inline
+  void getrs(char* trans,
+	     int* N,
+	     int* nrhs,
+	     std::complex<float>* A,
+	     int* ldA,
+	     int* ipiv,
+	     std::complex<float>* B,
+	     int* ldB,
+	     int* info)
+  {
+    cgetrs_(trans,N,nrhs,A,ldA,ipiv,B,ldB,info);
+  }
+
+  inline
+  void getrs(char* trans,
+	     int* N,
+	     int* nrhs,
+	     std::complex<double>* A,
+	     int* ldA,
+	     int* ipiv,
+	     std::complex<double>* B,
+	     int* ldB,
+	     int* info)
+  {
+    zgetrs_(trans,N,nrhs,A,ldA,ipiv,B,ldB,info);
+  }
+
+  // Cholesky factorization of a symmetric (Hermitian) positive-definite
+  // matrix
+  template<class T>
+  void potrf(char* uplo,
+	     int* N,
+	     T* A,
+	     int* ldA,
+	     int* info);
+
+  inline
+  void potrf(char* uplo,
+	     int* N,
+	     float* A,
+	     int* ldA,
+	     int* info)
+  {
+    spotrf_(uplo,N,A,ldA,info);
+  }
+
+  inline
+  void potrf(char* uplo,
+	     int* N,
+	     double* A,
+	     int* ldA,
+	     int* info)
+  {
+    dpotrf_(uplo,N,A,ldA,info);
+  }
+
+  inline
+  void potrf(char* uplo,
+	     int* N,
+	     std::complex<float>* A,
+	     int* ldA,
+	     int* info)
+  {
+    cpotrf_(uplo,N,A,ldA,info);
+  }
+
+  inline
+  void potrf(char* uplo,
+	     int* N,
+	     std::complex<double>* A,
+	     int* ldA,
+	     int* info)
+  {
+    zpotrf_(uplo,N,A,ldA,info);
+  }
+
+  // Bunch-Kaufman factorization of a symmetric indefinite matrix
+  template<class T>
+  void sytrf(char* uplo,
+	     int* N,
+	     T* A,
+	     int* ldA,
+	     int* ipiv,
+	     T* work,
+	     int* lwork,
+	     int* info);
+
+  inline
+  void sytrf(char* uplo,
+	     int* N,
+	     float* A,
+	     int* ldA,
+	     int* ipiv,
+	     float* work,
+	     int* lwork,
+	     int* info)
+  {
+    ssytrf_(uplo,N,A,ldA,ipiv,work,lwork,info);
+  }
+
+  inline
+  void sytrf(char* uplo,
+	     int* N,
+	     double* A,
+	     int* ldA,
+	     int* ipiv,
+	     double* work,
+	     int* lwork,
+	     int* info)
+  {
+    dsytrf_(uplo,N,A,ldA,ipiv,work,lwork,info);
+  }
+
+  inline
+  void sytrf(char* uplo,
+	     int* N,
+	     std::complex<float>* A,
+	     int* ldA,
+	     int* ipiv,
+	     std::complex<float>* work,
+	     int* lwork,
+	     int* info)
+  {
+    csytrf_(uplo,N,A,ldA,ipiv,work,lwork,info);
+  }
+
+  inline
+  void sytrf(char* uplo,
+	     int* N,
+	     std::complex<double>* A,
+	     int* ldA,
+	     int* ipiv,
+	     std::complex<double>* work,
+	     int* lwork,
+	     int* info)
+  {
+    zsytrf_(uplo,N,A,ldA,ipiv,work,lwork,info);
+  }
+
+  // Symmetric positive-definite band matrix
+  template<class T>
+  void pbsv(char* uplo,
+	    int* N,
+	    int* kd,
+	    int* nrhs,
+	    T* AB,
+	    int* ldAB,
+	    T* B,
+	    int* ldB,
+	    int* info);
+
+  inline
+  void pbsv(char* uplo,
+	    int* N,
+	    int* kd,
+	    int* nrhs,
+	    float* AB,
+	    int* ldAB,
+	    float* B,
+	    int* ldB,
+	    int* info)
+  {
+    spbsv_(uplo,N,kd,nrhs,AB,ldAB,B,ldB,info);
+  }
+
+  inline
+  void pbsv(char* uplo,
+	    int* N,
+	    int* kd,
+	    int* nrhs,
+	    double* AB,
+	    int* ldAB,
+	    double* B,
+	    int* ldB,
+	    int* info)
+  {
+    dpbsv_(uplo,N,kd,nrhs,AB,ldAB,B,ldB,info);
+  }
+
+  // General band matrix
+  template<class T>
+  void gbsv(int* N,
+	    int* kl,
+	    int* ku,
+	    int* nrhs,
+	    T* AB,
+	    int* ldAB,
+	    int* ipiv,
+	    T* B,
+	    int* ldB,
+	    int* info);
+
+  inline
+  void gbsv(int* N,
+	    int* kl,
+	    int* ku,
+	    int* nrhs,
+	    float* AB,
+	    int* ldAB,
+	    int* ipiv,
+	    float* B,
+	    int* ldB,
+	    int* info)
+  {
+    sgbsv_(N,kl,ku,nrhs,AB,ldAB,ipiv,B,ldB,info);
+  }
+
+  inline
+  void gbsv(int* N,
+	    int* kl,
+	    int* ku,
+	    int* nrhs,
+	    double* AB,
+	    int* ldAB,
+	    int* ipiv,
+	    double* B,
+	    int* ldB,
+	    int* info)
+  {
+    dgbsv_(N,kl,ku,nrhs,AB,ldAB,ipiv,B,ldB,info);
+  }
+
+  //
+  // Strided matrices
+  //
+
+  // These are used by Choleskydecomp and LDLTdecomp (matrixutil.hpp)
+  // when JLT_USE_LAPACK is defined.  Both read and write the lower
+  // triangle of an n by n matrix whose element (i,j) is at
+  // A[i*rs + j*cs], in the layout of the library's own code.
+
+  // Element types that LAPACK handles.
+  template<class T> struct is_lapack_type : std::false_type {};
+  template<> struct is_lapack_type<float> : std::true_type {};
+  template<> struct is_lapack_type<double> : std::true_type {};
+  template<> struct is_lapack_type<std::complex<float>> : std::true_type {};
+  template<> struct is_lapack_type<std::complex<double>> : std::true_type {};
+
+  // Is the n by n matrix stored with contiguous columns (*row_major
+  // false) or rows (*row_major true), with leading dimension *ld?
+  inline bool square_layout(std::size_t n, std::ptrdiff_t rs,
+			    std::ptrdiff_t cs, bool* row_major, int* ld)
+  {
+    const std::ptrdiff_t nn = (n > 0 ? n : 1);
+
+    if (n > INT_MAX || rs > INT_MAX || cs > INT_MAX) return false;
+
+    if (n <= 1 || (rs == 1 && cs >= nn))
+      {
+	*row_major = false;
+	*ld = (n <= 1 ? 1 : cs);
+	return true;
+      }
+    if (cs == 1 && rs >= nn)
+      {
+	*row_major = true;
+	*ld = rs;
+	return true;
+      }
+    return false;
+  }
+
+  // A = L L^T (L L^H if complex), with L in the lower triangle of A.
+  // LAPACK sees a row-major matrix as its transpose, whose upper
+  // triangle U has A = trans(U) conj(U): trans(U) is then L, and
+  // already lies in the lower triangle.  Returns false if A has no
+  // LAPACK layout; info is that of potrf.
+  template<class T>
+  bool strided_potrf(std::size_t n, T* A, std::ptrdiff_t rs,
+		     std::ptrdiff_t cs, int* info)
+  {
+    bool row_major;
+    int ld;
+
+    if (!square_layout(n,rs,cs,&row_major,&ld)) return false;
+
+    char uplo = (row_major ? 'U' : 'L');
+    int N = n;
+    potrf(&uplo,&N,A,&ld,info);
+    return true;
+  }
+
+  // P A P^T = L D L^T by Bunch-Kaufman pivoting, in the format of sytrf
+  // with uplo = 'L', but with pivots counted from zero (a 2 by 2 block
+  // for rows p is marked by ipiv = -p-1, as LAPACK's -p from one).  A
+  // row-major matrix is first made symmetric by copying its lower
+  // triangle to the upper one, which LAPACK sees as the lower triangle
+  // of the transpose; the factors are then exchanged back, leaving the
+  // upper triangle as it was made.  Returns false if A has no LAPACK
+  // layout; info is that of sytrf.
+  template<class T>
+  bool strided_sytrf(std::size_t n, T* A, std::ptrdiff_t rs,
+		     std::ptrdiff_t cs, int* ipiv, int* info)
+  {
+    bool row_major;
+    int ld;
+
+    if (!square_layout(n,rs,cs,&row_major,&ld)) return false;
+
+    if (row_major)
+      for (std::size_t i = 0; i < n; ++i)
+	for (std::size_t j = 0; j < i; ++j) A[j*rs + i*cs] = A[i*rs + j*cs];
+
+    char uplo = 'L';
+    int N = n, lwork = -1;
+    T wsize;
+    sytrf(&uplo,&N,A,&ld,ipiv,&wsize,&lwork,info);
+    lwork = std::max(1,(int)std::real(wsize));
+    std::vector<T> work(lwork);
+    sytrf(&uplo,&N,A,&ld,ipiv,work.data(),&lwork,info);
+
+    if (row_major)
+      for (std::size_t i = 0; i < n; ++i)
+	for (std::size_t j = 0; j < i; ++j)
+	  std::swap(A[j*rs + i*cs],A[i*rs + j*cs]);
+
+    for (std::size_t k = 0; k < n; ++k)
+      if (ipiv[k] > 0) --ipiv[k];
+
+    return true;
+  }
+
 } // namespace lapack
 } // namespace jlt
 
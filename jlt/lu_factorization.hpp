@@ -0,0 +1,253 @@
+//
+// Copyright (c) 2004-2020 Jean-Luc Thiffeault <jeanluc@mailaps.org>
+//
+// See the file LICENSE for copying permission.
+//
+
+#ifndef JLT_LU_FACTORIZATION_HPP
+#define JLT_LU_FACTORIZATION_HPP
+
+//
+// lu_factorization.hpp
+//
+
+// The LU factors of a square matrix, with their pivots, kept for
+// repeated use:
+//
+//   jlt::lu_factorization<double> lu(J);
+//   for (...) { lu.solve_in_place(x); ... }
+//   lu.factor(J2);                 // New values, same storage.
+//
+// The factors are those of LUdecomp (matrixutil.hpp), with partial
+// pivoting.  Once factored, solve() and solve_transpose() take n^2
+// multiply-adds per right-hand side (with the blocked substitutions of
+// LUsolve for several at once), det() and logdet() n operations, and
+// inverse() the n^3 of LUinvert: none of them factors again.  factor()
+// copies a matrix of the same size into the storage already held, so
+// that refactoring a Jacobian in an implicit integrator allocates
+// nothing; passing an rvalue Matrix takes over its storage instead.
+//
+// Matrix is the type holding the factors, by default a row-major
+// mathmatrix<T>.  A matrix that is singular to working precision still
+// factors, with its zero pivots replaced by a tiny number, but a zero
+// row throws.
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+#include <jlt/mathvector.hpp>
+#include <jlt/mathmatrix.hpp>
+#include <jlt/matrixutil.hpp>
+#include <jlt/transposed.hpp>
+
+namespace jlt {
+
+template<class T, class Matrix = mathmatrix<T>>
+class lu_factorization
+{
+public:
+  using value_type = T;
+  using size_type = std::size_t;
+  using matrix_type = Matrix;
+  // The type of |det|.
+  using real_type = decltype(std::abs(T()));
+
+private:
+  Matrix LU;
+  std::vector<int> row_index;
+  int perm{1};
+
+  // Matrices and views have columns(); vectors do not.
+  template<class M, class = void>
+  struct has_columns : std::false_type {};
+  template<class M>
+  struct has_columns<M,std::void_t<decltype(std::declval<M&>().columns())>>
+    : std::true_type {};
+
+  template<class M>
+  using enable_if_matrix_t =
+    typename std::enable_if<has_columns<M>::value>::type;
+
+  void decompose()
+    {
+      row_index.resize(LU.rows());
+      if (LU.rows() > 0) LUdecomp<T>(LU, row_index.data(), &perm);
+    }
+
+public:
+  lu_factorization() {}
+
+  template<class M_A>
+  explicit lu_factorization(const M_A& A) { factor(A); }
+
+  explicit lu_factorization(Matrix&& A) { factor(std::move(A)); }
+
+  // Factor A, reusing the storage if A has the same size as before.
+  template<class M_A>
+  void factor(const M_A& A)
+    {
+      MATRIX_ASSERT(A.rows() == A.columns());
+
+      if constexpr (std::is_same<M_A,Matrix>::value)
+	{
+	  LU = A;
+	}
+      else
+	{
+	  const size_type n = A.rows();
+	  if (LU.rows() != n || LU.columns() != n)
+	    {
+	      Matrix tmp(n,n);
+	      LU.swap(tmp);
+	    }
+	  for (size_type i = 0; i < n; ++i)
+	    for (size_type j = 0; j < n; ++j) LU(i,j) = A(i,j);
+	}
+      decompose();
+    }
+
+  // Factor A in its own storage, which is taken over.
+  void factor(Matrix&& A)
+    {
+      MATRIX_ASSERT(A.rows() == A.columns());
+
+      LU.swap(A);
+      decompose();
+    }
+
+  [[nodiscard]] size_type dim() const { return LU.rows(); }
+
+  // L below the diagonal (with unit diagonal) and U on and above it.
+  [[nodiscard]] const Matrix& factors() const { return LU; }
+
+  // Row j was interchanged with row pivots()[j] at step j.
+  [[nodiscard]] const std::vector<int>& pivots() const { return row_index; }
+
+  // +1 or -1 for an even or odd number of interchanges.
+  [[nodiscard]] int permutation_sign() const { return perm; }
+
+  //
+  // Solves
+  //
+
+  // Overwrite b with the solution of A x = b.
+  template<class S_V, class A_V>
+  void solve_in_place(mathvector<T,S_V,A_V>& b) const
+    {
+      MATRIX_ASSERT(b.size() == dim());
+
+      LUbacksub<T>(LU, row_index.data(), b.data());
+    }
+
+  // Overwrite the n by r matrix or view B with the solution of A X = B.
+  template<class M_B, class = enable_if_matrix_t<M_B>>
+  void solve_in_place(M_B&& B) const
+    {
+      LUsolve<T>(LU, row_index.data(), B);
+    }
+
+  template<class S_V, class A_V>
+  [[nodiscard]] mathvector<T,S_V,A_V>
+  solve(const mathvector<T,S_V,A_V>& b) const
+    {
+      mathvector<T,S_V,A_V> x(b);
+      solve_in_place(x);
+      return x;
+    }
+
+  template<class S_B, class A_B, class O_B>
+  [[nodiscard]] mathmatrix<T,S_B,A_B,O_B>
+  solve(const mathmatrix<T,S_B,A_B,O_B>& B) const
+    {
+      mathmatrix<T,S_B,A_B,O_B> X(B);
+      solve_in_place(X);
+      return X;
+    }
+
+  // The same for trans(A) x = b, from the same factors.
+  template<class S_V, class A_V>
+  void solve_transpose_in_place(mathvector<T,S_V,A_V>& b) const
+    {
+      MATRIX_ASSERT(b.size() == dim());
+
+      LUbacksub<T>(trans(LU), row_index.data(), b.data());
+    }
+
+  template<class M_B, class = enable_if_matrix_t<M_B>>
+  void solve_transpose_in_place(M_B&& B) const
+    {
+      LUsolve<T>(trans(LU), row_index.data(), B);
+    }
+
+  template<class S_V, class A_V>
+  [[nodiscard]] mathvector<T,S_V,A_V>
+  solve_transpose(const mathvector<T,S_V,A_V>& b) const
+    {
+      mathvector<T,S_V,A_V> x(b);
+      solve_transpose_in_place(x);
+      return x;
+    }
+
+  template<class S_B, class A_B, class O_B>
+  [[nodiscard]] mathmatrix<T,S_B,A_B,O_B>
+  solve_transpose(const mathmatrix<T,S_B,A_B,O_B>& B) const
+    {
+      mathmatrix<T,S_B,A_B,O_B> X(B);
+      solve_transpose_in_place(X);
+      return X;
+    }
+
+  //
+  // Determinant and inverse
+  //
+
+  // The product of the pivots, which may overflow for large n.
+  [[nodiscard]] T det() const
+    {
+      T d = perm;
+      for (size_type i = 0; i < dim(); ++i) d *= LU(i,i);
+      return d;
+    }
+
+  // log|det(A)|, without overflow.  If sign is not null it is set to
+  // det(A)/|det(A)|: +1 or -1 for a real matrix, a phase for a complex
+  // one.
+  [[nodiscard]] real_type logdet(T* sign = nullptr) const
+    {
+      using std::abs;
+      using std::log;
+
+      real_type ld = 0;
+      T s = perm;
+      for (size_type i = 0; i < dim(); ++i)
+	{
+	  const real_type a = abs(LU(i,i));
+	  ld += log(a);
+	  s *= LU(i,i)/a;
+	}
+      if (sign) *sign = s;
+      return ld;
+    }
+
+  [[nodiscard]] Matrix inverse() const
+    {
+      Matrix Ainv(LU);
+      LUinvert<T>(Ainv, row_index.data());
+      return Ainv;
+    }
+
+  // Into Ainv, reusing its storage if it has the right size.
+  Matrix& inverse(Matrix& Ainv) const
+    {
+      Ainv = LU;
+      LUinvert<T>(Ainv, row_index.data());
+      return Ainv;
+    }
+};
+
+} // namespace jlt
+
+#endif // JLT_LU_FACTORIZATION_HPP
@@ -12,9 +12,17 @@
 //
 
 #include <cassert>
+#include <vector>
 #include <jlt/mathvector.hpp>
 #include <jlt/matrix.hpp>
 #include <jlt/matrixutil.hpp>
+#include <jlt/transposed.hpp>
+#include <jlt/bit_matrix.hpp>
+#include <jlt/graph.hpp>
+#include <jlt/expression.hpp>
+#include <jlt/gemm.hpp>
+#include <jlt/strassen.hpp>
+#include <jlt/thread_pool.hpp>
 #include <jlt/polynomial.hpp>
 
 namespace jlt {
@@ -23,104 +31,153 @@ namespace jlt {
 // Declare class and function templates
 //
 
-template<class T, class S> class mathmatrix;
+template<class T, class S, class Alloc, class Order> class mathmatrix;
 
-template<class T, class S>
-inline mathmatrix<T,S> operator+(const mathmatrix<T,S>& A);
+// The element-wise operators +, - and * and / by a scalar are
+// expression templates (see expression.hpp).
 
-template<class T, class S>
-inline mathmatrix<T,S> operator-(const mathmatrix<T,S>& B);
+template<class T, class S_T, class A_T, class O_T,
+	 class V, class S_V, class A_V>
+inline mathvector<V,S_V,A_V> operator*(const mathmatrix<T,S_T,A_T,O_T>& A,
+				       const mathvector<V,S_V,A_V>& v);
 
-template<class T, class S>
-inline mathmatrix<T,S> operator+(const mathmatrix<T,S>& A,
-				 const mathmatrix<T,S>& B);
-
-template<class T, class S>
-inline mathmatrix<T,S> operator-(const mathmatrix<T,S>& A,
-				 const mathmatrix<T,S>& B);
-
-template<class T, class S>
-inline mathmatrix<T,S> operator*(const S& a, const mathmatrix<T,S>& A);
-
-template<class T, class S_T, class V, class S_V>
-inline mathvector<V,S_V> operator*(const mathmatrix<T,S_T>& A,
-				   const mathvector<V,S_V>& v);
-
-template<class T, class S>
-inline mathmatrix<T,S> operator*(const mathmatrix<T,S>& A, const S& a);
-
-template<class T, class S>
-inline mathmatrix<T,S> operator/(const mathmatrix<T,S>& A, const S& a);
-
-template<class T, class S>
-inline mathmatrix<T,S> operator*(const mathmatrix<T,S>& A,
-				 const mathmatrix<T,S>& B);
+template<class T, class S, class Alloc, class Order>
+inline mathmatrix<T,S,Alloc,Order> operator*(const mathmatrix<T,S,Alloc,Order>& A,
+				 const mathmatrix<T,S,Alloc,Order>& B);
 
 //
 // class mathmatrix
 //
 
-template<class T, class S = T>
-class mathmatrix : public matrix<T>
+template<class T, class S = T, class Alloc = aligned_allocator<T>,
+	 class Order = row_major>
+class mathmatrix : public matrix<T,Alloc,Order>
 {
 public:
-  typedef typename matrix<T>::size_type		size_type;
-  using reference = typename matrix<T>::reference;
-  using const_reference = typename matrix<T>::const_reference;
-  using iterator = typename matrix<T>::iterator;
-  using const_iterator = typename matrix<T>::const_iterator;
+  typedef typename matrix<T,Alloc,Order>::size_type		size_type;
+  using reference = typename matrix<T,Alloc,Order>::reference;
+  using const_reference = typename matrix<T,Alloc,Order>::const_reference;
+  using iterator = typename matrix<T,Alloc,Order>::iterator;
+  using const_iterator = typename matrix<T,Alloc,Order>::const_iterator;
 
   using scalar_type = S;
   using const_scalar_type = const S;
   using scalar_reference = S &;
   using const_scalar_reference = const S &;
 
-  using matrix<T>::begin;
-  using matrix<T>::end;
-  using matrix<T>::rows;
-  using matrix<T>::columns;
+  using matrix<T,Alloc,Order>::begin;
+  using matrix<T,Alloc,Order>::end;
+  using matrix<T,Alloc,Order>::rows;
+  using matrix<T,Alloc,Order>::columns;
 
   //
   // Constructors
   //
 
 #if __cplusplus > 199711L
-  // Use C++11-style argument forwarding.
-  template<typename... Args>
-  mathmatrix(Args&&... _args) : matrix<T>(std::forward<Args>(_args)...) {}
+  // Use C++11-style argument forwarding.  Only arguments that matrix
+  // accepts, so that expressions use the constructor below.
+  template<typename... Args,
+	   class = typename std::enable_if<
+	     std::is_constructible<matrix<T,Alloc,Order>,Args&&...>::value>::type>
+  mathmatrix(Args&&... _args) : matrix<T,Alloc,Order>(std::forward<Args>(_args)...) {}
 
   // Forward initializer list as well.
   mathmatrix(size_type _m, size_type _n, std::initializer_list<T> _l)
-    : matrix<T>(_m,_n,_l) {}
+    : matrix<T,Alloc,Order>(_m,_n,_l) {}
 #else
-  mathmatrix() : matrix<T>() {}
+  mathmatrix() : matrix<T,Alloc,Order>() {}
 
   // Matrix of size _m*_n filled with _x.
   explicit mathmatrix(size_type _m, size_type _n, const_reference _x = T())
-    : matrix<T>(_m,_n,_x) {}
+    : matrix<T,Alloc,Order>(_m,_n,_x) {}
 
-  mathmatrix(const matrix<T>& _M) : matrix<T>(_M) {}	// Copy constructor.
+  mathmatrix(const matrix<T,Alloc,Order>& _M) : matrix<T,Alloc,Order>(_M) {}	// Copy constructor.
 #endif
 
+  // Evaluate an expression such as A + 2*B (see expression.hpp).
+  template<class E,
+	   class = typename std::enable_if<is_expr_node_t<E>::value &&
+	     std::is_same<expr_result_t<E>,mathmatrix>::value>::type>
+  mathmatrix(E&& e)
+    {
+      if (!expr_steal(*this,std::forward<E>(e)))
+	{
+	  mathmatrix res(e.shape().rows(),e.shape().columns(),default_init);
+	  expr_assign(res,e);
+	  this->swap(res);
+	}
+    }
+
   //
   // Elementary Matrix Operations
   //
 
-  // These are all inefficient.
-  // Only use when abstraction is more important than speed.
+  // The binary operators build expressions, which are evaluated in a
+  // single loop when assigned (see expression.hpp).
+
+  // The result may appear in the expression: A = A - h*B is fine.
+  template<class E,
+	   class = typename std::enable_if<is_expr_node_t<E>::value &&
+	     std::is_same<expr_result_t<E>,mathmatrix>::value>::type>
+  mathmatrix<T,S,Alloc,Order>& operator=(E&& e)
+    {
+      if (rows() == e.shape().rows() && columns() == e.shape().columns())
+	{
+	  expr_assign(*this,e);
+	}
+      else
+	{
+	  mathmatrix res(std::forward<E>(e));
+	  this->swap(res);
+	}
+
+      return *this;
+    }
+
+  template<class E,
+	   class = typename std::enable_if<is_expr_node_t<E>::value &&
+	     std::is_same<expr_result_t<E>,mathmatrix>::value>::type>
+  mathmatrix<T,S,Alloc,Order>& operator+=(const E& e)
+    {
+      MATRIX_ASSERT(rows() == e.shape().rows() &&
+		    columns() == e.shape().columns());
+
+      expr_plus_assign(*this,e);
+
+      return *this;
+    }
+
+  template<class E,
+	   class = typename std::enable_if<is_expr_node_t<E>::value &&
+	     std::is_same<expr_result_t<E>,mathmatrix>::value>::type>
+  mathmatrix<T,S,Alloc,Order>& operator-=(const E& e)
+    {
+      MATRIX_ASSERT(rows() == e.shape().rows() &&
+		    columns() == e.shape().columns());
+
+      expr_minus_assign(*this,e);
+
+      return *this;
+    }
 
-  mathmatrix<T,S>& operator+=(const mathmatrix<T,S>& A)
+  mathmatrix<T,S,Alloc,Order>& operator+=(const mathmatrix<T,S,Alloc,Order>& A)
     {
-      for (auto i = begin(), j = A.cbegin(); i != end(); ++i, ++j)
+#ifdef JLT_USE_BLAS
+      if constexpr (blas::is_blas_type<T>::value)
 	{
-	  *i += *j;
+	  if (blas::strided_axpy(this->size(),T(1),A.data(),1,this->data(),1))
+	    return *this;
 	}
+#endif
+
+      expr_plus_assign(*this,expr_ref<mathmatrix>(A));
 
       return *this;
     }
 
   // Adds a*Identity to matrix.
-  mathmatrix<T,S>& operator+=(const_scalar_reference a)
+  mathmatrix<T,S,Alloc,Order>& operator+=(const_scalar_reference a)
     {
       MATRIX_ASSERT(isSquare());
 
@@ -132,18 +189,23 @@ public:
       return *this;
     }
 
-  mathmatrix<T,S>& operator-=(const mathmatrix<T,S>& A)
+  mathmatrix<T,S,Alloc,Order>& operator-=(const mathmatrix<T,S,Alloc,Order>& A)
     {
-      for (auto i = begin(), j = A.cbegin(); i != end(); ++i, ++j)
+#ifdef JLT_USE_BLAS
+      if constexpr (blas::is_blas_type<T>::value)
 	{
-	  *i -= *j;
+	  if (blas::strided_axpy(this->size(),T(-1),A.data(),1,this->data(),1))
+	    return *this;
 	}
+#endif
+
+      expr_minus_assign(*this,expr_ref<mathmatrix>(A));
 
       return *this;
     }
 
   // Subtracts a*Identity from matrix.
-  mathmatrix<T,S>& operator-=(const_scalar_reference a)
+  mathmatrix<T,S,Alloc,Order>& operator-=(const_scalar_reference a)
     {
       MATRIX_ASSERT(isSquare());
 
@@ -156,7 +218,7 @@ public:
     }
 
   // Equate to a*identity
-  mathmatrix<T,S>& operator=(const_scalar_reference a)
+  mathmatrix<T,S,Alloc,Order>& operator=(const_scalar_reference a)
     {
       MATRIX_ASSERT(isSquare());
 
@@ -165,33 +227,77 @@ public:
       return *this;
     }
 
-  // Multiply matrix by a*Identity.
-  mathmatrix<T,S>& operator*=(const_scalar_reference a)
+  // Multiply matrix by a*Identity, i.e. every element by a.
+  mathmatrix<T,S,Alloc,Order>& operator*=(const_scalar_reference a)
     {
-      for (size_type i = 0; i < rows(); ++i)
+#ifdef JLT_USE_BLAS
+      if constexpr (blas::is_blas_type<T>::value &&
+		    std::is_convertible<S,T>::value)
 	{
-	  (*this)(i,i) *= a;
+	  if (blas::strided_scal(this->size(),T(a),this->data(),1))
+	    return *this;
+	}
+#endif
+
+      for (auto k = this->begin(); k != this->end(); ++k)
+	{
+	  *k *= a;
 	}
 
       return *this;
     }
 
-  // Divide matrix by a*Identity.
-  mathmatrix<T,S>& operator/=(const_scalar_reference a)
+  // Divide every element by a.
+  mathmatrix<T,S,Alloc,Order>& operator/=(const_scalar_reference a)
     {
-      for (size_type i = 0; i < rows(); ++i)
+      for (auto k = this->begin(); k != this->end(); ++k)
 	{
-	  (*this)(i,i) /= a;
+	  *k /= a;
 	}
 
       return *this;
     }
 
+  //
+  // Operations with views (see matrix_view.hpp)
+  //
+
+  // Copy the elements of a view, reusing the buffer if possible.
+  template<class U>
+  mathmatrix<T,S,Alloc,Order>& operator=(const matrix_view<U>& V)
+    {
+      matrix<T,Alloc,Order>::operator=(V);
+
+      return *this;
+    }
+
+  template<class U>
+  mathmatrix<T,S,Alloc,Order>& operator+=(const matrix_view<U>& A)
+    {
+      MATRIX_ASSERT(rows() == A.rows() && columns() == A.columns());
+
+      for (size_type i = 0; i < rows(); ++i)
+	for (size_type j = 0; j < columns(); ++j) (*this)(i,j) += A(i,j);
+
+      return *this;
+    }
+
+  template<class U>
+  mathmatrix<T,S,Alloc,Order>& operator-=(const matrix_view<U>& A)
+    {
+      MATRIX_ASSERT(rows() == A.rows() && columns() == A.columns());
+
+      for (size_type i = 0; i < rows(); ++i)
+	for (size_type j = 0; j < columns(); ++j) (*this)(i,j) -= A(i,j);
+
+      return *this;
+    }
+
   //
   // Comparison Operators
   //
 
-  bool operator==(const mathmatrix<T,S>& A) const
+  bool operator==(const mathmatrix<T,S,Alloc,Order>& A) const
     {
       for (auto i = this->cbegin(), j = A.cbegin();
 	   i != this->cend(); ++i, ++j)
@@ -201,7 +307,7 @@ public:
       return true;
     }
 
-  bool operator!=(const mathmatrix<T,S>& A) const
+  bool operator!=(const mathmatrix<T,S,Alloc,Order>& A) const
     {
       return !(operator==(A));
     }
@@ -220,28 +326,29 @@ public:
     }
 #endif
 
-  // Reducible matrix: a high-enough power still contains zeros.
-  /* Warning: this tests for primitivity, no reducibility.  See issue #1. */
-  [[nodiscard]] bool isReducible() const
+  // Irreducible matrix: the graph of its nonzero pattern is strongly
+  // connected.  O(n^2) to scan the matrix, then O(n + nnz).
+  [[nodiscard]] bool isIrreducible() const
     {
-#if 0
-  size_type ma = A.rows();
-  size_type na = A.columns();
-  size_type nb = B.columns();
-
-  MATRIX_ASSERT(na == B.rows());
+      MATRIX_ASSERT(isSquare());
 
-  mathmatrix<T,S> res(ma,nb);
+      return nonzero_graph(*this).strongly_connected();
+    }
 
-  for (size_type i = 0; i < ma; ++i)
+  // Primitive matrix: irreducible with period 1, so that a power of
+  // the matrix has no zeros (see graph.hpp).
+  [[nodiscard]] bool isPrimitive() const
     {
-      for (size_type j = 0; j < nb; ++j)
-	{
-	  for (size_type k = 0; k < na; ++k) res(i,j) += A(i,k)*B(k,j);
-	}
+      MATRIX_ASSERT(isSquare());
+
+      return nonzero_graph(*this).primitive();
     }
-#endif
 
+  // Reducible matrix: a high-enough power still contains zeros.
+  /* Warning: this tests for primitivity, no reducibility.  See issue #1.
+     Use isIrreducible() or isPrimitive() instead, which are faster. */
+  [[nodiscard]] bool isReducible() const
+    {
       MATRIX_ASSERT(isSquare());
       size_type n = rows();
 
@@ -251,41 +358,31 @@ public:
       // Take log2 since we nest the multiplications.
       auto pmax = (size_type)ceil(log2(n*n - 2*n + 2));
 
-      // Take powers of matrix.  Do this in place since we need to
-      // renormalise to avoid blow-up.
-      mathmatrix<T,S> Mp(n,n), M(*this);
+      // Take powers of the nonzero pattern, with Boolean products of
+      // bit-packed matrices (see bit_matrix.hpp).
+      bit_matrix M(*this), Mp;
       for (size_type p = 1; p < pmax; ++p)
 	{
-	  for (size_type i = 0; i < n; ++i)
-	    {
-	      // Mp = M*M.
-	      for (size_type j = 0; j < n; ++j)
-		{
-		  Mp(i,j) = M(i,0)*M(0,j);
-		  for (size_type k = 1; k < n; ++k)
-		    {
-		      Mp(i,j) += M(i,k)*M(k,j);
-		    }
-		  // Renormalise: all that matters is whether an element
-		  // is zero or not.
-		  if (Mp(i,j) != T()) Mp(i,j) = 1;
-		}
-	    }
-	  // Copy the result back to M.
-	  M = Mp;
+	  boolean_product(Mp,M,M);
+	  // A full pattern stays full, and a fixed point stays put.
+	  if (Mp.all()) return false;
+	  if (Mp == M) break;
+	  M.swap(Mp);
 	}
 
       // Now look for zeros.
-      for (auto i = M.cbegin(); i != M.cend(); ++i)
-	{
-	  if (*i == T()) return true;
-	}
+      return !M.all();
+    }
 
-      return false;
+  // The nonzero pattern, one bit per element.
+  [[nodiscard]] bit_matrix nonzero_pattern() const
+    {
+      return bit_matrix(*this);
     }
 
-  // Replace nonzero entries by 1.
-  mathmatrix<T,S>& ones_and_zeros()
+  // Replace nonzero entries by 1.  For a Boolean matrix in 1/64th of
+  // the memory, use nonzero_pattern() instead.
+  mathmatrix<T,S,Alloc,Order>& ones_and_zeros()
   {
     for (auto i = begin(); i != end(); ++i)
       {
@@ -298,28 +395,9 @@ public:
   // Friends
   //
 
-  friend mathmatrix<T,S> operator+<>(const mathmatrix<T,S>& A);
-
-  friend mathmatrix<T,S> operator-<>(const mathmatrix<T,S>& B);
-
-  friend mathmatrix<T,S> operator+<>(const mathmatrix<T,S>& A,
-				     const mathmatrix<T,S>& B);
-
-  friend mathmatrix<T,S> operator-<>(const mathmatrix<T,S>& A,
-				     const mathmatrix<T,S>& B);
-
-  friend mathmatrix<T,S> operator*<>(const_scalar_reference a,
-				     const mathmatrix<T,S>& A);
-
-  friend mathmatrix<T,S> operator*<>(const mathmatrix<T,S>& A,
-				     const_scalar_reference a);
-
-  friend mathmatrix<T,S> operator/<>(const mathmatrix<T,S>& A,
-				     const_scalar_reference a);
-
   // Component-wise division.
-  // friend const mathmatrix<T,S>& operator/(const mathmatrix<T,S>&, const
-  // mathmatrix<T,S>&);
+  // friend const mathmatrix<T,S,Alloc,Order>& operator/(const mathmatrix<T,S,Alloc,Order>&, const
+  // mathmatrix<T,S,Alloc,Order>&);
 
   //
   // Matrix Inverse
@@ -328,120 +406,52 @@ public:
   // The functions named invert() destroy the object,
   // the functions named inverse() leave it untouched.
 
-  // Replace matrix *this by its inverse.
+  // Replace matrix *this by its inverse, in place.
   void invert()
     {
       MATRIX_ASSERT(isSquare());
-      unsigned int n = rows();
 
       int perm;
-      int* row_index = new int[n];
-
-      LUdecomp<T,mathmatrix<T,S>>(*this, row_index, &perm);
-
-      T* col = new T[n];
-      mathmatrix<T,S> Ainv(n,n);
-
-      for (unsigned int j = 0; j < n; ++j)
-	{
-	  for (unsigned int i = 0; i < n; ++i) col[i] = 0.;
-	  col[j] = 1.;
-	  LUbacksub<T,mathmatrix<T,S>>(*this, row_index, col);
-	  for (unsigned int i = 0; i < n; ++i) Ainv(i,j) = col[i];
-	}
+      std::vector<int> row_index(rows());
 
-      // Copy Ainv to A, without reallocating.
-      auto j = begin();
-      auto i = Ainv.cbegin();
-      while (j != end()) *j++ = *i++;
+      LUdecomp<T,mathmatrix<T,S,Alloc,Order>>(*this, row_index.data(), &perm);
 
-      delete[] col;
-      delete[] row_index;
+      LUinvert<T,mathmatrix<T,S,Alloc,Order>>(*this, row_index.data());
     }
 
   // Replaces matrix Ainv by inverse, detroying *this.
   // Ainv has to be the same size as *this.
-  // This should be the fastest method, with the least temporaries.
-  void invert(mathmatrix<T,S>& Ainv)
+  // This should be the fastest method, with the least temporaries: the
+  // inverse is formed in place and the buffers exchanged.
+  void invert(mathmatrix<T,S,Alloc,Order>& Ainv)
     {
       MATRIX_ASSERT(m == Ainv.m && m == Ainv.n && isSquare());
-      unsigned int n = rows();
-
-      int perm;
-      int* row_index = new int[n];
-
-      LUdecomp<T,mathmatrix<T,S>>(*this, row_index, &perm);
-
-      T* col = new T[n];
 
-      for (unsigned int j = 0; j < n; ++j)
-	{
-	  for (unsigned int i = 0; i < n; ++i) col[i] = 0.;
-	  col[j] = 1.;
-	  LUbacksub<T,mathmatrix<T,S>>(*this, row_index, col);
-	  for (unsigned int i = 0; i < n; ++i) Ainv(i,j) = col[i];
-	}
-
-      delete[] col;
-      delete[] row_index;
+      invert();
+      this->swap(Ainv);
     }
 
   // Does not alter matrix.
-  [[nodiscard]] mathmatrix<T,S> inverse() const
+  [[nodiscard]] mathmatrix<T,S,Alloc,Order> inverse() const
     {
       MATRIX_ASSERT(isSquare());
-      unsigned int n = rows();
-
-      int perm;
-      int* row_index = new int[n];
 
-      mathmatrix<T,S> A_LU(*this);
+      mathmatrix<T,S,Alloc,Order> Ainv(*this);
 
-      LUdecomp<T,mathmatrix<T,S>>(A_LU, row_index, &perm);
-
-      T* col = new T[n];
-      mathmatrix<T,S> Ainv(n,n);
-
-      for (unsigned int j = 0; j < n; ++j)
-	{
-	  for (unsigned int i = 0; i < n; ++i) col[i] = 0.;
-	  col[j] = 1.;
-	  LUbacksub<T,mathmatrix<T,S>>(A_LU, row_index, col);
-	  for (unsigned int i = 0; i < n; ++i) Ainv(i,j) = col[i];
-	}
-
-      delete[] col;
-      delete[] row_index;
+      Ainv.invert();
 
       return Ainv;
     }
 
   // Replaces matrix Ainv by inverse, without altering *this.
   // Ainv has to be the same size as *this.
-  mathmatrix<T,S> inverse(mathmatrix<T,S>& Ainv) const
+  // Returns a reference to Ainv rather than a copy of it.
+  mathmatrix<T,S,Alloc,Order>& inverse(mathmatrix<T,S,Alloc,Order>& Ainv) const
     {
       MATRIX_ASSERT(m == Ainv.m && m == Ainv.n && isSquare());
-      unsigned int n = rows();
 
-      int perm;
-      int* row_index = new int[n];
-
-      mathmatrix<T,S> A_LU(*this);
-
-      LUdecomp<T,mathmatrix<T,S>>(A_LU, row_index, &perm);
-
-      T* col = new T[n];
-
-      for (unsigned int j = 0; j < n; ++j)
-	{
-	  for (unsigned int i = 0; i < n; ++i) col[i] = 0.;
-	  col[j] = 1.;
-	  LUbacksub<T,mathmatrix<T,S>>(A_LU, row_index, col);
-	  for (unsigned int i = 0; i < n; ++i) Ainv(i,j) = col[i];
-	}
-
-      delete[] col;
-      delete[] row_index;
+      Ainv = *this;
+      Ainv.invert();
 
       return Ainv;
     }
@@ -456,16 +466,16 @@ public:
 
       T det = 1;
       int perm;
-      int* row_index = new int[columns()];
+      std::vector<int> row_index(columns());
 
       // The price to pay to leave the object intact is creating a temporary.
-      mathmatrix<T,S> A_LU(*this);
+      mathmatrix<T,S,Alloc,Order> A_LU(*this);
 
-      LUdecomp<T,mathmatrix<T,S>>(A_LU, row_index, &perm);
+      LUdecomp<T,mathmatrix<T,S,Alloc,Order>>(A_LU, row_index.data(), &perm);
 
       for (size_type i = 0; i < columns(); ++i) det *= A_LU(i,i);
 
-      return (perm*det);
+      return (T(perm)*det);
     }
 
   [[nodiscard]] T trace() const
@@ -487,7 +497,7 @@ public:
       MATRIX_ASSERT(isSquare());
       size_type n = rows();
       T t0;
-      mathmatrix<T,S> B(n,n), C(n,n);
+      mathmatrix<T,S,Alloc,Order> B(n,n), C(n,n);
       polynomial<T> p;
 
       p[0] = (n % 2 == 0 ? 1 : -1);
@@ -534,13 +544,28 @@ public:
   //
   // Transpose
   //
-  const mathmatrix<T,S>& transpose()
+  const mathmatrix<T,S,Alloc,Order>& transpose(unsigned nthreads = 0)
+    {
+      matrix<T,Alloc,Order>::transpose(nthreads);
+
+      return *this;
+    }
+
+  const mathmatrix<T,S,Alloc,Order>& transpose_in_place()
     {
-      matrix<T>::transpose();
+      matrix<T,Alloc,Order>::transpose_in_place();
 
       return *this;
     }
 
+  mathmatrix<T,S,Alloc,Order>& transpose(mathmatrix<T,S,Alloc,Order>& At,
+					 unsigned nthreads = 0) const
+    {
+      matrix<T,Alloc,Order>::transpose(At,nthreads);
+
+      return At;
+    }
+
   //
   // Some common matrices
   //
@@ -561,165 +586,462 @@ public:
 }; // class mathmatrix
 
 
+// mathmatrix takes part in expressions.
+template<class T, class S, class Alloc, class Order>
+struct expr_container_traits<mathmatrix<T,S,Alloc,Order>>
+{
+  static constexpr bool is_container = true;
+  static constexpr bool is_vector = false;
+};
+
+
 //
 // Function definitions
 //
 
-template<class T, class S>
-inline mathmatrix<T,S> operator+(const mathmatrix<T,S>& A)
+template<class T, class S_T, class A_T, class O_T,
+	 class V, class S_V, class A_V>
+inline mathvector<V,S_V,A_V> operator*(const mathmatrix<T,S_T,A_T,O_T>& A,
+				       const mathvector<V,S_V,A_V>& v)
 {
-  return A;
-}
+  MATRIX_ASSERT(A.columns() == v.size());
 
-template<class T, class S>
-inline mathmatrix<T,S> operator-(const mathmatrix<T,S>& A)
-{
-  mathmatrix<T,S> res(A.rows(),A.columns());
+  mathvector<V,S_V,A_V> res(A.rows());
 
-  {
-    auto k = res.begin();
-    for (auto i = A.cbegin(); i != A.cend(); ++i, ++k)
-      {
-	*k = -(*i);
-      }
-  }
+#ifdef JLT_USE_BLAS
+  if constexpr (std::is_same<T,V>::value && blas::is_blas_type<T>::value)
+    {
+      gemv_product(res,A,v);
+      return res;
+    }
+#endif
+
+  // Multiplication of a type T and type V must be defined.
+  matrix_vector_product(res,A,v);
 
   return res;
 }
 
-template<class T, class S>
-inline mathmatrix<T,S> operator+(const mathmatrix<T,S>& A,
-				 const mathmatrix<T,S>& B)
+template<class T, class S, class Alloc, class Order>
+inline mathmatrix<T,S,Alloc,Order> operator*(const mathmatrix<T,S,Alloc,Order>& A,
+				 const mathmatrix<T,S,Alloc,Order>& B)
 {
-  mathmatrix<T,S> res(A.rows(),A.columns());
-
-  {
-    auto k = res.begin();
-    for (auto i = A.cbegin(), j = B.cbegin();
-	 i != A.cend(); ++i, ++j, ++k)
-      {
-	*k = *i + *j;
-      }
-  }
+  MATRIX_ASSERT(A.columns() == B.rows());
 
+  mathmatrix<T,S,Alloc,Order> res(A.rows(),B.columns(),default_init);
+#ifdef JLT_USE_STRASSEN
+  // Opt-in Strassen-Winograd for large products (see strassen.hpp).
+  if (std::min(A.rows(),std::min(A.columns(),B.columns())) >=
+      JLT_STRASSEN_CROSSOVER)
+    {
+      strassen_product(res,A,B);
+      return res;
+    }
+#endif
+  gemm_product(res,A,B);
   return res;
 }
 
-template<class T, class S>
-inline mathmatrix<T,S> operator-(const mathmatrix<T,S>& A,
-				 const mathmatrix<T,S>& B)
-{
-  mathmatrix<T,S> res(A.rows(),A.columns());
-
-  {
-    auto k = res.begin();
-    for (auto i = A.cbegin(), j = B.cbegin();
-	 i != A.cend(); ++i, ++j, ++k)
-      {
-	*k = *i - *j;
-      }
-  }
+//
+// Products and sums of views
+//
 
-  return res;
-}
+// These generic kernels work on anything with operator()(i,j), rows()
+// and columns(): mathmatrix, matrix_view, or a mix.  The result C must
+// already have the right size, and may itself be a view (for instance
+// a block of a larger matrix), but must not overlap A or B.
 
-template<class T, class S>
-inline mathmatrix<T,S> operator*(const S& a, const mathmatrix<T,S>& A)
+// C = A*B
+template<class M_C, class M_A, class M_B>
+inline void matrix_product(M_C&& C, const M_A& A, const M_B& B)
 {
-  mathmatrix<T,S> res(A.rows(),A.columns());
+  auto ma = A.rows();
+  auto na = A.columns();
+  auto nb = B.columns();
 
-  {
-    auto k = res.begin();
-    for (auto i = A.cbegin(); i != A.cend(); ++i, ++k)
-      {
-	*k = a * (*i);
-      }
-  }
+  MATRIX_ASSERT(na == B.rows() && C.rows() == ma && C.columns() == nb);
 
-  return res;
+  // i-k-j order, so that the inner loop runs along rows of B and C.
+  for (decltype(ma) i = 0; i < ma; ++i)
+    {
+      for (decltype(nb) j = 0; j < nb; ++j) C(i,j) = 0;
+      for (decltype(na) k = 0; k < na; ++k)
+	{
+	  auto aik = A(i,k);
+	  for (decltype(nb) j = 0; j < nb; ++j) C(i,j) += aik*B(k,j);
+	}
+    }
 }
 
-template<class T, class S_T, class V, class S_V>
-inline mathvector<V,S_V> operator*(const mathmatrix<T,S_T>& A,
-				   const mathvector<V,S_V>& v)
+// y = A*x
+template<class V_Y, class M_A, class V_X>
+inline void matrix_vector_product(V_Y&& y, const M_A& A, const V_X& x)
 {
   auto m = A.rows();
   auto n = A.columns();
 
-  MATRIX_ASSERT(n == v.size());
+  MATRIX_ASSERT(n == x.size() && y.size() == m);
+
+  // The sums start from their first term, which also works for
+  // elements that are themselves vectors or matrices.
+  if (n == 0)
+    {
+      for (decltype(m) i = 0; i < m; ++i) y[i] = std::decay_t<decltype(y[i])>();
+      return;
+    }
+
+  // One dot product per row of A, about n multiply-adds each.
+  parallel_for(0,m,JLT_PARALLEL_GRAIN/(n+1) + 1,
+	       [&](std::size_t i0, std::size_t i1)
+	       {
+		 for (auto i = i0; i < i1; ++i)
+		   {
+		     auto sum = A(i,0)*x[0];
+		     for (decltype(n) k = 1; k < n; ++k) sum += A(i,k)*x[k];
+		     y[i] = sum;
+		   }
+	       });
+}
 
-  mathvector<V,S_V> res(m);
+// C = A*B with the packed, cache-blocked gemm() of gemm.hpp when the
+// element type is float, double or complex and A and B are matrices,
+// views or trans() of them, and with matrix_product() otherwise.
+template<class M_C, class M_A, class M_B>
+inline void gemm_product(M_C&& C, const M_A& A, const M_B& B)
+{
+  using T = typename std::decay<M_C>::type::value_type;
 
-  for (auto i = 0u; i < m; ++i)
+  if constexpr (is_gemm_operand<M_A>::value && is_gemm_operand<M_B>::value &&
+		std::is_same<typename M_A::value_type,T>::value &&
+		std::is_same<typename M_B::value_type,T>::value)
+    {
+      gemm(T(1),A,B,T(0),C);
+    }
+  else
     {
-      // Multiplication of a type T and type V must be defined.
-      res[i] = A(i,0)*v[0];
-      for (auto k = 1u; k < n; ++k)
-	res[i] += A(i,k)*v[k];
+      matrix_product(C,A,B);
     }
+}
 
-  return res;
+#ifdef JLT_USE_BLAS
+template<class T, class Alloc>
+inline std::ptrdiff_t vector_stride(const std::vector<T,Alloc>&) { return 1; }
+
+template<class U>
+inline std::ptrdiff_t vector_stride(const vector_view<U>& x)
+{
+  return x.stride();
 }
+#endif
 
-template<class T, class S>
-inline mathmatrix<T,S> operator*(const mathmatrix<T,S>& A, const S& a)
+// y = A*x, with the BLAS xGEMV if JLT_USE_BLAS is defined and A is a
+// matrix, view or trans() of one with unit stride along its rows or
+// columns, and with matrix_vector_product() otherwise.
+template<class V_Y, class M_A, class V_X>
+inline void gemv_product(V_Y&& y, const M_A& A, const V_X& x)
 {
-  mathmatrix<T,S> res(A.rows(),A.columns());
+#ifdef JLT_USE_BLAS
+  using T = typename std::decay<V_Y>::type::value_type;
 
-  {
-    auto k = res.begin();
-    for (auto i = A.cbegin(); i != A.cend(); ++i, ++k)
-      {
-	*k = a * (*i);
-      }
-  }
+  if constexpr (blas::is_blas_type<T>::value && is_gemm_operand<M_A>::value &&
+		std::is_same<typename M_A::value_type,T>::value &&
+		std::is_same<typename V_X::value_type,T>::value)
+    {
+      auto a = gemm_operand(A);
 
-  return res;
+      MATRIX_ASSERT(a.columns() == x.size() && y.size() == a.rows());
+
+      if (blas::strided_gemv(a.rows(),a.columns(),T(1),
+			     a.data(),a.row_stride(),a.column_stride(),
+			     x.data(),vector_stride(x),
+			     T(0),y.data(),vector_stride(y)))
+	return;
+    }
+#endif
+
+  matrix_vector_product(y,A,x);
 }
 
-template<class T, class S>
-inline mathmatrix<T,S> operator/(const mathmatrix<T,S>& A, const S& a)
+//
+// Products with trans(A) and adj(A)
+//
+
+// trans(A)*B needs no special kernel: the i-k-j loop of
+// matrix_product() reads trans(A)(i,k) = A(k,i) once per row of B, and
+// the inner loop still runs along rows of B and C.  The other cases
+// would walk down columns in their inner loop, so they get their own
+// loop order.
+
+// C = A*trans(B): each element is the dot product of a row of A with a
+// row of B, both contiguous for row-major data.
+template<class M_C, class M_A, class M_B, bool Conj>
+inline void matrix_product(M_C&& C, const M_A& A, const transposed<M_B,Conj>& B)
 {
-  mathmatrix<T,S> res(A.rows(),A.columns());
+  auto ma = A.rows();
+  auto na = A.columns();
+  auto nb = B.columns();
 
-  {
-    auto k = res.begin();
-    for (auto i = A.cbegin(); i != A.cend(); ++i, ++k)
-      {
-	*k = (*i) / a;
-      }
-  }
+  MATRIX_ASSERT(na == B.rows() && C.rows() == ma && C.columns() == nb);
 
-  return res;
+  // As in matrix_vector_product, the sums start from their first term.
+  if (na == 0)
+    {
+      for (decltype(ma) i = 0; i < ma; ++i)
+	for (decltype(nb) j = 0; j < nb; ++j)
+	  C(i,j) = std::decay_t<decltype(C(i,j))>();
+      return;
+    }
+
+  for (decltype(ma) i = 0; i < ma; ++i)
+    {
+      for (decltype(nb) j = 0; j < nb; ++j)
+	{
+	  auto sum = A(i,0)*B(0,j);
+	  for (decltype(na) k = 1; k < na; ++k) sum += A(i,k)*B(k,j);
+	  C(i,j) = sum;
+	}
+    }
 }
 
-template<class T, class S>
-inline mathmatrix<T,S> operator*(const mathmatrix<T,S>& A,
-				 const mathmatrix<T,S>& B)
+// C = trans(A)*trans(B) = trans(B*A): j-k-i order, so that the inner
+// loop runs along rows of A.
+template<class M_C, class M_A, bool Conj_A, class M_B, bool Conj_B>
+inline void matrix_product(M_C&& C, const transposed<M_A,Conj_A>& A,
+			   const transposed<M_B,Conj_B>& B)
 {
   auto ma = A.rows();
   auto na = A.columns();
   auto nb = B.columns();
 
-  MATRIX_ASSERT(na == B.rows());
+  MATRIX_ASSERT(na == B.rows() && C.rows() == ma && C.columns() == nb);
 
-  mathmatrix<T,S> res(ma,nb);
+  if (na == 0)
+    {
+      for (decltype(ma) i = 0; i < ma; ++i)
+	for (decltype(nb) j = 0; j < nb; ++j)
+	  C(i,j) = std::decay_t<decltype(C(i,j))>();
+      return;
+    }
 
-  for (auto i = 0u; i < ma; ++i)
+  for (decltype(nb) j = 0; j < nb; ++j)
     {
-      for (auto j = 0u; j < nb; ++j)
+      auto b0j = B(0,j);
+      for (decltype(ma) i = 0; i < ma; ++i) C(i,j) = A(i,0)*b0j;
+      for (decltype(na) k = 1; k < na; ++k)
 	{
-	  for (auto k = 0u; k < na; ++k) res(i,j) += A(i,k)*B(k,j);
+	  auto bkj = B(k,j);
+	  for (decltype(ma) i = 0; i < ma; ++i) C(i,j) += A(i,k)*bkj;
 	}
     }
+}
+
+// y = trans(A)*x, as a sum of rows of A weighted by x.
+template<class V_Y, class M_A, bool Conj, class V_X>
+inline void matrix_vector_product(V_Y&& y, const transposed<M_A,Conj>& A,
+				  const V_X& x)
+{
+  auto m = A.rows();
+  auto n = A.columns();
+
+  MATRIX_ASSERT(n == x.size() && y.size() == m);
+
+  if (n == 0)
+    {
+      for (decltype(m) i = 0; i < m; ++i) y[i] = std::decay_t<decltype(y[i])>();
+      return;
+    }
+
+  // Column-by-column axpy, over a range of y per thread.
+  parallel_for(0,m,JLT_PARALLEL_GRAIN/(n+1) + 1,
+	       [&](std::size_t i0, std::size_t i1)
+	       {
+		 auto x0 = x[0];
+		 for (auto i = i0; i < i1; ++i) y[i] = A(i,0)*x0;
+		 for (decltype(n) k = 1; k < n; ++k)
+		   {
+		     auto xk = x[k];
+		     for (auto i = i0; i < i1; ++i) y[i] += A(i,k)*xk;
+		   }
+	       });
+}
+
+template<class M_A, bool Conj, class T, class S, class Alloc, class Order>
+inline mathmatrix<T,S,Alloc,Order>
+operator*(const transposed<M_A,Conj>& A, const mathmatrix<T,S,Alloc,Order>& B)
+{
+  mathmatrix<T,S,Alloc,Order> res(A.rows(),B.columns(),default_init);
+  gemm_product(res,A,B);
+  return res;
+}
+
+template<class T, class S, class Alloc, class Order, class M_B, bool Conj>
+inline mathmatrix<T,S,Alloc,Order>
+operator*(const mathmatrix<T,S,Alloc,Order>& A, const transposed<M_B,Conj>& B)
+{
+  mathmatrix<T,S,Alloc,Order> res(A.rows(),B.columns(),default_init);
+  gemm_product(res,A,B);
+  return res;
+}
+
+template<class M_A, bool Conj, class U>
+inline mathmatrix<typename matrix_view<U>::value_type>
+operator*(const transposed<M_A,Conj>& A, const matrix_view<U>& B)
+{
+  mathmatrix<typename matrix_view<U>::value_type>
+    res(A.rows(),B.columns(),default_init);
+  gemm_product(res,A,B);
+  return res;
+}
+
+template<class U, class M_B, bool Conj>
+inline mathmatrix<typename matrix_view<U>::value_type>
+operator*(const matrix_view<U>& A, const transposed<M_B,Conj>& B)
+{
+  mathmatrix<typename matrix_view<U>::value_type>
+    res(A.rows(),B.columns(),default_init);
+  gemm_product(res,A,B);
+  return res;
+}
+
+template<class M_A, bool Conj_A, class M_B, bool Conj_B>
+inline mathmatrix<typename M_A::value_type>
+operator*(const transposed<M_A,Conj_A>& A, const transposed<M_B,Conj_B>& B)
+{
+  mathmatrix<typename M_A::value_type> res(A.rows(),B.columns(),default_init);
+  gemm_product(res,A,B);
+  return res;
+}
+
+template<class M_A, bool Conj, class U, class S_V, class A_V>
+inline mathvector<U,S_V,A_V>
+operator*(const transposed<M_A,Conj>& A, const mathvector<U,S_V,A_V>& x)
+{
+  mathvector<U,S_V,A_V> res(A.rows());
+  gemv_product(res,A,x);
+  return res;
+}
+
+template<class M_A, bool Conj, class U>
+inline mathvector<typename M_A::value_type>
+operator*(const transposed<M_A,Conj>& A, const vector_view<U>& x)
+{
+  mathvector<typename M_A::value_type> res(A.rows());
+  gemv_product(res,A,x);
+  return res;
+}
+
+template<class T, class U>
+inline mathmatrix<typename matrix_view<T>::value_type>
+operator*(const matrix_view<T>& A, const matrix_view<U>& B)
+{
+  mathmatrix<typename matrix_view<T>::value_type>
+    res(A.rows(),B.columns(),default_init);
+  gemm_product(res,A,B);
+  return res;
+}
+
+template<class T, class S, class Alloc, class Order, class U>
+inline mathmatrix<T,S,Alloc,Order>
+operator*(const mathmatrix<T,S,Alloc,Order>& A, const matrix_view<U>& B)
+{
+  mathmatrix<T,S,Alloc,Order> res(A.rows(),B.columns(),default_init);
+  gemm_product(res,A,B);
+  return res;
+}
+
+template<class T, class S, class Alloc, class Order, class U>
+inline mathmatrix<T,S,Alloc,Order>
+operator*(const matrix_view<U>& A, const mathmatrix<T,S,Alloc,Order>& B)
+{
+  mathmatrix<T,S,Alloc,Order> res(A.rows(),B.columns(),default_init);
+  gemm_product(res,A,B);
+  return res;
+}
+
+template<class T, class U>
+inline mathvector<typename matrix_view<T>::value_type>
+operator*(const matrix_view<T>& A, const vector_view<U>& x)
+{
+  mathvector<typename matrix_view<T>::value_type> res(A.rows());
+  gemv_product(res,A,x);
+  return res;
+}
 
+template<class T, class U, class S_V, class A_V>
+inline mathvector<U,S_V,A_V>
+operator*(const matrix_view<T>& A, const mathvector<U,S_V,A_V>& x)
+{
+  mathvector<U,S_V,A_V> res(A.rows());
+  gemv_product(res,A,x);
   return res;
 }
 
-template<class T, class S>
-inline mathmatrix<T,S> identity_matrix(typename mathmatrix<T,S>::size_type n)
+template<class T, class S, class Alloc, class Order, class U>
+inline mathvector<T>
+operator*(const mathmatrix<T,S,Alloc,Order>& A, const vector_view<U>& x)
 {
-  mathmatrix<T,S> id(n,n);
+  mathvector<T> res(A.rows());
+  gemv_product(res,A,x);
+  return res;
+}
+
+template<class T, class U>
+inline mathmatrix<typename matrix_view<T>::value_type>
+operator+(const matrix_view<T>& A, const matrix_view<U>& B)
+{
+  mathmatrix<typename matrix_view<T>::value_type> res(A);
+  res += B;
+  return res;
+}
+
+template<class T, class S, class Alloc, class Order, class U>
+inline mathmatrix<T,S,Alloc,Order>
+operator+(mathmatrix<T,S,Alloc,Order> A, const matrix_view<U>& B)
+{
+  A += B;
+  return A;
+}
+
+template<class T, class S, class Alloc, class Order, class U>
+inline mathmatrix<T,S,Alloc,Order>
+operator+(const matrix_view<U>& A, mathmatrix<T,S,Alloc,Order> B)
+{
+  B += A;
+  return B;
+}
+
+template<class T, class U>
+inline mathmatrix<typename matrix_view<T>::value_type>
+operator-(const matrix_view<T>& A, const matrix_view<U>& B)
+{
+  mathmatrix<typename matrix_view<T>::value_type> res(A);
+  res -= B;
+  return res;
+}
+
+template<class T, class S, class Alloc, class Order, class U>
+inline mathmatrix<T,S,Alloc,Order>
+operator-(mathmatrix<T,S,Alloc,Order> A, const matrix_view<U>& B)
+{
+  A -= B;
+  return A;
+}
+
+template<class T, class S, class Alloc, class Order, class U>
+inline mathmatrix<T,S,Alloc,Order>
+operator-(const matrix_view<U>& A, const mathmatrix<T,S,Alloc,Order>& B)
+{
+  mathmatrix<T,S,Alloc,Order> res(A);
+  res -= B;
+  return res;
+}
+
+template<class T, class S, class Alloc = aligned_allocator<T>,
+	 class Order = row_major>
+inline mathmatrix<T,S,Alloc,Order>
+identity_matrix(typename mathmatrix<T,S,Alloc,Order>::size_type n)
+{
+  mathmatrix<T,S,Alloc,Order> id(n,n);
 
   for (auto i = 0u; i < n; ++i) id(i,i) = 1;
 
@@ -736,8 +1058,8 @@ inline mathmatrix<T> identity_matrix(typename mathmatrix<T>::size_type n)
   return id;
 }
 
-template<class T, class S>
-inline mathmatrix<T,S> diagonal_matrix(const mathvector<T,S>& v)
+template<class T, class S, class A_V>
+inline mathmatrix<T,S> diagonal_matrix(const mathvector<T,S,A_V>& v)
 {
   auto n = v.size();
   mathmatrix<T,S> diag(n,n);
@@ -747,8 +1069,8 @@ inline mathmatrix<T,S> diagonal_matrix(const mathvector<T,S>& v)
   return diag;
 }
 
-template<class T, class S>
-inline mathmatrix<T,S> diagonal_matrix(const mathvector<T,S>& v,
+template<class T, class S, class A_V>
+inline mathmatrix<T,S> diagonal_matrix(const mathvector<T,S,A_V>& v,
 				       typename mathmatrix<T>::size_type m,
 				       typename mathmatrix<T>::size_type n)
 {
@@ -761,6 +1083,51 @@ inline mathmatrix<T,S> diagonal_matrix(const mathvector<T,S>& v,
   return diag;
 }
 
+//
+// Linear systems
+//
+
+// X = inverse(A)*B, from the LU factors of a copy of A, with the
+// blocked substitutions of LUsolve.  This costs about a third of the
+// operations of forming inverse(A), and is more accurate.
+template<class T, class S, class Alloc, class Order, class A_B, class O_B>
+[[nodiscard]] inline mathmatrix<T,S,A_B,O_B>
+solve(const mathmatrix<T,S,Alloc,Order>& A, const mathmatrix<T,S,A_B,O_B>& B)
+{
+  MATRIX_ASSERT(A.isSquare() && A.rows() == B.rows());
+
+  mathmatrix<T,S,Alloc,Order> LU(A);
+  std::vector<int> row_index(A.rows());
+  int perm;
+  LUdecomp<T>(LU, row_index.data(), &perm);
+
+  mathmatrix<T,S,A_B,O_B> X(B);
+  LUsolve<T>(LU, row_index.data(), X);
+  return X;
+}
+
+// x = inverse(A)*b.
+template<class T, class S, class Alloc, class Order, class S_V, class A_V>
+[[nodiscard]] inline mathvector<T,S_V,A_V>
+solve(const mathmatrix<T,S,Alloc,Order>& A, const mathvector<T,S_V,A_V>& b)
+{
+  MATRIX_ASSERT(A.isSquare() && A.rows() == b.size());
+
+  mathmatrix<T,S,Alloc,Order> LU(A);
+  std::vector<int> row_index(A.rows());
+  int perm;
+  LUdecomp<T>(LU, row_index.data(), &perm);
+
+  mathvector<T,S_V,A_V> x(b);
+  LUbacksub<T>(LU, row_index.data(), x.data());
+  return x;
+}
+
+// Column-major mathmatrix, for passing to LAPACK or Matlab without
+// copying.
+template<class T, class S = T, class Alloc = aligned_allocator<T>>
+using colmajor_mathmatrix = mathmatrix<T,S,Alloc,column_major>;
+
 } // namespace jlt
 
 #endif // JLT_MATHMATRIX_HPP
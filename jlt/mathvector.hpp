@@ -13,8 +13,14 @@
 
 #include <stdexcept>
 #include <complex>
+#include <type_traits>
 #include <jlt/vector.hpp>
 #include <jlt/stlio.hpp>
+#include <jlt/expression.hpp>
+
+#ifdef JLT_USE_BLAS
+#  include <jlt/blas.hpp>
+#endif
 
 namespace jlt {
 
@@ -22,138 +28,190 @@ namespace jlt {
 // Declare class and function templates
 //
 
-template<class T, class S> class mathvector;
-
-template<class T, class S>
-inline mathvector<T,S> operator+(const mathvector<T,S>& v);
-
-template<class T, class S>
-inline mathvector<T,S> operator-(const mathvector<T,S>& v);
-
-template<class T, class S>
-inline mathvector<T,S> operator+(const mathvector<T,S>& v,
-				 const mathvector<T,S>& w);
-
-template<class T, class S>
-inline mathvector<T,S> operator-(const mathvector<T,S>& v,
-				 const mathvector<T,S>& w);
-
-template<class T, class S>
-inline mathvector<T,S> operator*(const S& a, const mathvector<T,S>& v);
-
-template<class T, class S>
-inline mathvector<T,S> operator*(const mathvector<T,S>& v, const S& a);
+template<class T, class S, class Alloc> class mathvector;
 
-template<class T, class S>
-inline mathvector<T,S> operator/(const mathvector<T,S>& v, const S& a);
+// The element-wise operators +, -, * and / by a scalar, and
+// component-wise /, are expression templates (see expression.hpp).
 
-template<class T, class S>
-inline mathvector<T,S> operator/(const mathvector<T,S>& v,
-				 const mathvector<T,S>& w);
+template<class T, class S, class Alloc>
+inline S operator*(const mathvector<T,S,Alloc>& v, const mathvector<T,S,Alloc>& w);
 
-template<class T, class S>
-inline S operator*(const mathvector<T,S>& v, const mathvector<T,S>& w);
-
-template<class T, class S>
-inline S dot(const mathvector<T,S>& v, const mathvector<T,S>& w);
+template<class T, class S, class Alloc>
+inline S dot(const mathvector<T,S,Alloc>& v, const mathvector<T,S,Alloc>& w);
 
 // Was called mag, but potentially confusing since it returns the
 // squared magnitude.
-template<class T, class S>
-inline S mag2(const mathvector<T,S>& v);
+template<class T, class S, class Alloc>
+inline S mag2(const mathvector<T,S,Alloc>& v);
 
-template<class T, class S>
-inline S abs(const mathvector<T,S>& v);
+template<class T, class S, class Alloc>
+inline S abs(const mathvector<T,S,Alloc>& v);
 
-template<class T, class S>
-inline mathvector<T,S> cross(const mathvector<T,S>& v,
-			     const mathvector<T,S>& w);
+template<class T, class S, class Alloc>
+inline mathvector<T,S,Alloc> cross(const mathvector<T,S,Alloc>& v,
+			     const mathvector<T,S,Alloc>& w);
 
 //
 // class mathvector
 //
 
-template<class T, class S = T>
-class mathvector : public vector<T> // note that this is jlt::vector
+template<class T, class S = T, class Alloc = std::allocator<T>>
+class mathvector : public vector<T,Alloc> // note that this is jlt::vector
 {
 public:
-  typedef typename std::vector<T>::size_type		size_type;
-  using reference = typename std::vector<T>::reference;
-  using const_reference = typename std::vector<T>::const_reference;
-  using iterator = typename std::vector<T>::iterator;
-  using const_iterator = typename std::vector<T>::const_iterator;
+  typedef typename std::vector<T,Alloc>::size_type		size_type;
+  using reference = typename std::vector<T,Alloc>::reference;
+  using const_reference = typename std::vector<T,Alloc>::const_reference;
+  using iterator = typename std::vector<T,Alloc>::iterator;
+  using const_iterator = typename std::vector<T,Alloc>::const_iterator;
 
   using scalar_type = S;
   using const_scalar_type = const S;
   using scalar_reference = S &;
   using const_scalar_reference = const S &;
 
-  using vector<T>::begin;
-  using vector<T>::end;
+  using vector<T,Alloc>::begin;
+  using vector<T,Alloc>::end;
 
   //
   // Constructors
   //
 
 #if __cplusplus > 199711L
-  // Use C++11-style argument forwarding.
-  template<typename... Args>
-  mathvector(Args&&... _args) : vector<T>(std::forward<Args>(_args)...) {}
+  // Use C++11-style argument forwarding.  Only arguments that
+  // std::vector accepts, so that expressions use the constructor below.
+  template<typename... Args,
+	   class = typename std::enable_if<
+	     std::is_constructible<std::vector<T,Alloc>,Args&&...>::value>::type>
+  mathvector(Args&&... _args) : vector<T,Alloc>(std::forward<Args>(_args)...) {}
 
   // Forward initializer list as well.
-  mathvector(std::initializer_list<T> _l) : vector<T>(_l) {}
+  mathvector(std::initializer_list<T> _l) : vector<T,Alloc>(_l) {}
 #else
   // Empty vector of size 0.
-  mathvector() : vector<T>() {}
+  mathvector() : vector<T,Alloc>() {}
 
   // mathvector of size _n filled with _x.
   explicit mathvector(size_type _n, const_reference _x = T())
-    : vector<T>(_n,_x) {}
+    : vector<T,Alloc>(_n,_x) {}
 
   // Copy constructor.
-  mathvector(const vector<T>& _v) : vector<T>(_v) {}
+  mathvector(const vector<T,Alloc>& _v) : vector<T,Alloc>(_v) {}
 
-  const vector<T>& operator=(const vector<T>& v)
+  const vector<T,Alloc>& operator=(const vector<T,Alloc>& v)
     {
-      return vector<T>::operator=(v);
+      return vector<T,Alloc>::operator=(v);
     }
 #endif
 
+  // Evaluate an expression such as a*x + y (see expression.hpp).
+  template<class E,
+	   class = typename std::enable_if<is_expr_node_t<E>::value &&
+	     std::is_same<expr_result_t<E>,mathvector>::value>::type>
+  mathvector(E&& e)
+    {
+      if (!expr_steal(*this,std::forward<E>(e)))
+	{
+	  this->resize(e.size());
+	  expr_assign(*this,e);
+	}
+    }
+
+  // The result may appear in the expression: x = x + dt*v is fine.
+  template<class E,
+	   class = typename std::enable_if<is_expr_node_t<E>::value &&
+	     std::is_same<expr_result_t<E>,mathvector>::value>::type>
+  mathvector<T,S,Alloc>& operator=(E&& e)
+    {
+      if (this->size() == e.size())
+	{
+	  expr_assign(*this,e);
+	}
+      else if (!expr_steal(*this,std::forward<E>(e)))
+	{
+	  this->resize(e.size());
+	  expr_assign(*this,e);
+	}
+
+      return *this;
+    }
+
   //
   // Vector Operations
   //
 
-  // These are really slow, because of temporaries and copying, and
-  // lead to nested loops.
+  // The binary operators build expressions, which are evaluated in a
+  // single loop when assigned (see expression.hpp).
 
-  mathvector<T,S>& operator+=(const mathvector<T,S>& v)
+  mathvector<T,S,Alloc>& operator+=(const mathvector<T,S,Alloc>& v)
     {
       VECTOR_ASSERT(this->size() == v.size());
 
-      auto k = begin();
-      for (auto i = v.cbegin(); i != v.cend(); ++i, ++k)
+#ifdef JLT_USE_BLAS
+      if constexpr (blas::is_blas_type<T>::value)
 	{
-	  *k += *i;
+	  if (blas::strided_axpy(v.size(),T(1),v.data(),1,this->data(),1))
+	    return *this;
 	}
+#endif
+
+      expr_plus_assign(*this,expr_ref<mathvector>(v));
 
       return *this;
     }
 
-  mathvector<T,S>& operator-=(const mathvector<T,S>& v)
+  mathvector<T,S,Alloc>& operator-=(const mathvector<T,S,Alloc>& v)
     {
       VECTOR_ASSERT(this->size() == v.size());
 
-      auto k = begin();
-      for (auto i = v.cbegin(); i != v.cend(); ++i, ++k)
+#ifdef JLT_USE_BLAS
+      if constexpr (blas::is_blas_type<T>::value)
 	{
-	  *k -= *i;
+	  if (blas::strided_axpy(v.size(),T(-1),v.data(),1,this->data(),1))
+	    return *this;
 	}
+#endif
+
+      expr_minus_assign(*this,expr_ref<mathvector>(v));
+
+      return *this;
+    }
+
+  template<class E,
+	   class = typename std::enable_if<is_expr_node_t<E>::value &&
+	     std::is_same<expr_result_t<E>,mathvector>::value>::type>
+  mathvector<T,S,Alloc>& operator+=(const E& e)
+    {
+      VECTOR_ASSERT(this->size() == e.size());
+
+      expr_plus_assign(*this,e);
+
+      return *this;
+    }
+
+  template<class E,
+	   class = typename std::enable_if<is_expr_node_t<E>::value &&
+	     std::is_same<expr_result_t<E>,mathvector>::value>::type>
+  mathvector<T,S,Alloc>& operator-=(const E& e)
+    {
+      VECTOR_ASSERT(this->size() == e.size());
+
+      expr_minus_assign(*this,e);
 
       return *this;
     }
 
-  mathvector<T,S>& operator*=(const_scalar_reference a)
+  mathvector<T,S,Alloc>& operator*=(const_scalar_reference a)
     {
+#ifdef JLT_USE_BLAS
+      if constexpr (blas::is_blas_type<T>::value &&
+		    std::is_convertible<S,T>::value)
+	{
+	  if (blas::strided_scal(this->size(),T(a),this->data(),1))
+	    return *this;
+	}
+#endif
+
       for (auto k = begin(); k != end(); ++k)
 	{
 	  *k *= a;
@@ -162,7 +220,7 @@ public:
       return *this;
     }
 
-  mathvector<T,S>& operator/=(const_scalar_reference a)
+  mathvector<T,S,Alloc>& operator/=(const_scalar_reference a)
     {
       for (auto k = begin(); k != end(); ++k)
 	{
@@ -173,7 +231,7 @@ public:
     }
 
   // Component-wise division.
-  mathvector<T,S>& operator/=(const mathvector<T,S>& v)
+  mathvector<T,S,Alloc>& operator/=(const mathvector<T,S,Alloc>& v)
     {
       VECTOR_ASSERT(this->size() == v.size());
 
@@ -191,9 +249,9 @@ public:
       T _sum = T();
 
       for (auto i = this->cbegin(); i != this->cend(); ++i)
-        {
+	{
 	  _sum += *i;
-        }
+	}
 
       return _sum;
     }
@@ -216,44 +274,30 @@ public:
   // Friends
   //
 
-  friend mathvector<T,S> operator+<>(const mathvector<T,S>& v);
-
-  friend mathvector<T,S> operator-<>(const mathvector<T,S>& v);
-
-  friend mathvector<T,S> operator+<>(const mathvector<T,S>& v,
-				     const mathvector<T,S>& w);
-
-  friend mathvector<T,S> operator-<>(const mathvector<T,S>& v,
-				     const mathvector<T,S>& w);
-
-  friend mathvector<T,S> operator*<>(const_scalar_reference a,
-				     const mathvector<T,S>& v);
-
-  friend mathvector<T,S> operator*<>(const mathvector<T,S>& v,
-				     const_scalar_reference a);
-
-  friend mathvector<T,S> operator/<>(const mathvector<T,S>& v,
-				     const_scalar_reference a);
-
-  // Component-wise division.
-  friend mathvector<T,S> operator/<>(const mathvector<T,S>& v,
-				  const mathvector<T,S>& w);
-
   // Dot product (not component-wise multiplication).
-  friend scalar_type jlt::operator*<>(const mathvector<T,S>& v,
-				      const mathvector<T,S>& w);
+  friend scalar_type jlt::operator*<>(const mathvector<T,S,Alloc>& v,
+				      const mathvector<T,S,Alloc>& w);
 
-  friend scalar_type jlt::dot<>(const mathvector<T,S>& v,
-				const mathvector<T,S>& w);
+  friend scalar_type jlt::dot<>(const mathvector<T,S,Alloc>& v,
+				const mathvector<T,S,Alloc>& w);
 
-  friend scalar_type jlt::mag2<>(const mathvector<T,S>& v);
+  friend scalar_type jlt::mag2<>(const mathvector<T,S,Alloc>& v);
 
-  friend scalar_type jlt::abs<>(const mathvector<T,S>& v);
+  friend scalar_type jlt::abs<>(const mathvector<T,S,Alloc>& v);
 
 
 }; // class mathvector
 
 
+// mathvector takes part in expressions.
+template<class T, class S, class Alloc>
+struct expr_container_traits<mathvector<T,S,Alloc>>
+{
+  static constexpr bool is_container = true;
+  static constexpr bool is_vector = true;
+};
+
+
 //
 // Function definitions
 //
@@ -261,6 +305,9 @@ public:
 //
 // Specializations of cross product
 //
+// These allocate the result on the heap: for many small cross
+// products, use fixed_mathvector<T,3> (fixed_mathvector.hpp) instead.
+//
 template<>
 inline mathvector<long double> cross(const mathvector<long double>& v,
 				     const mathvector<long double>& w)
@@ -309,122 +356,8 @@ inline mathvector<float> cross(const mathvector<float>& v,
   return res;
 }
 
-template<class T, class S>
-inline mathvector<T,S> operator+(const mathvector<T,S>& v)
-{
-  return v;
-}
-
-template<class T, class S>
-inline mathvector<T,S> operator-(const mathvector<T,S>& v)
-{
-  mathvector<T,S> res(v.size());
-
-  auto k = res.begin();
-  for (auto i = v.cbegin(); i != v.cend(); ++i,++k)
-    {
-      *k = -(*i);
-    }
-
-  return res;
-}
-
-template<class T, class S>
-inline mathvector<T,S> operator+(const mathvector<T,S>& v,
-				 const mathvector<T,S>& w)
-{
-  VECTOR_ASSERT(v.size() == w.size());
-
-  mathvector<T,S> res(v.size());
-
-  auto k = res.begin();
-  for (auto i = v.cbegin(), j = w.cbegin(); i != v.cend(); ++i,++j,++k)
-    {
-      *k = (*i) + (*j);
-    }
-
-  return res;
-}
-
-template<class T, class S>
-inline mathvector<T,S> operator-(const mathvector<T,S>& v,
-				 const mathvector<T,S>& w)
-{
-  VECTOR_ASSERT(v.size() == w.size());
-
-  mathvector<T,S> res(v.size());
-
-  auto k = res.begin();
-  for (auto i = v.cbegin(), j = w.cbegin(); i != v.cend(); ++i,++j,++k)
-    {
-      *k = (*i) - (*j);
-    }
-
-  return res;
-}
-
-template<class T, class S>
-inline mathvector<T,S> operator*(const S& a, const mathvector<T,S>& v)
-{
-  mathvector<T,S> res(v.size());
-
-  auto k = res.begin();
-  for (auto i = v.cbegin(); i != v.cend(); ++i, ++k)
-    {
-      *k = a * (*i);
-    }
-
-  return res;
-}
-
-template<class T, class S>
-inline mathvector<T,S> operator*(const mathvector<T,S>& v, const S& a)
-{
-  mathvector<T,S> res(v.size());
-
-  auto k = res.begin();
-  for (auto i = v.cbegin(); i != v.cend(); ++i, ++k)
-    {
-      *k = a * (*i);
-    }
-
-  return res;
-}
-
-template<class T, class S>
-inline mathvector<T,S> operator/(const mathvector<T,S>& v, const S& a)
-{
-  mathvector<T,S> res(v.size());
-
-  auto k = res.begin();
-  for (auto i = v.cbegin(); i != v.cend(); ++i, ++k)
-    {
-      *k = (*i) / a;
-    }
-
-  return res;
-}
-
-// Component-wise division.
-template<class T, class S>
-inline mathvector<T,S> operator/(const mathvector<T,S>& v,
-				 const mathvector<T,S>& w)
-{
-  VECTOR_ASSERT(v.size() == w.size());
-
-  mathvector<T,S> res(v.size());
-
-  auto k = res.begin();
-  for (auto i = v.cbegin(), j = w.cbegin(); i != v.cend(); ++i,++j,++k)
-    {
-      *k = (*i) / (*j);
-    }
-
-  return res;
-}
-
-template<class T, class S>
-inline S dot(const mathvector<T,S>& v, const mathvector<T,S>& w)
+template<class T, class S, class Alloc>
+inline S dot(const mathvector<T,S,Alloc>& v, const mathvector<T,S,Alloc>& w)
 {
   VECTOR_ASSERT(v.size() == w.size());
 
@@ -438,14 +371,14 @@ inline S dot(const mathvector<T,S>& v, const mathvector<T,S>& w)
   return dotp;
 }
 
-template<class T, class S>
-inline S operator*(const mathvector<T,S>& v, const mathvector<T,S>& w)
+template<class T, class S, class Alloc>
+inline S operator*(const mathvector<T,S,Alloc>& v, const mathvector<T,S,Alloc>& w)
 {
   return dot(v,w);
 }
 
-template<class T, class S>
-inline S mag2(const mathvector<T,S>& v)
+template<class T, class S, class Alloc>
+inline S mag2(const mathvector<T,S,Alloc>& v)
 {
   S magn = S();
 
@@ -458,8 +391,8 @@ inline S mag2(const mathvector<T,S>& v)
 }
 
 // Specializations of mag2 for complex types
-template<class T, class S>
-inline S mag2(const mathvector<std::complex<T>,S>& v)
+template<class T, class S, class Alloc>
+inline S mag2(const mathvector<std::complex<T>,S,Alloc>& v)
 {
   S magn = S();
 
@@ -472,8 +405,8 @@ inline S mag2(const mathvector<std::complex<T>,S>& v)
   return magn;
 }
 
-template<class T, class S>
-inline S abs(const mathvector<T,S>& v)
+template<class T, class S, class Alloc>
+inline S abs(const mathvector<T,S,Alloc>& v)
 {
   return std::sqrt(mag2((v)));
 }
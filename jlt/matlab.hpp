@@ -10,7 +10,9 @@
 #include <iostream>
 #include <string>
 #include <vector>
+#include <algorithm>
 #include <jlt/matrix.hpp>
+#include <jlt/matrix_view.hpp>
 #include <jlt/exceptions.hpp>
 #ifdef JLT_MATLAB_LIB_SUPPORT
 #  include "mat.h"
@@ -21,10 +23,10 @@ namespace jlt {
 
 
   // Forward declarations.
-template<typename T> class matrix;
+template<typename T, class Alloc, class Order> class matrix;
 
-template<typename T> std::ostream&
-printMatlabForm_nodefaults(std::ostream&, const matrix<T>&,
+template<typename T, class Alloc, class Order> std::ostream&
+printMatlabForm_nodefaults(std::ostream&, const matrix<T,Alloc,Order>&,
 			   const std::string, const std::string);
 
 
@@ -82,9 +84,9 @@ void printMatlabForm(MATFile *pmat,
       }
   }
 
-template<typename T>
+template<typename T, class Alloc>
 void printMatlabForm(MATFile *pmat,
-		     const std::vector<T>& v,
+		     const std::vector<T,Alloc>& v,
 		     const std::string name,
 		     const std::string description = "",
 		     const std::string orientation = "")
@@ -139,9 +141,47 @@ void printMatlabForm(MATFile *pmat,
   }
 
 
+// Also used for matrix-like classes that provide a view(), such as
+// mmap_matrix.
 template<typename T>
 void printMatlabForm(MATFile *pmat,
-		     const matrix<T>& A,
+		     const matrix_view<T>& A,
+		     const std::string name = "",
+		     const std::string description = "")
+  {
+    // description string is written to name_descr in the MAT file.
+    mxArray *mxA;
+    if (A.empty())
+      {
+	mxA = mxCreateDoubleMatrix(0,0,mxREAL);
+      }
+    else
+      {
+	mxA = mxCreateDoubleMatrix(A.rows(),A.columns(),mxREAL);
+	double *mxAp = mxGetPr(mxA);
+	for (int j = 0; j < (int)A.columns(); ++j)
+	  {
+	    for (int i = 0; i < (int)A.rows(); ++i)
+	      {
+		mxAp[i + A.rows()*j] = A(i,j);
+	      }
+	  }
+      }
+    matPutVariable(pmat,name.c_str(),mxA);
+    mxDestroyArray(mxA);
+
+    if (!description.empty())
+      {
+	auto name_descr = name + "_descr";
+	auto mxdescr = mxCreateString(description.c_str());
+	matPutVariable(pmat,name_descr.c_str(),mxdescr);
+	mxDestroyArray(mxdescr);
+      }
+  }
+
+template<typename T, class Alloc, class Order>
+void printMatlabForm(MATFile *pmat,
+		     const matrix<T,Alloc,Order>& A,
 		     const std::string name = "",
 		     const std::string description = "")
   {
@@ -149,9 +189,9 @@ void printMatlabForm(MATFile *pmat,
     printMatlabForm_nodefaults<T>(pmat,A,name,description);
   }
 
-template<typename T>
+template<typename T, class Alloc, class Order>
 void printMatlabForm_nodefaults(MATFile *pmat,
-				const matrix<T>& A,
+				const matrix<T,Alloc,Order>& A,
 				const std::string name,
 				const std::string description)
   {
@@ -165,11 +205,19 @@ void printMatlabForm_nodefaults(MATFile *pmat,
       {
 	mxA = mxCreateDoubleMatrix(A.rows(),A.columns(),mxREAL);
 	double *mxAp = mxGetPr(mxA);
-	for (int i = 0; i < (int)A.rows(); ++i)
+	if (matrix<T,Alloc,Order>::is_column_major)
 	  {
-	    for (int j = 0; j < (int)A.columns(); ++j)
+	    // Same layout as Matlab: straight copy, no transposition.
+	    std::copy(A.data(),A.data() + A.size(),mxAp);
+	  }
+	else
+	  {
+	    for (int i = 0; i < (int)A.rows(); ++i)
 	      {
-		mxAp[i + A.rows()*j] = A(i,j);
+		for (int j = 0; j < (int)A.columns(); ++j)
+		  {
+		    mxAp[i + A.rows()*j] = A(i,j);
+		  }
 	      }
 	  }
       }
@@ -275,9 +323,9 @@ std::ostream& printMatlabForm(std::ostream& strm,
     return strm;
   }
 
-template<typename T>
+template<typename T, class Alloc>
 std::ostream& printMatlabForm(std::ostream& strm,
-			      const std::vector<T>& v,
+			      const std::vector<T,Alloc>& v,
 			      const std::string name = "",
 			      const std::string description = "")
   {
@@ -315,7 +363,45 @@ std::ostream& printMatlabForm(std::ostream& strm,
 
 template<typename T>
 std::ostream& printMatlabForm(std::ostream& strm,
-			      const matrix<T>& A,
+			      const matrix_view<T>& A,
+			      const std::string name = "",
+			      const std::string description = "")
+  {
+    if (name.empty())
+      {
+	// Print description as comment if specified without name.
+	if (!description.empty()) strm << "% " << description << std::endl;
+      }
+    else
+      {
+	// Print description as string name_description, before variable.
+	auto name_descr = name + "_descr";
+	if (!description.empty())
+	  strm << name_descr << " = '" << description << "';" << std::endl;
+      }
+
+    // Only print = if name is specified.
+    if (!name.empty()) strm << name << " = ";
+
+    // If the matrix is empty, just print "[];"
+    if (A.empty()) { strm << "[];\n"; return strm; }
+
+    strm << "[\n";
+    for (int i = 0; i < (int)A.rows(); ++i) {
+      for (int j = 0; j < (int)A.columns()-1; ++j)
+	{
+	  strm << A(i,j) << " ";
+	}
+      strm << A(i,A.columns()-1) << "\n";
+    }
+    strm << "];\n";
+
+    return strm;
+  }
+
+template<typename T, class Alloc, class Order>
+std::ostream& printMatlabForm(std::ostream& strm,
+			      const matrix<T,Alloc,Order>& A,
 			      const std::string name = "",
 			      const std::string description = "")
   {
@@ -323,9 +409,9 @@ std::ostream& printMatlabForm(std::ostream& strm,
     return printMatlabForm_nodefaults<T>(strm,A,name,description);
   }
 
-template<typename T>
+template<typename T, class Alloc, class Order>
 std::ostream& printMatlabForm_nodefaults(std::ostream& strm,
-					 const matrix<T>& A,
+					 const matrix<T,Alloc,Order>& A,
 					 const std::string name,
 					 const std::string description)
   {
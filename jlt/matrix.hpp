@@ -21,6 +21,14 @@
 // This class is not easy to specialize to sparse matrices, symmetric
 // matrices, etc.
 
+// The storage order is row-major by default.  With Order =
+// column_major the elements are stored by columns, as expected by
+// Fortran (LAPACK) and Matlab, so that such matrices can be passed to
+// them without copying or transposing.  Element access through
+// operator(), the views, and all the output functions are independent
+// of the storage order; only data(), operator[] and the iterators see
+// the raw storage.
+
 /*
 
   Implement:
@@ -29,21 +37,39 @@
 
   grow()
   back()
-  reserve()
-  capacity()
   assign()
   push_back(T&)
-  push_back(vector<T>&)
-  pop_back()
 
-  row_iterator
-  col_iterator
+  (Appending and removing rows, with capacity management, is provided
+  by reserve(), capacity(), push_back_row(), pop_back_row() and
+  shrink_to_fit(), for row-major storage.)
+
+  (Row, column and diagonal iteration is provided by the views in
+  matrix_view.hpp: see row_view(), column_view(), diagonal_view().)
 
 */
 
 #include <iostream>
 #include <vector>
 #include <string>
+#include <utility>
+#include <memory>
+#include <type_traits>
+#include <jlt/aligned_allocator.hpp>
+#include <jlt/matrix_view.hpp>
+#include <jlt/transpose.hpp>
+
+namespace jlt {
+// Storage order tags.
+struct row_major {};
+struct column_major {};
+
+// Forward declaration, which carries the default template arguments.
+// This has to come before matlab.hpp, which refers to matrix.
+template<class T, class Alloc = aligned_allocator<T>,
+	 class Order = row_major> class matrix;
+}
+
 #include <jlt/matlab.hpp>
 #include <jlt/exceptions.hpp>
 
@@ -64,31 +90,32 @@
 
 namespace jlt {
 
-// Forward declarations.
-template<typename T> class matrix;
-
 // Cannot use printMatlabForm from matlab.hpp, since the forward
 // declarations below takes precendence (for some reason) and GCC
 // complains about providing default arguments.  As a workaround,
 // define nodefaults:: versions, which are just meant to be called
 // internally by the methods in jlt::matrix.
 
-template<typename T> std::ostream&
-printMatlabForm_nodefaults(std::ostream&, const matrix<T>&,
+template<typename T, class Alloc, class Order> std::ostream&
+printMatlabForm_nodefaults(std::ostream&, const matrix<T,Alloc,Order>&,
 			   const std::string, const std::string);
 
 #ifdef JLT_MATLAB_LIB_SUPPORT
-template<typename T> void
-printMatlabForm_nodefaults(MATFile *, const matrix<T>&,
+template<typename T, class Alloc, class Order> void
+printMatlabForm_nodefaults(MATFile *, const matrix<T,Alloc,Order>&,
 			   const std::string, const std::string);
 #endif
 
 
-template<class T>
+// The storage is obtained from Alloc, which by default returns memory
+// aligned on a cache line (see aligned_allocator.hpp).
+template<class T, class Alloc, class Order>
 class matrix
 {
 public:
   using value_type = T;
+  using allocator_type = Alloc;
+  using order_type = Order;
   using pointer = T *;
   using const_pointer = const T *;
   using iterator = pointer;
@@ -97,45 +124,129 @@ public:
   using const_reference = const T &;
   using size_type = size_t;
 
+  static constexpr bool is_row_major = std::is_same<Order,row_major>::value;
+  static constexpr bool is_column_major =
+    std::is_same<Order,column_major>::value;
+
+  static_assert(is_row_major || is_column_major,
+		"jlt::matrix: Order must be row_major or column_major.");
+
 private:
+  using alloc_traits = std::allocator_traits<Alloc>;
+
   pointer	start;
-  pointer	finish;
+  pointer	finish;			// End of the elements.
+  pointer	end_of_storage;		// End of the allocated storage.
   size_type	m{0}, n{0};		// Number of rows, columns.
+  Alloc		alloc;
+
+  // Allocate raw storage for mn elements; nothing is constructed.
+  void allocate_storage(size_type mn)
+    {
+      start = (mn == 0 ? nullptr : alloc_traits::allocate(alloc,mn));
+      finish = end_of_storage = start + mn;
+    }
+
+  // Destroy the elements and give the storage back to the allocator.
+  void free_storage()
+    {
+      if (start == nullptr) return;
+
+      for (iterator i = start; i != finish; ++i)
+	alloc_traits::destroy(alloc,i);
+      alloc_traits::deallocate(alloc,start,end_of_storage-start);
+      start = finish = end_of_storage = nullptr;
+    }
+
+  // Move the elements to new storage with room for cap elements.
+  void reallocate(size_type cap)
+    {
+      size_type mn = finish - start;
+      pointer p = (cap == 0 ? nullptr : alloc_traits::allocate(alloc,cap));
+
+      std::uninitialized_move(start,finish,p);
+      free_storage();
+
+      start = p;
+      finish = p + mn;
+      end_of_storage = p + cap;
+    }
+
+  // Shape of the storage seen as a row-major array.
+  size_type storage_rows() const { return (is_row_major ? m : n); }
+  size_type storage_columns() const { return (is_row_major ? n : m); }
+
+  // Offset of element (i,j) in the storage.
+  size_type index(size_type i, size_type j) const
+    {
+      return (is_row_major ? n*i + j : i + m*j);
+    }
 
 public:
   //
   // Constructors
   //
 
-  matrix() : start(nullptr), finish(nullptr) {}
+  matrix() : start(nullptr), finish(nullptr), end_of_storage(nullptr) {}
 
   // Matrix of size _m*_n filled with _x.
   explicit matrix(size_type _m, size_type _n, const_reference _x = T())
     : m(_m), n(_n)
     {
-      size_type mn = m*n;
+      allocate_storage(m*n);
+
+      for (iterator i = start; i != finish; ++i)
+	alloc_traits::construct(alloc,i,_x);
+    }
 
-      start = new T[mn];
-      finish = start + mn;
+  // Matrix of size _m*_n whose elements are default-initialised, which
+  // for built-in types means they are left uninitialised.  Use for
+  // scratch matrices that are about to be overwritten.
+  matrix(size_type _m, size_type _n, default_init_t)
+    : m(_m), n(_n)
+    {
+      allocate_storage(m*n);
 
-      for (iterator i = start; i != finish; ++i) *i = _x;
+      for (iterator i = start; i != finish; ++i)
+	::new(static_cast<void*>(i)) T;
     }
 
-  matrix(const matrix<T>& _M) : m(_M.m), n(_M.n)	// Copy constructor.
+  matrix(const matrix<T,Alloc,Order>& _M)	// Copy constructor.
+    : m(_M.m), n(_M.n),
+      alloc(alloc_traits::select_on_container_copy_construction(_M.alloc))
     {
-      size_type mn = _M.size();
+      allocate_storage(_M.size());
 
-      start = new T[mn];
-      finish = start + mn;
+      std::uninitialized_copy(_M.start,_M.finish,start);
+    }
+
+  // Copy the elements referred to by a view into a new matrix.
+  // The view may refer to data in either storage order, so this also
+  // converts between orders.
+  template<class U>
+  explicit matrix(const matrix_view<U>& V)
+    : m(V.rows()), n(V.columns())
+    {
+      allocate_storage(m*n);
 
-      iterator j = start;
-      const_iterator i = _M.start;
-      while (j != finish) *j++ = *i++;
+      for (size_type i = 0; i < m; ++i)
+	for (size_type j = 0; j < n; ++j)
+	  alloc_traits::construct(alloc,start + index(i,j),V(i,j));
+    }
+
+  // Move constructor: steal the buffer, leave _M empty.
+  matrix(matrix<T,Alloc,Order>&& _M) noexcept
+    : start(_M.start), finish(_M.finish), end_of_storage(_M.end_of_storage),
+      m(_M.m), n(_M.n), alloc(std::move(_M.alloc))
+    {
+      _M.start = _M.finish = _M.end_of_storage = nullptr;
+      _M.m = _M.n = 0;
     }
 
 #if __cplusplus > 199711L
   // C++11-style list initialization.
   // example: matrix(3,2,{1,2,3,4,5,6})
+  // The elements are always listed row by row, whatever the Order.
   matrix(size_type _m, size_type _n, std::initializer_list<T> _l)
     : m(_m), n(_n)
     {
@@ -147,15 +258,24 @@ public:
 	    (std::out_of_range("Out of range exception in jlt::matrix."));
 	}
 
-      start = new T[mn];
-      finish = start + mn;
+      allocate_storage(mn);
 
-      std::uninitialized_copy(_l.begin(),_l.end(),start);
+      if (is_row_major)
+	{
+	  std::uninitialized_copy(_l.begin(),_l.end(),start);
+	}
+      else
+	{
+	  auto l = _l.begin();
+	  for (size_type i = 0; i < m; ++i)
+	    for (size_type j = 0; j < n; ++j, ++l)
+	      alloc_traits::construct(alloc,start + index(i,j),*l);
+	}
     }
 #endif
 
   // Destructor
-  ~matrix() { if (start != nullptr) delete[] start; }
+  ~matrix() { free_storage(); }
 
   //
   // Element access.
@@ -166,7 +286,7 @@ public:
 #ifdef MATRIX_CHECK_BOUNDS
       return at(i,j);
 #else
-      return *(start + n*i + j);
+      return *(start + index(i,j));
 #endif
     }
 
@@ -175,7 +295,7 @@ public:
 #ifdef MATRIX_CHECK_BOUNDS
       return at(i,j);
 #else
-      return *(start + n*i + j);
+      return *(start + index(i,j));
 #endif
     }
 
@@ -184,7 +304,7 @@ public:
       if (i >= m || j >= n)
 	JLT_THROW(std::out_of_range("Out of range exception in jlt::matrix."));
 
-      return *(start + n*i + j);
+      return *(start + index(i,j));
     }
 
   [[nodiscard]] const_reference at(size_type i, size_type j) const
@@ -192,16 +312,19 @@ public:
       if (i >= m || j >= n)
 	JLT_THROW(std::out_of_range("Out of range exception in jlt::matrix."));
 
-      return *(start + n*i + j);
+      return *(start + index(i,j));
     }
 
   // The followind methods return a pointer.  Could return a Vec, but
   // that would be slower and would force Mat to work with Vec.
   // However, with pointers no bounds checking can be done on the
   // second square bracket in A[i][j].
+  // Only available for row-major storage.
 
   pointer operator[](size_type i)
     {
+      static_assert(is_row_major,
+		    "jlt::matrix: A[i][j] requires row-major storage.");
 #ifdef MATRIX_CHECK_BOUNDS
       static bool only_once = true;
       if (only_once) {
@@ -217,6 +340,8 @@ public:
 
   const_pointer operator[](size_type i) const
     {
+      static_assert(is_row_major,
+		    "jlt::matrix: A[i][j] requires row-major storage.");
 #ifdef MATRIX_CHECK_BOUNDS
       static bool only_once = true;
       if (only_once) {
@@ -248,7 +373,71 @@ public:
       if (i >= m)
 	JLT_THROW(std::out_of_range("Out of range exception in jlt::matrix."));
 #endif
-      return std::vector<T>(start + n*i,start + n*i + m);
+      const_pointer r = start + index(i,0);
+      if (is_row_major) return std::vector<T>(r,r + n);
+
+      auto v = row_view(i);
+      return std::vector<T>(v.begin(),v.end());
+    }
+
+  //
+  // Views (see matrix_view.hpp).  These refer to the data of the
+  // matrix without copying it, and are invalidated if the matrix is
+  // resized or destroyed.
+  //
+
+  matrix_view<T> view()
+    {
+      return (is_row_major ? matrix_view<T>(start,m,n,n,1)
+	      : matrix_view<T>(start,m,n,1,m));
+    }
+
+  [[nodiscard]] matrix_view<const T> view() const
+    {
+      return (is_row_major ? matrix_view<const T>(start,m,n,n,1)
+	      : matrix_view<const T>(start,m,n,1,m));
+    }
+
+  vector_view<T> row_view(size_type i)
+    {
+      return view().row(i);
+    }
+
+  [[nodiscard]] vector_view<const T> row_view(size_type i) const
+    {
+      return view().row(i);
+    }
+
+  vector_view<T> column_view(size_type j)
+    {
+      return view().column(j);
+    }
+
+  [[nodiscard]] vector_view<const T> column_view(size_type j) const
+    {
+      return view().column(j);
+    }
+
+  vector_view<T> diagonal_view()
+    {
+      return view().diagonal();
+    }
+
+  [[nodiscard]] vector_view<const T> diagonal_view() const
+    {
+      return view().diagonal();
+    }
+
+  // The _m by _n block with top-left corner at (i,j).
+  matrix_view<T> block(size_type i, size_type j, size_type _m, size_type _n)
+    {
+      return view().block(i,j,_m,_n);
+    }
+
+  [[nodiscard]] matrix_view<const T> block(size_type i, size_type j,
+					   size_type _m, size_type _n) const
+    {
+      return view().block(i,j,_m,_n);
     }
 
   // size() returns the total number of elements.
@@ -266,7 +455,7 @@ public:
   // Queries
   //
 
-  [[nodiscard]] bool empty() const { return (!start); }
+  [[nodiscard]] bool empty() const { return (start == finish); }
 
   [[nodiscard]] bool isSquare() const { return (m == n); }
 
@@ -281,65 +470,234 @@ public:
   [[nodiscard]] const_iterator end() const { return iterator(finish); }
   [[nodiscard]] const_iterator cend() const { return iterator(finish); }
 
-  // row/column iterators?  Diagonal iterator?
+  // For row/column/diagonal iterators, use the begin() and end() of
+  // row_view(), column_view() and diagonal_view().
 
-  matrix<T>& operator=(const matrix<T>& M)
+  matrix<T,Alloc,Order>& operator=(const matrix<T,Alloc,Order>& M)
     {
       if (&M == this) return *this;
 
+      size_type mn = M.size();
+
+      // Only reallocate if the number of elements changes: a matrix
+      // that is repeatedly assigned to in a loop then never touches
+      // the allocator.
+      if (start == nullptr || mn != size())
+	{
+	  // Free the matrix if not empty.
+	  free_storage();
+
+	  allocate_storage(mn);
+	  std::uninitialized_copy(M.start,M.finish,start);
+	}
+      else
+	{
+	  std::copy(M.start,M.finish,start);
+	}
+
       m = M.rows();
       n = M.columns();
-      size_type mn = size();
 
-      // Free the matrix if not empty.
-      if (start != nullptr) delete[] start;
+      return *this;
+    }
+
+  // Copy the elements referred to by a view, reusing the buffer if
+  // the number of elements is unchanged.  V must not overlap *this.
+  template<class U>
+  matrix<T,Alloc,Order>& operator=(const matrix_view<U>& V)
+    {
+      if (start == nullptr || V.size() != size())
+	{
+	  matrix<T,Alloc,Order> tmp(V);
+	  swap(tmp);
+	}
+      else
+	{
+	  m = V.rows();
+	  n = V.columns();
+	  for (size_type i = 0; i < m; ++i)
+	    for (size_type j = 0; j < n; ++j) start[index(i,j)] = V(i,j);
+	}
 
-      start = new T[mn];
-      finish = start + mn;
+      return *this;
+    }
 
-      iterator j = start;
-      const_iterator i = M.start;
-      while (j != finish) *j++ = *i++;
+  // Move assignment: take over M's buffer and hand ours back to M,
+  // which will free it.
+  matrix<T,Alloc,Order>& operator=(matrix<T,Alloc,Order>&& M) noexcept
+    {
+      swap(M);
 
       return *this;
     }
 
+  // Exchange contents with M, without copying any elements.
+  void swap(matrix<T,Alloc,Order>& M) noexcept
+    {
+      using std::swap;
+
+      swap(start,M.start);
+      swap(finish,M.finish);
+      swap(end_of_storage,M.end_of_storage);
+      swap(m,M.m);
+      swap(n,M.n);
+      swap(alloc,M.alloc);
+    }
+
+  [[nodiscard]] allocator_type get_allocator() const { return alloc; }
+
+  //
+  // Growing (row-major only)
+  //
+
+  // Rows are appended in amortised constant time, as with
+  // std::vector::push_back, so that a time series can be accumulated
+  // directly in contiguous storage.  Growing invalidates pointers,
+  // iterators and views into the matrix.
+
+  // Number of rows that fit in the current storage.
+  [[nodiscard]] size_type capacity() const
+    {
+      return (n == 0 ? 0 : (end_of_storage - start)/n);
+    }
+
+  // Make room for at least _m rows, without changing the size.  A
+  // matrix with no columns does not know the length of its rows yet,
+  // so this does nothing for it: use reserve(_m,_n) instead.
+  void reserve(size_type _m)
+    {
+      static_assert(is_row_major,
+		    "jlt::matrix: reserve requires row-major storage.");
+
+      if (_m > capacity()) reallocate(_m*n);
+    }
+
+  // Make room for at least _m rows of _n columns.  A matrix with no
+  // rows takes _n as its number of columns; otherwise _n must be
+  // columns().
+  void reserve(size_type _m, size_type _n)
+    {
+      static_assert(is_row_major,
+		    "jlt::matrix: reserve requires row-major storage.");
+
+      if (m == 0 && start == finish) n = _n;
+      else if (_n != n)
+	JLT_THROW(std::length_error("Size mismatch in jlt::matrix."));
+
+      reserve(_m);
+    }
+
+  // Give back the storage beyond the last row.
+  void shrink_to_fit()
+    {
+      if (end_of_storage != finish) reallocate(size());
+    }
+
+  // Append a row, from any container with size() and begin().  The
+  // first row appended to an empty matrix sets the number of columns.
+  template<class V>
+  void push_back_row(const V& r)
+    {
+      static_assert(is_row_major,
+		    "jlt::matrix: push_back_row requires row-major storage.");
+
+      if (m == 0 && start == finish) n = r.size();
+      if (r.size() != n || n == 0)
+	JLT_THROW(std::length_error("Size mismatch in jlt::matrix."));
+
+      if ((size_type)(end_of_storage - finish) < n)
+	{
+	  size_type cap = capacity();
+	  reallocate((cap == 0 ? 1 : 2*cap)*n);
+	}
+
+      auto x = r.begin();
+      for (size_type j = 0; j < n; ++j, ++x, ++finish)
+	alloc_traits::construct(alloc,finish,*x);
+      ++m;
+    }
+
+  // example: A.push_back_row({1,2,3})
+  void push_back_row(std::initializer_list<T> r)
+    {
+      push_back_row<std::initializer_list<T>>(r);
+    }
+
+  // Remove the last row, keeping the storage.
+  void pop_back_row()
+    {
+      static_assert(is_row_major,
+		    "jlt::matrix: pop_back_row requires row-major storage.");
+      MATRIX_ASSERT(m > 0);
+
+      for (size_type j = 0; j < n; ++j) alloc_traits::destroy(alloc,--finish);
+      --m;
+    }
+
   //
   // Transpose
   //
-  const matrix<T>& transpose()
+  // Transpose the matrix.  Square matrices are transposed in place;
+  // otherwise the transpose is built in a new buffer.  Large matrices
+  // are transposed by at most nthreads threads of the library's pool
+  // (all of them if nthreads is zero; see thread_pool.hpp).
+  const matrix<T,Alloc,Order>& transpose(unsigned nthreads = 0)
     {
-      if (rows() == columns())
+      if (m == n)
 	{
-	  // Square: do transpose "in place"
-	  for (size_type i = 0; i < rows()-1; ++i)
-	    {
-	      for (size_type j = i+1; j < columns(); ++j)
-		{
-		  T temp = (*this)(j,i);
-		  (*this)(j,i) = (*this)(i,j);
-		  (*this)(i,j) = temp;
-		}
-	    }
+	  transpose_square(start,n,n,nthreads);
 	}
       else
 	{
-	  // Not square: use temporary matrix.
-
-	  std::cerr << "transpose(): Not implemented for nonsquare matrices yet.\n";
+	  matrix<T,Alloc,Order> At(n,m,default_init);
+	  transpose_copy(start,storage_rows(),storage_columns(),
+			 storage_columns(),At.start,storage_rows(),nthreads);
+	  swap(At);
 	}
 
       return *this;
     }
 
+  // Transpose without allocating a second buffer, even if the matrix
+  // is not square.  This is slower than transpose() for nonsquare
+  // matrices (see transpose_in_place in transpose.hpp).
+  const matrix<T,Alloc,Order>& transpose_in_place()
+    {
+      jlt::transpose_in_place(start,storage_rows(),storage_columns());
+      std::swap(m,n);
+
+      return *this;
+    }
+
+  // Put the transpose of the matrix in At, reusing At's buffer if it
+  // has the right number of elements.
+  matrix<T,Alloc,Order>& transpose(matrix<T,Alloc,Order>& At,
+				   unsigned nthreads = 0) const
+    {
+      if (At.start == nullptr || At.size() != size())
+	{
+	  matrix<T,Alloc,Order> tmp(n,m,default_init);
+	  At.swap(tmp);
+	}
+      At.m = n;
+      At.n = m;
+      transpose_copy(start,storage_rows(),storage_columns(),
+		     storage_columns(),At.start,storage_rows(),nthreads);
+
+      return At;
+    }
+
   //
   // Output
   //
 
   // The default printing style is on one line.
+  // Output is always row by row, whatever the storage order.
   std::ostream& printOn(std::ostream& strm) const
     {
-      if (start == nullptr) return strm;
+      if (empty()) return strm;
+
+      if (!is_row_major) return view().printOn(strm);
 
       for (const_iterator i = start; i != finish-1; ++i)
 	{
@@ -352,7 +710,9 @@ public:
 
   std::ostream& printMatrixForm(std::ostream& strm) const
     {
-      if (start == nullptr) return strm;
+      if (empty()) return strm;
+
+      if (!is_row_major) return view().printMatrixForm(strm);
 
       for (const_iterator i = start; i != finish; i += n) {
 	for (const_iterator j = i; j != i+n-1; ++j)
@@ -369,7 +729,7 @@ public:
 				     const std::string name = "",
 				     const std::string comment = "") const
     {
-      if (start == 0) return strm;
+      if (empty()) return strm;
 
       // Print comment if specified.
       if (!comment.empty()) strm << "(* " << comment << " *)" << std::endl;
@@ -378,16 +738,16 @@ public:
       if (!name.empty()) strm << name << " = ";
 
       strm << "{";
-      for (const_iterator i = start; i != finish; i += n) {
+      for (size_type i = 0; i < m; ++i) {
 	strm << "{";
-	for (const_iterator j = i; j != i+n-1; ++j)
+	for (size_type j = 0; j < n-1; ++j)
 	  {
-	    strm << *j << ",";
+	    strm << (*this)(i,j) << ",";
 	  }
-	if (i != finish-n)
-	  strm << *(i+n-1) << "},";
+	if (i != m-1)
+	  strm << (*this)(i,n-1) << "},";
 	else
-	  strm << *(i+n-1) << "}";
+	  strm << (*this)(i,n-1) << "}";
       }
       // Don't append newline, since in Mathematica it is common to
       // write on same line.
@@ -414,25 +774,37 @@ public:
 
 };
 
-template<class T>
-std::ostream& operator<<(std::ostream& strm, const matrix<T>& M)
+template<class T, class Alloc, class Order>
+std::ostream& operator<<(std::ostream& strm, const matrix<T,Alloc,Order>& M)
 {
   return (M.printOn(strm));
 }
 
 // Read M.size() = m*n elements from strm, overwriting content of M.
 // Works if matrix is in row/column or single row format.
-template<class T>
-std::istream& operator>>(std::istream& strm, matrix<T>& M)
+// The elements are read row by row, whatever the storage order.
+template<class T, class Alloc, class Order>
+std::istream& operator>>(std::istream& strm, matrix<T,Alloc,Order>& M)
 {
-  for (auto i = M.begin(); i != M.end(); ++i)
-    {
-      strm >> *i;
-    }
+  for (size_t i = 0; i < M.rows(); ++i)
+    for (size_t j = 0; j < M.columns(); ++j)
+      {
+	strm >> M(i,j);
+      }
 
   return strm;
 }
 
+template<class T, class Alloc, class Order>
+inline void swap(matrix<T,Alloc,Order>& A, matrix<T,Alloc,Order>& B) noexcept
+{
+  A.swap(B);
+}
+
+// Column-major matrix, for passing to Fortran or Matlab without copying.
+template<class T, class Alloc = aligned_allocator<T>>
+using colmajor_matrix = matrix<T,Alloc,column_major>;
+
 } // namespace jlt
 
 #endif // JLT_MATRIX_HPP
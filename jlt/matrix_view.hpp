@@ -0,0 +1,418 @@
+//
+// Copyright (c) 2004-2020 Jean-Luc Thiffeault <jeanluc@mailaps.org>
+//
+// See the file LICENSE for copying permission.
+//
+
+#ifndef JLT_MATRIX_VIEW_HPP
+#define JLT_MATRIX_VIEW_HPP
+
+//
+// matrix_view.hpp
+//
+
+// Non-owning views into strided data: vector_view for rows, columns
+// and diagonals, matrix_view for rectangular blocks.  Neither copies
+// or frees anything, so a view must not outlive the matrix it refers
+// to.
+//
+// Element (i,j) of a matrix_view lives at data()[i*rs + j*cs], where
+// rs is the row stride (the "leading dimension" for row-major data)
+// and cs the column stride.  A view of a whole row-major matrix has
+// rs = columns() and cs = 1.  Swapping the strides gives a transposed
+// view, again without moving any data.
+//
+// Copying a view gives another view of the same data.  Assigning to a
+// view, on the other hand, copies elements into the data it refers to
+// (like std::slice_array), so that e.g.
+//
+//   A.block(0,0,2,2) = B.block(2,2,2,2);
+//
+// copies a 2x2 block of B into the top-left corner of A.
+
+#include <iostream>
+#include <iterator>
+#include <cstddef>
+#include <type_traits>
+#include <jlt/exceptions.hpp>
+
+#ifdef MATRIX_BOUNDS_CHECK
+#  define MATRIX_CHECK_BOUNDS
+#endif
+
+namespace jlt {
+
+//
+// Random-access iterator with a constant stride.
+//
+template<class T>
+class strided_iterator
+{
+public:
+  using iterator_category = std::random_access_iterator_tag;
+  using value_type = typename std::remove_const<T>::type;
+  using difference_type = std::ptrdiff_t;
+  using pointer = T *;
+  using reference = T &;
+
+private:
+  pointer p{nullptr};
+  difference_type s{1};
+
+public:
+  strided_iterator() {}
+  strided_iterator(pointer _p, difference_type _s) : p(_p), s(_s) {}
+
+  // Allow conversion from iterator to const_iterator.
+  template<class U,
+	   class = typename std::enable_if<std::is_convertible<U*,T*>::value>::type>
+  strided_iterator(const strided_iterator<U>& it)
+    : p(it.base()), s(it.stride()) {}
+
+  [[nodiscard]] pointer base() const { return p; }
+  [[nodiscard]] difference_type stride() const { return s; }
+
+  reference operator*() const { return *p; }
+  pointer operator->() const { return p; }
+  reference operator[](difference_type k) const { return p[k*s]; }
+
+  strided_iterator& operator++() { p += s; return *this; }
+  strided_iterator& operator--() { p -= s; return *this; }
+  strided_iterator operator++(int) { auto t = *this; p += s; return t; }
+  strided_iterator operator--(int) { auto t = *this; p -= s; return t; }
+  strided_iterator& operator+=(difference_type k) { p += k*s; return *this; }
+  strided_iterator& operator-=(difference_type k) { p -= k*s; return *this; }
+
+  friend strided_iterator operator+(strided_iterator it, difference_type k)
+    { return it += k; }
+  friend strided_iterator operator+(difference_type k, strided_iterator it)
+    { return it += k; }
+  friend strided_iterator operator-(strided_iterator it, difference_type k)
+    { return it -= k; }
+  friend difference_type operator-(const strided_iterator& a,
+				   const strided_iterator& b)
+    { return (a.p - b.p)/a.s; }
+
+  friend bool operator==(const strided_iterator& a, const strided_iterator& b)
+    { return a.p == b.p; }
+  friend bool operator!=(const strided_iterator& a, const strided_iterator& b)
+    { return a.p != b.p; }
+  friend bool operator<(const strided_iterator& a, const strided_iterator& b)
+    { return (a.s > 0 ? a.p < b.p : a.p > b.p); }
+  friend bool operator>(const strided_iterator& a, const strided_iterator& b)
+    { return b < a; }
+  friend bool operator<=(const strided_iterator& a, const strided_iterator& b)
+    { return !(b < a); }
+  friend bool operator>=(const strided_iterator& a, const strided_iterator& b)
+    { return !(a < b); }
+};
+
+
+//
+// class vector_view
+//
+
+template<class T>
+class vector_view
+{
+public:
+  using value_type = typename std::remove_const<T>::type;
+  using pointer = T *;
+  using reference = T &;
+  using const_reference = const T &;
+  using iterator = strided_iterator<T>;
+  using const_iterator = strided_iterator<const T>;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+
+private:
+  pointer	start;
+  size_type	n;
+  difference_type	s;
+
+public:
+  vector_view(pointer _p, size_type _n, difference_type _s = 1)
+    : start(_p), n(_n), s(_s) {}
+
+  // A view of non-const data converts to a view of const data.
+  template<class U,
+	   class = typename std::enable_if<std::is_convertible<U*,T*>::value>::type>
+  vector_view(const vector_view<U>& v)
+    : start(v.data()), n(v.size()), s(v.stride()) {}
+
+  vector_view(const vector_view& v) = default;
+
+  //
+  // Element access.
+  //
+
+  reference operator[](size_type i) const
+    {
+#ifdef MATRIX_CHECK_BOUNDS
+      return at(i);
+#else
+      return start[i*s];
+#endif
+    }
+
+  reference at(size_type i) const
+    {
+      if (i >= n)
+	JLT_THROW(std::out_of_range("Out of range exception in jlt::vector_view."));
+
+      return start[i*s];
+    }
+
+  [[nodiscard]] pointer data() const { return start; }
+  [[nodiscard]] size_type size() const { return n; }
+  [[nodiscard]] difference_type stride() const { return s; }
+  [[nodiscard]] bool empty() const { return (n == 0); }
+
+  //
+  // Iterators
+  //
+
+  iterator begin() const { return iterator(start,s); }
+  iterator end() const { return iterator(start + n*s,s); }
+  const_iterator cbegin() const { return const_iterator(start,s); }
+  const_iterator cend() const { return const_iterator(start + n*s,s); }
+
+  //
+  // Assignment copies elements into the viewed data.
+  //
+
+  vector_view& operator=(const vector_view& v)
+    {
+      return assign(v);
+    }
+
+  template<class V, class = typename std::enable_if<
+		       !std::is_convertible<V,value_type>::value>::type>
+  vector_view& operator=(const V& v)
+    {
+      return assign(v);
+    }
+
+  vector_view& operator=(const value_type& x)
+    {
+      for (size_type i = 0; i < n; ++i) start[i*s] = x;
+
+      return *this;
+    }
+
+  std::ostream& printOn(std::ostream& strm) const
+    {
+      if (n == 0) return strm;
+
+      for (size_type i = 0; i < n-1; ++i) strm << start[i*s] << "\t";
+      strm << start[(n-1)*s];	// To avoid dangling tab.
+
+      return strm;
+    }
+
+private:
+  template<class V>
+  vector_view& assign(const V& v)
+    {
+      if (v.size() != n)
+	JLT_THROW(std::length_error("Size mismatch in jlt::vector_view."));
+
+      auto j = v.begin();
+      for (size_type i = 0; i < n; ++i, ++j) start[i*s] = *j;
+
+      return *this;
+    }
+};
+
+
+//
+// class matrix_view
+//
+
+template<class T>
+class matrix_view
+{
+public:
+  using value_type = typename std::remove_const<T>::type;
+  using pointer = T *;
+  using reference = T &;
+  using const_reference = const T &;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+
+private:
+  pointer	start;
+  size_type	m, n;			// Number of rows, columns.
+  difference_type	rs, cs;		// Row and column strides.
+
+public:
+  matrix_view(pointer _p, size_type _m, size_type _n,
+	      difference_type _rs, difference_type _cs = 1)
+    : start(_p), m(_m), n(_n), rs(_rs), cs(_cs) {}
+
+  // A view of non-const data converts to a view of const data.
+  template<class U,
+	   class = typename std::enable_if<std::is_convertible<U*,T*>::value>::type>
+  matrix_view(const matrix_view<U>& V)
+    : start(V.data()), m(V.rows()), n(V.columns()),
+      rs(V.row_stride()), cs(V.column_stride()) {}
+
+  matrix_view(const matrix_view& V) = default;
+
+  //
+  // Element access.
+  //
+
+  reference operator()(size_type i, size_type j) const
+    {
+#ifdef MATRIX_CHECK_BOUNDS
+      return at(i,j);
+#else
+      return start[i*rs + j*cs];
+#endif
+    }
+
+  reference at(size_type i, size_type j) const
+    {
+      if (i >= m || j >= n)
+	JLT_THROW(std::out_of_range("Out of range exception in jlt::matrix_view."));
+
+      return start[i*rs + j*cs];
+    }
+
+  [[nodiscard]] pointer data() const { return start; }
+
+  [[nodiscard]] size_type size() const { return m*n; }
+  [[nodiscard]] size_type dim() const { return n; }
+  [[nodiscard]] size_type rows() const { return m; }
+  [[nodiscard]] size_type columns() const { return n; }
+
+  [[nodiscard]] difference_type row_stride() const { return rs; }
+  [[nodiscard]] difference_type column_stride() const { return cs; }
+  // For row-major data with unit column stride.
+  [[nodiscard]] difference_type leading_dimension() const { return rs; }
+
+  [[nodiscard]] bool empty() const { return (m == 0 || n == 0); }
+  [[nodiscard]] bool isSquare() const { return (m == n); }
+
+  //
+  // Subviews
+  //
+
+  [[nodiscard]] vector_view<T> row(size_type i) const
+    {
+      return vector_view<T>(start + i*rs,n,cs);
+    }
+
+  [[nodiscard]] vector_view<T> column(size_type j) const
+    {
+      return vector_view<T>(start + j*cs,m,rs);
+    }
+
+  [[nodiscard]] vector_view<T> diagonal() const
+    {
+      return vector_view<T>(start,(m < n ? m : n),rs+cs);
+    }
+
+  // The _m by _n block with top-left corner at (i,j).
+  [[nodiscard]] matrix_view<T> block(size_type i, size_type j,
+				     size_type _m, size_type _n) const
+    {
+#ifdef MATRIX_CHECK_BOUNDS
+      if (i+_m > m || j+_n > n)
+	JLT_THROW(std::out_of_range("Out of range exception in jlt::matrix_view."));
+#endif
+      return matrix_view<T>(start + i*rs + j*cs,_m,_n,rs,cs);
+    }
+
+  // Transposed view of the same data.
+  [[nodiscard]] matrix_view<T> transpose() const
+    {
+      return matrix_view<T>(start,n,m,cs,rs);
+    }
+
+  //
+  // Assignment copies elements into the viewed data.
+  //
+
+  matrix_view& operator=(const matrix_view& V)
+    {
+      return assign(V);
+    }
+
+  template<class M, class = typename std::enable_if<
+		       !std::is_convertible<M,value_type>::value>::type>
+  matrix_view& operator=(const M& V)
+    {
+      return assign(V);
+    }
+
+  matrix_view& operator=(const value_type& x)
+    {
+      for (size_type i = 0; i < m; ++i)
+	for (size_type j = 0; j < n; ++j) start[i*rs + j*cs] = x;
+
+      return *this;
+    }
+
+  //
+  // Output
+  //
+
+  // The default printing style is on one line.
+  std::ostream& printOn(std::ostream& strm) const
+    {
+      if (empty()) return strm;
+
+      for (size_type i = 0; i < m; ++i)
+	for (size_type j = 0; j < n; ++j)
+	  {
+	    strm << (*this)(i,j);
+	    if (i != m-1 || j != n-1) strm << "\t";	// No dangling tab.
+	  }
+
+      return strm;
+    }
+
+  std::ostream& printMatrixForm(std::ostream& strm) const
+    {
+      if (empty()) return strm;
+
+      for (size_type i = 0; i < m; ++i)
+	{
+	  for (size_type j = 0; j < n-1; ++j) strm << (*this)(i,j) << "\t";
+	  strm << (*this)(i,n-1) << std::endl;	// To avoid dangling tab.
+	}
+
+      return strm;
+    }
+
+private:
+  template<class M>
+  matrix_view& assign(const M& V)
+    {
+      if (V.rows() != m || V.columns() != n)
+	JLT_THROW(std::length_error("Size mismatch in jlt::matrix_view."));
+
+      for (size_type i = 0; i < m; ++i)
+	for (size_type j = 0; j < n; ++j) start[i*rs + j*cs] = V(i,j);
+
+      return *this;
+    }
+};
+
+template<class T>
+std::ostream& operator<<(std::ostream& strm, const vector_view<T>& v)
+{
+  return v.printOn(strm);
+}
+
+template<class T>
+std::ostream& operator<<(std::ostream& strm, const matrix_view<T>& V)
+{
+  return V.printOn(strm);
+}
+
+} // namespace jlt
+
+#endif // JLT_MATRIX_VIEW_HPP
@@ -0,0 +1,432 @@
+//
+// Copyright (c) 2004-2020 Jean-Luc Thiffeault <jeanluc@mailaps.org>
+//
+// See the file LICENSE for copying permission.
+//
+
+#ifndef JLT_MATRIXFUNC_HPP
+#define JLT_MATRIXFUNC_HPP
+
+//
+// matrixfunc.hpp
+//
+
+// Powers and exponentials of square mathmatrices.
+//
+//   pow(A,k)     A^k for an unsigned integer k, by binary
+//                exponentiation: about 2 log2(k) products.
+//   expm(A)      exp(A), by scaling and squaring with a diagonal Pade
+//                approximant of degree 3, 5, 7, 9 or 13, chosen from
+//                the 1-norm of A (Higham, SIAM J. Matrix Anal. Appl.
+//                26, 1179 (2005)).  The Pade denominator is solved for
+//                with LUdecomp and LUsolve.
+//
+// Each comes in four forms:
+//
+//   B = pow(A,k);                 // Returns a new matrix.
+//   pow(A,k,B);                   // Into B, reusing its storage.
+//   pow(A,k,B,ws);                // Scratch space from ws as well.
+//   pow_in_place(A,k,ws);         // A = A^k.
+//
+// and the same for expm.  A matrix_workspace holds the scratch
+// matrices, allocated on first use and kept for later calls with the
+// same size, so that in a time-stepping loop
+//
+//   jlt::matrix_workspace<mathmatrix<double>> ws;
+//   for (...) { jlt::expm(dt*L, P, ws); x = P*x; }
+//
+// allocates nothing after the first step.  The products themselves
+// are computed by gemm_product into the preallocated buffers, which
+// are exchanged (ping-pong) rather than copied.
+
+#include <cstddef>
+#include <cmath>
+#include <complex>
+#include <limits>
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <jlt/mathmatrix.hpp>
+#include <jlt/matrixutil.hpp>
+
+namespace jlt {
+
+//
+// class matrix_workspace
+//
+
+// Scratch matrices and vectors for the functions of this file.
+template<class Matrix>
+class matrix_workspace
+{
+public:
+  using value_type = typename Matrix::value_type;
+  using size_type = typename Matrix::size_type;
+
+private:
+  std::deque<Matrix> buf;	// Growing keeps references valid.
+  std::vector<int> piv;
+
+public:
+  // The k-th scratch matrix, with n rows and columns.  Its contents
+  // are undefined.
+  Matrix& operator()(size_type k, size_type n)
+    {
+      if (buf.size() <= k) buf.resize(k+1);
+      if (buf[k].rows() != n || buf[k].columns() != n)
+	{
+	  Matrix tmp(n,n,default_init);
+	  buf[k].swap(tmp);
+	}
+      return buf[k];
+    }
+
+  // Pivot indices for an n by n matrix.
+  int* pivots(size_type n) { piv.resize(n); return piv.data(); }
+};
+
+namespace matrixfunc_detail {
+
+template<class Matrix>
+inline void resize_square(Matrix& A, typename Matrix::size_type n)
+{
+  if (A.rows() != n || A.columns() != n)
+    {
+      Matrix tmp(n,n,default_init);
+      A.swap(tmp);
+    }
+}
+
+template<class Matrix>
+inline void set_identity(Matrix& A)
+{
+  for (typename Matrix::size_type i = 0; i < A.rows(); ++i)
+    for (typename Matrix::size_type j = 0; j < A.columns(); ++j)
+      A(i,j) = (i == j ? 1 : 0);
+}
+
+// Maximum absolute column sum.
+template<class Matrix>
+inline auto norm1(const Matrix& A)
+{
+  using std::abs;
+  using R = decltype(abs(A(0,0)));
+
+  std::vector<R> sum(A.columns(),R(0));
+  for (typename Matrix::size_type i = 0; i < A.rows(); ++i)
+    for (typename Matrix::size_type j = 0; j < A.columns(); ++j)
+      sum[j] += abs(A(i,j));
+  return (sum.empty() ? R(0) : *std::max_element(sum.begin(),sum.end()));
+}
+
+// C = sum of c[l]*P[l] for l < np, plus d times the identity.
+template<class Matrix, class R>
+inline void combine(Matrix& C, const Matrix* const P[], const R c[],
+		    std::size_t np, const R& d)
+{
+  using T = typename Matrix::value_type;
+  const auto n = C.rows();
+
+  for (typename Matrix::size_type i = 0; i < n; ++i)
+    for (typename Matrix::size_type j = 0; j < n; ++j)
+      {
+	T s = (i == j ? T(d) : T(0));
+	for (std::size_t l = 0; l < np; ++l) s += T(c[l])*(*P[l])(i,j);
+	C(i,j) = s;
+      }
+}
+
+} // namespace matrixfunc_detail
+
+//
+// Matrix power
+//
+
+// Ak = A^k.  Ak must not be A; it is resized if need be.
+template<class T, class S, class Alloc, class Order>
+mathmatrix<T,S,Alloc,Order>&
+pow(const mathmatrix<T,S,Alloc,Order>& A, unsigned long k,
+    mathmatrix<T,S,Alloc,Order>& Ak,
+    matrix_workspace<mathmatrix<T,S,Alloc,Order>>& ws)
+{
+  using namespace matrixfunc_detail;
+
+  MATRIX_ASSERT(A.isSquare() && &A != &Ak);
+  const auto n = A.rows();
+
+  resize_square(Ak,n);
+
+  if (k == 0) { set_identity(Ak); return Ak; }
+
+  // Squares of A in P, the product of those for the set bits of k in
+  // Ak; each product goes to tmp and is swapped in.
+  auto& P = ws(0,n);
+  auto& tmp = ws(1,n);
+  bool first = true;
+  P = A;
+
+  for (;;)
+    {
+      if (k & 1)
+	{
+	  if (first) Ak = P;
+	  else { gemm_product(tmp,Ak,P); Ak.swap(tmp); }
+	  first = false;
+	}
+      k >>= 1;
+      if (k == 0) break;
+      gemm_product(tmp,P,P);
+      P.swap(tmp);
+    }
+
+  return Ak;
+}
+
+template<class T, class S, class Alloc, class Order>
+inline mathmatrix<T,S,Alloc,Order>&
+pow(const mathmatrix<T,S,Alloc,Order>& A, unsigned long k,
+    mathmatrix<T,S,Alloc,Order>& Ak)
+{
+  matrix_workspace<mathmatrix<T,S,Alloc,Order>> ws;
+  return pow(A,k,Ak,ws);
+}
+
+template<class T, class S, class Alloc, class Order>
+[[nodiscard]] inline mathmatrix<T,S,Alloc,Order>
+pow(const mathmatrix<T,S,Alloc,Order>& A, unsigned long k)
+{
+  mathmatrix<T,S,Alloc,Order> Ak;
+  pow(A,k,Ak);
+  return Ak;
+}
+
+// A = A^k.
+template<class T, class S, class Alloc, class Order>
+inline mathmatrix<T,S,Alloc,Order>&
+pow_in_place(mathmatrix<T,S,Alloc,Order>& A, unsigned long k,
+	     matrix_workspace<mathmatrix<T,S,Alloc,Order>>& ws)
+{
+  auto& Ak = ws(2,A.rows());
+  pow(A,k,Ak,ws);
+  A.swap(Ak);
+  return A;
+}
+
+template<class T, class S, class Alloc, class Order>
+inline mathmatrix<T,S,Alloc,Order>&
+pow_in_place(mathmatrix<T,S,Alloc,Order>& A, unsigned long k)
+{
+  matrix_workspace<mathmatrix<T,S,Alloc,Order>> ws;
+  return pow_in_place(A,k,ws);
+}
+
+//
+// Matrix exponential
+//
+
+// E = exp(A).  E must not be A; it is resized if need be.
+template<class T, class S, class Alloc, class Order>
+mathmatrix<T,S,Alloc,Order>&
+expm(const mathmatrix<T,S,Alloc,Order>& A,
+     mathmatrix<T,S,Alloc,Order>& E,
+     matrix_workspace<mathmatrix<T,S,Alloc,Order>>& ws)
+{
+  using namespace matrixfunc_detail;
+  using M = mathmatrix<T,S,Alloc,Order>;
+  using R = decltype(norm1(A));
+  using std::ldexp;
+
+  MATRIX_ASSERT(A.isSquare() && &A != &E);
+  const auto n = A.rows();
+
+  resize_square(E,n);
+  if (n == 0) return E;
+
+  // Coefficients of the Pade approximants, b[0] to b[m].
+  static const R b3[] = {120, 60, 12, 1};
+  static const R b5[] = {30240, 15120, 3360, 420, 30, 1};
+  static const R b7[] = {17297280, 8648640, 1995840, 277200, 25200, 1512,
+			 56, 1};
+  static const R b9[] = {17643225600., 8821612800., 2075673600., 302702400.,
+			 30270240, 2162160, 110880, 3960, 90, 1};
+  static const R b13[] = {64764752532480000., 32382376266240000.,
+			  7771770303897600., 1187353796428800.,
+			  129060195264000., 10559470521600., 670442572800.,
+			  33522128640., 1323241920., 40840800., 960960.,
+			  16380., 182., 1.};
+
+  // Largest 1-norms for which each degree is accurate to unit
+  // roundoff, in double and single precision.
+  const bool single = (std::numeric_limits<R>::digits <= 24);
+  const R theta_d[] = {1.495585217958292e-2, 2.539398330063230e-1,
+		       9.504178996162932e-1, 2.097847961257068e0,
+		       5.371920351148152e0};
+  const R theta_s[] = {4.258730016922831e-1, 1.880152677804762e0,
+		       3.925724783138660e0};
+  const R* theta = (single ? theta_s : theta_d);
+  const int degrees[] = {3, 5, 7, 9, 13};
+  const int nlow = (single ? 2 : 4);	// Degrees tried without scaling.
+  const int mtop = (single ? 7 : 13);	// Degree used with scaling.
+  const R thetatop = (single ? theta_s[2] : theta_d[4]);
+  const R* btop = (single ? b7 : b13);
+
+  const R a1 = norm1(A);
+
+  M& A2 = ws(0,n);
+  M& U = ws(1,n);
+  M& V = ws(2,n);
+  M& tmp = ws(3,n);
+
+  int m = 0, s = 0;
+  for (int d = 0; d < nlow; ++d)
+    {
+      if (a1 <= theta[d]) { m = degrees[d]; break; }
+    }
+
+  const M* P[4];
+  R cu[4], cv[4];
+
+  if (m != 0)
+    {
+      // Unscaled, with degree m <= 9: powers A2, A4, ... of A.
+      const R* b = (m == 3 ? b3 : m == 5 ? b5 : m == 7 ? b7 : b9);
+      M& A4 = ws(4,n);
+      M& A6 = ws(5,n);
+      M& A8 = ws(6,n);
+      M* Ap[] = {&A2, &A4, &A6, &A8};
+
+      gemm_product(A2,A,A);
+      for (int p = 1; 2*(p+1) <= m - 1; ++p) gemm_product(*Ap[p],*Ap[p-1],A2);
+
+      const int np = (m - 1)/2;
+      for (int p = 0; p < np; ++p)
+	{
+	  P[p] = Ap[p];
+	  cu[p] = b[2*p+3];
+	  cv[p] = b[2*p+2];
+	}
+      combine(tmp,P,cu,np,b[1]);
+      gemm_product(U,A,tmp);
+      combine(V,P,cv,np,b[0]);
+    }
+  else
+    {
+      // Scale A by 2^-s so that its norm is below thetatop.
+      m = mtop;
+      if (a1 > thetatop)
+	s = std::max(0,(int)std::ceil(std::log2(a1/thetatop)));
+      M& As = ws(4,n);
+      const T scale = T(ldexp(R(1),-s));
+      for (typename M::size_type i = 0; i < n; ++i)
+	for (typename M::size_type j = 0; j < n; ++j) As(i,j) = scale*A(i,j);
+
+      const R* b = btop;
+
+      if (m == 13)
+	{
+	  M& A4 = ws(5,n);
+	  M& A6 = ws(6,n);
+	  gemm_product(A2,As,As);
+	  gemm_product(A4,A2,A2);
+	  gemm_product(A6,A4,A2);
+
+	  // U = As*(A6*(b13 A6 + b11 A4 + b9 A2) + b7 A6 + b5 A4 + b3 A2 + b1 I)
+	  P[0] = &A2; P[1] = &A4; P[2] = &A6;
+	  cu[0] = b[9]; cu[1] = b[11]; cu[2] = b[13];
+	  combine(V,P,cu,3,R(0));
+	  gemm_product(U,A6,V);
+	  cu[0] = b[3]; cu[1] = b[5]; cu[2] = b[7];
+	  P[3] = &U; cu[3] = 1;
+	  combine(tmp,P,cu,4,b[1]);
+	  gemm_product(U,As,tmp);
+
+	  // V = A6*(b12 A6 + b10 A4 + b8 A2) + b6 A6 + b4 A4 + b2 A2 + b0 I
+	  cv[0] = b[8]; cv[1] = b[10]; cv[2] = b[12];
+	  combine(tmp,P,cv,3,R(0));
+	  gemm_product(V,A6,tmp);
+	  cv[0] = b[2]; cv[1] = b[4]; cv[2] = b[6];
+	  P[3] = &V; cv[3] = 1;
+	  combine(tmp,P,cv,4,b[0]);
+	  V.swap(tmp);
+	}
+      else
+	{
+	  // Degree 7 for single precision.
+	  M& A4 = ws(5,n);
+	  M& A6 = ws(6,n);
+	  gemm_product(A2,As,As);
+	  gemm_product(A4,A2,A2);
+	  gemm_product(A6,A4,A2);
+	  P[0] = &A2; P[1] = &A4; P[2] = &A6;
+	  cu[0] = b[3]; cu[1] = b[5]; cu[2] = b[7];
+	  combine(tmp,P,cu,3,b[1]);
+	  gemm_product(U,As,tmp);
+	  cv[0] = b[2]; cv[1] = b[4]; cv[2] = b[6];
+	  combine(V,P,cv,3,b[0]);
+	}
+    }
+
+  // Solve (V - U) E = (V + U): tmp = V - U, factored in place, and
+  // E = V + U, overwritten by the solution.
+  for (typename M::size_type i = 0; i < n; ++i)
+    for (typename M::size_type j = 0; j < n; ++j)
+      {
+	tmp(i,j) = V(i,j) - U(i,j);
+	E(i,j) = V(i,j) + U(i,j);
+      }
+
+  int perm;
+  int *row_index = ws.pivots(n);
+  LUdecomp<T,M>(tmp,row_index,&perm);
+  LUsolve<T>(tmp,row_index,E);
+
+  // Undo the scaling by squaring s times.
+  for (int q = 0; q < s; ++q)
+    {
+      gemm_product(tmp,E,E);
+      E.swap(tmp);
+    }
+
+  return E;
+}
+
+template<class T, class S, class Alloc, class Order>
+inline mathmatrix<T,S,Alloc,Order>&
+expm(const mathmatrix<T,S,Alloc,Order>& A, mathmatrix<T,S,Alloc,Order>& E)
+{
+  matrix_workspace<mathmatrix<T,S,Alloc,Order>> ws;
+  return expm(A,E,ws);
+}
+
+template<class T, class S, class Alloc, class Order>
+[[nodiscard]] inline mathmatrix<T,S,Alloc,Order>
+expm(const mathmatrix<T,S,Alloc,Order>& A)
+{
+  mathmatrix<T,S,Alloc,Order> E;
+  expm(A,E);
+  return E;
+}
+
+// A = exp(A).
+template<class T, class S, class Alloc, class Order>
+inline mathmatrix<T,S,Alloc,Order>&
+expm_in_place(mathmatrix<T,S,Alloc,Order>& A,
+	      matrix_workspace<mathmatrix<T,S,Alloc,Order>>& ws)
+{
+  auto& E = ws(7,A.rows());
+  expm(A,E,ws);
+  A.swap(E);
+  return A;
+}
+
+template<class T, class S, class Alloc, class Order>
+inline mathmatrix<T,S,Alloc,Order>&
+expm_in_place(mathmatrix<T,S,Alloc,Order>& A)
+{
+  matrix_workspace<mathmatrix<T,S,Alloc,Order>> ws;
+  return expm_in_place(A,ws);
+}
+
+} // namespace jlt
+
+#endif // JLT_MATRIXFUNC_HPP
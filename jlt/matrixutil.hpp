@@ -10,6 +10,14 @@
 #include <iostream>
 #include <algorithm>
 #include <cmath>
+#include <utility>
+#include <vector>
+#include <jlt/transposed.hpp>
+#include <jlt/gemm.hpp>
+#include <jlt/thread_pool.hpp>
+#ifdef JLT_USE_LAPACK
+#  include <jlt/lapack.hpp>
+#endif
 
 #ifndef MATRIX_ASSERT
 #  define MATRIX_ASSERT(x)
@@ -17,73 +25,201 @@
 
 namespace jlt {
 
-template<class T, class T_Matrix>
-void LUdecomp(T_Matrix& A, int* row_index, int* perm)
+//
+// LU decomposition
+//
+
+// LUdecomp(A, row_index, &perm) overwrites the square matrix A with
+// its LU factors, with partial pivoting: the unit lower-triangular L
+// below the diagonal and U on and above it.  Row j was interchanged
+// with row row_index[j] >= j at step j (as LAPACK's ipiv, from zero),
+// and perm is +1 or -1 for an even or odd number of interchanges.
+// Pivots are chosen with implicit row scaling: the largest element of
+// the column relative to the largest of its row.  A zero pivot is
+// replaced by a tiny number, and a zero row throws.
+//
+// The factorisation is blocked and right-looking.  Each panel of
+// JLT_LU_BLOCK columns is factored with rank-1 updates, the rows of U
+// to its right are found by a triangular solve, and the trailing
+// submatrix is updated by one product of the panel with those rows.
+// For float, double and complex matrices that product is the packed
+// gemm() of gemm.hpp (or BLAS with JLT_USE_BLAS), which carries almost
+// all of the 2n^3/3 operations.  The rank-1 updates run in parallel
+// over rows of the panel, and the triangular solves over columns of
+// the right-hand side.
+
+// Columns per panel.
+#ifndef JLT_LU_BLOCK
+#  define JLT_LU_BLOCK 64
+#endif
+
+namespace lu_detail {
+
+// Factor the panel of columns j0 to j1-1 in place, below row j0,
+// interchanging whole rows of A.
+template<class T, class T_Matrix, class R>
+void factor_panel(T_Matrix& A, int n, int j0, int j1,
+		  int* row_index, int* perm, std::vector<R>& vv)
 {
   using std::abs;
 
-  int	imax = 0;
-  int	n = A.dim();
-  T	big, dum, sum, temp;
-
   const T tiny = 1.e-20;
 
-  T* vv = new T[n];
+  for (int j = j0; j < j1; ++j)
+    {
+      // Scaled pivot: the last row with the largest scaled element.
+      R big = 0;
+      int imax = j;
+      for (int i = j; i < n; ++i)
+	{
+	  R dum = vv[i]*abs(A(i,j));
+	  if (dum >= big) { big = dum; imax = i; }
+	}
+      if (j != imax)
+	{
+	  for (int k = 0; k < n; ++k) std::swap(A(imax,k),A(j,k));
+	  *perm = -(*perm);
+	  vv[imax] = vv[j];
+	}
+      row_index[j] = imax;
+      if (A(j,j) == T(0)) A(j,j) = tiny;
+
+      const T dum = T(1)/A(j,j);
+      for (int i = j+1; i < n; ++i) A(i,j) *= dum;
+
+      // Rank-1 update of the rest of the panel.
+      if (j+1 == j1) continue;
+      parallel_for(j+1,n,JLT_PARALLEL_GRAIN/(j1-j) + 1,
+		   [&](std::size_t i0, std::size_t i1)
+		   {
+		     for (int i = (int)i0; i < (int)i1; ++i)
+		       {
+			 const T l = A(i,j);
+			 if (l == T(0)) continue;
+			 for (int k = j+1; k < j1; ++k) A(i,k) -= l*A(j,k);
+		       }
+		   });
+    }
+}
+
+// Rows j0 to j1-1 of U, to the right of the panel: solve L11 U12 = A12
+// with L11 unit lower-triangular, by columns in parallel.
+template<class T, class T_Matrix>
+void solve_panel_rows(T_Matrix& A, int n, int j0, int j1)
+{
+  const int nb = j1 - j0;
+
+  parallel_for(j1,n,JLT_PARALLEL_GRAIN/(nb*nb/2 + 1) + 1,
+	       [&](std::size_t c0, std::size_t c1)
+	       {
+		 for (int i = j0+1; i < j1; ++i)
+		   for (int k = j0; k < i; ++k)
+		     {
+		       const T l = A(i,k);
+		       if (l == T(0)) continue;
+		       for (int c = (int)c0; c < (int)c1; ++c) A(i,c) -= l*A(k,c);
+		     }
+	       });
+}
+
+// Can gemm() take M as an operand with elements of type T?
+template<class T, class M, class = void>
+struct is_gemm_block : std::false_type {};
+
+template<class T, class M>
+struct is_gemm_block<T,M,
+		     typename std::enable_if<is_gemm_operand<M>::value>::type>
+  : std::is_same<typename decltype(gemm_operand(std::declval<M&>()))::value_type,T>
+{};
+
+// Z(zi..zi+m-1, zj..zj+n-1) = alpha*X*Y + beta*Z, for the m by k block
+// of X at (xi,xj) and the k by n block of Y at (yi,yj).  The blocks of
+// Z must not overlap those of X and Y.  This is gemm() for float,
+// double and complex matrices or views, and a loop over rows of Z
+// otherwise.
+template<class T, class M_X, class M_Y, class M_Z>
+void block_gemm(const T& alpha, M_X& X, int xi, int xj,
+		M_Y& Y, int yi, int yj, const T& beta, M_Z& Z, int zi, int zj,
+		int m, int n, int k)
+{
+  if (m == 0 || n == 0 || (k == 0 && beta == T(1))) return;
+
+  if constexpr (is_gemm_block<T,M_X>::value && is_gemm_block<T,M_Y>::value &&
+		is_gemm_block<T,M_Z>::value)
+    {
+      gemm(alpha,gemm_operand(X).block(xi,xj,m,k),
+	   gemm_operand(Y).block(yi,yj,k,n),beta,
+	   gemm_operand(Z).block(zi,zj,m,n));
+    }
+  else
+    {
+      parallel_for(0,m,JLT_PARALLEL_GRAIN/((std::size_t)n*k + 1) + 1,
+		   [&](std::size_t i0, std::size_t i1)
+		   {
+		     for (int i = (int)i0; i < (int)i1; ++i)
+		       {
+			 if (beta != T(1))
+			   for (int c = 0; c < n; ++c)
+			     Z(zi+i,zj+c) = (beta == T(0) ? T(0) :
+					     beta*Z(zi+i,zj+c));
+			 for (int l = 0; l < k; ++l)
+			   {
+			     const T x = alpha*X(xi+i,xj+l);
+			     if (x == T(0)) continue;
+			     for (int c = 0; c < n; ++c)
+			       Z(zi+i,zj+c) += x*Y(yi+l,yj+c);
+			   }
+		       }
+		   });
+    }
+}
+
+// A22 -= L21*U12, for the trailing submatrix below and to the right of
+// the panel.
+template<class T, class T_Matrix>
+inline void update_trailing(T_Matrix& A, int n, int j0, int j1)
+{
+  block_gemm(T(-1),A,j1,j0,A,j0,j1,T(1),A,j1,j1,n-j1,n-j1,j1-j0);
+}
+
+} // namespace lu_detail
 
-  *perm=1;
+template<class T, class T_Matrix>
+void LUdecomp(T_Matrix& A, int* row_index, int* perm)
+{
+  using std::abs;
+  using R = decltype(abs(T()));
+
+  const int n = A.dim();
 
+  // Implicit scaling: the inverse of the largest element of each row.
+  std::vector<R> vv(n);
   for (int i = 0; i < n; ++i)
     {
-      big = 0.0;
-      for (int j = 0; j < n; ++j)
-	if (abs(temp = abs(A(i,j))) > abs(big)) big = temp;
-      if (big == 0.0)
+      R big = 0;
+      for (int j = 0; j < n; ++j) big = std::max(big,(R)abs(A(i,j)));
+      if (big == R(0))
 	{
 	  JLT_THROW(std::runtime_error("Singular Matrix in LUdecomp."));
 	}
-      vv[i]=1.0/big;
-    }
-  for (int j = 0; j < n; ++j) {
-    for (int i = 0; i < j; ++i) {
-      sum = A(i,j);
-      for (int k = 0; k < i ; ++k) sum -= A(i,k)*A(k,j);
-      A(i,j) = sum;
-    }
-    big = 0.0;
-    for (int i = j; i < n; ++i)
-      {
-	sum=A(i,j);
-	for (int k = 0; k < j; ++k)
-	  sum -= A(i,k)*A(k,j);
-	A(i,j) = sum;
-	if (abs(dum = vv[i]*abs(sum)) >= abs(big)) {
-	  big = dum;
-	  imax = i;
-	}
-      }
-    if (j != imax)
-      {
-	for (int k = 0; k < n; ++k)
-	  {
-	    dum = A(imax,k);
-	    A(imax,k) = A(j,k);
-	    A(j,k) = dum;
-	  }
-	*perm = -(*perm);
-	vv[imax] = vv[j];
-      }
-    row_index[j] = imax;
-    if (A(j,j) == 0.0) A(j,j) = tiny;
-    if (j != n) {
-      dum = 1.0/(A(j,j));
-      for (int i = j+1; i < n; ++i) A(i,j) *= dum;
+      vv[i] = R(1)/big;
+    }
+
+  *perm = 1;
+
+  for (int j0 = 0; j0 < n; j0 += JLT_LU_BLOCK)
+    {
+      const int j1 = std::min(n,j0 + JLT_LU_BLOCK);
+
+      lu_detail::factor_panel<T>(A,n,j0,j1,row_index,perm,vv);
+      if (j1 == n) break;
+      lu_detail::solve_panel_rows<T>(A,n,j0,j1);
+      lu_detail::update_trailing<T>(A,n,j0,j1);
     }
-  }
-  delete[] vv;
 }
 
 template<class T, class T_Matrix>
-void LUbacksub(T_Matrix& A, int* row_index, T* b)
+void LUbacksub(T_Matrix& A, const int* row_index, T* b)
 {
   using std::abs;
 
@@ -113,31 +249,724 @@ void LUbacksub(T_Matrix& A, int* row_index, T* b)
     }
 }
 
+// Solve trans(A) x = b (or adj(A) x = b) with the factors of A from
+// LUdecomp, without transposing them:
+//
+//   LUbacksub(trans(A), row_index, b);
+//
+// Both triangular solves are arranged so that the inner loops run
+// along rows of the factors.
+template<class T, class T_Matrix, bool Conj>
+void LUbacksub(const transposed<T_Matrix,Conj>& At, const int* row_index, T* b)
+{
+  int n = At.dim();
+
+  // trans(U) is lower-triangular.
+  for (int j = 0; j < n; ++j)
+    {
+      b[j] /= At(j,j);
+      for (int i = j+1; i < n; ++i) b[i] -= At(i,j)*b[j];
+    }
+
+  // trans(L) is upper-triangular, with unit diagonal.
+  for (int j = n-1; j > 0; --j)
+    for (int i = 0; i < j; ++i) b[i] -= At(i,j)*b[j];
+
+  // Undo the row interchanges, in reverse order.
+  for (int j = n-1; j >= 0; --j) std::swap(b[j],b[row_index[j]]);
+}
+
+//
+// Solves and inverse with the factors from LUdecomp
+//
+
+namespace lu_detail {
+
+// Solve L X = B in place, with L the lower triangle of A (with unit
+// diagonal if Unit), by blocks of JLT_LU_BLOCK rows.  Each block of
+// rows of X is solved for with the diagonal block of L, with columns
+// of B shared among threads, and then eliminated from the rows below
+// by a single product.
+template<bool Unit, class T, class T_Matrix, class T_RHS>
+void solve_lower(T_Matrix& A, T_RHS& B, int n, int r)
+{
+  const int nb = JLT_LU_BLOCK;
+  const std::size_t grain = JLT_PARALLEL_GRAIN/((std::size_t)nb*nb + 1) + 1;
+
+  for (int i0 = 0; i0 < n; i0 += nb)
+    {
+      const int i1 = std::min(n,i0 + nb);
+      parallel_for(0,r,grain,[&](std::size_t c0, std::size_t c1)
+		   {
+		     for (int i = i0; i < i1; ++i)
+		       {
+			 for (int k = i0; k < i; ++k)
+			   {
+			     const T l = A(i,k);
+			     if (l == T(0)) continue;
+			     for (int c = (int)c0; c < (int)c1; ++c)
+			       B(i,c) -= l*B(k,c);
+			   }
+			 if constexpr (!Unit)
+			   {
+			     const T d = T(1)/A(i,i);
+			     for (int c = (int)c0; c < (int)c1; ++c) B(i,c) *= d;
+			   }
+		       }
+		   });
+      block_gemm(T(-1),A,i1,i0,B,i0,0,T(1),B,i1,0,n-i1,r,i1-i0);
+    }
+}
+
+// Solve U X = B in place, with U the upper triangle of A, from the
+// last block of rows up.
+template<bool Unit, class T, class T_Matrix, class T_RHS>
+void solve_upper(T_Matrix& A, T_RHS& B, int n, int r)
+{
+  const int nb = JLT_LU_BLOCK;
+  const std::size_t grain = JLT_PARALLEL_GRAIN/((std::size_t)nb*nb + 1) + 1;
+
+  for (int i0 = ((n-1)/nb)*nb; i0 >= 0; i0 -= nb)
+    {
+      const int i1 = std::min(n,i0 + nb);
+      parallel_for(0,r,grain,[&](std::size_t c0, std::size_t c1)
+		   {
+		     for (int i = i1-1; i >= i0; --i)
+		       {
+			 for (int k = i+1; k < i1; ++k)
+			   {
+			     const T u = A(i,k);
+			     if (u == T(0)) continue;
+			     for (int c = (int)c0; c < (int)c1; ++c)
+			       B(i,c) -= u*B(k,c);
+			   }
+			 if constexpr (!Unit)
+			   {
+			     const T d = T(1)/A(i,i);
+			     for (int c = (int)c0; c < (int)c1; ++c) B(i,c) *= d;
+			   }
+		       }
+		   });
+      block_gemm(T(-1),A,0,i0,B,i0,0,T(1),B,0,0,i0,r,i1-i0);
+    }
+}
+
+} // namespace lu_detail
+
+// Solve A X = B for the n by r matrix B, overwriting B with X, given
+// the factors of A from LUdecomp.  B may be a matrix or a view.  The
+// substitutions are blocked as in LUdecomp, with the off-diagonal
+// eliminations done by gemm().  This is much faster than calling
+// LUbacksub for each column of B.
+template<class T, class T_Matrix, class T_RHS>
+void LUsolve(T_Matrix& A, const int* row_index, T_RHS&& B)
+{
+  const int n = A.dim(), r = B.columns();
+
+  MATRIX_ASSERT((int)B.rows() == n);
+
+  if (n == 0 || r == 0) return;
+
+  // Row interchanges.
+  for (int i = 0; i < n; ++i)
+    if (row_index[i] != i)
+      for (int c = 0; c < r; ++c) std::swap(B(i,c),B(row_index[i],c));
+
+  lu_detail::solve_lower<true,T>(A,B,n,r);
+  lu_detail::solve_upper<false,T>(A,B,n,r);
+}
+
+// Solve trans(A) X = B (or adj(A) X = B) with the factors of A from
+// LUdecomp, as LUbacksub(trans(A), ...) does for a single vector:
+//
+//   LUsolve(trans(A), row_index, B);
+//
+// trans(U) is lower-triangular and trans(L) upper-triangular with unit
+// diagonal.  For trans() of float, double and complex matrices the
+// eliminations are done by gemm() on the transposed factors.
+template<class T, class T_Matrix, bool Conj, class T_RHS>
+void LUsolve(const transposed<T_Matrix,Conj>& At, const int* row_index, T_RHS&& B)
+{
+  const int n = At.dim(), r = B.columns();
+
+  MATRIX_ASSERT((int)B.rows() == n);
+
+  if (n == 0 || r == 0) return;
+
+  lu_detail::solve_lower<false,T>(At,B,n,r);
+  lu_detail::solve_upper<true,T>(At,B,n,r);
+
+  // Undo the row interchanges, in reverse order.
+  for (int i = n-1; i >= 0; --i)
+    if (row_index[i] != i)
+      for (int c = 0; c < r; ++c) std::swap(B(i,c),B(row_index[i],c));
+}
+
+// Replace the factors of A from LUdecomp by the inverse of A, in place,
+// as LAPACK's getri: U is inverted in place, then inverse(A) is the
+// solution of X L = inverse(U), found by blocks of JLT_LU_BLOCK columns
+// from the right, each needing a copy of its part of L and one gemm(),
+// and finally the row interchanges are undone on the columns of X.
+// This takes n^3 multiply-adds and n*JLT_LU_BLOCK elements of extra
+// storage, against 4n^3/3 and a full matrix for solving A X = I.
+template<class T, class T_Matrix>
+void LUinvert(T_Matrix& A, const int* row_index)
+{
+  const int n = A.dim();
+  const int nb = JLT_LU_BLOCK;
+
+  if (n == 0) return;
+
+  // Inverse of U, by blocks of columns from the left.
+  for (int j0 = 0; j0 < n; j0 += nb)
+    {
+      const int j1 = std::min(n,j0 + nb), jb = j1 - j0;
+
+      // Rows above the diagonal block: A12 = inverse(U11)*A12 ...
+      for (int i0 = 0; i0 < j0; i0 += nb)
+	{
+	  const int i1 = std::min(j0,i0 + nb);
+	  for (int i = i0; i < i1; ++i)
+	    for (int c = j0; c < j1; ++c)
+	      {
+		T sum = 0;
+		for (int k = i; k < i1; ++k) sum += A(i,k)*A(k,c);
+		A(i,c) = sum;
+	      }
+	  lu_detail::block_gemm(T(1),A,i0,i1,A,i1,j0,T(1),A,i0,j0,
+				i1-i0,jb,j0-i1);
+	}
+
+      // ... then A12 = -A12*inverse(U22), row by row.
+      parallel_for(0,j0,JLT_PARALLEL_GRAIN/((std::size_t)jb*jb + 1) + 1,
+		   [&](std::size_t r0, std::size_t r1)
+		   {
+		     for (int i = (int)r0; i < (int)r1; ++i)
+		       for (int c = j0; c < j1; ++c)
+			 {
+			   T x = -A(i,c);
+			   for (int k = j0; k < c; ++k) x -= A(i,k)*A(k,c);
+			   A(i,c) = x/A(c,c);
+			 }
+		   });
+
+      // The diagonal block itself.
+      for (int j = j0; j < j1; ++j)
+	{
+	  A(j,j) = T(1)/A(j,j);
+	  const T ajj = -A(j,j);
+	  for (int i = j0; i < j; ++i)
+	    {
+	      T sum = 0;
+	      for (int k = i; k < j; ++k) sum += A(i,k)*A(k,j);
+	      A(i,j) = ajj*sum;
+	    }
+	}
+    }
+
+  // Solve X L = inverse(U), by blocks of columns from the right.
+  matrix<T> W(n,nb);
+  for (int j0 = ((n-1)/nb)*nb; j0 >= 0; j0 -= nb)
+    {
+      const int j1 = std::min(n,j0 + nb), jb = j1 - j0;
+
+      // Copy the block of L out of A and zero it.
+      for (int i = j0; i < n; ++i)
+	for (int j = j0; j < j1; ++j)
+	  if (i > j)
+	    {
+	      W(i-j0,j-j0) = A(i,j);
+	      A(i,j) = 0;
+	    }
+
+      // A(:,j0:j1) -= A(:,j1:n)*L(j1:n,j0:j1).
+      lu_detail::block_gemm(T(-1),A,0,j1,W,j1-j0,0,T(1),A,0,j0,n,jb,n-j1);
+
+      // A(:,j0:j1) = A(:,j0:j1)*inverse(L11), row by row.
+      parallel_for(0,n,JLT_PARALLEL_GRAIN/((std::size_t)jb*jb + 1) + 1,
+		   [&](std::size_t r0, std::size_t r1)
+		   {
+		     for (int i = (int)r0; i < (int)r1; ++i)
+		       for (int c = j1-1; c >= j0; --c)
+			 {
+			   T x = A(i,c);
+			   for (int k = c+1; k < j1; ++k)
+			     x -= A(i,k)*W(k-j0,c-j0);
+			   A(i,c) = x;
+			 }
+		   });
+    }
+
+  // Undo the row interchanges on the columns.
+  for (int j = n-2; j >= 0; --j)
+    {
+      const int jp = row_index[j];
+      if (jp != j)
+	for (int i = 0; i < n; ++i) std::swap(A(i,j),A(i,jp));
+    }
+}
+
+// Put the inverse of A in Ainv, given the factors of A from LUdecomp.
+// Ainv must already be the same size as A; A is not modified.
+template<class T, class T_Matrix, class T_Inverse>
+void LUinverse(T_Matrix& A, const int* row_index, T_Inverse& Ainv)
+{
+  const int n = A.dim();
+
+  for (int i = 0; i < n; ++i)
+    for (int j = 0; j < n; ++j) Ainv(i,j) = A(i,j);
+
+  LUinvert<T>(Ainv, row_index);
+}
+
+// The inverse of A, which is overwritten by its LU factors.
 template<class T, class T_Matrix>
 T_Matrix inverse(T_Matrix& A)
 {
   int n = A.dim();
   int perm;
 
-  int* row_index = new int[n];
+  std::vector<int> row_index(n);
 
-  LUdecomp<T,T_Matrix>(A, row_index, &perm);
+  LUdecomp<T,T_Matrix>(A, row_index.data(), &perm);
 
-  T* col = new T[n];
   T_Matrix Ainv(n,n);
 
-  for (int j = 0; j < n; ++j)
+  LUinverse<T,T_Matrix>(A, row_index.data(), Ainv);
+
+  return Ainv;
+}
+
+
+//
+// Cholesky and LDL^T decompositions
+//
+
+// Choleskydecomp(A) overwrites the lower triangle of the symmetric
+// positive-definite matrix A with L, where A = L trans(L) (L adj(L)
+// for a complex Hermitian A).  Only the lower triangle of A is read,
+// and the strict upper triangle is left alone.  Throws if A is not
+// positive-definite.
+//
+// The factorisation is blocked as LUdecomp: each panel of JLT_LU_BLOCK
+// columns is factored on its diagonal block, the rows below are found
+// by a triangular solve, and the lower triangle of the trailing
+// submatrix is updated by gemm() on its blocks of rows.  This takes
+// n^3/6 multiply-adds and no pivots, half of LU.  With JLT_USE_LAPACK,
+// float, double and complex matrices and views with contiguous rows or
+// columns call xPOTRF instead (lapack.hpp).
+template<class T, class T_Matrix>
+void Choleskydecomp(T_Matrix& A)
+{
+  using std::real;
+  using std::sqrt;
+  using R = decltype(std::abs(T()));
+
+  const int n = A.dim();
+  const int nb = JLT_LU_BLOCK;
+
+#ifdef JLT_USE_LAPACK
+  if constexpr (lapack::is_lapack_type<T>::value &&
+		lu_detail::is_gemm_block<T,T_Matrix>::value)
     {
-      for (int i = 0; i < n; ++i) col[i] = 0.;
-      col[j] = 1.;
-      LUbacksub<T,T_Matrix>(A, row_index, col);
-      for (int i = 0; i < n; ++i) Ainv(i,j) = col[i];
+      auto a = gemm_operand(A);
+      int info;
+      if (lapack::strided_potrf(n,a.data(),a.row_stride(),a.column_stride(),
+				&info))
+	{
+	  if (info > 0)
+	    {
+	      JLT_THROW(std::runtime_error("Matrix not positive-definite in Choleskydecomp."));
+	    }
+	  return;
+	}
     }
+#endif
 
-  delete[] row_index;
-  delete[] col;
+  matrix<T> W(std::max(n - nb,0),nb);
 
-  return Ainv;
+  for (int j0 = 0; j0 < n; j0 += nb)
+    {
+      const int j1 = std::min(n,j0 + nb), jb = j1 - j0;
+
+      // The diagonal block.
+      for (int j = j0; j < j1; ++j)
+	{
+	  R d = real(A(j,j));
+	  for (int k = j0; k < j; ++k) d -= std::norm(A(j,k));
+	  if (!(d > R(0)))
+	    {
+	      JLT_THROW(std::runtime_error("Matrix not positive-definite in Choleskydecomp."));
+	    }
+	  d = sqrt(d);
+	  A(j,j) = d;
+	  for (int i = j+1; i < j1; ++i)
+	    {
+	      T x = A(i,j);
+	      for (int k = j0; k < j; ++k) x -= A(i,k)*conjugate(A(j,k));
+	      A(i,j) = x/d;
+	    }
+	}
+
+      if (j1 == n) break;
+
+      // L21 = A21 adj(L11)^-1, row by row.
+      parallel_for(j1,n,JLT_PARALLEL_GRAIN/((std::size_t)jb*jb + 1) + 1,
+		   [&](std::size_t r0, std::size_t r1)
+		   {
+		     for (int i = (int)r0; i < (int)r1; ++i)
+		       for (int c = j0; c < j1; ++c)
+			 {
+			   T x = A(i,c);
+			   for (int k = j0; k < c; ++k)
+			     x -= A(i,k)*conjugate(A(c,k));
+			   A(i,c) = x/A(c,c);
+			 }
+		   });
+
+      // A22 -= L21 adj(L21), lower triangle only: adj(L21) is trans(W).
+      for (int i = j1; i < n; ++i)
+	for (int k = 0; k < jb; ++k) W(i-j1,k) = conjugate(A(i,j0+k));
+
+      const auto Wt = trans(W);
+      for (int i0 = j1; i0 < n; i0 += nb)
+	{
+	  const int i1 = std::min(n,i0 + nb);
+	  lu_detail::block_gemm(T(-1),A,i0,j0,Wt,0,0,T(1),A,i0,j1,
+				i1-i0,i0-j1,jb);
+	  for (int i = i0; i < i1; ++i)
+	    for (int c = i0; c <= i; ++c)
+	      {
+		T x = 0;
+		for (int k = 0; k < jb; ++k) x += A(i,j0+k)*W(c-j1,k);
+		A(i,c) -= x;
+	      }
+	}
+    }
+}
+
+// Solve A X = B for the n by r matrix or view B, overwriting B with X,
+// given the factor L of A from Choleskydecomp: L Y = B, then
+// adj(L) X = Y, blocked as LUsolve.
+template<class T, class T_Matrix, class T_RHS>
+void Choleskysolve(T_Matrix& A, T_RHS&& B)
+{
+  const int n = A.dim(), r = B.columns();
+
+  MATRIX_ASSERT((int)B.rows() == n);
+
+  if (n == 0 || r == 0) return;
+
+  lu_detail::solve_lower<false,T>(A,B,n,r);
+  const auto At = adj(A);
+  lu_detail::solve_upper<false,T>(At,B,n,r);
+}
+
+namespace ldlt_detail {
+
+// Bunch-Kaufman constant (1 + sqrt(17))/8, which bounds the growth of
+// the elements of the factors.
+template<class R>
+inline R bk_alpha() { using std::sqrt; return (R(1) + sqrt(R(17)))/R(8); }
+
+// |Re z| + |Im z|, the size by which LAPACK's complex xSYTRF chooses its
+// pivots; |z| for real z.
+template<class T>
+inline auto cabs1(const T& z)
+{
+  using std::abs;
+  return abs(std::real(z)) + abs(std::imag(z));
+}
+
+// Factor up to nb-1 (or, if nb >= m, all) of the columns of the m by m
+// trailing submatrix of A at (o,o), as LAPACK's xLASYF with uplo 'L':
+// the columns are factored left-looking, with W holding their products
+// with D, and the rest of the submatrix is then updated by gemm().
+// ipiv is local to the submatrix.  Returns the number of columns
+// factored; *singular is set if a pivot is exactly zero.
+template<class T, class T_Matrix>
+int lasyf(T_Matrix& A, int o, int m, int nb, int* ipiv, matrix<T>& W,
+	  bool* singular)
+{
+  using std::abs;
+  using R = decltype(abs(T()));
+
+  const R alpha = bk_alpha<R>();
+  auto a = [&](int i, int j) -> decltype(A(0,0)) { return A(o+i,o+j); };
+
+  // y(k:m) = column c of W = a(k:m,c) - a(k:m,0:k) trans(W(row,0:k)).
+  auto update_column = [&](int k, int c, int row)
+    {
+      parallel_for(k,m,JLT_PARALLEL_GRAIN/((std::size_t)k + 1) + 1,
+		   [&](std::size_t i0, std::size_t i1)
+		   {
+		     for (int i = (int)i0; i < (int)i1; ++i)
+		       {
+			 T s = W(i,c);
+			 for (int l = 0; l < k; ++l) s -= a(i,l)*W(row,l);
+			 W(i,c) = s;
+		       }
+		   });
+    };
+
+  int k = 0;
+  while (!((k >= nb-1 && nb < m) || k >= m))
+    {
+      for (int i = k; i < m; ++i) W(i,k) = a(i,k);
+      update_column(k,k,k);
+
+      int kstep = 1, kp, imax = k;
+      const R absakk = cabs1(W(k,k));
+      R colmax = 0;
+      for (int i = k+1; i < m; ++i)
+	if (cabs1(W(i,k)) > colmax) { colmax = cabs1(W(i,k)); imax = i; }
+
+      if (std::max(absakk,colmax) == R(0))
+	{
+	  *singular = true;
+	  kp = k;
+	}
+      else
+	{
+	  if (absakk >= alpha*colmax)
+	    {
+	      kp = k;
+	    }
+	  else
+	    {
+	      // Column imax into column k+1 of W.
+	      for (int i = k; i < imax; ++i) W(i,k+1) = a(imax,i);
+	      for (int i = imax; i < m; ++i) W(i,k+1) = a(i,imax);
+	      update_column(k,k+1,imax);
+
+	      R rowmax = 0;
+	      for (int i = k; i < m; ++i)
+		if (i != imax) rowmax = std::max(rowmax,(R)cabs1(W(i,k+1)));
+
+	      if (absakk >= alpha*colmax*(colmax/rowmax))
+		{
+		  kp = k;
+		}
+	      else if (cabs1(W(imax,k+1)) >= alpha*rowmax)
+		{
+		  kp = imax;
+		  for (int i = k; i < m; ++i) W(i,k) = W(i,k+1);
+		}
+	      else
+		{
+		  kp = imax;
+		  kstep = 2;
+		}
+	    }
+
+	  const int kk = k + kstep - 1;
+	  if (kp != kk)
+	    {
+	      // Move the untouched column kk to kp, and interchange rows
+	      // kk and kp of the columns already factored.
+	      a(kp,kp) = a(kk,kk);
+	      for (int j = kk+1; j < kp; ++j) a(kp,j) = a(j,kk);
+	      for (int i = kp+1; i < m; ++i) a(i,kp) = a(i,kk);
+	      for (int j = 0; j < kk; ++j) std::swap(a(kk,j),a(kp,j));
+	      for (int j = 0; j <= kk; ++j) std::swap(W(kk,j),W(kp,j));
+	    }
+
+	  if (kstep == 1)
+	    {
+	      for (int i = k; i < m; ++i) a(i,k) = W(i,k);
+	      const T r1 = T(1)/a(k,k);
+	      for (int i = k+1; i < m; ++i) a(i,k) *= r1;
+	    }
+	  else
+	    {
+	      if (k < m-2)
+		{
+		  T d21 = W(k+1,k);
+		  const T d11 = W(k+1,k+1)/d21, d22 = W(k,k)/d21;
+		  const T t = T(1)/(d11*d22 - T(1));
+		  d21 = t/d21;
+		  for (int j = k+2; j < m; ++j)
+		    {
+		      a(j,k) = d21*(d11*W(j,k) - W(j,k+1));
+		      a(j,k+1) = d21*(d22*W(j,k+1) - W(j,k));
+		    }
+		}
+	      a(k,k) = W(k,k);
+	      a(k+1,k) = W(k+1,k);
+	      a(k+1,k+1) = W(k+1,k+1);
+	    }
+	}
+
+      if (kstep == 1)
+	ipiv[k] = kp;
+      else
+	ipiv[k] = ipiv[k+1] = -kp-1;
+      k += kstep;
+    }
+
+  // Lower triangle of A22 -= L21 trans(W21), by blocks of columns.
+  const auto Wt = trans(W);
+  for (int j = k; j < m; j += nb)
+    {
+      const int jb = std::min(nb,m - j);
+      for (int jj = j; jj < j+jb; ++jj)
+	for (int i = jj; i < j+jb; ++i)
+	  {
+	    T s = 0;
+	    for (int l = 0; l < k; ++l) s += a(i,l)*W(jj,l);
+	    a(i,jj) -= s;
+	  }
+      lu_detail::block_gemm(T(-1),A,o+j+jb,o,Wt,0,j,T(1),A,o+j+jb,o+j,
+			    m-j-jb,jb,k);
+    }
+
+  // Undo the row interchanges in the columns factored, so that each
+  // column of L is stored as its own step left it.
+  for (int j = k-1; j >= 0;)
+    {
+      const int jj = j;
+      int jp = ipiv[j];
+      if (jp < 0) { jp = -jp-1; --j; }
+      --j;
+      if (jp != jj && j >= 0)
+	for (int l = 0; l <= j; ++l) std::swap(a(jp,l),a(jj,l));
+    }
+
+  return k;
+}
+
+} // namespace ldlt_detail
+
+// LDLTdecomp(A, ipiv) factors the symmetric matrix A, which need not be
+// positive-definite, as P A trans(P) = L D trans(L) with Bunch-Kaufman
+// pivoting: D is block-diagonal with 1 by 1 and 2 by 2 blocks, and L
+// unit lower-triangular.  The factors replace the lower triangle of A
+// in the format of LAPACK's xSYTRF with uplo 'L', with ipiv counted
+// from zero: ipiv[k] >= 0 for a 1 by 1 block, whose step interchanged
+// rows k and ipiv[k], and ipiv[k] = ipiv[k+1] = -p-1 for a 2 by 2 block
+// in rows k and k+1, whose step interchanged rows k+1 and p.  Only the
+// lower triangle of A is read.  Complex matrices are taken to be
+// symmetric, not Hermitian, and their pivots chosen by |Re|+|Im| as in
+// LAPACK.  Returns true if D is exactly singular; the
+// factorisation is still completed in this case.
+//
+// Panels of JLT_LU_BLOCK columns are factored as by LAPACK's xLASYF,
+// and the rest of the matrix updated by gemm(), in n^3/6
+// multiply-adds.  With JLT_USE_LAPACK, float, double and complex
+// matrices and views with contiguous rows or columns call xSYTRF
+// instead (for row-major storage, the upper triangle is then
+// overwritten by the lower).
+template<class T, class T_Matrix>
+bool LDLTdecomp(T_Matrix& A, int* ipiv)
+{
+  const int n = A.dim();
+  const int nb = JLT_LU_BLOCK;
+  bool singular = false;
+
+#ifdef JLT_USE_LAPACK
+  if constexpr (lapack::is_lapack_type<T>::value &&
+		lu_detail::is_gemm_block<T,T_Matrix>::value)
+    {
+      auto a = gemm_operand(A);
+      int info;
+      if (lapack::strided_sytrf(n,a.data(),a.row_stride(),a.column_stride(),
+				ipiv,&info))
+	return (info > 0);
+    }
+#endif
+
+  matrix<T> W(n,std::min(n,nb));
+
+  for (int k = 0; k < n;)
+    {
+      const int m = n - k;
+      const int kb =
+	ldlt_detail::lasyf<T>(A,k,m,(m > nb ? nb : m),ipiv+k,W,&singular);
+
+      for (int j = k; j < k+kb; ++j)
+	ipiv[j] = (ipiv[j] >= 0 ? ipiv[j] + k : ipiv[j] - k);
+      k += kb;
+    }
+
+  return singular;
+}
+
+// Solve A X = B for the n by r matrix or view B, overwriting B with X,
+// given the factors of A from LDLTdecomp, as LAPACK's xSYTRS.  Columns
+// of B are shared among threads.
+template<class T, class T_Matrix, class T_RHS>
+void LDLTsolve(T_Matrix& A, const int* ipiv, T_RHS&& B)
+{
+  const int n = A.dim(), r = B.columns();
+
+  MATRIX_ASSERT((int)B.rows() == n);
+
+  if (n == 0 || r == 0) return;
+
+  auto swap_rows = [&](int i, int j, int c0, int c1)
+    {
+      if (i != j)
+	for (int c = c0; c < c1; ++c) std::swap(B(i,c),B(j,c));
+    };
+
+  parallel_for(0,r,JLT_PARALLEL_GRAIN/((std::size_t)n*n + 1) + 1,
+	       [&](std::size_t cc0, std::size_t cc1)
+	       {
+		 const int c0 = cc0, c1 = cc1;
+
+		 // L D Y = P B.
+		 for (int k = 0; k < n;)
+		   {
+		     if (ipiv[k] >= 0)
+		       {
+			 swap_rows(k,ipiv[k],c0,c1);
+			 for (int i = k+1; i < n; ++i)
+			   {
+			     const T l = A(i,k);
+			     if (l == T(0)) continue;
+			     for (int c = c0; c < c1; ++c) B(i,c) -= l*B(k,c);
+			   }
+			 const T d = T(1)/A(k,k);
+			 for (int c = c0; c < c1; ++c) B(k,c) *= d;
+			 k += 1;
+		       }
+		     else
+		       {
+			 swap_rows(k+1,-ipiv[k]-1,c0,c1);
+			 for (int i = k+2; i < n; ++i)
+			   {
+			     const T l0 = A(i,k), l1 = A(i,k+1);
+			     for (int c = c0; c < c1; ++c)
+			       B(i,c) -= l0*B(k,c) + l1*B(k+1,c);
+			   }
+			 const T d21 = A(k+1,k);
+			 const T d11 = A(k,k)/d21, d22 = A(k+1,k+1)/d21;
+			 const T denom = d11*d22 - T(1);
+			 for (int c = c0; c < c1; ++c)
+			   {
+			     const T b1 = B(k,c)/d21, b2 = B(k+1,c)/d21;
+			     B(k,c) = (d22*b1 - b2)/denom;
+			     B(k+1,c) = (d11*b2 - b1)/denom;
+			   }
+			 k += 2;
+		       }
+		   }
+
+		 // trans(P) trans(L) X = Y.
+		 for (int k = n-1; k >= 0;)
+		   {
+		     const int kstep = (ipiv[k] >= 0 ? 1 : 2);
+		     for (int s = 0; s < kstep; ++s)
+		       for (int i = k+1; i < n; ++i)
+			 {
+			   const T l = A(i,k-s);
+			   if (l == T(0)) continue;
+			   for (int c = c0; c < c1; ++c) B(k-s,c) -= l*B(i,c);
+			 }
+		     swap_rows(k,(ipiv[k] >= 0 ? ipiv[k] : -ipiv[k]-1),c0,c1);
+		     k -= kstep;
+		   }
+	       });
 }
 
 
@@ -279,6 +1108,240 @@ bool QRdecomp(T_Matrix& A, T_Matrix& Q, T_Matrix& R)
 }
 
 
+//
+// Blocked Householder QR
+//
+
+// HouseholderQR(A, tau) factors the m by n matrix A as A = Q R, for
+// any m and n, as LAPACK's xGEQRF.  R replaces the upper triangle (or
+// trapezoid) of A, and Q = H_0 H_1 ... H_{k-1}, with k = min(m,n), is
+// kept implicitly: H_j = I - tau[j] v_j adj(v_j), where v_j is zero
+// above row j, one at row j, and stored below the diagonal in column j
+// of A.  tau must hold k elements.
+//
+// Q is never formed.  HouseholderQRapply multiplies a matrix or view by
+// Q or adj(Q) in O(m n r) operations for r columns, so that least
+// squares problems and projections on tall matrices need neither the
+// m by m matrix Q nor the O(m^3) work to form it.
+//
+// Panels of JLT_QR_BLOCK columns are factored one column at a time.
+// Their reflectors are then gathered into the compact WY form
+// H_j0 ... H_j1-1 = I - V T adj(V), with T upper-triangular (xLARFT),
+// which is applied to the rest of A, or to another matrix, by two
+// gemm() products with V and a small one with T (xLARFB).
+
+// Columns per panel.
+#ifndef JLT_QR_BLOCK
+#  define JLT_QR_BLOCK 32
+#endif
+
+namespace qr_detail {
+
+// Make column j of A, from row j down, into a Householder vector, as
+// xLARFG: returns tau, such that adj(H) x = (beta, 0, ..., 0) with beta
+// real, and stores beta in A(j,j) and v below it.
+template<class T, class T_Matrix>
+T reflector(T_Matrix& A, int m, int j)
+{
+  using std::abs;
+  using std::sqrt;
+  using R = decltype(abs(T()));
+
+  const T alpha = A(j,j);
+
+  // |x|, scaled to avoid overflow.
+  R scale = 0, xnorm = 0;
+  for (int i = j+1; i < m; ++i) scale = std::max(scale,(R)abs(A(i,j)));
+  if (scale > R(0))
+    {
+      R s = 0;
+      for (int i = j+1; i < m; ++i) s += std::norm(A(i,j)/scale);
+      xnorm = scale*sqrt(s);
+    }
+
+  if (xnorm == R(0) && std::imag(alpha) == R(0)) return T(0);
+
+  R beta = std::hypot((R)abs(alpha),xnorm);
+  if (std::real(alpha) >= R(0)) beta = -beta;
+
+  const T s = T(1)/(alpha - T(beta));
+  for (int i = j+1; i < m; ++i) A(i,j) *= s;
+  A(j,j) = beta;
+
+  return (T(beta) - alpha)/T(beta);
+}
+
+// Factor columns j0 to j1-1 of A, applying each reflector to the
+// columns of the panel to its right.
+template<class T, class T_Matrix>
+void factor_panel(T_Matrix& A, int m, int j0, int j1, T* tau)
+{
+  for (int j = j0; j < j1; ++j)
+    {
+      tau[j] = reflector<T>(A,m,j);
+      if (tau[j] == T(0) || j+1 == j1) continue;
+
+      const T ajj = A(j,j), ct = conjugate(tau[j]);
+      A(j,j) = 1;
+      parallel_for(j+1,j1,JLT_PARALLEL_GRAIN/((std::size_t)(m-j) + 1) + 1,
+		   [&](std::size_t c0, std::size_t c1)
+		   {
+		     for (int c = (int)c0; c < (int)c1; ++c)
+		       {
+			 T w = 0;
+			 for (int i = j; i < m; ++i) w += conjugate(A(i,j))*A(i,c);
+			 w *= ct;
+			 for (int i = j; i < m; ++i) A(i,c) -= A(i,j)*w;
+		       }
+		   });
+      A(j,j) = ajj;
+    }
+}
+
+// The reflectors of columns j0 to j1-1 in compact WY form, with
+// buffers that are reused from one panel to the next.
+template<class T>
+class block_reflector
+{
+  int j0{0}, jb{0}, mv{0};
+  matrix<T> V, Vc, Tm, W;	// V, conj(V), T and scratch.
+
+  static void reserve(matrix<T>& M, int m, int n)
+    {
+      if ((int)M.rows() != m || (int)M.columns() != n)
+	{
+	  matrix<T> tmp(m,n);
+	  M.swap(tmp);
+	}
+    }
+
+public:
+  // V from A (unit lower-trapezoidal, rows j0 to m-1), then T as
+  // xLARFT: T(0:i,i) = -tau_i T(0:i,0:i) adj(V(:,0:i)) v_i.
+  template<class T_Matrix>
+  void form(const T_Matrix& A, int m, int _j0, int j1, const T* tau)
+    {
+      j0 = _j0;
+      jb = j1 - j0;
+      mv = m - j0;
+      reserve(V,mv,jb);
+      reserve(Vc,mv,jb);
+      reserve(Tm,jb,jb);
+
+      for (int i = 0; i < mv; ++i)
+	for (int c = 0; c < jb; ++c)
+	  {
+	    const T v = (i < c ? T(0) : (i == c ? T(1) : A(j0+i,j0+c)));
+	    V(i,c) = v;
+	    Vc(i,c) = conjugate(v);
+	  }
+
+      // adj(V) V, by gemm(); only its strict upper triangle is used.
+      const auto Vt = trans(Vc);
+      lu_detail::block_gemm(T(1),Vt,0,0,V,0,0,T(0),Tm,0,0,jb,jb,mv);
+
+      std::vector<T> t(jb);
+      for (int i = 0; i < jb; ++i)
+	{
+	  const T ti = tau[j0+i];
+	  for (int p = 0; p < i; ++p) t[p] = -ti*Tm(p,i);
+	  for (int p = 0; p < i; ++p)
+	    {
+	      T s = 0;
+	      for (int q = p; q < i; ++q) s += Tm(p,q)*t[q];
+	      Tm(p,i) = s;
+	    }
+	  Tm(i,i) = ti;
+	  for (int p = i+1; p < jb; ++p) Tm(p,i) = 0;
+	}
+    }
+
+  // C = H C, or adj(H) C if adjoint, for columns c0 to c0+r-1 of C,
+  // which has m rows:
+  //   W = adj(V) C,  W = T W (or adj(T) W),  C -= V W.
+  template<class T_Matrix>
+  void apply(T_Matrix& C, int c0, int r, bool adjoint)
+    {
+      if (r <= 0 || jb == 0) return;
+
+      reserve(W,jb,r);
+      const auto Vt = trans(Vc);
+      lu_detail::block_gemm(T(1),Vt,0,0,C,j0,c0,T(0),W,0,0,jb,r,mv);
+
+      parallel_for(0,r,JLT_PARALLEL_GRAIN/((std::size_t)jb*jb + 1) + 1,
+		   [&](std::size_t cc0, std::size_t cc1)
+		   {
+		     for (int c = (int)cc0; c < (int)cc1; ++c)
+		       if (adjoint)
+			 for (int p = jb-1; p >= 0; --p)
+			   {
+			     T s = 0;
+			     for (int q = 0; q <= p; ++q)
+			       s += conjugate(Tm(q,p))*W(q,c);
+			     W(p,c) = s;
+			   }
+		       else
+			 for (int p = 0; p < jb; ++p)
+			   {
+			     T s = 0;
+			     for (int q = p; q < jb; ++q) s += Tm(p,q)*W(q,c);
+			     W(p,c) = s;
+			   }
+		   });
+
+      lu_detail::block_gemm(T(-1),V,0,0,W,0,0,T(1),C,j0,c0,mv,r,jb);
+    }
+};
+
+} // namespace qr_detail
+
+template<class T, class T_Matrix>
+void HouseholderQR(T_Matrix& A, T* tau)
+{
+  const int m = A.rows(), n = A.columns(), k = std::min(m,n);
+  const int nb = JLT_QR_BLOCK;
+
+  qr_detail::block_reflector<T> H;
+
+  for (int j0 = 0; j0 < k; j0 += nb)
+    {
+      const int j1 = std::min(k,j0 + nb);
+
+      qr_detail::factor_panel<T>(A,m,j0,j1,tau);
+      if (j1 == n) break;
+
+      H.form(A,m,j0,j1,tau);
+      H.apply(A,j1,n-j1,true);
+    }
+}
+
+// C = Q C, or adj(Q) C if adjoint is true, for the Q of the factors of
+// HouseholderQR in A and tau.  C is a matrix or view with as many rows
+// as A.
+template<class T, class T_Matrix, class T_RHS>
+void HouseholderQRapply(const T_Matrix& A, const T* tau, T_RHS&& C,
+			bool adjoint)
+{
+  const int m = A.rows(), k = std::min(m,(int)A.columns()), r = C.columns();
+  const int nb = JLT_QR_BLOCK;
+
+  MATRIX_ASSERT((int)C.rows() == m);
+
+  if (k == 0 || r == 0) return;
+
+  qr_detail::block_reflector<T> H;
+
+  // adj(Q) = adj(H_{k-1}) ... adj(H_0) starts with the first block,
+  // Q = H_0 ... H_{k-1} with the last.
+  const int last = ((k-1)/nb)*nb;
+  for (int j0 = (adjoint ? 0 : last); j0 >= 0 && j0 < k;
+       j0 += (adjoint ? nb : -nb))
+    {
+      H.form(A,m,j0,std::min(k,j0 + nb),tau);
+      H.apply(C,0,r,adjoint);
+    }
+}
+
 //
 // Gram-Schmidt Orthonormalization.
 //
@@ -0,0 +1,473 @@
+//
+// Copyright (c) 2004-2020 Jean-Luc Thiffeault <jeanluc@mailaps.org>
+//
+// See the file LICENSE for copying permission.
+//
+
+#ifndef JLT_MMAP_MATRIX_HPP
+#define JLT_MMAP_MATRIX_HPP
+
+//
+// mmap_matrix.hpp
+//
+
+// Row-major matrix backed by a binary file mapped into memory, for
+// data that does not fit in RAM.  The file holds the raw elements row
+// by row, with no header, so it can be read with e.g. Matlab's fread
+// or numpy.fromfile.  Its number of rows is deduced from its size.
+//
+// Element access, iterators, data() and the views of matrix_view.hpp
+// work as for jlt::matrix, so that code written against those (the
+// mathmatrix view kernels, printMatlabForm, finitediff on a row or
+// column view) runs on the mapped data directly.  Pages are read from
+// and written to the file by the kernel as they are touched.
+//
+// Modes:
+//
+//   mmap_read_only   Open an existing file.  Writing through the
+//                    matrix is an error (the process gets SIGSEGV).
+//   mmap_read_write  Open an existing file, or create an empty one.
+//   mmap_create      Create the file, truncating it if it exists.
+//
+// Rows can be appended with push_back_row().  The file then grows
+// geometrically, and is trimmed to the exact number of rows when the
+// matrix is destroyed.  Appending may move the mapping, which
+// invalidates pointers, iterators and views into the matrix.
+//
+// Requires POSIX (mmap, ftruncate).
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <type_traits>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <jlt/matrix_view.hpp>
+#include <jlt/matlab.hpp>
+#include <jlt/exceptions.hpp>
+
+#ifdef MATRIX_BOUNDS_CHECK
+#  define MATRIX_CHECK_BOUNDS
+#endif
+
+namespace jlt {
+
+enum mmap_mode { mmap_read_only, mmap_read_write, mmap_create };
+
+// Access pattern hints, passed on to madvise.
+enum mmap_advice { mmap_normal, mmap_sequential, mmap_random,
+		   mmap_willneed, mmap_dontneed };
+
+
+template<class T>
+class mmap_matrix
+{
+  static_assert(std::is_trivially_copyable<T>::value,
+		"jlt::mmap_matrix: elements must be trivially copyable.");
+
+public:
+  using value_type = T;
+  using pointer = T *;
+  using const_pointer = const T *;
+  using iterator = pointer;
+  using const_iterator = const_pointer;
+  using reference = T &;
+  using const_reference = const T &;
+  using size_type = size_t;
+
+private:
+  int		fd{-1};
+  pointer	start{nullptr};
+  size_type	m{0}, n{0};		// Number of rows, columns.
+  size_type	cap{0};			// Number of rows mapped.
+  mmap_mode	mode{mmap_read_only};
+  std::string	fname;
+
+  static void fail(const std::string& what, const std::string& file)
+    {
+      JLT_THROW(std::runtime_error("jlt::mmap_matrix: " + what + " " + file
+				   + ": " + std::strerror(errno)));
+    }
+
+  // Map the first _cap rows of the file, which must be at least that
+  // long.  Returns false if mmap fails.
+  bool try_map(size_type _cap)
+    {
+      cap = _cap;
+      if (cap == 0 || n == 0) { start = nullptr; return true; }
+
+      int prot = (mode == mmap_read_only ? PROT_READ : PROT_READ | PROT_WRITE);
+      void *p = ::mmap(nullptr,cap*n*sizeof(T),prot,MAP_SHARED,fd,0);
+      if (p == MAP_FAILED) { start = nullptr; cap = 0; return false; }
+      start = static_cast<pointer>(p);
+      return true;
+    }
+
+  void map(size_type _cap)
+    {
+      if (!try_map(_cap)) fail("cannot map",fname);
+    }
+
+  void unmap()
+    {
+      if (start != nullptr) ::munmap(start,cap*n*sizeof(T));
+      start = nullptr;
+      cap = 0;
+    }
+
+  // Set the length of the file to _m rows.
+  void truncate(size_type _m)
+    {
+      if (::ftruncate(fd,(off_t)(_m*n*sizeof(T))) != 0)
+	fail("cannot resize",fname);
+    }
+
+  void require_writable() const
+    {
+      if (mode == mmap_read_only)
+	JLT_THROW(std::logic_error("jlt::mmap_matrix: " + fname
+				   + " is open read-only."));
+    }
+
+public:
+  //
+  // Constructors
+  //
+
+  mmap_matrix() {}
+
+  // Map the file filename as a matrix with _n columns.
+  mmap_matrix(const std::string& filename, size_type _n,
+	      mmap_mode _mode = mmap_read_only)
+    : n(_n), mode(_mode), fname(filename)
+    {
+      if (n == 0)
+	JLT_THROW(std::invalid_argument("jlt::mmap_matrix: zero columns."));
+
+      int flags = O_RDWR;
+      if (mode == mmap_read_only) flags = O_RDONLY;
+      else if (mode == mmap_read_write) flags |= O_CREAT;
+      else flags |= O_CREAT | O_TRUNC;
+
+      fd = ::open(filename.c_str(),flags,0644);
+      if (fd < 0) fail("cannot open",fname);
+
+      struct stat st;
+      if (::fstat(fd,&st) != 0) { ::close(fd); fail("cannot stat",fname); }
+
+      size_type bytes = st.st_size, rowbytes = n*sizeof(T);
+      if (bytes % rowbytes != 0)
+	{
+	  ::close(fd);
+	  JLT_THROW(std::length_error("jlt::mmap_matrix: size of " + fname
+				      + " is not a whole number of rows."));
+	}
+      m = bytes / rowbytes;
+
+      // The destructor does not run if the constructor throws, so close
+      // the file here as above.
+      if (!try_map(m)) { ::close(fd); fail("cannot map",fname); }
+    }
+
+  // Create the file filename holding an _m by _n matrix of zeros.
+  mmap_matrix(const std::string& filename, size_type _m, size_type _n)
+    : mmap_matrix(filename,_n,mmap_create)
+    {
+      resize(_m);
+    }
+
+  // A mapping cannot be copied: copy into a jlt::matrix instead, with
+  // matrix<T>(A.view()).
+  mmap_matrix(const mmap_matrix&) = delete;
+  mmap_matrix& operator=(const mmap_matrix&) = delete;
+
+  mmap_matrix(mmap_matrix&& A) noexcept { swap(A); }
+
+  mmap_matrix& operator=(mmap_matrix&& A) noexcept
+    {
+      swap(A);
+
+      return *this;
+    }
+
+  // Unmap, trim the file to its exact number of rows, and close it.
+  ~mmap_matrix() { close(); }
+
+  void close()
+    {
+      if (fd < 0) return;
+
+      unmap();
+      if (mode != mmap_read_only)
+	{
+	  // Called from the destructor, so cannot throw: on failure the
+	  // file just keeps some trailing zero rows.
+	  int err = ::ftruncate(fd,(off_t)(m*n*sizeof(T)));
+	  (void)err;
+	}
+      ::close(fd);
+      fd = -1;
+      m = 0;
+    }
+
+  void swap(mmap_matrix& A) noexcept
+    {
+      using std::swap;
+
+      swap(fd,A.fd);
+      swap(start,A.start);
+      swap(m,A.m);
+      swap(n,A.n);
+      swap(cap,A.cap);
+      swap(mode,A.mode);
+      swap(fname,A.fname);
+    }
+
+  //
+  // Element access.
+  //
+
+  reference operator()(size_type i, size_type j)
+    {
+#ifdef MATRIX_CHECK_BOUNDS
+      return at(i,j);
+#else
+      return start[n*i + j];
+#endif
+    }
+
+  const_reference operator()(size_type i, size_type j) const
+    {
+#ifdef MATRIX_CHECK_BOUNDS
+      return at(i,j);
+#else
+      return start[n*i + j];
+#endif
+    }
+
+  reference at(size_type i, size_type j)
+    {
+      if (i >= m || j >= n)
+	JLT_THROW(std::out_of_range("Out of range exception in jlt::mmap_matrix."));
+
+      return start[n*i + j];
+    }
+
+  [[nodiscard]] const_reference at(size_type i, size_type j) const
+    {
+      if (i >= m || j >= n)
+	JLT_THROW(std::out_of_range("Out of range exception in jlt::mmap_matrix."));
+
+      return start[n*i + j];
+    }
+
+  pointer operator[](size_type i) { return start + n*i; }
+  const_pointer operator[](size_type i) const { return start + n*i; }
+
+  pointer data() { return start; }
+  [[nodiscard]] const_pointer data() const { return start; }
+
+  [[nodiscard]] std::vector<T> row(size_type i) const
+    {
+      return std::vector<T>(start + n*i,start + n*(i+1));
+    }
+
+  //
+  // Views (see matrix_view.hpp).
+  //
+
+  matrix_view<T> view() { return matrix_view<T>(start,m,n,n,1); }
+
+  [[nodiscard]] matrix_view<const T> view() const
+    {
+      return matrix_view<const T>(start,m,n,n,1);
+    }
+
+  vector_view<T> row_view(size_type i) { return view().row(i); }
+  [[nodiscard]] vector_view<const T> row_view(size_type i) const
+    {
+      return view().row(i);
+    }
+
+  vector_view<T> column_view(size_type j) { return view().column(j); }
+  [[nodiscard]] vector_view<const T> column_view(size_type j) const
+    {
+      return view().column(j);
+    }
+
+  vector_view<T> diagonal_view() { return view().diagonal(); }
+  [[nodiscard]] vector_view<const T> diagonal_view() const
+    {
+      return view().diagonal();
+    }
+
+  matrix_view<T> block(size_type i, size_type j, size_type _m, size_type _n)
+    {
+      return view().block(i,j,_m,_n);
+    }
+
+  [[nodiscard]] matrix_view<const T> block(size_type i, size_type j,
+					   size_type _m, size_type _n) const
+    {
+      return view().block(i,j,_m,_n);
+    }
+
+  //
+  // Size
+  //
+
+  [[nodiscard]] size_type size() const { return m*n; }
+  [[nodiscard]] size_type dim() const { return n; }
+  [[nodiscard]] size_type rows() const { return m; }
+  [[nodiscard]] size_type columns() const { return n; }
+  // Number of rows that fit in the current mapping.
+  [[nodiscard]] size_type capacity() const { return cap; }
+
+  [[nodiscard]] bool empty() const { return (m == 0); }
+  [[nodiscard]] bool isSquare() const { return (m == n); }
+  [[nodiscard]] bool is_open() const { return (fd >= 0); }
+  [[nodiscard]] mmap_mode open_mode() const { return mode; }
+  [[nodiscard]] const std::string& filename() const { return fname; }
+
+  //
+  // Iterators
+  //
+
+  iterator begin() { return start; }
+  [[nodiscard]] const_iterator begin() const { return start; }
+  [[nodiscard]] const_iterator cbegin() const { return start; }
+  iterator end() { return start + m*n; }
+  [[nodiscard]] const_iterator end() const { return start + m*n; }
+  [[nodiscard]] const_iterator cend() const { return start + m*n; }
+
+  //
+  // Growing
+  //
+
+  // Make room for at least _cap rows, growing the file if necessary.
+  void reserve(size_type _cap)
+    {
+      if (_cap <= cap) return;
+      require_writable();
+
+      unmap();
+      truncate(_cap);
+      map(_cap);
+    }
+
+  // Change the number of rows.  New rows are zero.
+  void resize(size_type _m)
+    {
+      require_writable();
+
+      if (_m > cap)
+	{
+	  reserve(_m);
+	}
+      else if (_m < m)
+	{
+	  // Zero the dropped rows, in case they are appended again
+	  // before the file is trimmed.
+	  std::memset(static_cast<void*>(start + _m*n),0,(m-_m)*n*sizeof(T));
+	}
+      m = _m;
+    }
+
+  // Append a row, taken from any container with size() and begin().
+  template<class V>
+  void push_back_row(const V& r)
+    {
+      if (r.size() != n)
+	JLT_THROW(std::length_error("Size mismatch in jlt::mmap_matrix."));
+
+      // Grow geometrically to keep appending amortised O(1).
+      if (m == cap) reserve(cap < 16 ? 16 : 2*cap);
+
+      std::copy(r.begin(),r.end(),start + m*n);
+      ++m;
+    }
+
+  //
+  // Paging
+  //
+
+  // Advise the kernel on how the data will be accessed.  sequential
+  // enables aggressive read-ahead, which suits sweeps through the rows.
+  void advise(mmap_advice a) const
+    {
+      if (start == nullptr) return;
+
+      int adv = MADV_NORMAL;
+      switch (a)
+	{
+	case mmap_normal: adv = MADV_NORMAL; break;
+	case mmap_sequential: adv = MADV_SEQUENTIAL; break;
+	case mmap_random: adv = MADV_RANDOM; break;
+	case mmap_willneed: adv = MADV_WILLNEED; break;
+	case mmap_dontneed: adv = MADV_DONTNEED; break;
+	}
+      // Only a hint: ignore failure.
+      ::madvise(start,cap*n*sizeof(T),adv);
+    }
+
+  // Write modified pages back to the file, waiting for completion.
+  void sync()
+    {
+      if (start == nullptr || mode == mmap_read_only) return;
+
+      if (::msync(start,cap*n*sizeof(T),MS_SYNC) != 0)
+	fail("cannot sync",fname);
+    }
+
+  //
+  // Output
+  //
+
+  std::ostream& printOn(std::ostream& strm) const
+    {
+      return view().printOn(strm);
+    }
+
+  std::ostream& printMatrixForm(std::ostream& strm) const
+    {
+      return view().printMatrixForm(strm);
+    }
+
+  std::ostream& printMatlabForm(std::ostream& strm,
+				const std::string name = "",
+				const std::string description = "") const
+    {
+      return jlt::printMatlabForm(strm,view(),name,description);
+    }
+
+#ifdef JLT_MATLAB_LIB_SUPPORT
+  void printMatlabForm(MATFile *pmat,
+		       const std::string name = "",
+		       const std::string description = "") const
+  {
+    jlt::printMatlabForm(pmat,view(),name,description);
+  }
+#endif // JLT_MATLAB_LIB_SUPPORT
+};
+
+template<class T>
+std::ostream& operator<<(std::ostream& strm, const mmap_matrix<T>& M)
+{
+  return M.printOn(strm);
+}
+
+template<class T>
+inline void swap(mmap_matrix<T>& A, mmap_matrix<T>& B) noexcept
+{
+  A.swap(B);
+}
+
+} // namespace jlt
+
+#endif // JLT_MMAP_MATRIX_HPP
@@ -0,0 +1,670 @@
+//
+// Copyright (c) 2004-2020 Jean-Luc Thiffeault <jeanluc@mailaps.org>
+//
+// See the file LICENSE for copying permission.
+//
+
+#ifndef JLT_PACKED_MATRIX_HPP
+#define JLT_PACKED_MATRIX_HPP
+
+//
+// packed_matrix.hpp
+//
+
+// Square matrices that only store one triangle, packed row by row:
+// symmetric_matrix and triangular_matrix.  They use about half the
+// memory of a mathmatrix of the same size, and their products only
+// read the stored triangle once.  Element access is as for
+// jlt::matrix, with A(i,j).
+//
+// symmetric_matrix stores the lower triangle: row i holds A(i,0) to
+// A(i,i).  This is the same as LAPACK's column-major packed storage of
+// the upper triangle (uplo = 'U'), so the data can be passed to the
+// packed LAPACK drivers as is; see symmetric_matrix_eigensystem in
+// eigensystem.hpp.
+//
+// triangular_matrix<T,lower_triangle> stores rows A(i,0..i), and
+// triangular_matrix<T,upper_triangle> rows A(i,i..n-1).  Elements
+// outside the triangle read as zero and cannot be written to.
+
+#include <iostream>
+#include <cassert>
+#include <vector>
+#include <cstddef>
+#include <type_traits>
+#include <jlt/aligned_allocator.hpp>
+#include <jlt/matrix_view.hpp>
+#include <jlt/mathvector.hpp>
+#include <jlt/mathmatrix.hpp>
+#include <jlt/exceptions.hpp>
+
+namespace jlt {
+
+// Triangle tags for triangular_matrix.
+struct lower_triangle {};
+struct upper_triangle {};
+
+//
+// class symmetric_matrix
+//
+
+template<class T, class Alloc = aligned_allocator<T>>
+class symmetric_matrix
+{
+public:
+  using value_type = T;
+  using allocator_type = Alloc;
+  using pointer = T *;
+  using const_pointer = const T *;
+  using iterator = pointer;
+  using const_iterator = const_pointer;
+  using reference = T &;
+  using const_reference = const T &;
+  using size_type = std::size_t;
+
+private:
+  size_type n{0};
+  std::vector<T,Alloc> a;
+
+  // Position of (i,j) in the packed lower triangle.
+  static size_type index(size_type i, size_type j)
+    {
+      return (i >= j ? i*(i+1)/2 + j : j*(j+1)/2 + i);
+    }
+
+public:
+  //
+  // Constructors
+  //
+
+  symmetric_matrix() {}
+
+  // Matrix of size _n*_n filled with _x.
+  explicit symmetric_matrix(size_type _n, const_reference _x = T())
+    : n(_n), a(_n*(_n+1)/2,_x) {}
+
+  // From the lower triangle of a square matrix or mathmatrix.  The
+  // upper triangle is not referenced.
+  template<class Alloc2, class Order>
+  explicit symmetric_matrix(const matrix<T,Alloc2,Order>& A)
+    {
+      assign(A);
+    }
+
+  // From the lower triangle of a square view.
+  template<class U>
+  explicit symmetric_matrix(const matrix_view<U>& A)
+    {
+      assign(A);
+    }
+
+  //
+  // Element access.
+  //
+
+  // A(i,j) and A(j,i) refer to the same element.
+  reference operator()(size_type i, size_type j)
+    {
+#ifdef MATRIX_CHECK_BOUNDS
+      return at(i,j);
+#else
+      return a[index(i,j)];
+#endif
+    }
+
+  const_reference operator()(size_type i, size_type j) const
+    {
+#ifdef MATRIX_CHECK_BOUNDS
+      return at(i,j);
+#else
+      return a[index(i,j)];
+#endif
+    }
+
+  reference at(size_type i, size_type j)
+    {
+      if (i >= n || j >= n)
+	JLT_THROW(std::out_of_range("Out of range exception in jlt::symmetric_matrix."));
+      return a[index(i,j)];
+    }
+
+  [[nodiscard]] const_reference at(size_type i, size_type j) const
+    {
+      if (i >= n || j >= n)
+	JLT_THROW(std::out_of_range("Out of range exception in jlt::symmetric_matrix."));
+      return a[index(i,j)];
+    }
+
+  // The packed triangle, n(n+1)/2 elements.
+  pointer data() { return a.data(); }
+  [[nodiscard]] const_pointer data() const { return a.data(); }
+  [[nodiscard]] size_type storage_size() const { return a.size(); }
+
+  [[nodiscard]] size_type size() const { return n*n; }
+  [[nodiscard]] size_type dim() const { return n; }
+  [[nodiscard]] size_type rows() const { return n; }
+  [[nodiscard]] size_type columns() const { return n; }
+  [[nodiscard]] bool empty() const { return (n == 0); }
+  [[nodiscard]] bool isSquare() const { return true; }
+
+  //
+  // Iterators, over the packed triangle.
+  //
+
+  iterator begin() { return a.data(); }
+  [[nodiscard]] const_iterator begin() const { return a.data(); }
+  [[nodiscard]] const_iterator cbegin() const { return a.data(); }
+  iterator end() { return a.data() + a.size(); }
+  [[nodiscard]] const_iterator end() const { return a.data() + a.size(); }
+  [[nodiscard]] const_iterator cend() const { return a.data() + a.size(); }
+
+  //
+  // Matrix Operations
+  //
+
+  symmetric_matrix& operator+=(const symmetric_matrix& A)
+    {
+      MATRIX_ASSERT(n == A.n);
+      for (size_type k = 0; k < a.size(); ++k) a[k] += A.a[k];
+      return *this;
+    }
+
+  symmetric_matrix& operator-=(const symmetric_matrix& A)
+    {
+      MATRIX_ASSERT(n == A.n);
+      for (size_type k = 0; k < a.size(); ++k) a[k] -= A.a[k];
+      return *this;
+    }
+
+  symmetric_matrix& operator*=(const_reference x)
+    {
+      for (auto& y : a) y *= x;
+      return *this;
+    }
+
+  symmetric_matrix& operator/=(const_reference x)
+    {
+      for (auto& y : a) y /= x;
+      return *this;
+    }
+
+  // Unpack into a full mathmatrix.
+  [[nodiscard]] mathmatrix<T> full() const
+    {
+      mathmatrix<T> A(n,n,default_init);
+      for (size_type i = 0; i < n; ++i)
+	for (size_type j = 0; j < n; ++j) A(i,j) = (*this)(i,j);
+      return A;
+    }
+
+  //
+  // Output
+  //
+
+  // As for matrix, the whole matrix is printed.
+  std::ostream& printOn(std::ostream& strm) const
+    {
+      if (empty()) return strm;
+
+      for (size_type i = 0; i < n; ++i)
+	for (size_type j = 0; j < n; ++j)
+	  {
+	    strm << (*this)(i,j);
+	    if (i != n-1 || j != n-1) strm << "\t";	// No dangling tab.
+	  }
+
+      return strm;
+    }
+
+  std::ostream& printMatrixForm(std::ostream& strm) const
+    {
+      if (empty()) return strm;
+
+      for (size_type i = 0; i < n; ++i)
+	{
+	  for (size_type j = 0; j < n-1; ++j) strm << (*this)(i,j) << "\t";
+	  strm << (*this)(i,n-1) << std::endl;	// To avoid dangling tab.
+	}
+
+      return strm;
+    }
+
+private:
+  template<class Matrix>
+  void assign(const Matrix& A)
+    {
+      if (A.rows() != A.columns())
+	JLT_THROW(std::length_error("Matrix must be square in jlt::symmetric_matrix."));
+
+      n = A.rows();
+      a.resize(n*(n+1)/2);
+      for (size_type i = 0; i < n; ++i)
+	for (size_type j = 0; j <= i; ++j) a[index(i,j)] = A(i,j);
+    }
+};
+
+
+//
+// class triangular_matrix
+//
+
+template<class T, class Uplo = lower_triangle,
+	 class Alloc = aligned_allocator<T>>
+class triangular_matrix
+{
+public:
+  using value_type = T;
+  using allocator_type = Alloc;
+  using pointer = T *;
+  using const_pointer = const T *;
+  using iterator = pointer;
+  using const_iterator = const_pointer;
+  using reference = T &;
+  using const_reference = const T &;
+  using size_type = std::size_t;
+
+  static constexpr bool is_lower = std::is_same<Uplo,lower_triangle>::value;
+  static constexpr bool is_upper = std::is_same<Uplo,upper_triangle>::value;
+
+  static_assert(is_lower || is_upper,
+		"jlt::triangular_matrix: Uplo must be lower_triangle or upper_triangle.");
+
+private:
+  size_type n{0};
+  std::vector<T,Alloc> a;
+
+  // Position of row i in the packed storage.
+  size_type row_start(size_type i) const
+    {
+      return (is_lower ? i*(i+1)/2 : i*(2*n - i + 1)/2 - i);
+    }
+
+public:
+  // Is (i,j) in the stored triangle?
+  [[nodiscard]] static bool inTriangle(size_type i, size_type j)
+    {
+      return (is_lower ? j <= i : i <= j);
+    }
+
+  //
+  // Constructors
+  //
+
+  triangular_matrix() {}
+
+  // Matrix of size _n*_n, with the triangle filled with _x.
+  explicit triangular_matrix(size_type _n, const_reference _x = T())
+    : n(_n), a(_n*(_n+1)/2,_x) {}
+
+  // From the triangle of a square matrix or mathmatrix.  The other
+  // triangle is not referenced.
+  template<class Alloc2, class Order>
+  explicit triangular_matrix(const matrix<T,Alloc2,Order>& A)
+    {
+      assign(A);
+    }
+
+  // From the triangle of a square view.
+  template<class U>
+  explicit triangular_matrix(const matrix_view<U>& A)
+    {
+      assign(A);
+    }
+
+  //
+  // Element access.
+  //
+
+  // Only elements in the triangle can be written, or read through a
+  // non-const object: use a const reference, e.g. std::as_const(L)(i,j),
+  // to read the zeros outside it.
+  reference operator()(size_type i, size_type j)
+    {
+#ifdef MATRIX_CHECK_BOUNDS
+      return at(i,j);
+#else
+      assert(inTriangle(i,j));
+      return a[row_start(i) + j];
+#endif
+    }
+
+  // Elements outside the triangle are zero.
+  value_type operator()(size_type i, size_type j) const
+    {
+#ifdef MATRIX_CHECK_BOUNDS
+      return at(i,j);
+#else
+      return (inTriangle(i,j) ? a[row_start(i) + j] : T());
+#endif
+    }
+
+  reference at(size_type i, size_type j)
+    {
+      if (i >= n || j >= n || !inTriangle(i,j))
+	JLT_THROW(std::out_of_range("Out of range exception in jlt::triangular_matrix."));
+      return a[row_start(i) + j];
+    }
+
+  [[nodiscard]] value_type at(size_type i, size_type j) const
+    {
+      if (i >= n || j >= n)
+	JLT_THROW(std::out_of_range("Out of range exception in jlt::triangular_matrix."));
+      return (inTriangle(i,j) ? a[row_start(i) + j] : T());
+    }
+
+  // The packed triangle, n(n+1)/2 elements.
+  pointer data() { return a.data(); }
+  [[nodiscard]] const_pointer data() const { return a.data(); }
+  [[nodiscard]] size_type storage_size() const { return a.size(); }
+
+  [[nodiscard]] size_type size() const { return n*n; }
+  [[nodiscard]] size_type dim() const { return n; }
+  [[nodiscard]] size_type rows() const { return n; }
+  [[nodiscard]] size_type columns() const { return n; }
+  [[nodiscard]] bool empty() const { return (n == 0); }
+  [[nodiscard]] bool isSquare() const { return true; }
+
+  //
+  // Iterators, over the packed triangle.
+  //
+
+  iterator begin() { return a.data(); }
+  [[nodiscard]] const_iterator begin() const { return a.data(); }
+  [[nodiscard]] const_iterator cbegin() const { return a.data(); }
+  iterator end() { return a.data() + a.size(); }
+  [[nodiscard]] const_iterator end() const { return a.data() + a.size(); }
+  [[nodiscard]] const_iterator cend() const { return a.data() + a.size(); }
+
+  //
+  // Matrix Operations
+  //
+
+  triangular_matrix& operator+=(const triangular_matrix& A)
+    {
+      MATRIX_ASSERT(n == A.n);
+      for (size_type k = 0; k < a.size(); ++k) a[k] += A.a[k];
+      return *this;
+    }
+
+  triangular_matrix& operator-=(const triangular_matrix& A)
+    {
+      MATRIX_ASSERT(n == A.n);
+      for (size_type k = 0; k < a.size(); ++k) a[k] -= A.a[k];
+      return *this;
+    }
+
+  triangular_matrix& operator*=(const_reference x)
+    {
+      for (auto& y : a) y *= x;
+      return *this;
+    }
+
+  triangular_matrix& operator/=(const_reference x)
+    {
+      for (auto& y : a) y /= x;
+      return *this;
+    }
+
+  [[nodiscard]] T det() const
+    {
+      T d = 1;
+      for (size_type i = 0; i < n; ++i) d *= a[row_start(i) + i];
+      return d;
+    }
+
+  // Unpack into a full mathmatrix.
+  [[nodiscard]] mathmatrix<T> full() const
+    {
+      mathmatrix<T> A(n,n);
+      for (size_type i = 0; i < n; ++i)
+	for (size_type j = 0; j < n; ++j)
+	  if (inTriangle(i,j)) A(i,j) = a[row_start(i) + j];
+      return A;
+    }
+
+  //
+  // Output
+  //
+
+  // As for matrix, the whole matrix is printed.
+  std::ostream& printOn(std::ostream& strm) const
+    {
+      if (empty()) return strm;
+
+      for (size_type i = 0; i < n; ++i)
+	for (size_type j = 0; j < n; ++j)
+	  {
+	    strm << (*this)(i,j);
+	    if (i != n-1 || j != n-1) strm << "\t";	// No dangling tab.
+	  }
+
+      return strm;
+    }
+
+  std::ostream& printMatrixForm(std::ostream& strm) const
+    {
+      if (empty()) return strm;
+
+      for (size_type i = 0; i < n; ++i)
+	{
+	  for (size_type j = 0; j < n-1; ++j) strm << (*this)(i,j) << "\t";
+	  strm << (*this)(i,n-1) << std::endl;	// To avoid dangling tab.
+	}
+
+      return strm;
+    }
+
+private:
+  template<class Matrix>
+  void assign(const Matrix& A)
+    {
+      if (A.rows() != A.columns())
+	JLT_THROW(std::length_error("Matrix must be square in jlt::triangular_matrix."));
+
+      n = A.rows();
+      a.resize(n*(n+1)/2);
+      for (size_type i = 0; i < n; ++i)
+	for (size_type j = 0; j < n; ++j)
+	  if (inTriangle(i,j)) a[row_start(i) + j] = A(i,j);
+    }
+};
+
+
+//
+// Products
+//
+
+// These read each stored element once.  The result must already have
+// the right size and must not overlap the arguments; B and x may be
+// anything with element access, as for matrix_product() in
+// mathmatrix.hpp.
+
+// y = A*x: each off-diagonal element contributes to y[i] and y[j].
+template<class V_Y, class T, class Alloc, class V_X>
+inline void matrix_vector_product(V_Y&& y, const symmetric_matrix<T,Alloc>& A,
+				  const V_X& x)
+{
+  auto n = A.rows();
+
+  MATRIX_ASSERT(n == x.size() && y.size() == n);
+
+  for (decltype(n) i = 0; i < n; ++i) y[i] = 0;
+
+  const T *p = A.data();
+  for (decltype(n) i = 0; i < n; ++i, p += i)
+    {
+      auto xi = x[i];
+      auto sum = p[i]*xi;
+      for (decltype(n) j = 0; j < i; ++j)
+	{
+	  sum += p[j]*x[j];
+	  y[j] += p[j]*xi;
+	}
+      y[i] += sum;
+    }
+}
+
+// C = A*B, adding multiples of rows of B to rows of C.
+template<class M_C, class T, class Alloc, class M_B>
+inline void matrix_product(M_C&& C, const symmetric_matrix<T,Alloc>& A,
+			   const M_B& B)
+{
+  auto n = A.rows();
+  auto nb = B.columns();
+
+  MATRIX_ASSERT(n == B.rows() && C.rows() == n && C.columns() == nb);
+
+  for (decltype(n) i = 0; i < n; ++i)
+    for (decltype(nb) k = 0; k < nb; ++k) C(i,k) = 0;
+
+  const T *p = A.data();
+  for (decltype(n) i = 0; i < n; ++i, p += i)
+    {
+      for (decltype(n) j = 0; j < i; ++j)
+	{
+	  auto aij = p[j];
+	  for (decltype(nb) k = 0; k < nb; ++k)
+	    {
+	      C(i,k) += aij*B(j,k);
+	      C(j,k) += aij*B(i,k);
+	    }
+	}
+      auto aii = p[i];
+      for (decltype(nb) k = 0; k < nb; ++k) C(i,k) += aii*B(i,k);
+    }
+}
+
+template<class V_Y, class T, class Uplo, class Alloc, class V_X>
+inline void matrix_vector_product(V_Y&& y,
+				  const triangular_matrix<T,Uplo,Alloc>& A,
+				  const V_X& x)
+{
+  auto n = A.rows();
+
+  MATRIX_ASSERT(n == x.size() && y.size() == n);
+
+  const T *p = A.data();
+  for (decltype(n) i = 0; i < n; ++i)
+    {
+      // The stored part of row i is columns j0 to j1-1.
+      auto j0 = (A.is_lower ? 0 : i), j1 = (A.is_lower ? i+1 : n);
+      auto sum = p[0]*x[j0];
+      for (decltype(n) j = j0+1; j < j1; ++j) sum += p[j-j0]*x[j];
+      y[i] = sum;
+      p += j1 - j0;
+    }
+}
+
+template<class M_C, class T, class Uplo, class Alloc, class M_B>
+inline void matrix_product(M_C&& C, const triangular_matrix<T,Uplo,Alloc>& A,
+			   const M_B& B)
+{
+  auto n = A.rows();
+  auto nb = B.columns();
+
+  MATRIX_ASSERT(n == B.rows() && C.rows() == n && C.columns() == nb);
+
+  const T *p = A.data();
+  for (decltype(n) i = 0; i < n; ++i)
+    {
+      auto j0 = (A.is_lower ? 0 : i), j1 = (A.is_lower ? i+1 : n);
+      for (decltype(nb) k = 0; k < nb; ++k) C(i,k) = 0;
+      for (decltype(n) j = j0; j < j1; ++j)
+	{
+	  auto aij = p[j-j0];
+	  for (decltype(nb) k = 0; k < nb; ++k) C(i,k) += aij*B(j,k);
+	}
+      p += j1 - j0;
+    }
+}
+
+template<class T, class Alloc, class S, class A_M, class O_M>
+inline mathmatrix<T,S,A_M,O_M>
+operator*(const symmetric_matrix<T,Alloc>& A, const mathmatrix<T,S,A_M,O_M>& B)
+{
+  mathmatrix<T,S,A_M,O_M> res(A.rows(),B.columns(),default_init);
+  matrix_product(res,A,B);
+  return res;
+}
+
+template<class T, class Alloc, class U>
+inline mathmatrix<T>
+operator*(const symmetric_matrix<T,Alloc>& A, const matrix_view<U>& B)
+{
+  mathmatrix<T> res(A.rows(),B.columns(),default_init);
+  matrix_product(res,A,B);
+  return res;
+}
+
+template<class T, class Alloc, class S_V, class A_V>
+inline mathvector<T,S_V,A_V>
+operator*(const symmetric_matrix<T,Alloc>& A, const mathvector<T,S_V,A_V>& x)
+{
+  mathvector<T,S_V,A_V> res(A.rows());
+  matrix_vector_product(res,A,x);
+  return res;
+}
+
+template<class T, class Alloc, class U>
+inline mathvector<T>
+operator*(const symmetric_matrix<T,Alloc>& A, const vector_view<U>& x)
+{
+  mathvector<T> res(A.rows());
+  matrix_vector_product(res,A,x);
+  return res;
+}
+
+template<class T, class Uplo, class Alloc, class S, class A_M, class O_M>
+inline mathmatrix<T,S,A_M,O_M>
+operator*(const triangular_matrix<T,Uplo,Alloc>& A,
+	  const mathmatrix<T,S,A_M,O_M>& B)
+{
+  mathmatrix<T,S,A_M,O_M> res(A.rows(),B.columns(),default_init);
+  matrix_product(res,A,B);
+  return res;
+}
+
+template<class T, class Uplo, class Alloc, class U>
+inline mathmatrix<T>
+operator*(const triangular_matrix<T,Uplo,Alloc>& A, const matrix_view<U>& B)
+{
+  mathmatrix<T> res(A.rows(),B.columns(),default_init);
+  matrix_product(res,A,B);
+  return res;
+}
+
+template<class T, class Uplo, class Alloc, class S_V, class A_V>
+inline mathvector<T,S_V,A_V>
+operator*(const triangular_matrix<T,Uplo,Alloc>& A,
+	  const mathvector<T,S_V,A_V>& x)
+{
+  mathvector<T,S_V,A_V> res(A.rows());
+  matrix_vector_product(res,A,x);
+  return res;
+}
+
+template<class T, class Uplo, class Alloc, class U>
+inline mathvector<T>
+operator*(const triangular_matrix<T,Uplo,Alloc>& A, const vector_view<U>& x)
+{
+  mathvector<T> res(A.rows());
+  matrix_vector_product(res,A,x);
+  return res;
+}
+
+template<class T, class Alloc>
+std::ostream& operator<<(std::ostream& strm, const symmetric_matrix<T,Alloc>& A)
+{
+  return A.printOn(strm);
+}
+
+template<class T, class Uplo, class Alloc>
+std::ostream& operator<<(std::ostream& strm,
+			 const triangular_matrix<T,Uplo,Alloc>& A)
+{
+  return A.printOn(strm);
+}
+
+} // namespace jlt
+
+#endif // JLT_PACKED_MATRIX_HPP
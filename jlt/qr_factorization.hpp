@@ -0,0 +1,213 @@
+//
+// Copyright (c) 2004-2020 Jean-Luc Thiffeault <jeanluc@mailaps.org>
+//
+// See the file LICENSE for copying permission.
+//
+
+#ifndef JLT_QR_FACTORIZATION_HPP
+#define JLT_QR_FACTORIZATION_HPP
+
+//
+// qr_factorization.hpp
+//
+
+// The Householder QR factors of an m by n matrix, A = Q R, from the
+// blocked HouseholderQR of matrixutil.hpp, with Q kept implicit:
+//
+//   jlt::qr_factorization<double> qr(A);
+//   qr.apply_qt(B);                  // B = trans(Q) B
+//   auto Q1 = qr.q();                // m by min(m,n): the economy Q
+//   auto Q  = qr.q(false);           // m by m
+//   auto x  = qr.least_squares(b);   // minimises |A x - b|
+//
+// Applying Q or trans(Q) (adj(Q) for complex matrices) to r vectors
+// takes O(m min(m,n) r) operations, and the economy Q only m min(m,n)
+// storage, so that tall data matrices are never squared up.
+//
+// least_squares(A, b) solves the full-rank overdetermined problem
+// (m >= n) from R and trans(Q) b.  Unlike the normal equations
+// trans(A) A x = trans(A) b, this does not square the condition number
+// of A.  A rank-deficient A gives a zero on the diagonal of R, and
+// infinite or undefined components of x.  An underdetermined A (m < n)
+// or a right-hand side with the wrong number of rows throws
+// std::invalid_argument.
+
+#include <cstddef>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+#include <jlt/mathvector.hpp>
+#include <jlt/mathmatrix.hpp>
+#include <jlt/matrixutil.hpp>
+#include <jlt/blas1.hpp>
+#include <jlt/exceptions.hpp>
+
+namespace jlt {
+
+template<class T, class Matrix = mathmatrix<T>>
+class qr_factorization
+{
+public:
+  using value_type = T;
+  using size_type = std::size_t;
+  using matrix_type = Matrix;
+
+private:
+  Matrix QR;
+  std::vector<T> tau_;
+
+  void decompose()
+    {
+      tau_.resize(std::min(QR.rows(),QR.columns()));
+      HouseholderQR<T>(QR,tau_.data());
+    }
+
+  // Solve R X = trans(Q) B, in the first columns() rows of X.
+  template<class M_X>
+  void solve_r(M_X& X) const
+    {
+      if (rows() < columns())
+	JLT_THROW(std::invalid_argument("jlt::qr_factorization::least_squares: more columns than rows."));
+      if (X.rows() != rows())
+	JLT_THROW(std::invalid_argument("jlt::qr_factorization::least_squares: right-hand side has the wrong number of rows."));
+
+      apply_qt(X);
+      lu_detail::solve_upper<false,T>(QR,X,columns(),X.columns());
+    }
+
+public:
+  qr_factorization() {}
+
+  template<class M_A>
+  explicit qr_factorization(const M_A& A) { factor(A); }
+
+  explicit qr_factorization(Matrix&& A) { factor(std::move(A)); }
+
+  // Factor A, reusing the storage if A has the same shape as before.
+  template<class M_A>
+  void factor(const M_A& A)
+    {
+      if constexpr (std::is_same<M_A,Matrix>::value)
+	{
+	  QR = A;
+	}
+      else
+	{
+	  if (QR.rows() != A.rows() || QR.columns() != A.columns())
+	    {
+	      Matrix tmp(A.rows(),A.columns());
+	      QR.swap(tmp);
+	    }
+	  for (size_type i = 0; i < A.rows(); ++i)
+	    for (size_type j = 0; j < A.columns(); ++j) QR(i,j) = A(i,j);
+	}
+      decompose();
+    }
+
+  void factor(Matrix&& A)
+    {
+      QR.swap(A);
+      decompose();
+    }
+
+  [[nodiscard]] size_type rows() const { return QR.rows(); }
+  [[nodiscard]] size_type columns() const { return QR.columns(); }
+
+  // R on and above the diagonal, the Householder vectors below it.
+  [[nodiscard]] const Matrix& factors() const { return QR; }
+  [[nodiscard]] const std::vector<T>& tau() const { return tau_; }
+
+  //
+  // Q and R
+  //
+
+  // B = Q B, for a vector, matrix or view B with rows() rows.
+  template<class M_B>
+  void apply_q(M_B&& B) const
+    {
+      HouseholderQRapply<T>(QR,tau_.data(),blas1_view(B),false);
+    }
+
+  // B = trans(Q) B, or adj(Q) B for complex elements.
+  template<class M_B>
+  void apply_qt(M_B&& B) const
+    {
+      HouseholderQRapply<T>(QR,tau_.data(),blas1_view(B),true);
+    }
+
+  // The first min(rows(),columns()) columns of Q if economy is true,
+  // which span the columns of A, and all of Q otherwise.
+  [[nodiscard]] Matrix q(bool economy = true) const
+    {
+      const size_type m = rows(), k = (economy ? tau_.size() : m);
+      Matrix Q(m,k);
+      for (size_type i = 0; i < k; ++i) Q(i,i) = 1;
+      apply_q(Q);
+      return Q;
+    }
+
+  // The min(rows(),columns()) by columns() matrix R if economy is true,
+  // and R padded with zero rows to rows() by columns() otherwise.
+  [[nodiscard]] Matrix r(bool economy = true) const
+    {
+      const size_type m = (economy ? tau_.size() : rows()), n = columns();
+      Matrix R(m,n);
+      for (size_type i = 0; i < std::min(m,tau_.size()); ++i)
+	for (size_type j = i; j < n; ++j) R(i,j) = QR(i,j);
+      return R;
+    }
+
+  //
+  // Least squares
+  //
+
+  // The x that minimises |A x - b|, for rows() >= columns().  Throws
+  // std::invalid_argument otherwise.
+  template<class S_V, class A_V>
+  [[nodiscard]] mathvector<T,S_V,A_V>
+  least_squares(const mathvector<T,S_V,A_V>& b) const
+    {
+      mathvector<T,S_V,A_V> y(b);
+      auto Y = blas1_view(y);
+      solve_r(Y);
+      mathvector<T,S_V,A_V> x(columns());
+      for (size_type i = 0; i < columns(); ++i) x[i] = y[i];
+      return x;
+    }
+
+  // The same for each column of B.
+  template<class S_B, class A_B, class O_B>
+  [[nodiscard]] mathmatrix<T,S_B,A_B,O_B>
+  least_squares(const mathmatrix<T,S_B,A_B,O_B>& B) const
+    {
+      mathmatrix<T,S_B,A_B,O_B> Y(B);
+      solve_r(Y);
+      mathmatrix<T,S_B,A_B,O_B> X(columns(),B.columns());
+      X.view() = Y.block(0,0,columns(),B.columns());
+      return X;
+    }
+};
+
+// The x that minimises |A x - b|, for an m by n matrix A with m >= n
+// and full rank, by Householder QR of a copy of A.
+template<class T, class S, class Alloc, class Order, class S_V, class A_V>
+[[nodiscard]] inline mathvector<T,S_V,A_V>
+least_squares(const mathmatrix<T,S,Alloc,Order>& A,
+	      const mathvector<T,S_V,A_V>& b)
+{
+  return qr_factorization<T,mathmatrix<T,S,Alloc,Order>>(A).least_squares(b);
+}
+
+template<class T, class S, class Alloc, class Order,
+	 class S_B, class A_B, class O_B>
+[[nodiscard]] inline mathmatrix<T,S_B,A_B,O_B>
+least_squares(const mathmatrix<T,S,Alloc,Order>& A,
+	      const mathmatrix<T,S_B,A_B,O_B>& B)
+{
+  return qr_factorization<T,mathmatrix<T,S,Alloc,Order>>(A).least_squares(B);
+}
+
+} // namespace jlt
+
+#endif // JLT_QR_FACTORIZATION_HPP
@@ -0,0 +1,197 @@
+//
+// Copyright (c) 2004-2020 Jean-Luc Thiffeault <jeanluc@mailaps.org>
+//
+// See the file LICENSE for copying permission.
+//
+
+#ifndef JLT_SEMIRING_HPP
+#define JLT_SEMIRING_HPP
+
+//
+// semiring.hpp
+//
+
+// Matrix products over semirings other than (+,*):
+//
+//   boolean_semiring<T>     (or, and)   reachability, nonzero patterns
+//   max_plus_semiring<T>    (max, +)    longest paths, scheduling
+//   min_plus_semiring<T>    (min, +)    shortest paths
+//   modular_semiring<T>     (+, *) mod p
+//
+// A semiring is a class with members zero(), one(), add(a,b) and
+// mul(a,b); zero() must be the identity of add and annihilate mul.
+// The product
+//
+//   semiring_product(C, A, B, max_plus_semiring<double>());
+//   C = semiring_product(A, B, max_plus_semiring<double>());
+//
+// computes C(i,j) = add over k of mul(A(i,k),B(k,j)), for A, B and C
+// matrices, views or trans() of them; C must already have the right
+// size and must not overlap A or B.  The i-k-j loop skips the elements
+// of A equal to zero(), so sparse operands are cheap, and each row of C
+// is written by one thread.
+//
+// Boolean products of bit_matrix operands (see bit_matrix.hpp) use the
+// bit-packed kernel instead, 64 elements per word operation.
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <algorithm>
+#include <type_traits>
+#include <jlt/bit_matrix.hpp>
+#include <jlt/mathmatrix.hpp>
+#include <jlt/thread_pool.hpp>
+
+namespace jlt {
+
+//
+// Semirings
+//
+
+// Nonzero is true.  Results are T(0) or T(1).
+template<class T = bool>
+struct boolean_semiring
+{
+  using value_type = T;
+
+  [[nodiscard]] T zero() const { return T(0); }
+  [[nodiscard]] T one() const { return T(1); }
+  [[nodiscard]] T add(const T& a, const T& b) const
+    { return (a != T(0) || b != T(0)) ? T(1) : T(0); }
+  [[nodiscard]] T mul(const T& a, const T& b) const
+    { return (a != T(0) && b != T(0)) ? T(1) : T(0); }
+};
+
+// zero() is -infinity, or the lowest value for types without infinity.
+template<class T>
+struct max_plus_semiring
+{
+  using value_type = T;
+
+  [[nodiscard]] T zero() const
+    {
+      return (std::numeric_limits<T>::has_infinity ?
+	      -std::numeric_limits<T>::infinity() :
+	      std::numeric_limits<T>::lowest());
+    }
+  [[nodiscard]] T one() const { return T(0); }
+  [[nodiscard]] T add(const T& a, const T& b) const { return std::max(a,b); }
+  [[nodiscard]] T mul(const T& a, const T& b) const
+    { return (a == zero() || b == zero()) ? zero() : a + b; }
+};
+
+// zero() is +infinity, or the largest value for types without infinity.
+template<class T>
+struct min_plus_semiring
+{
+  using value_type = T;
+
+  [[nodiscard]] T zero() const
+    {
+      return (std::numeric_limits<T>::has_infinity ?
+	      std::numeric_limits<T>::infinity() :
+	      std::numeric_limits<T>::max());
+    }
+  [[nodiscard]] T one() const { return T(0); }
+  [[nodiscard]] T add(const T& a, const T& b) const { return std::min(a,b); }
+  [[nodiscard]] T mul(const T& a, const T& b) const
+    { return (a == zero() || b == zero()) ? zero() : a + b; }
+};
+
+// Integers modulo p, for unsigned or nonnegative elements less than p.
+// Products are formed in 128 bits where the compiler has them, so p
+// can be any 64-bit modulus; otherwise p must be below 2^32.
+template<class T>
+struct modular_semiring
+{
+  static_assert(std::is_integral<T>::value,
+		"jlt::modular_semiring: element type must be integral.");
+
+  using value_type = T;
+
+  T p;
+
+  explicit modular_semiring(const T& _p) : p(_p) {}
+
+  [[nodiscard]] T zero() const { return T(0); }
+  [[nodiscard]] T one() const { return T(1) % p; }
+  [[nodiscard]] T add(const T& a, const T& b) const
+    {
+      // a + b without overflow, since a,b < p.
+      return (a >= p - b ? a - (p - b) : a + b);
+    }
+  [[nodiscard]] T mul(const T& a, const T& b) const
+    {
+#ifdef __SIZEOF_INT128__
+      return T((unsigned __int128)a*b % p);
+#else
+      return T((std::uint64_t)a*b % p);
+#endif
+    }
+};
+
+//
+// Products
+//
+
+// C = A*B over the semiring sr.
+template<class Semiring, class M_C, class M_A, class M_B>
+void semiring_product(M_C&& C, const M_A& A, const M_B& B,
+		      const Semiring& sr)
+{
+  using T = typename Semiring::value_type;
+  using std::size_t;
+
+  const size_t m = A.rows(), l = A.columns(), n = B.columns();
+
+  MATRIX_ASSERT(l == B.rows() && C.rows() == m && C.columns() == n);
+
+  const T zero = sr.zero();
+
+  parallel_for(0,m,JLT_PARALLEL_GRAIN/(l*n + 1) + 1,
+	       [&](size_t i0, size_t i1)
+	       {
+		 for (size_t i = i0; i < i1; ++i)
+		   {
+		     for (size_t j = 0; j < n; ++j) C(i,j) = zero;
+		     for (size_t k = 0; k < l; ++k)
+		       {
+			 const T aik = A(i,k);
+			 if (aik == zero) continue;
+			 for (size_t j = 0; j < n; ++j)
+			   C(i,j) = sr.add(C(i,j),sr.mul(aik,B(k,j)));
+		       }
+		   }
+	       });
+}
+
+// The Boolean product of bit matrices uses the packed kernel.
+template<class T>
+inline void semiring_product(bit_matrix& C, const bit_matrix& A,
+			     const bit_matrix& B, const boolean_semiring<T>&)
+{
+  boolean_product(C,A,B);
+}
+
+template<class T>
+inline bit_matrix semiring_product(const bit_matrix& A, const bit_matrix& B,
+				   const boolean_semiring<T>&)
+{
+  return A*B;
+}
+
+template<class Semiring, class T, class S, class Alloc, class Order>
+inline mathmatrix<T,S,Alloc,Order>
+semiring_product(const mathmatrix<T,S,Alloc,Order>& A,
+		 const mathmatrix<T,S,Alloc,Order>& B,
+		 const Semiring& sr)
+{
+  mathmatrix<T,S,Alloc,Order> C(A.rows(),B.columns(),default_init);
+  semiring_product(C,A,B,sr);
+  return C;
+}
+
+} // namespace jlt
+
+#endif // JLT_SEMIRING_HPP
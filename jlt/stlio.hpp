@@ -119,8 +119,8 @@ struct format_traits<long double> {
 const char format_traits<long double>::field_sep[] = "  ";
 #endif
 
-template<class T>
-std::ostream& operator<<(std::ostream& strm, const std::vector<T>& vv)
+template<class T, class Alloc>
+std::ostream& operator<<(std::ostream& strm, const std::vector<T,Alloc>& vv)
 {
   if (vv.size() == 0) return strm;
 
@@ -256,8 +256,8 @@ std::ostream& operator<<(std::ostream& strm, const std::map<double,T>& mm)
 //
 
 // Read vv.size() elements from strm, overwriting content of vv.
-template<class T>
-std::istream& operator>>(std::istream& strm, std::vector<T>& vv)
+template<class T, class Alloc>
+std::istream& operator>>(std::istream& strm, std::vector<T,Alloc>& vv)
 {
   for (auto i = vv.begin(); i != vv.end(); ++i)
     {
@@ -0,0 +1,266 @@
+//
+// Copyright (c) 2004-2020 Jean-Luc Thiffeault <jeanluc@mailaps.org>
+//
+// See the file LICENSE for copying permission.
+//
+
+#ifndef JLT_STRASSEN_HPP
+#define JLT_STRASSEN_HPP
+
+//
+// strassen.hpp
+//
+
+// Matrix product C = A*B by the Strassen-Winograd recursion, which
+// replaces 8 half-size products by 7 products and 15 additions.  The
+// number of operations then grows as n^2.81 rather than n^3.
+//
+//   strassen_product(C, A, B);            // crossover JLT_STRASSEN_CROSSOVER
+//   strassen_product(C, A, B, 256);
+//
+// Products whose smallest dimension is below the crossover use the
+// base kernel: gemm() (see gemm.hpp) for float, double and complex,
+// and a plain i-k-j loop for other element types.  Odd dimensions are
+// handled by peeling off the last row, column or inner index and
+// fixing up the result with thin products.  The operands may be
+// matrix, mathmatrix, matrix_view or trans() of them, of any shape; C
+// must already have the right size and must not overlap A or B.
+//
+// The temporaries of every level of the recursion come from a single
+// arena, allocated once per product, following the schedule of Boyer,
+// Dumas, Pernet and Zhou (ISSAC 2009), which needs only two
+// temporaries per level: for n by n matrices the arena holds less than
+// (2/3)n^2 elements in all.
+//
+// If JLT_USE_STRASSEN is defined, operator* for two mathmatrix
+// operands (in mathmatrix.hpp) calls strassen_product() when all their
+// dimensions are at least JLT_STRASSEN_CROSSOVER.
+//
+// Accuracy: for floating-point types, the error of Strassen-Winograd
+// is only bounded normwise, ||C - fl(C)|| <= c n^(log2 18) u ||A|| ||B||
+// (Higham, Accuracy and Stability of Numerical Algorithms, ch. 23),
+// whereas the classical product has a componentwise bound.  Elements
+// of C much smaller than ||A|| ||B|| can thus lose relative accuracy,
+// for instance for matrices with widely varying scales.  For exact
+// types (integers, rationals, modular integers) there is no accuracy
+// penalty, but the intermediate sums can be up to four times larger
+// than the elements of A and B, so signed integer types need that
+// much headroom.  Unsigned types wrap around consistently and give
+// the same result modulo 2^w as the classical product.
+
+#include <cstddef>
+#include <algorithm>
+#include <vector>
+#include <type_traits>
+#include <jlt/aligned_allocator.hpp>
+#include <jlt/matrix_view.hpp>
+#include <jlt/gemm.hpp>
+
+// Products whose smallest dimension is below this use the base kernel.
+#ifndef JLT_STRASSEN_CROSSOVER
+#  define JLT_STRASSEN_CROSSOVER 512
+#endif
+
+#ifndef MATRIX_ASSERT
+#  define MATRIX_ASSERT(x)
+#endif
+
+namespace jlt {
+
+namespace strassen_detail {
+
+using std::size_t;
+
+// C(i,j) = op(A(i,j),B(i,j)) on views.  C may coincide with A or B.
+// The inner loop uses plain pointers when the rows are contiguous, as
+// they are for the arena and for row-major matrices.
+template<class T, class Op>
+inline void elementwise(const matrix_view<T>& C, const matrix_view<const T>& A,
+			const matrix_view<const T>& B, Op op)
+{
+  const size_t m = C.rows(), n = C.columns();
+
+  if (C.column_stride() == 1 && A.column_stride() == 1 &&
+      B.column_stride() == 1)
+    {
+      for (size_t i = 0; i < m; ++i)
+	{
+	  T *c = &C(i,0);
+	  const T *a = &A(i,0), *b = &B(i,0);
+	  for (size_t j = 0; j < n; ++j) c[j] = op(a[j],b[j]);
+	}
+    }
+  else
+    {
+      for (size_t i = 0; i < m; ++i)
+	for (size_t j = 0; j < n; ++j) C(i,j) = op(A(i,j),B(i,j));
+    }
+}
+
+template<class T>
+inline void add(const matrix_view<T>& C, const matrix_view<const T>& A,
+		const matrix_view<const T>& B)
+{
+  elementwise(C,A,B,[](const T& a, const T& b) { return a + b; });
+}
+
+template<class T>
+inline void sub(const matrix_view<T>& C, const matrix_view<const T>& A,
+		const matrix_view<const T>& B)
+{
+  elementwise(C,A,B,[](const T& a, const T& b) { return a - b; });
+}
+
+// C = A*B, or C += A*B if accumulate is true, by the base kernel.
+template<class T>
+inline void base_product(const matrix_view<T>& C, const matrix_view<const T>& A,
+			 const matrix_view<const T>& B, bool accumulate = false)
+{
+  if constexpr (is_gemm_type<T>::value)
+    {
+      gemm(T(1),A,B,(accumulate ? T(1) : T(0)),C);
+    }
+  else
+    {
+      const size_t m = A.rows(), k = A.columns(), n = B.columns();
+      const bool contiguous = (C.column_stride() == 1 &&
+			       B.column_stride() == 1);
+
+      // i-k-j order, so that the inner loop runs along rows of B and C.
+      for (size_t i = 0; i < m; ++i)
+	{
+	  if (!accumulate) for (size_t j = 0; j < n; ++j) C(i,j) = T(0);
+	  for (size_t l = 0; l < k; ++l)
+	    {
+	      const T ail = A(i,l);
+	      if (contiguous)
+		{
+		  T *c = &C(i,0);
+		  const T *b = &B(l,0);
+		  for (size_t j = 0; j < n; ++j) c[j] += ail*b[j];
+		}
+	      else
+		{
+		  for (size_t j = 0; j < n; ++j) C(i,j) += ail*B(l,j);
+		}
+	    }
+	}
+    }
+}
+
+inline bool recurse(size_t m, size_t k, size_t n, size_t crossover)
+{
+  return std::min(m,std::min(k,n)) >= std::max<size_t>(crossover,2);
+}
+
+// Elements of the arena needed for an m by k times k by n product.
+inline size_t workspace(size_t m, size_t k, size_t n, size_t crossover)
+{
+  size_t ws = 0;
+  while (recurse(m,k,n,crossover))
+    {
+      m /= 2; k /= 2; n /= 2;
+      ws += m*std::max(k,n) + k*n;
+    }
+  return ws;
+}
+
+// C = A*B with the arena starting at w.
+template<class T>
+void product(const matrix_view<T>& C, const matrix_view<const T>& A,
+	     const matrix_view<const T>& B, size_t crossover, T *w)
+{
+  const size_t m = A.rows(), k = A.columns(), n = B.columns();
+
+  if (!recurse(m,k,n,crossover))
+    {
+      base_product(C,A,B);
+      return;
+    }
+
+  const size_t mh = m/2, kh = k/2, nh = n/2;
+
+  const auto A11 = A.block(0,0,mh,kh),  A12 = A.block(0,kh,mh,kh);
+  const auto A21 = A.block(mh,0,mh,kh), A22 = A.block(mh,kh,mh,kh);
+  const auto B11 = B.block(0,0,kh,nh),  B12 = B.block(0,nh,kh,nh);
+  const auto B21 = B.block(kh,0,kh,nh), B22 = B.block(kh,nh,kh,nh);
+  const auto C11 = C.block(0,0,mh,nh),  C12 = C.block(0,nh,mh,nh);
+  const auto C21 = C.block(mh,0,mh,nh), C22 = C.block(mh,nh,mh,nh);
+
+  // Temporaries: X holds sums of blocks of A and then P1, Y sums of
+  // blocks of B.  The rest of the arena is for the next level.
+  const size_t ldx = std::max(kh,nh);
+  T *x = w, *y = w + mh*ldx, *wnext = y + kh*nh;
+  const matrix_view<T> X(x,mh,kh,ldx), Y(y,kh,nh,nh), P1(x,mh,nh,ldx);
+
+  // Schedule of Boyer et al., Table 1.
+  sub<T>(X,A11,A21);			// S3
+  sub<T>(Y,B22,B12);			// T3
+  product<T>(C21,X,Y,crossover,wnext);	// P7 = S3*T3
+  add<T>(X,A21,A22);			// S1
+  sub<T>(Y,B12,B11);			// T1
+  product<T>(C22,X,Y,crossover,wnext);	// P5 = S1*T1
+  sub<T>(X,X,A11);			// S2 = S1 - A11
+  sub<T>(Y,B22,Y);			// T2 = B22 - T1
+  product<T>(C12,X,Y,crossover,wnext);	// P6 = S2*T2
+  sub<T>(X,A12,X);			// S4 = A12 - S2
+  sub<T>(Y,Y,B21);			// T4 = T2 - B21
+  product<T>(C11,X,B22,crossover,wnext);	// P3 = S4*B22
+  product<T>(P1,A11,B11,crossover,wnext);	// P1
+  add<T>(C12,P1,C12);			// U2 = P1 + P6
+  add<T>(C21,C12,C21);			// U3 = U2 + P7
+  add<T>(C12,C12,C22);			// U4 = U2 + P5
+  add<T>(C22,C21,C22);			// U7 = U3 + P5 = C22
+  add<T>(C12,C12,C11);			// U5 = U4 + P3 = C12
+  product<T>(C11,A22,Y,crossover,wnext);	// P4 = A22*T4
+  sub<T>(C21,C21,C11);			// U6 = U3 - P4 = C21
+  product<T>(C11,A12,B21,crossover,wnext);	// P2
+  add<T>(C11,P1,C11);			// U1 = P1 + P2 = C11
+
+  // Odd dimensions: the even part is done, fix up the rest.
+  const size_t me = 2*mh, ke = 2*kh, ne = 2*nh;
+
+  if (k > ke)
+    {
+      // Rank-one update with the last column of A and last row of B.
+      base_product(C.block(0,0,me,ne),A.block(0,ke,me,1),B.block(ke,0,1,ne),
+		   true);
+    }
+  if (n > ne)
+    {
+      base_product(C.block(0,ne,m,1),A,B.block(0,ne,k,1));
+    }
+  if (m > me)
+    {
+      base_product(C.block(me,0,1,ne),A.block(me,0,1,k),B.block(0,0,k,ne));
+    }
+}
+
+} // namespace strassen_detail
+
+// C = A*B by Strassen-Winograd, with the base kernel for products
+// whose smallest dimension is below crossover.
+template<class M_C, class M_A, class M_B>
+void strassen_product(M_C&& C, const M_A& A, const M_B& B,
+		      std::size_t crossover = JLT_STRASSEN_CROSSOVER)
+{
+  auto c = gemm_operand(C);
+  using T = typename decltype(c)::value_type;
+  const matrix_view<const T> a = gemm_operand(A), b = gemm_operand(B);
+
+  MATRIX_ASSERT(a.columns() == b.rows() &&
+		c.rows() == a.rows() && c.columns() == b.columns());
+
+  if (c.empty()) return;
+
+  // The whole arena, left uninitialised.
+  std::vector<T,aligned_allocator<T,JLT_DEFAULT_ALIGNMENT,alloc_default_init>>
+    arena(strassen_detail::workspace(a.rows(),a.columns(),b.columns(),
+				     crossover));
+
+  strassen_detail::product<T>(c,a,b,crossover,arena.data());
+}
+
+} // namespace jlt
+
+#endif // JLT_STRASSEN_HPP
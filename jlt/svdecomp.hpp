@@ -10,6 +10,7 @@
 #include <jlt/matrix.hpp>
 #include <jlt/lapack.hpp>
 #include <cassert>
+#include <utility>
 
 // No data() method in std::vector prior to GCC 4.1.
 #if (__GNUC__ < 4 || (__GNUC__ == 4 && __GNUC_MINOR__ < 1))
@@ -28,11 +29,16 @@ namespace jlt {
 //
 // The M by N matrix A is the input, is destroyed on return.
 //
+// LAPACK expects column-major storage.  A column-major A is passed to
+// it directly; a row-major A is seen by LAPACK as its transpose, so the
+// roles of U and Vt are exchanged in the call.  Either way no copy of A
+// is made.
+//
 
-template<class T>
-int SVdecomp(matrix<T>& A,
-	     matrix<T>& U,
-	     matrix<T>& Vt,
+template<class T, class Alloc, class Order>
+int SVdecomp(matrix<T,Alloc,Order>& A,
+	     matrix<T,Alloc,Order>& U,
+	     matrix<T,Alloc,Order>& Vt,
 	     std::vector<T>& w)
 {
   using std::min;
@@ -46,6 +52,21 @@ int SVdecomp(matrix<T>& A,
   int M = A.rows(), N = A.columns();	// Dimensions of matrix.
   int info;
 
+# if !defined(JLT_NO_VECTOR_DATA_METHOD)
+  T *Ap = A.data(), *Up = U.data(), *Vtp = Vt.data();
+# else
+  T *Ap = &(*A.begin()), *Up = &(*U.begin()), *Vtp = &(*Vt.begin());
+# endif
+
+  // Dimensions and output arrays as seen by LAPACK.
+  int m = N, n = M;
+  T *u = Vtp, *vt = Up;
+  if constexpr (matrix<T,Alloc,Order>::is_column_major)
+    {
+      m = M; n = N;
+      u = Up; vt = Vtp;
+    }
+
 #ifdef JLT_MIN_WORKSIZE
   // Use the smallest possible workspace.
   int worksize = max(3*min(M,N)+max(M,N),5*min(M,N));
@@ -55,14 +76,8 @@ int SVdecomp(matrix<T>& A,
   int worksize = -1;
   T tmpwork[1];
 
-# if !defined(JLT_NO_VECTOR_DATA_METHOD)
-  lapack::gesvd(&jobu, &jobvt, &N, &M, A.data(), &N, w.data(),
-		Vt.data(), &N, U.data(), &M, tmpwork, &worksize, &info);
-# else
-  lapack::gesvd(&jobu, &jobvt, &N, &M, &(*A.begin()), &N, &(*w.begin()),
-		&(*Vt.begin()), &N, &(*U.begin()), &M,
-		tmpwork, &worksize, &info);
-#endif
+  lapack::gesvd(&jobu, &jobvt, &m, &n, Ap, &m, &(*w.begin()),
+		u, &m, vt, &n, tmpwork, &worksize, &info);
 
   worksize = (int)tmpwork[0];
 
@@ -75,21 +90,15 @@ int SVdecomp(matrix<T>& A,
   std::vector<T> work(worksize);
 #endif
 
-# if !defined(JLT_NO_VECTOR_DATA_METHOD)
-  lapack::gesvd(&jobu, &jobvt, &N, &M, A.data(), &N, w.data(), Vt.data(), &N,
-		U.data(), &M, work.data(), &worksize, &info);
-# else
-  lapack::gesvd(&jobu, &jobvt, &N, &M, &(*A.begin()), &N, &(*w.begin()),
-		&(*Vt.begin()), &N, &(*U.begin()), &M,
-		&(*work.begin()), &worksize, &info);
-# endif
+  lapack::gesvd(&jobu, &jobvt, &m, &n, Ap, &m, &(*w.begin()),
+		u, &m, vt, &n, &(*work.begin()), &worksize, &info);
 
   return info;
 }
 
 
-template<class T>
-int SVdecomp(matrix<T>& A, std::vector<T>& w)
+template<class T, class Alloc, class Order>
+int SVdecomp(matrix<T,Alloc,Order>& A, std::vector<T>& w)
 {
   using std::min;
   using std::max;
@@ -97,7 +106,10 @@ int SVdecomp(matrix<T>& A, std::vector<T>& w)
   char jobu = 'N', jobvt = 'N';		// 'N' - only singular values
 					// are computed.
 
+  // A row-major A is seen by LAPACK as its transpose, which has the
+  // same singular values.
   int M = A.rows(), N = A.columns();	// Dimensions of matrix.
+  if constexpr (matrix<T,Alloc,Order>::is_column_major) std::swap(M,N);
   int info;
 
 #ifdef JLT_MIN_WORKSIZE
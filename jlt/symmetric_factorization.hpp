@@ -0,0 +1,279 @@
+//
+// Copyright (c) 2004-2020 Jean-Luc Thiffeault <jeanluc@mailaps.org>
+//
+// See the file LICENSE for copying permission.
+//
+
+#ifndef JLT_SYMMETRIC_FACTORIZATION_HPP
+#define JLT_SYMMETRIC_FACTORIZATION_HPP
+
+//
+// symmetric_factorization.hpp
+//
+
+// Factors of symmetric matrices, kept for repeated solves as
+// lu_factorization (lu_factorization.hpp) keeps those of LU:
+//
+//   cholesky_factorization<T>   A = L trans(L) (L adj(L) if complex)
+//                               for positive-definite A, e.g. diffusion
+//                               operators, normal equations or
+//                               covariance matrices.  Throws if A is
+//                               not positive-definite.
+//   ldlt_factorization<T>       P A trans(P) = L D trans(L) with
+//                               Bunch-Kaufman pivoting, for any
+//                               nonsingular symmetric A.
+//
+// Both are computed by the blocked Choleskydecomp and LDLTdecomp of
+// matrixutil.hpp (or LAPACK's xPOTRF and xSYTRF with JLT_USE_LAPACK),
+// in n^3/6 multiply-adds, half of LU, and read only the lower triangle
+// of A.  factor() reuses the storage already held for a matrix of the
+// same size, and an rvalue Matrix is factored in its own storage.
+// solve() works on vectors, or on matrices or views with several
+// right-hand sides at once.
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+#include <utility>
+#include <type_traits>
+#include <jlt/mathvector.hpp>
+#include <jlt/mathmatrix.hpp>
+#include <jlt/matrixutil.hpp>
+#include <jlt/blas1.hpp>
+
+namespace jlt {
+
+namespace symmetric_detail {
+
+// Copy the lower triangle of the square matrix A into M, resizing M
+// only if needed.
+template<class Matrix, class M_A>
+void copy_lower(Matrix& M, const M_A& A)
+{
+  using size_type = typename Matrix::size_type;
+
+  MATRIX_ASSERT(A.rows() == A.columns());
+
+  const size_type n = A.rows();
+  if (M.rows() != n || M.columns() != n)
+    {
+      Matrix tmp(n,n);
+      M.swap(tmp);
+    }
+  for (size_type i = 0; i < n; ++i)
+    for (size_type j = 0; j <= i; ++j) M(i,j) = A(i,j);
+}
+
+} // namespace symmetric_detail
+
+//
+// class cholesky_factorization
+//
+
+template<class T, class Matrix = mathmatrix<T>>
+class cholesky_factorization
+{
+public:
+  using value_type = T;
+  using size_type = std::size_t;
+  using matrix_type = Matrix;
+  using real_type = decltype(std::abs(T()));
+
+private:
+  Matrix L;
+
+public:
+  cholesky_factorization() {}
+
+  template<class M_A>
+  explicit cholesky_factorization(const M_A& A) { factor(A); }
+
+  explicit cholesky_factorization(Matrix&& A) { factor(std::move(A)); }
+
+  template<class M_A>
+  void factor(const M_A& A)
+    {
+      symmetric_detail::copy_lower(L,A);
+      Choleskydecomp<T>(L);
+    }
+
+  void factor(Matrix&& A)
+    {
+      MATRIX_ASSERT(A.rows() == A.columns());
+
+      L.swap(A);
+      Choleskydecomp<T>(L);
+    }
+
+  [[nodiscard]] size_type dim() const { return L.rows(); }
+
+  // L in the lower triangle; the upper triangle is not used.
+  [[nodiscard]] const Matrix& factors() const { return L; }
+
+  // Overwrite b, or the columns of the matrix or view B, with the
+  // solution of A x = b.
+  template<class M_B>
+  void solve_in_place(M_B&& B) const
+    {
+      Choleskysolve<T>(L,blas1_view(B));
+    }
+
+  template<class S_V, class A_V>
+  [[nodiscard]] mathvector<T,S_V,A_V>
+  solve(const mathvector<T,S_V,A_V>& b) const
+    {
+      mathvector<T,S_V,A_V> x(b);
+      solve_in_place(x);
+      return x;
+    }
+
+  template<class S_B, class A_B, class O_B>
+  [[nodiscard]] mathmatrix<T,S_B,A_B,O_B>
+  solve(const mathmatrix<T,S_B,A_B,O_B>& B) const
+    {
+      mathmatrix<T,S_B,A_B,O_B> X(B);
+      solve_in_place(X);
+      return X;
+    }
+
+  // det(A) = prod L(i,i)^2, which may overflow for large n.
+  [[nodiscard]] real_type det() const
+    {
+      real_type d = 1;
+      for (size_type i = 0; i < dim(); ++i) d *= std::norm(L(i,i));
+      return d;
+    }
+
+  // log(det(A)), without overflow.
+  [[nodiscard]] real_type logdet() const
+    {
+      using std::log;
+
+      real_type ld = 0;
+      for (size_type i = 0; i < dim(); ++i) ld += log(std::real(L(i,i)));
+      return 2*ld;
+    }
+};
+
+//
+// class ldlt_factorization
+//
+
+template<class T, class Matrix = mathmatrix<T>>
+class ldlt_factorization
+{
+public:
+  using value_type = T;
+  using size_type = std::size_t;
+  using matrix_type = Matrix;
+  using real_type = decltype(std::abs(T()));
+
+private:
+  Matrix LD;
+  std::vector<int> ipiv;
+  bool sing{false};
+
+  void decompose()
+    {
+      ipiv.resize(LD.rows());
+      sing = LDLTdecomp<T>(LD,ipiv.data());
+    }
+
+  // Determinant of the block of D starting at row k.
+  T block_det(size_type k) const
+    {
+      if (ipiv[k] >= 0) return LD(k,k);
+      return LD(k,k)*LD(k+1,k+1) - LD(k+1,k)*LD(k+1,k);
+    }
+
+public:
+  ldlt_factorization() {}
+
+  template<class M_A>
+  explicit ldlt_factorization(const M_A& A) { factor(A); }
+
+  explicit ldlt_factorization(Matrix&& A) { factor(std::move(A)); }
+
+  template<class M_A>
+  void factor(const M_A& A)
+    {
+      symmetric_detail::copy_lower(LD,A);
+      decompose();
+    }
+
+  void factor(Matrix&& A)
+    {
+      MATRIX_ASSERT(A.rows() == A.columns());
+
+      LD.swap(A);
+      decompose();
+    }
+
+  [[nodiscard]] size_type dim() const { return LD.rows(); }
+
+  // L and D in the lower triangle, in the format of LDLTdecomp.
+  [[nodiscard]] const Matrix& factors() const { return LD; }
+
+  // The interchanges of LDLTdecomp, counted from zero.
+  [[nodiscard]] const std::vector<int>& pivots() const { return ipiv; }
+
+  // Is D exactly singular?  Solves are then meaningless.
+  [[nodiscard]] bool singular() const { return sing; }
+
+  template<class M_B>
+  void solve_in_place(M_B&& B) const
+    {
+      LDLTsolve<T>(LD,ipiv.data(),blas1_view(B));
+    }
+
+  template<class S_V, class A_V>
+  [[nodiscard]] mathvector<T,S_V,A_V>
+  solve(const mathvector<T,S_V,A_V>& b) const
+    {
+      mathvector<T,S_V,A_V> x(b);
+      solve_in_place(x);
+      return x;
+    }
+
+  template<class S_B, class A_B, class O_B>
+  [[nodiscard]] mathmatrix<T,S_B,A_B,O_B>
+  solve(const mathmatrix<T,S_B,A_B,O_B>& B) const
+    {
+      mathmatrix<T,S_B,A_B,O_B> X(B);
+      solve_in_place(X);
+      return X;
+    }
+
+  // det(A) = det(D), which may overflow for large n.
+  [[nodiscard]] T det() const
+    {
+      T d = 1;
+      for (size_type k = 0; k < dim(); k += (ipiv[k] >= 0 ? 1 : 2))
+	d *= block_det(k);
+      return d;
+    }
+
+  // log|det(A)|, without overflow.  If sign is not null it is set to
+  // det(A)/|det(A)|.
+  [[nodiscard]] real_type logdet(T* sign = nullptr) const
+    {
+      using std::abs;
+      using std::log;
+
+      real_type ld = 0;
+      T s = 1;
+      for (size_type k = 0; k < dim(); k += (ipiv[k] >= 0 ? 1 : 2))
+	{
+	  const T d = block_det(k);
+	  const real_type a = abs(d);
+	  ld += log(a);
+	  s *= d/a;
+	}
+      if (sign) *sign = s;
+      return ld;
+    }
+};
+
+} // namespace jlt
+
+#endif // JLT_SYMMETRIC_FACTORIZATION_HPP
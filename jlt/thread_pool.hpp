@@ -0,0 +1,274 @@
+//
+// Copyright (c) 2004-2020 Jean-Luc Thiffeault <jeanluc@mailaps.org>
+//
+// See the file LICENSE for copying permission.
+//
+
+#ifndef JLT_THREAD_POOL_HPP
+#define JLT_THREAD_POOL_HPP
+
+//
+// thread_pool.hpp
+//
+
+// A pool of worker threads shared by the dense kernels of the library
+// (matrix products, element-wise operations, transposes, inverses),
+// so that threads are started once rather than for every operation.
+//
+//   jlt::parallel_for(0, n, grain, [&](std::size_t i0, std::size_t i1)
+//                     { for (auto i = i0; i < i1; ++i) y[i] = f(x[i]); });
+//
+// splits [0,n) into contiguous ranges of at least grain indices, runs
+// them on the pool and the calling thread, and returns when all are
+// done.  A range smaller than 2*grain is run directly by the caller,
+// so small problems pay no threading overhead.  A parallel_for called
+// from inside another (e.g. a product inside a parallel loop) also
+// runs serially, in the thread that called it, whether that is a
+// worker or the caller of the outer parallel_for running its own range.
+//
+// The kernels of the library call parallel_for over independent pieces
+// of their output (rows or columns of a result, tiles, or slices of a
+// flat loop), with a grain chosen so that each range holds about
+// JLT_PARALLEL_GRAIN operations.  Every piece is written by a single
+// thread, so the kernels need no locks.
+//
+// The number of threads, including the calling thread, is taken from
+// the environment variable JLT_NUM_THREADS if it is set, and otherwise
+// from std::thread::hardware_concurrency().  It can be changed with
+// jlt::set_num_threads(), but not while a parallel_for is running.
+// Defining JLT_NO_THREADS makes every parallel_for serial.
+//
+// Programs using the pool must be linked with -pthread.
+
+#include <cstddef>
+#include <cstdlib>
+#include <algorithm>
+#include <vector>
+#include <deque>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+
+// Default grain for element-wise loops, in elements: below twice this
+// a loop runs in a single thread.
+#ifndef JLT_PARALLEL_GRAIN
+#  define JLT_PARALLEL_GRAIN 32768
+#endif
+
+namespace jlt {
+
+class thread_pool
+{
+public:
+  // A pool with nthreads threads in total: the calling thread and
+  // nthreads-1 workers.
+  explicit thread_pool(unsigned nthreads = default_size())
+    {
+      start(nthreads);
+    }
+
+  thread_pool(const thread_pool&) = delete;
+  thread_pool& operator=(const thread_pool&) = delete;
+
+  ~thread_pool() { stop(); }
+
+  // Number of threads, including the calling thread.
+  [[nodiscard]] unsigned size() const { return (unsigned)workers.size() + 1; }
+
+  // Restart with a different number of threads.  Must not be called
+  // while a parallel_for is running.
+  void resize(unsigned nthreads)
+    {
+      if (nthreads < 1) nthreads = 1;
+      if (nthreads == size()) return;
+      stop();
+      start(nthreads);
+    }
+
+  // Call f(i0,i1) on contiguous subranges [i0,i1) covering
+  // [begin,end), each at least grain long, using at most maxthreads
+  // threads (all of them if maxthreads is zero).
+  template<class F>
+  void parallel_for(std::size_t begin, std::size_t end, std::size_t grain,
+		    F&& f, unsigned maxthreads = 0)
+    {
+      if (end <= begin) return;
+
+      const std::size_t len = end - begin;
+      if (grain < 1) grain = 1;
+      std::size_t nchunks = std::min<std::size_t>(size(),len/grain);
+      if (maxthreads > 0) nchunks = std::min<std::size_t>(nchunks,maxthreads);
+
+      if (nchunks <= 1 || in_worker())
+	{
+	  f(begin,end);
+	  return;
+	}
+
+      batch b;
+      b.remaining = nchunks - 1;
+
+      auto bound = [&](std::size_t c) { return begin + c*len/nchunks; };
+
+      {
+	std::lock_guard<std::mutex> lock(mtx);
+	for (std::size_t c = 1; c < nchunks; ++c)
+	  {
+	    std::size_t i0 = bound(c), i1 = bound(c+1);
+	    tasks.emplace_back([&b,&f,i0,i1]()
+			       {
+				 try { f(i0,i1); }
+				 catch (...) { b.fail(std::current_exception()); }
+				 b.done();
+			       });
+	  }
+      }
+      cv.notify_all();
+
+      // The first range is done by the calling thread, marked as a
+      // worker meanwhile so that parallel_for calls made from it run
+      // serially.
+      {
+	worker_scope scope;
+	try { f(begin,bound(1)); }
+	catch (...) { b.fail(std::current_exception()); }
+      }
+
+      b.wait();
+
+      if (b.error) std::rethrow_exception(b.error);
+    }
+
+  // The pool used by the library.
+  static thread_pool& global()
+    {
+      static thread_pool pool;
+      return pool;
+    }
+
+  // JLT_NUM_THREADS, or the number of hardware threads.
+  static unsigned default_size()
+    {
+#ifdef JLT_NO_THREADS
+      return 1;
+#else
+      if (const char* s = std::getenv("JLT_NUM_THREADS"))
+	{
+	  int n = std::atoi(s);
+	  if (n > 0) return (unsigned)n;
+	}
+      unsigned n = std::thread::hardware_concurrency();
+      return (n > 0 ? n : 1);
+#endif
+    }
+
+private:
+  // Completion count and first exception of one parallel_for.
+  struct batch
+  {
+    std::mutex m;
+    std::condition_variable cv;
+    std::size_t remaining = 0;
+    std::exception_ptr error;
+
+    void fail(std::exception_ptr e)
+      {
+	std::lock_guard<std::mutex> lock(m);
+	if (!error) error = e;
+      }
+
+    void done()
+      {
+	std::lock_guard<std::mutex> lock(m);
+	if (--remaining == 0) cv.notify_one();
+      }
+
+    void wait()
+      {
+	std::unique_lock<std::mutex> lock(m);
+	cv.wait(lock,[this]{ return remaining == 0; });
+      }
+  };
+
+  std::vector<std::thread> workers;
+  std::deque<std::function<void()>> tasks;
+  std::mutex mtx;
+  std::condition_variable cv;
+  bool stopping = false;
+
+  static bool& in_worker()
+    {
+      static thread_local bool flag = false;
+      return flag;
+    }
+
+  // Sets in_worker() for the lifetime of the object.
+  struct worker_scope
+  {
+    bool saved = in_worker();
+
+    worker_scope() { in_worker() = true; }
+    ~worker_scope() { in_worker() = saved; }
+  };
+
+  void start(unsigned nthreads)
+    {
+      stopping = false;
+      if (nthreads < 1) nthreads = 1;
+      workers.reserve(nthreads-1);
+      for (unsigned t = 1; t < nthreads; ++t)
+	workers.emplace_back([this]{ run(); });
+    }
+
+  void stop()
+    {
+      {
+	std::lock_guard<std::mutex> lock(mtx);
+	stopping = true;
+      }
+      cv.notify_all();
+      for (auto& th : workers) th.join();
+      workers.clear();
+    }
+
+  void run()
+    {
+      in_worker() = true;
+      for (;;)
+	{
+	  std::function<void()> task;
+	  {
+	    std::unique_lock<std::mutex> lock(mtx);
+	    cv.wait(lock,[this]{ return stopping || !tasks.empty(); });
+	    if (tasks.empty()) return;
+	    task = std::move(tasks.front());
+	    tasks.pop_front();
+	  }
+	  task();
+	}
+    }
+};
+
+// Number of threads used by the library's kernels.
+inline unsigned num_threads() { return thread_pool::global().size(); }
+
+// Change the number of threads used by the library's kernels.
+inline void set_num_threads(unsigned nthreads)
+{
+  thread_pool::global().resize(nthreads);
+}
+
+// parallel_for on the library's pool.
+template<class F>
+inline void parallel_for(std::size_t begin, std::size_t end,
+			 std::size_t grain, F&& f, unsigned maxthreads = 0)
+{
+  thread_pool::global().parallel_for(begin,end,grain,std::forward<F>(f),
+				     maxthreads);
+}
+
+} // namespace jlt
+
+#endif // JLT_THREAD_POOL_HPP
@@ -0,0 +1,213 @@
+//
+// Copyright (c) 2004-2020 Jean-Luc Thiffeault <jeanluc@mailaps.org>
+//
+// See the file LICENSE for copying permission.
+//
+
+#ifndef JLT_TRANSPOSE_HPP
+#define JLT_TRANSPOSE_HPP
+
+//
+// transpose.hpp
+//
+
+// Transposition of dense row-major arrays, used by matrix::transpose().
+//
+//   transpose_copy      Out-of-place: B = transpose(A).  Multithreaded
+//                       on the library's thread pool for large arrays.
+//   transpose_square    In-place, for square arrays.
+//   transpose_in_place  In-place, for any shape (cycle-following).
+//
+// The naive loop B[j][i] = A[i][j] walks down a column of either A or
+// B, touching a new cache line (and often a new page) at every step.
+// Here the array is instead processed in square tiles of side
+// JLT_TRANSPOSE_BLOCK, so that a source tile and its destination both
+// stay in L1 cache while they are being swapped.  The innermost loop
+// writes contiguously, which the compiler can vectorise.
+//
+// Since a column-major array is just the row-major array of its
+// transpose, the same functions serve both storage orders.
+
+#include <cstddef>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <jlt/thread_pool.hpp>
+
+// Side of the square tiles, in elements.  32x32 doubles is 8kB, so a
+// tile and its transpose fit comfortably in a 32kB L1 data cache.
+#ifndef JLT_TRANSPOSE_BLOCK
+#  define JLT_TRANSPOSE_BLOCK 32
+#endif
+
+// Arrays with fewer elements than this are transposed by a single
+// thread, whatever the number of threads requested.
+#ifndef JLT_TRANSPOSE_THREAD_THRESHOLD
+#  define JLT_TRANSPOSE_THREAD_THRESHOLD (256*256)
+#endif
+
+namespace jlt {
+
+//
+// Transpose columns [j0,j1) of the m by n array A (leading dimension
+// lda) into rows [j0,j1) of B (leading dimension ldb).
+//
+template<class T>
+void transpose_copy_columns(const T *A, std::size_t m, std::size_t lda,
+			    T *B, std::size_t ldb,
+			    std::size_t j0, std::size_t j1)
+{
+  const std::size_t bs = JLT_TRANSPOSE_BLOCK;
+
+  for (std::size_t jj = j0; jj < j1; jj += bs)
+    {
+      std::size_t je = std::min(jj+bs,j1);
+      for (std::size_t ii = 0; ii < m; ii += bs)
+	{
+	  std::size_t ie = std::min(ii+bs,m);
+	  for (std::size_t j = jj; j < je; ++j)
+	    {
+	      T *b = B + j*ldb;
+	      const T *a = A + j;
+	      for (std::size_t i = ii; i < ie; ++i) b[i] = a[i*lda];
+	    }
+	}
+    }
+}
+
+//
+// B = transpose(A), where A is m by n with leading dimension lda and B
+// is n by m with leading dimension ldb.  A and B must not overlap.
+//
+// The rows of B are shared among at most nthreads threads of the
+// library's pool (see thread_pool.hpp), or all of them if nthreads is
+// zero, each writing its own range of rows.
+//
+template<class T>
+void transpose_copy(const T *A, std::size_t m, std::size_t n, std::size_t lda,
+		    T *B, std::size_t ldb, unsigned nthreads = 0)
+{
+  const std::size_t bs = JLT_TRANSPOSE_BLOCK;
+
+  if (nthreads == 1 || m*n < JLT_TRANSPOSE_THREAD_THRESHOLD)
+    {
+      transpose_copy_columns(A,m,lda,B,ldb,0,n);
+      return;
+    }
+
+  // Give each thread a whole number of tile columns.
+  std::size_t ntiles = (n + bs - 1)/bs;
+  parallel_for(0,ntiles,1,
+	       [=](std::size_t t0, std::size_t t1)
+	       {
+		 transpose_copy_columns(A,m,lda,B,ldb,
+					t0*bs,std::min(n,t1*bs));
+	       },
+	       nthreads);
+}
+
+//
+// Transpose the diagonal tile and the tiles to its right in tile row
+// ii of the n by n array A.  Each pair of tiles is swapped by only one
+// tile row, so that tile rows can be processed concurrently.
+//
+template<class T>
+void transpose_square_tile_row(T *A, std::size_t n, std::size_t lda,
+			       std::size_t ii)
+{
+  using std::swap;
+  const std::size_t bs = JLT_TRANSPOSE_BLOCK;
+
+  std::size_t ie = std::min(ii+bs,n);
+
+  // Diagonal tile: swap across its own diagonal.
+  for (std::size_t i = ii; i < ie; ++i)
+    for (std::size_t j = i+1; j < ie; ++j)
+      swap(A[i*lda + j],A[j*lda + i]);
+
+  // Off-diagonal tiles: swap tile (ii,jj) with tile (jj,ii).
+  for (std::size_t jj = ie; jj < n; jj += bs)
+    {
+      std::size_t je = std::min(jj+bs,n);
+      for (std::size_t i = ii; i < ie; ++i)
+	for (std::size_t j = jj; j < je; ++j)
+	  swap(A[i*lda + j],A[j*lda + i]);
+    }
+}
+
+//
+// Transpose the n by n array A (leading dimension lda) in place, on at
+// most nthreads threads of the library's pool (all if zero).
+//
+template<class T>
+void transpose_square(T *A, std::size_t n, std::size_t lda,
+		      unsigned nthreads = 0)
+{
+  const std::size_t bs = JLT_TRANSPOSE_BLOCK;
+  const std::size_t ntiles = (n + bs - 1)/bs;
+
+  if (nthreads == 1 || n*n < JLT_TRANSPOSE_THREAD_THRESHOLD)
+    {
+      for (std::size_t t = 0; t < ntiles; ++t)
+	transpose_square_tile_row(A,n,lda,t*bs);
+      return;
+    }
+
+  // Tile row t has ntiles-t tiles, so pair it with row ntiles-1-t to
+  // share the work evenly.
+  parallel_for(0,(ntiles+1)/2,1,
+	       [=](std::size_t t0, std::size_t t1)
+	       {
+		 for (std::size_t t = t0; t < t1; ++t)
+		   {
+		     transpose_square_tile_row(A,n,lda,t*bs);
+		     if (ntiles-1-t != t)
+		       transpose_square_tile_row(A,n,lda,(ntiles-1-t)*bs);
+		   }
+	       },
+	       nthreads);
+}
+
+//
+// Transpose the m by n array A in place, leaving the n by m array of
+// its transpose in the same storage.  No leading dimension: the data
+// must be contiguous.
+//
+// For square arrays this is transpose_square.  Otherwise the elements
+// are moved along the cycles of the permutation taking position p to
+// p*m mod (mn-1).  This needs only one bit per element of extra
+// memory, to remember which elements have been moved, but has poor
+// locality: prefer transpose_copy when memory allows.
+//
+template<class T>
+void transpose_in_place(T *A, std::size_t m, std::size_t n)
+{
+  using std::swap;
+
+  if (m == n) { transpose_square(A,n,n); return; }
+  if (m <= 1 || n <= 1) return;	// Row or column vector: nothing to do.
+
+  // The first and last elements are fixed points.
+  const std::size_t mn1 = m*n - 1;
+  std::vector<bool> moved(mn1);
+
+  for (std::size_t s = 1; s < mn1; ++s)
+    {
+      if (moved[s]) continue;
+
+      // Follow the cycle starting at s: the element at p goes to p*m.
+      T tmp = std::move(A[s]);
+      std::size_t p = s;
+      do
+	{
+	  p = (p*m) % mn1;
+	  swap(tmp,A[p]);
+	  moved[p] = true;
+	}
+      while (p != s);
+    }
+}
+
+} // namespace jlt
+
+#endif // JLT_TRANSPOSE_HPP
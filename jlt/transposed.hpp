@@ -0,0 +1,131 @@
+//
+// Copyright (c) 2004-2020 Jean-Luc Thiffeault <jeanluc@mailaps.org>
+//
+// See the file LICENSE for copying permission.
+//
+
+#ifndef JLT_TRANSPOSED_HPP
+#define JLT_TRANSPOSED_HPP
+
+//
+// transposed.hpp
+//
+
+// Lazy transpose and adjoint: trans(A) and adj(A) only record that A
+// is to be used transposed (or conjugate-transposed), without moving
+// any data.  The products in mathmatrix.hpp and the solvers in
+// matrixutil.hpp recognise them and pick a loop order that walks the
+// original rows of A, so that e.g. the normal equations
+//
+//   mathmatrix<double> N = trans(A)*A;
+//   mathvector<double> c = trans(A)*y;
+//
+// cost no copy of A.  For LAPACK routines that take a 'trans'
+// argument, lapack_trans() gives the flag to pass for the stored data.
+//
+// A transposed object refers to A, so it should be used within the
+// expression that creates it and not stored.  Views are the exception:
+// they are held by value, so trans(A.block(...)) is safe.
+//
+// For real types adj(A) is the same as trans(A).
+
+#include <complex>
+#include <type_traits>
+#include <cstddef>
+#include <jlt/matrix_view.hpp>
+
+namespace jlt {
+
+// Complex conjugate that leaves real types real (std::conj of a
+// double returns a std::complex<double>).
+template<class T>
+inline T conjugate(const T& x) { return x; }
+
+template<class T>
+inline std::complex<T> conjugate(const std::complex<T>& x)
+{
+  return std::conj(x);
+}
+
+template<class T> struct is_complex : std::false_type {};
+template<class T> struct is_complex<std::complex<T>> : std::true_type {};
+
+template<class Matrix, bool Conj = false>
+class transposed
+{
+public:
+  using value_type = typename Matrix::value_type;
+  using size_type = std::size_t;
+
+  // True for adj(A) of a complex matrix.
+  static constexpr bool conjugated = Conj && is_complex<value_type>::value;
+
+private:
+  // Views are cheap to copy and often temporaries, so keep a copy.
+  template<class M> struct storage { using type = const M&; };
+  template<class U> struct storage<matrix_view<U>> { using type = matrix_view<U>; };
+
+  typename storage<Matrix>::type A;
+
+public:
+  explicit transposed(const Matrix& _A) : A(_A) {}
+
+  // The matrix that is being transposed.
+  [[nodiscard]] const Matrix& base() const { return A; }
+
+  // Element (i,j) of the transpose, i.e. A(j,i) (conjugated for adj).
+  value_type operator()(size_type i, size_type j) const
+    {
+      if constexpr (conjugated) return conjugate(A(j,i)); else return A(j,i);
+    }
+
+  [[nodiscard]] size_type size() const { return A.size(); }
+  [[nodiscard]] size_type dim() const { return A.rows(); }
+  [[nodiscard]] size_type rows() const { return A.columns(); }
+  [[nodiscard]] size_type columns() const { return A.rows(); }
+  [[nodiscard]] bool isSquare() const { return (A.rows() == A.columns()); }
+};
+
+// Transpose of A.
+template<class Matrix>
+inline transposed<Matrix> trans(const Matrix& A)
+{
+  return transposed<Matrix>(A);
+}
+
+// Conjugate transpose (adjoint) of A.
+template<class Matrix>
+inline transposed<Matrix,true> adj(const Matrix& A)
+{
+  return transposed<Matrix,true>(A);
+}
+
+//
+// LAPACK 'trans' flags
+//
+
+// LAPACK expects column-major data, so a row-major matrix is seen as
+// its own transpose: solving A x = b with getrs on row-major data
+// needs 'T', and trans(A) x = b needs 'N'.  The conjugate transpose
+// of a complex row-major matrix has no flag (LAPACK's 'C' would give
+// conj(A)), so that case is rejected at compile time.
+template<class Matrix>
+constexpr char lapack_trans(const Matrix&)
+{
+  return (Matrix::is_row_major ? 'T' : 'N');
+}
+
+template<class Matrix, bool Conj>
+constexpr char lapack_trans(const transposed<Matrix,Conj>&)
+{
+  constexpr bool conj = transposed<Matrix,Conj>::conjugated;
+
+  static_assert(!(conj && Matrix::is_row_major),
+		"jlt::lapack_trans: no LAPACK flag for adj of a row-major complex matrix.");
+
+  return (Matrix::is_row_major ? 'N' : (conj ? 'C' : 'T'));
+}
+
+} // namespace jlt
+
+#endif // JLT_TRANSPOSED_HPP
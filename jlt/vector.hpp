@@ -13,6 +13,11 @@
 
 // Bounds-checked version of std::vector.
 
+// The allocator defaults to std::allocator, so that a jlt::vector<T>
+// is still a std::vector<T> and can be passed to the many functions
+// that take one.  Use e.g. jlt::aligned_allocator<T> (see
+// aligned_allocator.hpp) for aligned or huge-page storage.
+
 #if defined(VECTOR_CHECK_BOUNDS)
 #  include <cassert>
 #  define VECTOR_ASSERT(x) assert(x)
@@ -30,15 +35,15 @@
 
 namespace jlt {
 
-template<class T>
-class vector : public std::vector<T>
+template<class T, class Alloc = std::allocator<T>>
+class vector : public std::vector<T,Alloc>
 {
 public:
-  typedef typename std::vector<T>::size_type		size_type;
-  using reference = typename std::vector<T>::reference;
-  using const_reference = typename std::vector<T>::const_reference;
+  typedef typename std::vector<T,Alloc>::size_type	size_type;
+  using reference = typename std::vector<T,Alloc>::reference;
+  using const_reference = typename std::vector<T,Alloc>::const_reference;
 
-  using std::vector<T>::size;
+  using std::vector<T,Alloc>::size;
 
   //
   // Constructors
@@ -47,20 +52,21 @@ public:
 #if __cplusplus > 199711L
   // Use C++11-style argument forwarding.
   template<typename... Args>
-  vector(Args&&... _args) : std::vector<T>(std::forward<Args>(_args)...) {}
+  vector(Args&&... _args)
+    : std::vector<T,Alloc>(std::forward<Args>(_args)...) {}
 
   // Forward initializer list as well.
-  vector(std::initializer_list<T> _l) : std::vector<T>(_l) {}
+  vector(std::initializer_list<T> _l) : std::vector<T,Alloc>(_l) {}
 #else
   // Empty vector of size 0.
-  vector() : std::vector<T>() {}
+  vector() : std::vector<T,Alloc>() {}
 
   // mathvector of size _n filled with _x.
   explicit vector(size_type _n, const_reference _x = T())
-    : std::vector<T>(_n,_x) {}
+    : std::vector<T,Alloc>(_n,_x) {}
 
   // Copy constructor.
-  vector(const std::vector<T>& _v) : std::vector<T>(_v) {}
+  vector(const std::vector<T,Alloc>& _v) : std::vector<T,Alloc>(_v) {}
 #endif
 
   //
@@ -72,7 +78,7 @@ public:
 #     ifdef VECTOR_CHECK_BOUNDS
         return at(i);
 #     else
-        return std::vector<T>::operator[](i);
+        return std::vector<T,Alloc>::operator[](i);
 #     endif
     }
 
@@ -81,7 +87,7 @@ public:
 #     ifdef VECTOR_CHECK_BOUNDS
         return at(i);
 #     else
-        return std::vector<T>::operator[](i);
+        return std::vector<T,Alloc>::operator[](i);
 #     endif
     }
 
@@ -91,7 +97,7 @@ public:
       if (i >= size())
 	JLT_THROW(std::out_of_range("Out of range exception in jlt::vector."));
 
-      return std::vector<T>::operator[](i);
+      return std::vector<T,Alloc>::operator[](i);
     }
 
   [[nodiscard]] const_reference at(size_type i) const
@@ -99,12 +105,12 @@ public:
       if (i >= size())
 	JLT_THROW(std::out_of_range("Out of range exception in jlt::vector."));
 
-      return std::vector<T>::operator[](i);
+      return std::vector<T,Alloc>::operator[](i);
     }
 
-  std::vector<T>& operator=(const std::vector<T>& v)
+  std::vector<T,Alloc>& operator=(const std::vector<T,Alloc>& v)
     {
-      return std::vector<T>::operator=(v);
+      return std::vector<T,Alloc>::operator=(v);
     }
 
   std::ostream& printMathematicaForm(std::ostream& strm,
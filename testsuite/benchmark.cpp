@@ -0,0 +1,255 @@
+//
+// Copyright (c) 2004-2020 Jean-Luc Thiffeault <jeanluc@mailaps.org>
+//
+// See the file LICENSE for copying permission.
+//
+
+// Wall-clock timings of the main kernels, against the simpler methods
+// they replace.  These are kept out of the *_test programs, whose
+// output is reproducible; the times here depend on the machine and on
+// JLT_NUM_THREADS.
+
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+#include <chrono>
+#include <jlt/mathvector.hpp>
+#include <jlt/mathmatrix.hpp>
+#include <jlt/matrixutil.hpp>
+#include <jlt/thread_pool.hpp>
+#include <jlt/strassen.hpp>
+#include <jlt/bit_matrix.hpp>
+#include <jlt/graph.hpp>
+#include <jlt/matrixfunc.hpp>
+#include <jlt/blas1.hpp>
+#include <jlt/gram.hpp>
+#include <jlt/lu_factorization.hpp>
+#include <jlt/symmetric_factorization.hpp>
+#include <jlt/qr_factorization.hpp>
+#include "test_helpers.hpp"
+
+using std::cout;
+using std::endl;
+using jlt::mathmatrix;
+using jlt::mathvector;
+
+// Seconds taken by f().
+template<class F>
+double seconds(F f)
+{
+  auto t0 = std::chrono::steady_clock::now();
+  f();
+  std::chrono::duration<double> dt = std::chrono::steady_clock::now() - t0;
+  return dt.count();
+}
+
+// A large product on one thread and on all of them.
+void product_threads()
+{
+  const int N = 1500;
+  mathmatrix<double> P = random_matrix<double>(N,N);
+  mathmatrix<double> Q = random_matrix<double>(N,N), PQ;
+  for (unsigned t : {1u,jlt::thread_pool::default_size()})
+    {
+      jlt::set_num_threads(t);
+      cout << N << "x" << N << " product on " << t << " thread(s): "
+	   << seconds([&] { PQ = P*Q; }) << " s" << endl;
+    }
+  jlt::set_num_threads(jlt::thread_pool::default_size());
+}
+
+// Strassen against the blocked kernel on a large integer product.
+void strassen()
+{
+  const unsigned N = 1024;
+  mathmatrix<long> P(N,N), Q(N,N), PQ1(N,N), PQ2(N,N);
+  for (auto& x : P) x = rand() % 21 - 10;
+  for (auto& x : Q) x = rand() % 21 - 10;
+
+  double d1 = seconds([&] { PQ1 = P*Q; });
+  double d2 = seconds([&] { jlt::strassen_product(PQ2,P,Q,128); });
+  cout << N << "x" << N << " long product: classical " << d1
+       << " s, Strassen " << d2 << " s" << endl;
+}
+
+// Nodes reachable in a large graph: a cycle with random extra edges.
+void reachability()
+{
+  const unsigned N = 10000;
+  jlt::bit_matrix G(N,N);
+  for (unsigned i = 0; i < N; ++i)
+    {
+      G.set(i,(i+1) % N);
+      for (int e = 0; e < 3; ++e) G.set(i,rand() % N);
+    }
+  unsigned nreach = 0;
+  double dt = seconds([&] { nreach = G.reachable(0).count(); });
+  cout << "Nodes reachable from node 0 of " << N << ": " << nreach << " ("
+       << dt*1000 << " ms)" << endl;
+}
+
+// Primitivity and reducibility of many small transition matrices.
+void primitivity()
+{
+  const int nmat = 2000;
+  const unsigned n = 50;
+  std::vector<mathmatrix<double>> T(nmat,mathmatrix<double>(n,n));
+  for (auto& A : T)
+    for (auto& x : A) x = (rand() % 10 == 0 ? (double)rand()/RAND_MAX : 0);
+
+  int nprim = 0, nred = 0;
+  double d1 = seconds([&] { for (auto& A : T) nprim += A.isPrimitive(); });
+  double d2 = seconds([&] { for (auto& A : T) nred += A.isReducible(); });
+  cout << nmat << " matrices " << n << "x" << n << ": isPrimitive " << d1
+       << " s, isReducible " << d2 << " s (" << nprim << " primitive, "
+       << nred << " reducible)" << endl;
+}
+
+// A propagator applied many times, reusing the workspace.
+void expm()
+{
+  const unsigned m = 100;
+  mathmatrix<double> L(m,m), Pt;
+  for (auto& x : L) x = (2*(double)rand()/RAND_MAX - 1)/m;
+  jlt::matrix_workspace<mathmatrix<double>> ws;
+  cout << "20 expm of " << m << "x" << m << ": "
+       << seconds([&] { for (int s = 0; s < 20; ++s) jlt::expm(L,Pt,ws); })
+       << " s" << endl;
+}
+
+// An integrator stage, with expressions and with fused updates.
+void blas1_stages()
+{
+  const unsigned N = 1 << 20;
+  const int nsteps = 20;
+  mathvector<double> u(N), k1(N), k2(N), k3(N), v(N);
+  randomize(u);
+  randomize(k1);
+  randomize(k2);
+  randomize(k3);
+  const double h = 0.01;
+
+  double d1 = seconds([&]
+    {
+      for (int q = 0; q < nsteps; ++q)
+	{
+	  v = u;
+	  v += (h/6)*k1;
+	  v += (h/3)*k2;
+	  v += (h/3)*k3;
+	}
+    });
+  double d2 = seconds([&]
+    {
+      for (int q = 0; q < nsteps; ++q)
+	{
+	  jlt::lincomb(1.0,u,h/6,k1,v);
+	  jlt::axpy(h/3,k2,v);
+	  jlt::axpy(h/3,k3,v);
+	}
+    });
+  cout << nsteps << " stages on " << N << " elements: expressions " << d1
+       << " s, fused " << d2 << " s" << endl;
+}
+
+// gram() against the full product F*trans(F).
+void gram()
+{
+  const unsigned n = 600;
+  mathmatrix<double> F = random_matrix<double>(n,n), P;
+  jlt::symmetric_matrix<double> S;
+
+  double d1 = seconds([&] { P = F*jlt::trans(F); });
+  double d2 = seconds([&] { S = jlt::gram(F); });
+  cout << n << "x" << n << ": F*trans(F) " << d1 << " s, gram(F) " << d2
+       << " s" << endl;
+}
+
+// The blocked LU.
+void lu()
+{
+  const int n = 1000;
+  mathmatrix<double> B = random_matrix<double>(n,n);
+  std::vector<int> row_index(n);
+  int perm;
+  double dt = seconds([&] { jlt::LUdecomp<double>(B,row_index.data(),&perm); });
+  cout << "LUdecomp of " << n << "x" << n << ": " << dt << " s ("
+       << 2.0*n*n*n/3/dt/1e9 << " Gflop/s)" << endl;
+}
+
+// The inverse from the LU factors, by solving with the identity and
+// in place.
+void lu_inverse()
+{
+  const int n = 1000;
+  mathmatrix<double> B = random_matrix<double>(n,n);
+  std::vector<int> row_index(n);
+  int perm;
+  jlt::LUdecomp<double>(B,row_index.data(),&perm);
+
+  mathmatrix<double> I = jlt::identity_matrix<double>(n);
+  double d1 = seconds([&] { jlt::LUsolve<double>(B,row_index.data(),I); });
+  double d2 = seconds([&] { jlt::LUinvert<double>(B,row_index.data()); });
+  cout << "Inverse from the factors: solving with I " << d1
+       << " s, in place " << d2 << " s" << endl;
+}
+
+// Factor once and solve many times, against factoring at every solve.
+void lu_solves()
+{
+  const int n = 300, nsteps = 100;
+  mathmatrix<double> J = random_matrix<double>(n,n);
+  mathvector<double> x(n,1.0), y(n,1.0);
+  double d1 = seconds([&]
+    {
+      jlt::lu_factorization<double> fac(J);
+      for (int s = 0; s < nsteps; ++s) fac.solve_in_place(x);
+    });
+  double d2 = seconds([&]
+    { for (int s = 0; s < nsteps; ++s) y = jlt::solve(J,y); });
+  cout << nsteps << " solves of size " << n << ": factored once " << d1
+       << " s, every time " << d2 << " s" << endl;
+}
+
+// The symmetric factorisations against LU.
+void symmetric()
+{
+  const int n = 1000;
+  mathmatrix<double> A = random_matrix<double>(n,n), S(n,n);
+  for (int i = 0; i < n; ++i)
+    for (int j = 0; j <= i; ++j) S(i,j) = S(j,i) = A(i,j) + (i == j ? n : 0);
+
+  double d1 = seconds([&] { jlt::lu_factorization<double> f(S); });
+  double d2 = seconds([&] { jlt::cholesky_factorization<double> f(S); });
+  double d3 = seconds([&] { jlt::ldlt_factorization<double> f(S); });
+  cout << "Factoring " << n << "x" << n << ": LU " << d1 << " s, Cholesky "
+       << d2 << " s, LDL^T " << d3 << " s" << endl;
+}
+
+// Blocked Householder QR against QRdecomp, which also forms Q.
+void qr()
+{
+  const int n = 600;
+  mathmatrix<double> A = random_matrix<double>(n,n), Q(n,n), R(n,n), A2(A);
+  double d1 = seconds([&]
+    { jlt::QRdecomp<double,mathmatrix<double>,std::vector<double>>(A2,Q,R); });
+  double d2 = seconds([&] { jlt::qr_factorization<double> f(A); });
+  cout << "QR of " << n << "x" << n << ": QRdecomp " << d1
+       << " s, HouseholderQR " << d2 << " s" << endl;
+}
+
+int main()
+{
+  product_threads();
+  strassen();
+  reachability();
+  primitivity();
+  expm();
+  blas1_stages();
+  gram();
+  lu();
+  lu_inverse();
+  lu_solves();
+  symmetric();
+  qr();
+}
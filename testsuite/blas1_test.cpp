@@ -0,0 +1,129 @@
+//
+// Copyright (c) 2004-2020 Jean-Luc Thiffeault <jeanluc@mailaps.org>
+//
+// See the file LICENSE for copying permission.
+//
+
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+#include <complex>
+#include <jlt/mathvector.hpp>
+#include <jlt/mathmatrix.hpp>
+#include <jlt/blas1.hpp>
+
+
+double frand() { return 2*(double)rand()/RAND_MAX - 1; }
+
+int main()
+{
+  using std::cout;
+  using std::endl;
+  using jlt::mathvector;
+  using jlt::mathmatrix;
+
+  const unsigned n = 1000;
+  mathvector<double> x(n), y(n), z(n), w(n);
+  for (auto& a : x) a = frand();
+  for (auto& a : y) a = frand();
+  for (auto& a : z) a = frand();
+
+  // Each kernel against the equivalent expression.
+  mathvector<double> r = y + 2.0*x;
+  w = y; jlt::axpy(2.0,x,w);
+  cout << "axpy: " << (abs(w - r) < 1e-13) << endl;
+
+  r = 2.0*x - 3.0*y;
+  w = y; jlt::axpby(2.0,x,-3.0,w);
+  cout << "axpby: " << (abs(w - r) < 1e-13) << endl;
+
+  r = 0.5*x;
+  w = x; jlt::scal(0.5,w);
+  cout << "scal: " << (abs(w - r) < 1e-13) << endl;
+
+  w = z; jlt::fma(x,y,w);
+  bool ok = true;
+  for (unsigned i = 0; i < n; ++i) ok = ok && (std::abs(w[i] - (x[i]*y[i] + z[i])) < 1e-14);
+  cout << "fma: " << ok << endl;
+
+  r = 1.5*x + 0.25*y;
+  jlt::lincomb(1.5,x,0.25,y,w);
+  cout << "lincomb: " << (abs(w - r) < 1e-13) << endl;
+
+  cout << "dot: " << (std::abs(jlt::dot(jlt::vector_view<double>(x.data(),n),y) - dot(x,y)) < 1e-12)
+       << ", nrm2: " << (std::abs(jlt::nrm2(x) - abs(x)) < 1e-12) << endl;
+
+  // nrm2 does not overflow or underflow.
+  mathvector<double> big(3,1e300), tiny(3,1e-300);
+  cout << "nrm2 of large and tiny vectors: " << jlt::nrm2(big)/1e300 << " "
+       << jlt::nrm2(tiny)/1e-300 << endl;
+  mathvector<std::complex<double>> c(2);
+  c[0] = {3,4}; c[1] = {0,12};
+  cout << "nrm2 of complex vector: " << jlt::nrm2(c) << endl;
+
+  // On matrices of both storage orders, and on views with strides.
+  const unsigned m = 60;
+  mathmatrix<double> A(m,m), B(m,m), C(m,m);
+  mathmatrix<double,double,jlt::aligned_allocator<double>,jlt::column_major>
+    Bc(m,m);
+  for (auto& a : A) a = frand();
+  for (auto& a : B) a = frand();
+  for (unsigned i = 0; i < m; ++i)
+    for (unsigned j = 0; j < m; ++j) Bc(i,j) = B(i,j);
+
+  C = A;
+  jlt::axpy(3.0,Bc,C);
+  mathmatrix<double> D = A + 3.0*B;
+  double e = 0;
+  for (unsigned i = 0; i < m; ++i)
+    for (unsigned j = 0; j < m; ++j) e = std::max(e,std::abs(C(i,j) - D(i,j)));
+  cout << "\naxpy with mixed storage orders: " << (e < 1e-13) << endl;
+
+  // Scale a block, then the transpose of another.
+  C = A;
+  jlt::scal(2.0,C.block(10,20,30,15));
+  jlt::axpy(-1.0,A.block(10,20,30,15),C.block(10,20,30,15));
+  e = 0;
+  for (unsigned i = 0; i < m; ++i)
+    for (unsigned j = 0; j < m; ++j) e = std::max(e,std::abs(C(i,j) - A(i,j)));
+  cout << "scal and axpy on blocks: " << (e < 1e-14) << endl;
+
+  jlt::lincomb(1.0,A.view().transpose(),1.0,A,C);
+  e = 0;
+  for (unsigned i = 0; i < m; ++i)
+    for (unsigned j = 0; j < m; ++j)
+      e = std::max(e,std::abs(C(i,j) - (A(i,j) + A(j,i))));
+  cout << "lincomb with a transpose: " << (e < 1e-14) << endl;
+
+  double s = 0, s3 = 0;
+  for (unsigned i = 0; i < m; ++i)
+    for (unsigned j = 0; j < m; ++j) s += A(i,j)*B(i,j);
+  for (unsigned i = 0; i < m; ++i) s3 += A(i,3)*B(i,3);
+  cout << "Frobenius inner product: "
+       << (std::abs(jlt::dot(A,Bc) - s) < 1e-12) << ", column dot: "
+       << (std::abs(jlt::dot(A.column_view(3),B.column_view(3)) - s3) < 1e-12)
+       << endl;
+
+  // A*=a scales every element.
+  C = A;
+  C *= 2.0;
+  cout << "A *= 2 scales every element: " << (C(0,1) == 2*A(0,1)) << endl;
+
+  // An integrator stage, fused and with expressions.
+  const unsigned N = 1000;
+  mathvector<double> u(N), k1(N), k2(N), k3(N), v(N), uf(N);
+  for (auto& a : u) a = frand();
+  for (auto& a : k1) a = frand();
+  for (auto& a : k2) a = frand();
+  for (auto& a : k3) a = frand();
+  const double h = 0.01;
+  v = u;
+  v += (h/6)*k1;
+  v += (h/3)*k2;
+  v += (h/3)*k3;
+  jlt::lincomb(1.0,u,h/6,k1,uf);
+  jlt::axpy(h/3,k2,uf);
+  jlt::axpy(h/3,k3,uf);
+  cout << "Fused stage agrees with expressions: " << (abs(v - uf) < 1e-12)
+       << endl;
+}
@@ -0,0 +1,87 @@
+//
+// Copyright (c) 2004-2020 Jean-Luc Thiffeault <jeanluc@mailaps.org>
+//
+// See the file LICENSE for copying permission.
+//
+
+// Products and in-place updates, routed to BLAS when the build defines
+// JLT_USE_BLAS (see SConscript).  Link with -lblas.
+
+#include <iostream>
+#include <complex>
+#include <cmath>
+#include <jlt/mathmatrix.hpp>
+#include <jlt/mathvector.hpp>
+#include <jlt/gemm.hpp>
+#include "test_helpers.hpp"
+
+
+int main()
+{
+  using std::cout;
+  using std::endl;
+  using jlt::mathmatrix;
+  using jlt::mathvector;
+  using jlt::trans;
+
+  cout << "dgemm, row-major: " << check_product<double,jlt::row_major>(70,50,90,1e-14)
+       << endl;
+  cout << "dgemm, column-major: "
+       << check_product<double,jlt::column_major>(70,50,90,1e-14) << endl;
+  cout << "sgemm: " << check_product<float,jlt::row_major>(40,30,20,1e-5) << endl;
+  cout << "zgemm: "
+       << check_product<std::complex<double>,jlt::row_major>(30,40,50,1e-14)
+       << endl;
+
+  mathmatrix<double> A(60,40), B(50,40), Bt, R(60,50);
+  randomize(A);
+  randomize(B);
+  B.transpose(Bt);
+  naive_product(R,A,Bt);
+  cout << "A*trans(B): " << (maxdiff(A*trans(B),R) < 1e-12) << endl;
+
+  // Every other column: no unit stride, so gemm() does it itself.
+  mathmatrix<double> D(60,100);
+  jlt::matrix_view<double> Dodd(D.data(),60,50,100,2);
+  jlt::gemm(1.0,A,trans(B),0.0,Dodd);
+  cout << "Strided result: " << (maxdiff(Dodd,R) < 1e-12) << endl;
+
+  // Matrix-vector products.
+  mathvector<double> x(40), y(60), z(60);
+  randomize(x);
+  randomize(y);
+  for (unsigned i = 0; i < 60; ++i)
+    {
+      z[i] = 0;
+      for (unsigned j = 0; j < 40; ++j) z[i] += A(i,j)*x[j];
+    }
+  cout << "\ndgemv: " << (maxdiff(A*x,z) < 1e-12) << endl;
+  mathvector<double> w = trans(A)*y;
+  double err = 0;
+  for (unsigned j = 0; j < 40; ++j)
+    {
+      double s = 0;
+      for (unsigned i = 0; i < 60; ++i) s += A(i,j)*y[i];
+      err = std::max(err,std::abs(w[j] - s));
+    }
+  cout << "dgemv, trans(A): " << (err < 1e-12) << endl;
+  // A strided vector: a column of a row-major matrix with 40 rows.
+  mathmatrix<double> G(40,7);
+  randomize(G);
+  cout << "dgemv, column of a matrix: "
+       << (maxdiff(B.view()*G.view().column(3),
+		       B*mathvector<double>(G.view().column(3).begin(),
+					    G.view().column(3).end())) < 1e-12)
+       << endl;
+
+  // In-place updates.
+  mathvector<double> u(y);
+  u += z;
+  u *= 2.0;
+  u -= y;
+  cout << "\ndaxpy/dscal: " << (maxdiff(u,y + 2.0*z) < 1e-12) << endl;
+  mathmatrix<double> E(A);
+  E += A;
+  E -= 3.0*A;
+  cout << "daxpy on matrices: " << (maxdiff(E,mathmatrix<double>(-A)) < 1e-14) << endl;
+}
@@ -45,4 +45,18 @@ int main ()
       cout << BT->r[i] << " ";
     }
   cout << endl;
+
+  // Irreducibility from the compressed columns, against mathmatrix.
+  cout << "irreducible: " << jlt::cs_isIrreducible(T)
+       << " (mathmatrix: " << M.isIrreducible() << ")" << endl;
+
+  // A cycle through all nodes is irreducible, with period 10; a chord
+  // closing a cycle of length 3 makes it primitive.
+  mathmatrix<int> C(10,10);
+  for (int i = 0; i < 10; ++i) C(i,(i+1) % 10) = 1;
+  C(2,0) = 1;
+  jlt::cs_unique_ptr Cs(jlt::mathmatrix_to_cs_sparse_matrix(C));
+  cout << "cycle: irreducible " << jlt::cs_isIrreducible(Cs)
+       << ", primitive " << jlt::cs_isPrimitive(Cs)
+       << " (mathmatrix: " << C.isPrimitive() << ")" << endl;
 }
@@ -0,0 +1,77 @@
+//
+// Copyright (c) 2004-2020 Jean-Luc Thiffeault <jeanluc@mailaps.org>
+//
+// See the file LICENSE for copying permission.
+//
+
+#include <iostream>
+#include <complex>
+#include <utility>
+#include <jlt/mathvector.hpp>
+#include <jlt/mathmatrix.hpp>
+
+
+int main()
+{
+  using std::cout;
+  using std::endl;
+  using jlt::mathvector;
+  using jlt::mathmatrix;
+
+  mathvector<double> x{1,2,3}, y{4,5,6}, z{-1,0,1};
+
+  // Evaluated in one loop, with no temporary vectors.
+  mathvector<double> r = 2.0*x + y*3 - z/2.0;
+  cout << "2x + 3y - z/2 = " << r << endl;
+  cout << "x/y           = " << x/y << endl;
+  cout << "-(x - y)      = " << -(x - y) << endl;
+
+  // Reductions of expressions don't evaluate them.
+  cout << "(x+y).z       = " << dot(x + y,z) << " " << (x + y)*z << endl;
+  cout << "|x-y|^2       = " << mag2(x - y) << endl;
+
+  // The result can appear on the right.
+  r = x;
+  r = r + 0.5*y;
+  r += x - z;
+  r -= 2*z;
+  cout << "r             = " << r << endl;
+
+  // A temporary operand lends its storage to the result.
+  mathvector<double> t(x);
+  const double *p = t.data();
+  mathvector<double> u = std::move(t) + y;
+  cout << "u             = " << u << endl;
+  cout << "Reused the temporary: " << (u.data() == p) << endl;
+
+  // Complex vectors.
+  using cplx = std::complex<double>;
+  mathvector<cplx> c{cplx(1,1),cplx(0,2)}, d{cplx(1,0),cplx(0,-1)};
+  cout << "|c - i d|^2   = " << mag2(c - cplx(0,1)*d) << endl;
+
+  //
+  // Matrices
+  //
+
+  mathmatrix<double> A(2,2,{1,2,3,4}), B(2,2,{0,1,1,0});
+  mathmatrix<double> C = A - 2*B + A/2.0;
+  cout << "\nA - 2B + A/2 =\n";
+  C.printMatrixForm(cout);
+
+  // Products evaluate expression operands first.
+  cout << "(A+B)*B =\n";
+  ((A + B)*B).printMatrixForm(cout);
+  mathvector<double> v{1,-1};
+  cout << "(A-B)*v = " << (A - B)*v << endl;
+  cout << "A*(v+v) = " << A*(v + v) << endl;
+
+  C = C - A;
+  C += B;
+  cout << "C - A + B =\n";
+  C.printMatrixForm(cout);
+
+  // The storage of A*B holds the result.
+  mathmatrix<double> D = A*B - A;
+  cout << "A*B - A =\n";
+  D.printMatrixForm(cout);
+}
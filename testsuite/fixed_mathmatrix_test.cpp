@@ -0,0 +1,97 @@
+//
+// Copyright (c) 2004-2020 Jean-Luc Thiffeault <jeanluc@mailaps.org>
+//
+// See the file LICENSE for copying permission.
+//
+
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+#include <jlt/fixed_mathmatrix.hpp>
+#include <jlt/mathmatrix.hpp>
+#include <jlt/mathvector.hpp>
+#include <jlt/stlio.hpp>
+
+
+// Compare det, inverse and charpoly of a random N by N matrix with
+// those of the same mathmatrix.
+template<std::size_t N>
+void compare_with_mathmatrix()
+{
+  using jlt::fixed_mathmatrix;
+
+  fixed_mathmatrix<double,N> F;
+  for (auto& x : F) x = (double)rand()/RAND_MAX - 0.5;
+  jlt::mathmatrix<double> A(F.view());
+
+  double errdet = std::abs(F.det() - A.det());
+
+  fixed_mathmatrix<double,N> Finv = F.inverse();
+  jlt::mathmatrix<double> Ainv = A.inverse();
+  double errinv = 0;
+  for (std::size_t i = 0; i < N; ++i)
+    for (std::size_t j = 0; j < N; ++j) errinv += std::abs(Finv(i,j)-Ainv(i,j));
+
+  auto pF = F.charpoly_coefficients();
+  auto pA = A.charpoly();
+  double errp = 0;
+  for (std::size_t k = 0; k <= N; ++k) errp += std::abs(pF[k] - pA[k]);
+
+  std::cout << "  " << N << "x" << N << ":  det error < 1e-12: "
+	    << (errdet < 1e-12) << "   inverse error < 1e-10: "
+	    << (errinv < 1e-10) << "   charpoly error < 1e-12: "
+	    << (errp < 1e-12) << std::endl;
+}
+
+int main()
+{
+  using std::cout;
+  using std::endl;
+  using jlt::fixed_mathvector;
+  using jlt::fixed_mathmatrix;
+
+  // Everything here is computed at compile time.
+  constexpr fixed_mathmatrix<double,2> J{2, 1,
+					 1, 1};
+  constexpr fixed_mathvector<double,2> v{1, -1};
+  static_assert(J.det() == 1, "det");
+  static_assert((J*J)(0,0) == 5, "product");
+  static_assert((J*v)[0] == 1, "matrix-vector product");
+  constexpr auto Jinv = J.inverse();
+  static_assert((J*Jinv)(1,1) == 1, "inverse");
+
+  cout << "J =\n";
+  J.printMatrixForm(cout);
+  cout << "\ninverse(J) =\n";
+  Jinv.printMatrixForm(cout);
+  cout << "\nJ.v = " << J*v << endl;
+  cout << "charpoly(J) = " << J.charpoly() << endl;
+
+  fixed_mathvector<double,3> a{1,0,0}, b{0,1,0};
+  cout << "\ncross(a,b) = " << cross(a,b) << endl;
+  cout << "a.b = " << a*b << ",  |a+b| = " << abs(a+b) << endl;
+
+  // Nonsquare products and transposes.
+  fixed_mathmatrix<double,2,3> B{1,2,3,
+				 4,5,6};
+  cout << "\nB.transpose(B) =\n";
+  (B*transpose(B)).printMatrixForm(cout);
+
+  // Interoperation with mathvector and mathmatrix.
+  jlt::mathvector<double> w{1,2,3};
+  cout << "\nB.w = " << B*w << endl;
+  jlt::mathmatrix<double> C(3,3);
+  C.identity(2);
+  fixed_mathmatrix<double,3> Cf(C);
+  cout << "det(C) = " << Cf.det() << endl;
+  jlt::mathmatrix<double> D((Cf*Cf).view());
+  cout << "C^2 as a mathmatrix =\n";
+  D.printMatrixForm(cout);
+
+  cout << "\nAgreement with mathmatrix:\n";
+  compare_with_mathmatrix<1>();
+  compare_with_mathmatrix<2>();
+  compare_with_mathmatrix<3>();
+  compare_with_mathmatrix<4>();
+  compare_with_mathmatrix<6>();
+}
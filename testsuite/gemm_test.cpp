@@ -0,0 +1,74 @@
+//
+// Copyright (c) 2004-2020 Jean-Luc Thiffeault <jeanluc@mailaps.org>
+//
+// See the file LICENSE for copying permission.
+//
+
+#include <iostream>
+#include <complex>
+#include <cmath>
+#include <jlt/mathmatrix.hpp>
+#include <jlt/gemm.hpp>
+#include "test_helpers.hpp"
+
+
+int main()
+{
+  using std::cout;
+  using std::endl;
+  using jlt::mathmatrix;
+  using jlt::trans;
+
+  // Sizes on either side of the small-product cutoff, the register
+  // tiles and the cache blocks.
+  const unsigned sizes[][3] = {{3,4,5}, {17,33,9}, {64,64,64}, {97,131,300},
+			       {200,7,520}, {5,300,40}};
+
+  cout << "A*B against the triple loop:\n";
+  for (auto& s : sizes)
+    {
+      cout << "  " << s[0] << "x" << s[2] << " times " << s[2] << "x" << s[1]
+	   << ": double " << check_product<double,jlt::row_major>(s[0],s[1],s[2],1e-14)
+	   << ", float " << check_product<float,jlt::row_major>(s[0],s[1],s[2],1e-5)
+	   << ", column-major "
+	   << check_product<double,jlt::column_major>(s[0],s[1],s[2],1e-14)
+	   << ", complex "
+	   << check_product<std::complex<double>,jlt::row_major>(s[0],s[1],s[2],1e-14)
+	   << endl;
+    }
+
+  // Transposes and views.
+  mathmatrix<double> A(150,70), B(120,70), Bt, D(300,200), R(150,120);
+  randomize(A);
+  randomize(B);
+  randomize(D);
+  B.transpose(Bt);
+
+  naive_product(R,A,Bt);
+  cout << "\nA*trans(B): " << (maxdiff(A*trans(B),R)/70 < 1e-14) << endl;
+
+  mathmatrix<double> At;
+  A.transpose(At);
+  cout << "trans(At)*Bt: " << (maxdiff(trans(At)*Bt,R)/70 < 1e-14) << endl;
+
+  auto Db = D.view().block(10,20,100,150);
+  mathmatrix<double> E(150,60), R2(100,60);
+  randomize(E);
+  naive_product(R2,Db,E);
+  cout << "block*E: " << (maxdiff(Db*E,R2)/150 < 1e-14) << endl;
+
+  // Accumulate into a block of a larger matrix: C += 2*A*B'.
+  mathmatrix<double> C(200,200), C0;
+  randomize(C);
+  C0 = C;
+  jlt::gemm(2.0,A,trans(B),1.0,C.view().block(50,40,150,120));
+  double err = 0;
+  for (unsigned i = 0; i < 200; ++i)
+    for (unsigned j = 0; j < 200; ++j)
+      {
+	double expect = C0(i,j);
+	if (i >= 50 && j >= 40 && j < 160) expect += 2*R(i-50,j-40);
+	err = std::max(err,std::abs(C(i,j) - expect));
+      }
+  cout << "C += 2*A*trans(B) on a block: " << (err < 1e-12) << endl;
+}
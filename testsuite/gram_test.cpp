@@ -0,0 +1,82 @@
+//
+// Copyright (c) 2004-2020 Jean-Luc Thiffeault <jeanluc@mailaps.org>
+//
+// See the file LICENSE for copying permission.
+//
+
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+#include <cmath>
+#include <complex>
+#include <jlt/mathmatrix.hpp>
+#include <jlt/packed_matrix.hpp>
+#include <jlt/eigensystem.hpp>
+#include <jlt/gram.hpp>
+#include "test_helpers.hpp"
+
+
+int main()
+{
+  using std::cout;
+  using std::endl;
+  using jlt::mathmatrix;
+  using jlt::trans;
+
+  // Sizes that are not multiples of the tile size.
+  const unsigned m = 250, k = 130;
+  mathmatrix<double> A(m,k);
+  for (auto& x : A) x = (double)rand()/RAND_MAX - 0.5;
+
+  mathmatrix<double> AAt = A*trans(A), AtA = trans(A)*A;
+
+  jlt::symmetric_matrix<double> S = jlt::gram(A), St = jlt::gram_t(A);
+  cout << "gram(A) agrees with A*trans(A): " << (maxdiff(S,AAt) < 1e-12)
+       << endl;
+  cout << "gram_t(A) agrees with trans(A)*A: " << (maxdiff(St,AtA) < 1e-12)
+       << endl;
+
+  // Dense results, mirrored or not.
+  mathmatrix<double> G(m,m), H(m,m,-1.0);
+  jlt::gram(A,G);
+  jlt::gram(A,H,false);
+  bool upper_untouched = true;
+  for (unsigned i = 0; i < m; ++i)
+    for (unsigned j = i+1; j < m; ++j) upper_untouched &= (H(i,j) == -1.0);
+  cout << "Dense, mirrored: " << (maxdiff(G,AAt) < 1e-12)
+       << ", upper triangle untouched: " << upper_untouched << endl;
+
+  // Accumulate the normal equations of two blocks of rows.
+  mathmatrix<double> N(k,k);
+  jlt::syrk(1.0,A.block(0,0,100,k).transpose(),0.0,N);
+  jlt::syrk(1.0,A.block(100,0,m-100,k).transpose(),1.0,N);
+  cout << "Normal equations by blocks: " << (maxdiff(N,AtA) < 1e-12) << endl;
+
+  // Integer and complex elements.
+  mathmatrix<long> L(7,5);
+  for (auto& x : L) x = rand() % 10 - 5;
+  cout << "Integer: " << (maxdiff(jlt::gram(L),L*trans(L)) == 0) << endl;
+  mathmatrix<std::complex<double>> Z(20,9);
+  for (auto& z : Z) z = {(double)rand()/RAND_MAX,(double)rand()/RAND_MAX};
+  cout << "Complex (not conjugated): "
+       << (maxdiff(jlt::gram(Z),Z*trans(Z)) < 1e-13) << endl;
+
+  // Eigenvalues of trans(A)*A are the squares of the singular values of
+  // A: their sum is the squared Frobenius norm.
+  std::vector<double> ev(k);
+  jlt::symmetric_matrix_eigenvalues(St,ev);
+  double sum = 0;
+  for (auto e : ev) sum += e;
+  cout << "Sum of eigenvalues of gram_t(A) is |A|^2: "
+       << (std::abs(sum - jlt::nrm2(A)*jlt::nrm2(A)) < 1e-10)
+       << ", smallest nonnegative: " << (ev[k-1] > -1e-12) << endl;
+
+  // Against the full product.
+  const unsigned n = 600;
+  mathmatrix<double> F(n,n);
+  for (auto& x : F) x = (double)rand()/RAND_MAX;
+  mathmatrix<double> P = F*trans(F);
+  jlt::symmetric_matrix<double> Q = jlt::gram(F);
+  cout << "\n" << n << "x" << n << ": gram(F) agrees with F*trans(F): "
+       << (maxdiff(P,Q) < 1e-9) << endl;
+}
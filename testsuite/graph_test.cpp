@@ -0,0 +1,94 @@
+//
+// Copyright (c) 2004-2020 Jean-Luc Thiffeault <jeanluc@mailaps.org>
+//
+// See the file LICENSE for copying permission.
+//
+
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+#include <jlt/mathmatrix.hpp>
+#include <jlt/bit_matrix.hpp>
+#include <jlt/graph.hpp>
+
+
+// Irreducible: (I + A)^(n-1) has no zeros.
+bool irreducible_by_powers(const jlt::bit_matrix& A)
+{
+  auto n = A.rows();
+  jlt::bit_matrix B(n,n), P(n,n);
+  B.identity();
+  B |= A;
+  P.identity();
+  for (unsigned p = 1; p < n; ++p) P = P*B;
+  return P.all();
+}
+
+// Primitive: A^(n^2 - 2n + 2) has no zeros (Wielandt).
+bool primitive_by_powers(const jlt::bit_matrix& A)
+{
+  auto n = A.rows();
+  jlt::bit_matrix P(A);
+  for (unsigned p = 1; p < n*n - 2*n + 2; ++p) P = P*A;
+  return P.all();
+}
+
+int main()
+{
+  using std::cout;
+  using std::endl;
+  using jlt::mathmatrix;
+
+  // A cycle of length 3 is irreducible with period 3; adding a chord
+  // that closes a cycle of length 2 makes it primitive.
+  mathmatrix<double> C3(3,3,{0, 1, 0,
+			     0, 0, 1,
+			     1, 0, 0});
+  cout << "3-cycle: irreducible " << C3.isIrreducible()
+       << ", period " << jlt::nonzero_graph(C3).period()
+       << ", primitive " << C3.isPrimitive() << endl;
+  C3(1,0) = 0.5;
+  cout << "3-cycle with a 2-cycle: irreducible " << C3.isIrreducible()
+       << ", period " << jlt::nonzero_graph(C3).period()
+       << ", primitive " << C3.isPrimitive() << endl;
+
+  // A triangular matrix is reducible.
+  mathmatrix<double> U(3,3,{1, 1, 1,
+			    0, 1, 1,
+			    0, 0, 1});
+  std::vector<std::size_t> comp;
+  cout << "Upper-triangular: irreducible " << U.isIrreducible()
+       << ", " << jlt::nonzero_graph(U).strong_components(comp)
+       << " strong components" << endl;
+
+  // Against powers of the pattern, on random sparse matrices.
+  int agree = 0, irred = 0, prim = 0;
+  const int ntests = 500;
+  for (int t = 0; t < ntests; ++t)
+    {
+      unsigned n = 1 + rand() % 10;
+      mathmatrix<double> A(n,n);
+      for (auto& x : A) x = (rand() % 4 == 0 ? 1 : 0);
+      jlt::bit_matrix P(A);
+      bool i = A.isIrreducible(), p = A.isPrimitive();
+      irred += i;
+      prim += p;
+      agree += (i == irreducible_by_powers(P) && p == primitive_by_powers(P));
+    }
+  cout << "\nAgree with matrix powers on " << agree << " of " << ntests
+       << " matrices (" << irred << " irreducible, " << prim
+       << " primitive)" << endl;
+
+  // Thousands of small transition matrices.
+  const int nmat = 2000;
+  const unsigned n = 50;
+  std::vector<mathmatrix<double>> T(nmat,mathmatrix<double>(n,n));
+  for (auto& A : T)
+    for (auto& x : A) x = (rand() % 10 == 0 ? (double)rand()/RAND_MAX : 0);
+
+  int nprim = 0, nred = 0;
+  for (auto& A : T) nprim += A.isPrimitive();
+  for (auto& A : T) nred += A.isReducible();
+  cout << "\n" << nmat << " matrices " << n << "x" << n << ": " << nprim
+       << " primitive, " << nred << " reducible" << endl;
+}
@@ -0,0 +1,136 @@
+//
+// Copyright (c) 2004-2020 Jean-Luc Thiffeault <jeanluc@mailaps.org>
+//
+// See the file LICENSE for copying permission.
+//
+
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+#include <complex>
+#include <jlt/mathvector.hpp>
+#include <jlt/mathmatrix.hpp>
+#include <jlt/lu_factorization.hpp>
+#include "test_helpers.hpp"
+
+
+template<class T>
+bool check(int n)
+{
+  const double tol = tolerance<T>(1e7);
+  using jlt::mathmatrix;
+  using jlt::mathvector;
+
+  mathmatrix<T> A = random_matrix<T>(n,n), B = random_matrix<T>(n,7);
+  jlt::lu_factorization<T> lu(A);
+
+  mathmatrix<T> X = lu.solve(B), Xt = lu.solve_transpose(B);
+  mathvector<T> b(n), x, xt;
+  for (int i = 0; i < n; ++i) b[i] = B(i,0);
+  x = lu.solve(b);
+  xt = lu.solve_transpose(b);
+
+  double r = std::max(residual(A,X,B),residual(A,Xt,B,true));
+  for (int i = 0; i < n; ++i)
+    r = std::max(r,(double)std::max(std::abs(x[i] - X(i,0)),
+				    std::abs(xt[i] - Xt(i,0))));
+
+  // The inverse, and the determinant against mathmatrix::det().
+  mathmatrix<T> I(n,n);
+  I.identity();
+  r = std::max(r,residual(A,lu.inverse(),I));
+
+  T sign;
+  auto ld = lu.logdet(&sign);
+  T d = A.det();
+  r = std::max(r,(double)(std::abs(lu.det() - d)/std::abs(d)));
+  r = std::max(r,(double)(std::abs(sign*std::exp(ld) - d)/std::abs(d)));
+
+  return (r < tol);
+}
+
+int main()
+{
+  using std::cout;
+  using std::endl;
+  using jlt::mathmatrix;
+  using jlt::mathvector;
+
+  bool ok = true;
+  for (int n : {1, 5, JLT_LU_BLOCK + 3, 2*JLT_LU_BLOCK + 1})
+    ok = ok && check<double>(n);
+  cout << "Solves, inverse and determinant, double: " << ok;
+  cout << ", complex: " << check<std::complex<double>>(150);
+  cout << ", long double: " << check<long double>(150) << endl;
+
+  // adj(A) X = B for a complex A, from the factors.
+  {
+    using C = std::complex<double>;
+    const int n = 100;
+    mathmatrix<C> A = random_matrix<C>(n,n), B = random_matrix<C>(n,3);
+    for (auto& z : A) z *= C(1,0.5);
+    jlt::lu_factorization<C> lu(A);
+    mathmatrix<C> X(B);
+    jlt::LUsolve<C>(jlt::adj(lu.factors()),lu.pivots().data(),X);
+    double r = 0;
+    for (int i = 0; i < n; ++i)
+      for (int c = 0; c < 3; ++c)
+	{
+	  C s = 0;
+	  for (int k = 0; k < n; ++k) s += std::conj(A(k,i))*X(k,c);
+	  r = std::max(r,std::abs(s - B(i,c)));
+	}
+    cout << "adj(A) solve: " << (r < 1e-10) << endl;
+  }
+
+  // The determinant of a large matrix overflows, but not its logarithm.
+  {
+    const int n = 400;
+    mathmatrix<double> A(n,n);
+    A.identity();
+    A *= 1e3;
+    A(0,0) = 1; A(0,1) = 2; A(1,0) = 1e3;	// det = -1e3 * 1e3^398.
+    jlt::lu_factorization<double> lu(A);
+    double sign;
+    double ld = lu.logdet(&sign);
+    cout << "\nlog|det| = " << ld << " (" << 399*std::log(1e3)
+	 << "), sign " << sign << ", det " << lu.det() << endl;
+  }
+
+  // Refactoring reuses the storage.
+  {
+    mathmatrix<double> A = random_matrix<double>(50,50);
+    jlt::lu_factorization<double> lu(A);
+    const double* p = lu.factors().data();
+    A(3,4) += 1;
+    lu.factor(A);
+    jlt::mathmatrix<double> B = random_matrix<double>(50,2);
+    cout << "Refactored in the same storage: " << (lu.factors().data() == p)
+	 << ", residual " << (residual(A,lu.solve(B),B) < 1e-10) << endl;
+
+    // Solve into a block of a larger matrix.
+    mathmatrix<double> C(60,4);
+    for (int i = 0; i < 50; ++i)
+      for (int c = 0; c < 2; ++c) C(i+10,c+2) = B(i,c);
+    lu.solve_transpose_in_place(C.block(10,2,50,2));
+    mathmatrix<double> Xt = lu.solve_transpose(B);
+    double e = 0;
+    for (int i = 0; i < 50; ++i)
+      for (int c = 0; c < 2; ++c) e = std::max(e,std::abs(C(i+10,c+2) - Xt(i,c)));
+    cout << "Transposed solve on a block: " << (e < 1e-12) << endl;
+  }
+
+  // Factor once, solve many times, against factoring at every solve.
+  {
+    const int n = 300, nsteps = 100;
+    mathmatrix<double> J = random_matrix<double>(n,n);
+    mathvector<double> x(n,1.0), y(n,1.0);
+
+    jlt::lu_factorization<double> lu(J);
+    for (int s = 0; s < nsteps; ++s) lu.solve_in_place(x);
+    for (int s = 0; s < nsteps; ++s) y = jlt::solve(J,y);
+    cout << "\n" << nsteps << " solves of size " << n
+	 << ", factored once and every time, agree: "
+	 << (abs(x - y) < 1e-6*abs(y)) << endl;
+  }
+}
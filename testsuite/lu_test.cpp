@@ -0,0 +1,158 @@
+//
+// Copyright (c) 2004-2020 Jean-Luc Thiffeault <jeanluc@mailaps.org>
+//
+// See the file LICENSE for copying permission.
+//
+
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+#include <cmath>
+#include <complex>
+#include <jlt/mathvector.hpp>
+#include <jlt/mathmatrix.hpp>
+#include <jlt/matrixutil.hpp>
+#include "test_helpers.hpp"
+
+
+// Largest residual |A x - b| of a solve with the LU factors of A.
+template<class T>
+double lu_residual(const jlt::mathmatrix<T>& A)
+{
+  const int n = A.rows();
+  jlt::mathmatrix<T> LU(A);
+  std::vector<int> row_index(n);
+  int perm;
+  jlt::LUdecomp<T>(LU,row_index.data(),&perm);
+
+  std::vector<T> b(n), x(n);
+  for (int i = 0; i < n; ++i) b[i] = x[i] = T(i % 3) - T(1);
+  jlt::LUbacksub<T>(LU,row_index.data(),x.data());
+
+  double r = 0;
+  for (int i = 0; i < n; ++i)
+    {
+      T s = 0;
+      for (int j = 0; j < n; ++j) s += A(i,j)*x[j];
+      r = std::max(r,(double)std::abs(s - b[i]));
+    }
+  return r;
+}
+
+// Largest element of A*X - I.
+template<class T>
+double inverse_error(const jlt::mathmatrix<T>& A, const jlt::mathmatrix<T>& X)
+{
+  double e = 0;
+  for (unsigned i = 0; i < A.rows(); ++i)
+    for (unsigned j = 0; j < A.rows(); ++j)
+      {
+	T s = 0;
+	for (unsigned k = 0; k < A.rows(); ++k) s += A(i,k)*X(k,j);
+	e = std::max(e,(double)std::abs(s - T(i == j ? 1 : 0)));
+      }
+  return e;
+}
+
+template<class T>
+bool check_residual(int n)
+{
+  return (lu_residual(random_matrix<T>(n,n)) < tolerance<T>(1e6));
+}
+
+template<class T>
+bool check_invert(int n)
+{
+  jlt::mathmatrix<T> A = random_matrix<T>(n,n), X(A);
+  X.invert();
+  return (inverse_error(A,X) < tolerance<T>(1e7));
+}
+
+int main()
+{
+  using std::cout;
+  using std::endl;
+  using jlt::mathmatrix;
+  using jlt::mathvector;
+
+  // Sizes on either side of the panel width.
+  bool ok = true;
+  for (int n : {1, 2, 7, JLT_LU_BLOCK-1, JLT_LU_BLOCK, JLT_LU_BLOCK+1, 300})
+    ok = ok && check_residual<double>(n);
+  cout << "Residuals, double: " << ok << endl;
+  cout << "Residuals, complex: " << check_residual<std::complex<double>>(150)
+       << ", long double: " << check_residual<long double>(150) << endl;
+
+  // Pivoting is needed here: the leading element is zero.
+  mathmatrix<double> P(3,3,{0, 1, 2,
+			    3, 4, 5,
+			    6, 7, 9});
+  cout << "det = " << P.det() << " (-3)" << endl;
+
+  // det(A) det(inverse(A)) = 1, for a matrix larger than a panel.
+  mathmatrix<double> A = random_matrix<double>(200,200);
+  mathmatrix<double> Ainv = A.inverse();
+  cout << "det(A) det(inverse(A)) = " << A.det()*Ainv.det() << endl;
+
+  // A singular matrix with a zero row throws.
+  mathmatrix<double> Z(3,3,{1, 2, 3,
+			    0, 0, 0,
+			    4, 5, 6});
+  try
+    {
+      cout << "No exception for a zero row: det = " << Z.det() << endl;
+    }
+  catch (std::runtime_error& e)
+    {
+      cout << "Zero row: " << e.what() << endl;
+    }
+
+  // Multiple right-hand sides, against LUbacksub column by column.
+  {
+    const int n = 2*JLT_LU_BLOCK + 17, r = 40;
+    mathmatrix<double> A = random_matrix<double>(n,n), B(n,r);
+    for (auto& x : B) x = (double)rand()/RAND_MAX;
+    mathmatrix<double> X = jlt::solve(A,B);
+
+    mathmatrix<double> LU(A);
+    std::vector<int> row_index(n);
+    int perm;
+    jlt::LUdecomp<double>(LU,row_index.data(),&perm);
+    double e = 0;
+    for (int c = 0; c < r; ++c)
+      {
+	std::vector<double> col(n);
+	for (int i = 0; i < n; ++i) col[i] = B(i,c);
+	jlt::LUbacksub<double>(LU,row_index.data(),col.data());
+	for (int i = 0; i < n; ++i) e = std::max(e,std::abs(col[i] - X(i,c)));
+      }
+    cout << "\nsolve(A,B) agrees with LUbacksub: " << (e < 1e-10) << endl;
+
+    // Into a block of a larger matrix.
+    mathmatrix<double> C(n+3,r+5);
+    for (int i = 0; i < n; ++i)
+      for (int c = 0; c < r; ++c) C(i+3,c+5) = B(i,c);
+    jlt::LUsolve<double>(LU,row_index.data(),C.block(3,5,n,r));
+    e = 0;
+    for (int i = 0; i < n; ++i)
+      for (int c = 0; c < r; ++c) e = std::max(e,std::abs(C(i+3,c+5) - X(i,c)));
+    cout << "LUsolve on a block: " << (e < 1e-10) << endl;
+
+    mathvector<double> b(n,1.0), x = jlt::solve(A,b), Ax = A*x;
+    cout << "solve(A,b) residual: " << (abs(Ax - b) < 1e-10) << endl;
+  }
+
+  // In-place inversion, for several sizes and element types.
+  ok = true;
+  for (int n : {1, 3, JLT_LU_BLOCK, 2*JLT_LU_BLOCK + 5})
+    ok = ok && check_invert<double>(n);
+  cout << "\ninvert(), double: " << ok
+       << ", complex: " << check_invert<std::complex<double>>(150)
+       << ", long double: " << check_invert<long double>(150) << endl;
+  {
+    auto L = random_matrix<long double>(150,150);
+    mathmatrix<long double> Linv(150,150), L2(L);
+    L2.invert(Linv);
+    cout << "invert(Ainv): " << (inverse_error(L,Linv) < 1e-12) << endl;
+  }
+}
@@ -0,0 +1,69 @@
+//
+// Copyright (c) 2004-2020 Jean-Luc Thiffeault <jeanluc@mailaps.org>
+//
+// See the file LICENSE for copying permission.
+//
+
+#include <iostream>
+#include <cmath>
+#include <jlt/matrix.hpp>
+#include <jlt/mathmatrix.hpp>
+#include <jlt/mathvector.hpp>
+#include <jlt/matlab.hpp>
+
+
+int main()
+{
+  using std::cout;
+  using std::endl;
+  using jlt::mathmatrix;
+  using jlt::mathvector;
+
+  // Accumulate a time series of a rotation, one row (t,x,y) per step,
+  // without knowing the number of steps in advance.
+  mathmatrix<double> X;
+  const double dt = 0.5;
+  mathvector<double> r{0,1,0};
+
+  cout << "rows\tcapacity\n";
+  for (int k = 0; k < 10; ++k)
+    {
+      X.push_back_row(r);
+      cout << X.rows() << "\t" << X.capacity() << endl;
+
+      double c = std::cos(dt), s = std::sin(dt);
+      r = mathvector<double>{r[0] + dt, c*r[1] - s*r[2], s*r[1] + c*r[2]};
+    }
+
+  // Release the unused capacity.
+  X.shrink_to_fit();
+  cout << "\nAfter shrink_to_fit: " << X.rows() << " rows, capacity "
+       << X.capacity() << endl;
+
+  // Drop the last two steps, and append a row of zeros.
+  X.pop_back_row();
+  X.pop_back_row();
+  X.push_back_row({0,0,0});
+  cout << "\nAfter popping two rows and pushing a row of zeros: "
+       << X.rows() << " rows, capacity " << X.capacity() << endl;
+
+  printMatlabForm(cout,X,"X","rotation time series");
+
+  // Reserving up front avoids any reallocation.
+  jlt::matrix<int> A(0,3);
+  A.reserve(100);
+  const int *p = A.data();
+  for (int i = 0; i < 100; ++i) A.push_back_row({i,i*i,i*i*i});
+  cout << "\nReserved 100 rows, appended " << A.rows()
+       << ", storage moved: " << (A.data() != p) << endl;
+  cout << "Last row: " << A.row_view(99) << endl;
+
+  // A default-constructed matrix has no columns: give reserve() the
+  // length of the rows to come.
+  jlt::matrix<int> B;
+  B.reserve(50,2);
+  p = B.data();
+  for (int i = 0; i < 50; ++i) B.push_back_row({i,-i});
+  cout << "Reserved 50 rows of 2 in an empty matrix, storage moved: "
+       << (B.data() != p) << endl;
+}
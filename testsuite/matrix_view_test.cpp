@@ -0,0 +1,104 @@
+//
+// Copyright (c) 2004-2020 Jean-Luc Thiffeault <jeanluc@mailaps.org>
+//
+// See the file LICENSE for copying permission.
+//
+
+#include <iostream>
+#include <cstdlib>
+#include <vector>
+#include <jlt/mathmatrix.hpp>
+#include <jlt/matrixutil.hpp>
+#include <jlt/stlio.hpp>
+
+
+int main()
+{
+  using std::cout;
+  using std::endl;
+  using jlt::mathmatrix;
+  using jlt::mathvector;
+  using jlt::matrix_view;
+
+  int n = 6;
+  mathmatrix<double> M(n,n);
+
+  for (int i = 0; i < n; ++i)
+    for (int j = 0; j < n; ++j)
+      M(i,j) = 10*i + j;
+
+  cout << "M =\n";
+  M.printMatrixForm(cout);
+
+  cout << "\nRow 2 (copy):   " << mathvector<double>(M.row(2)) << endl;
+  cout << "Row 2 (view):   " << M.row_view(2) << endl;
+  cout << "Column 3:       " << M.column_view(3) << endl;
+  cout << "Diagonal:       " << M.diagonal_view() << endl;
+
+  cout << "\nBlock (1,2) of size 3x2:\n";
+  M.block(1,2,3,2).printMatrixForm(cout);
+
+  cout << "\nIts transpose:\n";
+  M.block(1,2,3,2).transpose().printMatrixForm(cout);
+
+  // Writing through a view changes M.
+  M.block(4,4,2,2) = 0.;
+  M.column_view(0) = M.row_view(0);
+  cout << "\nM after zeroing a block and copying row 0 to column 0:\n";
+  M.printMatrixForm(cout);
+
+  // Products of blocks, without copying the blocks.
+  cout << "\nM(0:2,0:2) * M(3:5,3:5) =\n";
+  (M.block(0,0,3,3) * M.block(3,3,3,3)).printMatrixForm(cout);
+
+  // Write a product directly into a block of another matrix.
+  mathmatrix<double> C(n,n);
+  jlt::matrix_product(C.block(0,3,3,3),M.block(0,0,3,3),M.block(3,3,3,3));
+  cout << "\nSame product written into the top-right block of C:\n";
+  C.printMatrixForm(cout);
+
+  // LU decomposition and inverse of a diagonal block, in place.
+  mathmatrix<double> R(n,n);
+  for (int i = 0; i < n; ++i)
+    for (int j = 0; j < n; ++j)
+      R(i,j) = (double)rand()/RAND_MAX;
+
+  mathmatrix<double> Rblock(R.block(1,1,4,4));
+  matrix_view<double> B = R.block(1,1,4,4);
+  int perm;
+  std::vector<int> row_index(4);
+  jlt::LUdecomp<double>(B, row_index.data(), &perm);
+
+  double err = 0;
+  for (int j = 0; j < 4; ++j)
+    {
+      std::vector<double> col(4);
+      col[j] = 1;
+      jlt::LUbacksub<double>(B, row_index.data(), col.data());
+      // Check that Rblock * col is the jth unit vector.
+      for (int i = 0; i < 4; ++i)
+	{
+	  double sum = 0;
+	  for (int k = 0; k < 4; ++k) sum += Rblock(i,k)*col[k];
+	  err += std::abs(sum - (i == j ? 1 : 0));
+	}
+    }
+  cout << "\nLU inverse of a block, typical error = " << err/16 << endl;
+
+  // QR decomposition of a block.
+  mathmatrix<double> Q(4,4), Rq(4,4);
+  matrix_view<double> B2 = R.block(2,0,4,4), Qv = Q.view(), Rv = Rq.view();
+  mathmatrix<double> B2copy(B2);
+  jlt::QRdecomp<double,matrix_view<double>,std::vector<double>>(B2,Qv,Rv);
+  mathmatrix<double> Merr = B2copy - Q*Rq;
+  err = 0;
+  for (double e : Merr) err += std::abs(e);
+  cout << "QR decomposition of a block, typical error = " << err/16 << endl;
+
+  // Gram-Schmidt on the columns of a block, via a transposed view.
+  matrix_view<double> Bt = R.block(0,0,3,3).transpose();
+  jlt::GramSchmidtOrthonorm(Bt);
+  mathmatrix<double> G = R.block(0,0,3,3).transpose() * R.block(0,0,3,3);
+  cout << "\nColumns of an orthonormalised block, Gram matrix =\n";
+  G.printMatrixForm(cout);
+}
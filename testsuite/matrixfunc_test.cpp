@@ -0,0 +1,93 @@
+//
+// Copyright (c) 2004-2020 Jean-Luc Thiffeault <jeanluc@mailaps.org>
+//
+// See the file LICENSE for copying permission.
+//
+
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+#include <jlt/mathmatrix.hpp>
+#include <jlt/matrixfunc.hpp>
+#include "test_helpers.hpp"
+
+
+// exp(A) by its Taylor series, for small A.
+jlt::mathmatrix<double> expm_taylor(const jlt::mathmatrix<double>& A)
+{
+  unsigned n = A.rows();
+  jlt::mathmatrix<double> E(n,n), term(n,n);
+  for (unsigned i = 0; i < n; ++i) E(i,i) = term(i,i) = 1;
+  for (int k = 1; k < 30; ++k)
+    {
+      term = term*A;
+      for (auto& x : term) x /= k;
+      E += term;
+    }
+  return E;
+}
+
+int main()
+{
+  using std::cout;
+  using std::endl;
+  using jlt::mathmatrix;
+
+  // Powers of a Fibonacci matrix.
+  mathmatrix<long> F(2,2,{1, 1,
+			  1, 0});
+  cout << "F^0:\n";
+  jlt::pow(F,0).printMatrixForm(cout);
+  cout << "F^10:\n";
+  jlt::pow(F,10).printMatrixForm(cout);
+  jlt::pow_in_place(F,50);
+  cout << "F^50(0,1) = " << F(0,1) << endl;
+
+  // Against repeated products.
+  const unsigned n = 20;
+  mathmatrix<double> A(n,n), P(n,n), Ak;
+  for (auto& x : A) x = (double)rand()/RAND_MAX/n;
+  for (unsigned i = 0; i < n; ++i) P(i,i) = 1;
+  for (int k = 0; k < 37; ++k) P = P*A;
+  jlt::pow(A,37,Ak);
+  cout << "\npow(A,37) against 37 products: " << (maxdiff(P,Ak) < 1e-12)
+       << endl;
+
+  // exp of a rotation generator.
+  const double t = 2.5;
+  mathmatrix<double> R(2,2,{0, -t,
+			    t,  0});
+  cout << "\nexp of a rotation by " << t << ":\n";
+  jlt::expm(R).printMatrixForm(cout);
+  cout << "cos, sin: " << cos(t) << " " << sin(t) << endl;
+
+  // Against the Taylor series for matrices of increasing norm, so that
+  // each Pade degree is used, then with scaling.
+  bool ok = true;
+  for (double scale : {1e-3, 0.1, 0.5, 1.5, 4.0})
+    {
+      mathmatrix<double> B(n,n);
+      for (auto& x : B) x = scale*(2*(double)rand()/RAND_MAX - 1)/n;
+      ok = ok && (maxdiff(jlt::expm(B),expm_taylor(B)) < 1e-12);
+    }
+  cout << "expm against Taylor series: " << ok << endl;
+
+  // exp(A) exp(-A) = I, with scaling and squaring.
+  mathmatrix<double> G(n,n), E, Einv, I(n,n);
+  for (auto& x : G) x = 4*(2*(double)rand()/RAND_MAX - 1);
+  for (unsigned i = 0; i < n; ++i) I(i,i) = 1;
+  jlt::matrix_workspace<mathmatrix<double>> ws;
+  jlt::expm(G,E,ws);
+  mathmatrix<double> mG = -G;
+  jlt::expm(mG,Einv,ws);
+  mathmatrix<double> EEinv = E*Einv;
+  cout << "exp(G) exp(-G) = I: " << (maxdiff(EEinv,I) < 1e-8) << endl;
+
+  // Single precision.
+  mathmatrix<float> Rf(2,2,{0, -(float)t,
+			    (float)t,  0});
+  mathmatrix<float> Ef = jlt::expm(Rf);
+  cout << "Single precision: "
+       << (std::abs(Ef(0,0) - (float)cos(t)) < 1e-5 &&
+	   std::abs(Ef(1,0) - (float)sin(t)) < 1e-5) << endl;
+}
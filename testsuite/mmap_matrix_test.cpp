@@ -0,0 +1,70 @@
+//
+// Copyright (c) 2004-2020 Jean-Luc Thiffeault <jeanluc@mailaps.org>
+//
+// See the file LICENSE for copying permission.
+//
+
+#include <iostream>
+#include <vector>
+#include <cstdio>
+#include <cmath>
+#include <jlt/mmap_matrix.hpp>
+#include <jlt/mathmatrix.hpp>
+#include <jlt/finitediff.hpp>
+#include <jlt/matlab.hpp>
+#include <jlt/stlio.hpp>
+
+
+int main()
+{
+  using std::cout;
+  using std::endl;
+  using jlt::mmap_matrix;
+
+  const char *fname = "mmap_matrix_test.bin";
+  const int nt = 9;
+
+  // Times.
+  std::vector<double> t(nt);
+  for (int k = 0; k < nt; ++k) t[k] = 0.25*k;
+
+  {
+    // Write trajectories one time step (row) at a time: x, x^2, sin(x).
+    mmap_matrix<double> X(fname,3,jlt::mmap_create);
+    X.advise(jlt::mmap_sequential);
+    for (int k = 0; k < nt; ++k)
+      X.push_back_row(std::vector<double>{t[k],t[k]*t[k],std::sin(t[k])});
+
+    cout << "Wrote " << X.rows() << " rows of " << X.columns()
+	 << " columns (capacity " << X.capacity() << " rows).\n";
+  } // The file is trimmed and closed here.
+
+  // Map it again, read-only.
+  mmap_matrix<double> X(fname,3);
+  X.advise(jlt::mmap_sequential);
+
+  cout << "\nReopened: " << X.rows() << " x " << X.columns() << endl;
+  X.printMatlabForm(cout,"X","trajectories");
+
+  // Differentiate the second column in time, straight from the file.
+  jlt::mathvector<double> dx2(nt);
+  jlt::finitediff4(t,X.column_view(1),dx2);
+  cout << "\nd(t^2)/dt = " << dx2 << endl;
+
+  // Products with views of the mapped data.
+  jlt::mathmatrix<double> G = X.view().transpose() * X.view();
+  cout << "\nX^T X =\n";
+  G.printMatrixForm(cout);
+
+  // Read-write: scale a column in place, and append a row.
+  {
+    mmap_matrix<double> Y(fname,3,jlt::mmap_read_write);
+    for (auto& x : Y.column_view(2)) x *= 2;
+    Y.push_back_row(std::vector<double>{-1,-1,-1});
+  }
+  mmap_matrix<double> Z(fname,3);
+  cout << "\nAfter scaling column 2 and appending a row:\n";
+  Z.printMatrixForm(cout);
+
+  std::remove(fname);
+}
@@ -0,0 +1,136 @@
+//
+// Copyright (c) 2004-2020 Jean-Luc Thiffeault <jeanluc@mailaps.org>
+//
+// See the file LICENSE for copying permission.
+//
+
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+#include <cmath>
+#include <jlt/packed_matrix.hpp>
+#include <jlt/banded_matrix.hpp>
+#include <jlt/eigensystem.hpp>
+#include <jlt/mathmatrix.hpp>
+#include <jlt/mathvector.hpp>
+#include "test_helpers.hpp"
+
+
+int main()
+{
+  using std::cout;
+  using std::endl;
+  using jlt::mathmatrix;
+  using jlt::mathvector;
+
+  const int n = 5;
+  mathmatrix<double> B(n,3);
+  for (auto& x : B) x = (double)rand()/RAND_MAX - 0.5;
+  mathvector<double> x{1,-2,3,-4,5};
+
+  //
+  // Symmetric matrix
+  //
+
+  mathmatrix<double> M(n,n);
+  for (int i = 0; i < n; ++i)
+    for (int j = 0; j <= i; ++j) M(i,j) = M(j,i) = 1.0/(i+j+1);	// Hilbert
+
+  jlt::symmetric_matrix<double> S(M);
+  cout << "Symmetric: " << S.storage_size() << " elements stored instead of "
+       << S.size() << "\n";
+  S.printMatrixForm(cout);
+  cout << "S*x agrees: " << (abs(S*x - M*x) < 1e-14) << endl;
+  cout << "S*B agrees: " << (maxdiff(S*B,M*B) < 1e-14) << endl;
+  cout << "S*column agrees: "
+       << (abs(S*B.view().column(1) - M*B.view().column(1)) < 1e-14) << endl;
+
+  // Eigenvalues with the packed driver, compared to the full one.
+  {
+    jlt::symmetric_matrix<double> S2(S);
+    mathmatrix<double> Z(n,n), M2(M);
+    std::vector<double> ev(n), evfull(n);
+    jlt::symmetric_matrix_eigensystem(S2,ev,Z);
+    jlt::symmetric_matrix_eigensystem(M2,evfull);
+    cout << "\nEigenvalues: " << mathvector<double>(ev.begin(),ev.end()) << endl;
+    double err = 0;
+    for (int i = 0; i < n; ++i) err += std::abs(ev[i] - evfull[i]);
+    cout << "Same as from the full matrix: " << (err < 1e-12) << endl;
+    // Check M z = lambda z for the first (largest) eigenvector.
+    auto z0 = Z.row(0);
+    mathvector<double> z(z0.begin(),z0.end());
+    cout << "Residual of first eigenvector: " << (abs(M*z - ev[0]*z) < 1e-12)
+	 << endl;
+
+    jlt::symmetric_matrix<double> S3(S);
+    std::vector<double> ev3(n);
+    jlt::symmetric_matrix_eigenvalues(S3,ev3);
+    err = 0;
+    for (int i = 0; i < n; ++i) err += std::abs(ev3[i] - ev[i]);
+    cout << "Eigenvalues only agree: " << (err < 1e-12) << endl;
+  }
+
+  //
+  // Triangular matrices
+  //
+
+  mathmatrix<double> G(n,n);
+  for (auto& y : G) y = (double)rand()/RAND_MAX - 0.5;
+  jlt::triangular_matrix<double> L(G);
+  jlt::triangular_matrix<double,jlt::upper_triangle> U(G);
+  mathmatrix<double> Lf = L.full(), Uf = U.full();
+
+  cout << "\nLower triangle:\n";
+  L.printMatrixForm(cout);
+  cout << "L*x agrees: " << (abs(L*x - Lf*x) < 1e-14) << endl;
+  cout << "U*x agrees: " << (abs(U*x - Uf*x) < 1e-14) << endl;
+  cout << "L*B agrees: " << (maxdiff(L*B,Lf*B) < 1e-14) << endl;
+  cout << "U*B agrees: " << (maxdiff(U*B,Uf*B) < 1e-14) << endl;
+  cout << "det(U) agrees: " << (std::abs(U.det() - Uf.det()) < 1e-14) << endl;
+
+  //
+  // Banded matrices
+  //
+
+  // -u'' = 1 on (0,1), u(0) = u(1) = 0, with centred differences.
+  const int N = 9;
+  const double h = 1.0/(N+1);
+  jlt::banded_matrix<double> D(N,N,1,1);
+  for (int i = 0; i < N; ++i)
+    {
+      D(i,i) = 2/(h*h);
+      if (i > 0) D(i,i-1) = -1/(h*h);
+      if (i < N-1) D(i,i+1) = -1/(h*h);
+    }
+  cout << "\nTridiagonal: " << D.storage_size() << " elements stored instead of "
+       << D.size() << endl;
+
+  mathvector<double> f(N,1.0), u(f), v(f);
+  int info = jlt::banded_solve(D,u);
+  cout << "gbsv info = " << info << endl;
+  info = jlt::banded_spd_solve(D,v);
+  cout << "pbsv info = " << info << endl;
+
+  // The exact solution x(1-x)/2 is quadratic, so the discrete solution
+  // is exact at the grid points.
+  double err = 0;
+  for (int i = 0; i < N; ++i)
+    {
+      double xi = (i+1)*h;
+      err = std::max(err,std::abs(u[i] - xi*(1-xi)/2));
+      err = std::max(err,std::abs(v[i] - xi*(1-xi)/2));
+    }
+  cout << "Error at grid points < 1e-12: " << (err < 1e-12) << endl;
+  cout << "Residual of D*u = f < 1e-10: " << (abs(D*u - f) < 1e-10) << endl;
+
+  // Nonsquare band, against the full matrix.
+  jlt::banded_matrix<double> W(G.view().block(0,0,n,3),2,1);
+  mathmatrix<double> Wf = W.full();
+  mathvector<double> y{1,2,3};
+  cout << "\nBand of a 5x3 block, with 2 sub- and 1 superdiagonal:\n";
+  W.printMatrixForm(cout);
+  cout << "W*y agrees: " << (abs(W*y - Wf*y) < 1e-14) << endl;
+  cout << "W*B' agrees: "
+       << (maxdiff(W*B.view().block(0,0,3,3),Wf*B.view().block(0,0,3,3)) < 1e-14)
+       << endl;
+}
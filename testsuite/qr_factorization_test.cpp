@@ -0,0 +1,151 @@
+//
+// Copyright (c) 2004-2020 Jean-Luc Thiffeault <jeanluc@mailaps.org>
+//
+// See the file LICENSE for copying permission.
+//
+
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+#include <cmath>
+#include <complex>
+#include <stdexcept>
+#include <jlt/mathvector.hpp>
+#include <jlt/mathmatrix.hpp>
+#include <jlt/qr_factorization.hpp>
+#include "test_helpers.hpp"
+
+
+// Largest element of adj(A)*B, or of adj(A)*B - I if identity.
+template<class T>
+double adjoint_product(const jlt::mathmatrix<T>& A, const jlt::mathmatrix<T>& B,
+		       bool identity)
+{
+  double r = 0;
+  for (unsigned i = 0; i < A.columns(); ++i)
+    for (unsigned j = 0; j < B.columns(); ++j)
+      {
+	T s = (identity && i == j ? T(-1) : T(0));
+	for (unsigned k = 0; k < A.rows(); ++k) s += jlt::conjugate(A(k,i))*B(k,j);
+	r = std::max(r,(double)std::abs(s));
+      }
+  return r;
+}
+
+// Largest element of A - Q*R.
+template<class T>
+double product_error(const jlt::mathmatrix<T>& A, const jlt::mathmatrix<T>& Q,
+		     const jlt::mathmatrix<T>& R)
+{
+  double r = 0;
+  for (unsigned i = 0; i < A.rows(); ++i)
+    for (unsigned j = 0; j < A.columns(); ++j)
+      {
+	T s = A(i,j);
+	for (unsigned k = 0; k < Q.columns(); ++k) s -= Q(i,k)*R(k,j);
+	r = std::max(r,(double)std::abs(s));
+      }
+  return r;
+}
+
+template<class T>
+bool check(int m, int n, double tol)
+{
+  using jlt::mathmatrix;
+
+  mathmatrix<T> A = random_matrix<T>(m,n);
+  jlt::qr_factorization<T> qr(A);
+
+  mathmatrix<T> Q = qr.q(), Qf = qr.q(false), R = qr.r(), Rf = qr.r(false);
+
+  double r = std::max(adjoint_product(Q,Q,true),adjoint_product(Qf,Qf,true));
+  r = std::max(r,product_error(A,Q,R));
+  r = std::max(r,product_error(A,Qf,Rf));
+  for (int i = 0; i < (int)R.rows(); ++i)
+    for (int j = 0; j < std::min(i,n); ++j) r = std::max(r,(double)std::abs(R(i,j)));
+
+  // adj(Q) Q B = B.
+  mathmatrix<T> B = random_matrix<T>(m,3), C(B);
+  qr.apply_q(C);
+  qr.apply_qt(C);
+  for (int i = 0; i < m; ++i)
+    for (int c = 0; c < 3; ++c) r = std::max(r,(double)std::abs(C(i,c) - B(i,c)));
+
+  if (m >= n)
+    {
+      // The residual of a least-squares solution is orthogonal to the
+      // columns of A.
+      mathmatrix<T> X = qr.least_squares(B), E(B);
+      for (int i = 0; i < m; ++i)
+	for (int c = 0; c < 3; ++c)
+	  for (int k = 0; k < n; ++k) E(i,c) -= A(i,k)*X(k,c);
+      r = std::max(r,adjoint_product(A,E,false));
+
+      jlt::mathvector<T> b(m), x;
+      for (int i = 0; i < m; ++i) b[i] = B(i,1);
+      x = jlt::least_squares(A,b);
+      for (int k = 0; k < n; ++k) r = std::max(r,(double)std::abs(x[k] - X(k,1)));
+    }
+
+  return (r < tol);
+}
+
+int main()
+{
+  using std::cout;
+  using std::endl;
+  using jlt::mathmatrix;
+  using jlt::mathvector;
+  using C = std::complex<double>;
+
+  const int nb = JLT_QR_BLOCK;
+  const double tol = tolerance<double>(1e4);
+  const double ltol = tolerance<long double>(1e4);
+
+  // Tall and wide, on either side of the panel width.
+  bool ok = true;
+  for (int m : {1, 5, nb, nb + 1, 3*nb + 5})
+    for (int n : {1, 4, nb - 1, nb + 2, 2*nb + 3})
+      ok = ok && check<double>(m,n,tol);
+  cout << "Q, R and least squares, double: " << ok;
+  cout << ", complex: " << (check<C>(150,70,tol) && check<C>(40,90,tol));
+  cout << ", long double: " << check<long double>(120,80,ltol) << endl;
+
+  // Fitting a line to exact data.
+  {
+    mathmatrix<double> A(4,2,{1, 0,
+			      1, 1,
+			      1, 2,
+			      1, 3});
+    mathvector<double> b{1, 3, 5, 7};
+    mathvector<double> x = jlt::least_squares(A,b);
+    cout << "\nLine through (t, 1 + 2t): " << x << endl;
+
+    // An underdetermined system is rejected.
+    try
+      {
+	x = jlt::least_squares(mathmatrix<double>(2,4),x);
+	cout << "No exception for more columns than rows." << endl;
+      }
+    catch (std::invalid_argument& e)
+      {
+	cout << e.what() << endl;
+      }
+  }
+
+  // An ill-conditioned fit, against the normal equations.
+  {
+    const int m = 100, n = 10;
+    mathmatrix<double> A(m,n);
+    mathvector<double> xe(n,1.0);
+    for (int i = 0; i < m; ++i)
+      for (int j = 0; j < n; ++j) A(i,j) = std::pow((double)i/m,j);
+    mathvector<double> b = A*xe;
+
+    mathvector<double> x = jlt::least_squares(A,b);
+    mathmatrix<double> AtA = jlt::trans(A)*A;
+    mathvector<double> xn = jlt::solve(AtA,mathvector<double>(jlt::trans(A)*b));
+    cout << "Vandermonde fit error: QR " << abs(x - xe) << ", normal equations "
+	 << abs(xn - xe) << endl;
+  }
+}
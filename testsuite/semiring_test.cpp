@@ -0,0 +1,128 @@
+//
+// Copyright (c) 2004-2020 Jean-Luc Thiffeault <jeanluc@mailaps.org>
+//
+// See the file LICENSE for copying permission.
+//
+
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+#include <jlt/mathmatrix.hpp>
+#include <jlt/bit_matrix.hpp>
+#include <jlt/semiring.hpp>
+
+
+// Primitivity test by powers of a real matrix, as isReducible used to
+// do it.
+template<class M>
+bool reducible_by_powers(const M& A)
+{
+  auto n = A.rows();
+  auto pmax = (unsigned)ceil(log2(n*n - 2*n + 2));
+  M P(A);
+  P.ones_and_zeros();
+  for (unsigned p = 1; p < pmax; ++p)
+    {
+      P = P*P;
+      P.ones_and_zeros();
+    }
+  for (auto x : P) if (x == 0) return true;
+  return false;
+}
+
+int main()
+{
+  using std::cout;
+  using std::endl;
+  using jlt::mathmatrix;
+  using jlt::bit_matrix;
+
+  // A weighted directed graph on 4 nodes: 0 -> 1 -> 2 -> 3, 0 -> 2.
+  const double inf = std::numeric_limits<double>::infinity();
+  mathmatrix<double> W(4,4,{  0,   1,   5, inf,
+			    inf,   0,   2, inf,
+			    inf, inf,   0,   1,
+			    inf, inf, inf,   0});
+
+  // Shortest paths of up to two edges, then up to four.
+  jlt::min_plus_semiring<double> minplus;
+  mathmatrix<double> W2 = jlt::semiring_product(W,W,minplus);
+  mathmatrix<double> W4 = jlt::semiring_product(W2,W2,minplus);
+  cout << "Shortest paths (min-plus W^4):\n";
+  W4.printMatrixForm(cout);
+
+  // Longest paths of exactly two edges, on a graph without zero-length
+  // self-loops.
+  const double ninf = -inf;
+  mathmatrix<double> L(3,3,{ninf,    2,    7,
+			    ninf, ninf,    3,
+			       1, ninf, ninf});
+  cout << "\nLongest two-edge paths (max-plus L^2):\n";
+  jlt::semiring_product(L,L,jlt::max_plus_semiring<double>())
+    .printMatrixForm(cout);
+
+  // Modular products against the ordinary product reduced mod p.
+  const unsigned long p = 1000000007;
+  mathmatrix<unsigned long> M(30,30), N(30,30), MN(30,30);
+  for (auto& x : M) x = rand() % p;
+  for (auto& x : N) x = rand() % p;
+  jlt::semiring_product(MN,M,N,jlt::modular_semiring<unsigned long>(p));
+  bool modok = true;
+  for (unsigned i = 0; i < 30; ++i)
+    for (unsigned j = 0; j < 30; ++j)
+      {
+	unsigned long s = 0;
+	for (unsigned k = 0; k < 30; ++k)
+	  s = (s + (unsigned __int128)M(i,k)*N(k,j) % p) % p;
+	modok = modok && (s == MN(i,j));
+      }
+  cout << "\nModular product: " << modok << endl;
+
+  // Bit-packed Boolean products against the Boolean semiring on a
+  // mathmatrix, for a size that straddles a word boundary.
+  const unsigned n = 131;
+  mathmatrix<double> A(n,n), B(n,n);
+  for (auto& x : A) x = (rand() % 20 == 0 ? 1 : 0);
+  for (auto& x : B) x = (rand() % 20 == 0 ? 1 : 0);
+  bit_matrix Ab(A), Bb(B), Cb = Ab*Bb, Ct;
+  mathmatrix<double> C =
+    jlt::semiring_product(A,B,jlt::boolean_semiring<double>());
+  jlt::boolean_product_t(Ct,Ab,Bb.transpose());
+  mathmatrix<int> paths(n,n);
+  jlt::path_count(paths,Ab,Bb.transpose());
+  mathmatrix<double> AB = A*B;
+  bool pathsok = true;
+  for (unsigned i = 0; i < n; ++i)
+    for (unsigned j = 0; j < n; ++j) pathsok = pathsok && (paths(i,j) == AB(i,j));
+  cout << "bit_matrix product: " << (Cb == bit_matrix(C))
+       << ", with transpose: " << (Ct == Cb)
+       << ", path counts: " << pathsok
+       << ", count: " << (Cb.count() == bit_matrix(C).count()) << endl;
+
+  // isReducible against powers of the real matrix.
+  int agree = 0, reducible = 0;
+  for (int t = 0; t < 200; ++t)
+    {
+      unsigned m = 2 + rand() % 12;
+      mathmatrix<double> T(m,m);
+      for (auto& x : T) x = (rand() % 4 == 0 ? (double)rand()/RAND_MAX : 0);
+      bool r = T.isReducible();
+      reducible += r;
+      agree += (r == reducible_by_powers(T));
+    }
+  cout << "isReducible agrees on " << agree << " of 200 matrices ("
+       << reducible << " reducible)" << endl;
+
+  // Reachability and primitivity of a 10^4-node transition graph: a
+  // cycle with random extra edges.
+  const unsigned N4 = 10000;
+  bit_matrix G(N4,N4);
+  for (unsigned i = 0; i < N4; ++i)
+    {
+      G.set(i,(i+1) % N4);
+      for (int e = 0; e < 3; ++e) G.set(i,rand() % N4);
+    }
+  auto R = G.reachable(0);
+  cout << "\nNodes reachable from node 0 of " << N4 << ": " << R.count()
+       << endl;
+}
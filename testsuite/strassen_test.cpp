@@ -0,0 +1,68 @@
+//
+// Copyright (c) 2004-2020 Jean-Luc Thiffeault <jeanluc@mailaps.org>
+//
+// See the file LICENSE for copying permission.
+//
+
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+#include <jlt/mathmatrix.hpp>
+#include <jlt/strassen.hpp>
+#include "test_helpers.hpp"
+
+
+int main()
+{
+  using std::cout;
+  using std::endl;
+  using jlt::mathmatrix;
+
+  // Even, odd and mixed shapes, with a small crossover so that the
+  // recursion goes several levels deep.
+  const unsigned shapes[][3] = {{64,64,64}, {65,65,65}, {100,37,81},
+				{33,128,17}, {127,129,131}};
+
+  cout << "Strassen-Winograd against the triple loop:\n";
+  for (auto& s : shapes)
+    {
+      unsigned m = s[0], k = s[1], n = s[2];
+
+      // Exact for integers.
+      mathmatrix<long> Ai(m,k), Bi(k,n), Ci(m,n), Ri(m,n);
+      for (auto& x : Ai) x = rand() % 201 - 100;
+      for (auto& x : Bi) x = rand() % 201 - 100;
+      jlt::strassen_product(Ci,Ai,Bi,8);
+      naive_product(Ri,Ai,Bi);
+
+      mathmatrix<double> A(m,k), B(k,n), C(m,n), R(m,n);
+      for (auto& x : A) x = (double)rand()/RAND_MAX - 0.5;
+      for (auto& x : B) x = (double)rand()/RAND_MAX - 0.5;
+      jlt::strassen_product(C,A,B,8);
+      naive_product(R,A,B);
+
+      cout << "  " << m << "x" << k << " times " << k << "x" << n
+	   << ": long " << (Ci == Ri)
+	   << ", double " << (maxdiff(C,R) < 1e-12) << endl;
+    }
+
+  // Transposed operands and a block of a larger matrix as the result.
+  mathmatrix<double> A(90,70), B(90,70), D(200,200), R(70,70);
+  for (auto& x : A) x = (double)rand()/RAND_MAX - 0.5;
+  for (auto& x : B) x = (double)rand()/RAND_MAX - 0.5;
+  jlt::strassen_product(D.view().block(10,20,70,70),jlt::trans(A),B,16);
+  naive_product(R,jlt::trans(A),B);
+  cout << "\ntrans(A)*B into a block: "
+       << (maxdiff(D.view().block(10,20,70,70),R) < 1e-12) << endl;
+
+  // Against the blocked kernel on a large integer product, where
+  // Strassen has no accuracy penalty.
+  const unsigned N = 1024;
+  mathmatrix<long> P(N,N), Q(N,N), PQ1(N,N), PQ2(N,N);
+  for (auto& x : P) x = rand() % 21 - 10;
+  for (auto& x : Q) x = rand() % 21 - 10;
+  PQ1 = P*Q;
+  jlt::strassen_product(PQ2,P,Q,128);
+  cout << "\n" << N << "x" << N << " long product, same as classical: "
+       << (PQ1 == PQ2) << endl;
+}
@@ -41,6 +41,10 @@ int main()
   A(2,3) = 0;
 
   mathmatrix<Real> A2(A); // Make a copy, since A is destroyed.
+  // Column-major copy, passed to LAPACK without transposing.
+  jlt::colmajor_mathmatrix<Real> Ac(m,n), Uc(m,m), Vtc(n,n);
+  for (int i = 0; i < m; ++i)
+    for (int j = 0; j < n; ++j) Ac(i,j) = A(i,j);
 
   cout.precision(6);
   cout.setf(std::ios::fixed);
@@ -60,4 +64,11 @@ int main()
 
   cout << "\nU.diag(w).Vt =\n";
   (U*diagonal_matrix(w,m,n)*Vt).printMatrixForm(cout);
+
+  jlt::SVdecomp(Ac,Uc,Vtc,w);
+  cout << "\nColumn-major storage: w = " << w << endl;
+  cout << "\nU.diag(w).Vt =\n";
+  jlt::colmajor_mathmatrix<Real> D(m,n);
+  for (int i = 0; i < m; ++i) D(i,i) = w[i];
+  (Uc*D*Vtc).printMatrixForm(cout);
 }
@@ -0,0 +1,169 @@
+//
+// Copyright (c) 2004-2020 Jean-Luc Thiffeault <jeanluc@mailaps.org>
+//
+// See the file LICENSE for copying permission.
+//
+
+// Cholesky and Bunch-Kaufman LDL^T factors, compared with LAPACK's.
+// Link with -llapack.
+
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+#include <cmath>
+#include <complex>
+#include <stdexcept>
+#include <jlt/mathvector.hpp>
+#include <jlt/mathmatrix.hpp>
+#include <jlt/lapack.hpp>
+#include <jlt/lu_factorization.hpp>
+#include <jlt/symmetric_factorization.hpp>
+#include "test_helpers.hpp"
+
+
+// A random symmetric matrix, or Hermitian positive-definite if spd.
+// Every third diagonal element of an indefinite matrix is zero, to
+// force 2 by 2 pivots.
+template<class Matrix>
+Matrix random_symmetric(int n, bool spd)
+{
+  using T = typename Matrix::value_type;
+  Matrix A(n,n);
+  for (int i = 0; i < n; ++i)
+    for (int j = 0; j <= i; ++j)
+      {
+	T x = random_element<T>();
+	if (spd && i == j) x = std::real(x) + n;
+	A(i,j) = x;
+	A(j,i) = (spd ? jlt::conjugate(x) : x);
+      }
+  if (!spd)
+    for (int i = 1; i < n; i += 3) A(i,i) = 0;
+  return A;
+}
+
+template<class T, class Matrix>
+bool check(int n, double tol)
+{
+  Matrix S = random_symmetric<Matrix>(n,true);
+  Matrix A = random_symmetric<Matrix>(n,false);
+  jlt::mathmatrix<T> B = random_matrix<T>(n,5);
+
+  jlt::cholesky_factorization<T,Matrix> chol(S);
+  jlt::ldlt_factorization<T,Matrix> ldlt(A);
+
+  double r = std::max(residual(S,chol.solve(B),B),
+		      residual(A,ldlt.solve(B),B));
+
+  jlt::mathvector<T> b(n), x;
+  for (int i = 0; i < n; ++i) b[i] = B(i,0);
+  x = chol.solve(b);
+  for (int i = 0; i < n; ++i)
+    r = std::max(r,(double)std::abs(x[i] - chol.solve(B)(i,0)));
+
+  // Determinants, against LU.
+  jlt::lu_factorization<T,Matrix> luS(S), luA(A);
+  T sign;
+  const double ldA = ldlt.logdet(&sign);
+  r = std::max(r,(double)(std::abs(chol.det() - luS.det())/std::abs(luS.det())));
+  r = std::max(r,(double)std::abs(chol.logdet() - luS.logdet()));
+  r = std::max(r,(double)(std::abs(ldlt.det() - luA.det())/std::abs(luA.det())));
+  r = std::max(r,(double)std::abs(ldA - luA.logdet()));
+
+  return (r < tol);
+}
+
+// The factors and pivots of LAPACK's xPOTRF and xSYTRF, through the
+// strided wrappers used with JLT_USE_LAPACK.
+template<class T, class Matrix>
+double lapack_difference(int n)
+{
+  Matrix S = random_symmetric<Matrix>(n,true), S2(S);
+  Matrix A = random_symmetric<Matrix>(n,false), A2(A);
+  std::vector<int> ipiv(n), ipiv2(n);
+  int info;
+
+  jlt::Choleskydecomp<T>(S);
+  jlt::LDLTdecomp<T>(A,ipiv.data());
+
+  auto s = gemm_operand(S2), a = gemm_operand(A2);
+  jlt::lapack::strided_potrf(n,s.data(),s.row_stride(),s.column_stride(),&info);
+  jlt::lapack::strided_sytrf(n,a.data(),a.row_stride(),a.column_stride(),
+			     ipiv2.data(),&info);
+
+  double e = (ipiv == ipiv2 ? 0 : 1);
+  for (int i = 0; i < n; ++i)
+    for (int j = 0; j <= i; ++j)
+      e = std::max(e,(double)std::max(std::abs(S(i,j) - S2(i,j)),
+				      std::abs(A(i,j) - A2(i,j))));
+  return e;
+}
+
+int main()
+{
+  using std::cout;
+  using std::endl;
+  using jlt::mathmatrix;
+  using jlt::colmajor_mathmatrix;
+  using C = std::complex<double>;
+
+  const double tol = tolerance<double>(1e7);
+  const double ltol = tolerance<long double>(1e7);
+  bool ok = true;
+  for (int n : {1, 2, 7, JLT_LU_BLOCK, JLT_LU_BLOCK + 1, 2*JLT_LU_BLOCK + 9})
+    ok = ok && check<double,mathmatrix<double>>(n,tol);
+  cout << "Solves and determinants, double: " << ok;
+  cout << ", column-major: "
+       << check<double,colmajor_mathmatrix<double>>(150,tol);
+  cout << ", complex: " << check<C,mathmatrix<C>>(150,tol);
+  cout << ", long double: " << check<long double,mathmatrix<long double>>(150,ltol)
+       << endl;
+
+  cout << "\nSame factors and pivots as LAPACK: "
+       << (lapack_difference<double,mathmatrix<double>>(200) < 1e-10) << " "
+       << (lapack_difference<double,colmajor_mathmatrix<double>>(200) < 1e-10)
+       << " " << (lapack_difference<C,mathmatrix<C>>(150) < 1e-10) << endl;
+
+  // A block of a larger matrix, factored in place through a view.
+  {
+    const int n = 100;
+    mathmatrix<double> S = random_symmetric<mathmatrix<double>>(n,true);
+    mathmatrix<double> big(n+4,n+4), B = random_matrix<double>(n,3);
+    for (int i = 0; i < n; ++i)
+      for (int j = 0; j < n; ++j) big(i+2,j+4) = S(i,j);
+    auto V = big.block(2,4,n,n);
+    jlt::Choleskydecomp<double>(V);
+    mathmatrix<double> X(B);
+    jlt::Choleskysolve<double>(V,X);
+    cout << "Cholesky of a view: " << (residual(S,X,B) < 1e-10) << endl;
+  }
+
+  // Indefinite matrices have no Cholesky factor, but do have LDL^T.
+  {
+    mathmatrix<double> A(2,2,{0, 1,
+			      1, 0});
+    try
+      {
+	jlt::cholesky_factorization<double> chol(A);
+	cout << "No exception for an indefinite matrix." << endl;
+      }
+    catch (std::runtime_error& e)
+      {
+	cout << e.what() << endl;
+      }
+    jlt::ldlt_factorization<double> ldlt(A);
+    cout << "LDL^T: det = " << ldlt.det() << ", 2 by 2 pivot "
+	 << (ldlt.pivots()[0] < 0) << endl;
+  }
+
+  // Refactoring reuses the storage.
+  {
+    mathmatrix<double> S = random_symmetric<mathmatrix<double>>(60,true);
+    jlt::cholesky_factorization<double> chol(S);
+    const double* p = chol.factors().data();
+    S(5,5) += 1;
+    chol.factor(S);
+    cout << "Refactored in the same storage: " << (chol.factors().data() == p)
+	 << endl;
+  }
+}
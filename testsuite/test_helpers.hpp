@@ -0,0 +1,132 @@
+//
+// Copyright (c) 2004-2020 Jean-Luc Thiffeault <jeanluc@mailaps.org>
+//
+// See the file LICENSE for copying permission.
+//
+
+#ifndef JLT_TEST_HELPERS_HPP
+#define JLT_TEST_HELPERS_HPP
+
+//
+// test_helpers.hpp
+//
+
+// Random data and reference computations shared by the testsuite
+// programs.  The references are plain loops, slow but obviously
+// correct, against which the library's kernels are checked.
+
+#include <cstdlib>
+#include <cmath>
+#include <complex>
+#include <limits>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+#include <jlt/mathmatrix.hpp>
+
+
+// Uniform in [-1/2,1/2], in both parts for complex numbers.
+template<class T>
+T random_element() { return T((double)rand()/RAND_MAX - 0.5); }
+
+template<>
+inline std::complex<double> random_element()
+{
+  const double x = (double)rand()/RAND_MAX - 0.5;
+  return std::complex<double>(x,(double)rand()/RAND_MAX - 0.5);
+}
+
+// Fill a matrix or vector with random elements.
+template<class M>
+void randomize(M& A)
+{
+  for (auto& x : A) x = random_element<typename M::value_type>();
+}
+
+template<class T>
+jlt::mathmatrix<T> random_matrix(int m, int n)
+{
+  jlt::mathmatrix<T> A(m,n);
+  randomize(A);
+  return A;
+}
+
+// C = A*B by the triple loop.
+template<class M_C, class M_A, class M_B>
+void naive_product(M_C& C, const M_A& A, const M_B& B)
+{
+  for (unsigned i = 0; i < A.rows(); ++i)
+    for (unsigned j = 0; j < B.columns(); ++j)
+      {
+	typename std::decay<M_C>::type::value_type s = 0;
+	for (unsigned k = 0; k < A.columns(); ++k) s += A(i,k)*B(k,j);
+	C(i,j) = s;
+      }
+}
+
+template<class M, class = void>
+struct has_columns : std::false_type {};
+template<class M>
+struct has_columns<M,std::void_t<decltype(std::declval<const M&>().columns())>>
+  : std::true_type {};
+
+// Largest absolute difference between two matrices, views or vectors
+// of the same size.
+template<class M1, class M2>
+double maxdiff(const M1& A, const M2& B)
+{
+  double d = 0;
+  if constexpr (has_columns<M1>::value)
+    {
+      for (unsigned i = 0; i < A.rows(); ++i)
+	for (unsigned j = 0; j < A.columns(); ++j)
+	  d = std::max(d,(double)std::abs(A(i,j) - B(i,j)));
+    }
+  else
+    {
+      for (unsigned i = 0; i < A.size(); ++i)
+	d = std::max(d,(double)std::abs(A[i] - B[i]));
+    }
+  return d;
+}
+
+// Largest element of A*X - B, or of trans(A)*X - B if transpose.
+template<class M_A, class M_X, class M_B>
+double residual(const M_A& A, const M_X& X, const M_B& B,
+		bool transpose = false)
+{
+  using T = typename M_B::value_type;
+
+  double r = 0;
+  for (unsigned i = 0; i < B.rows(); ++i)
+    for (unsigned c = 0; c < B.columns(); ++c)
+      {
+	T s = 0;
+	for (unsigned k = 0; k < X.rows(); ++k)
+	  s += (transpose ? A(k,i) : A(i,k))*X(k,c);
+	r = std::max(r,(double)std::abs(s - B(i,c)));
+      }
+  return r;
+}
+
+// A*B against the triple loop, for random m by k and k by n matrices
+// of T stored in Order, with a tolerance per term of the inner product.
+template<class T, class Order>
+bool check_product(unsigned m, unsigned n, unsigned k, double tol)
+{
+  jlt::mathmatrix<T,T,jlt::aligned_allocator<T>,Order> A(m,k), B(k,n), C(m,n);
+  randomize(A);
+  randomize(B);
+  naive_product(C,A,B);
+  return (maxdiff(A*B,C) < tol*k);
+}
+
+// c machine epsilons of the real type of T.
+template<class T>
+double tolerance(double c)
+{
+  using R = decltype(std::abs(T()));
+  return c*(double)std::numeric_limits<R>::epsilon();
+}
+
+#endif // JLT_TEST_HELPERS_HPP
@@ -0,0 +1,108 @@
+//
+// Copyright (c) 2004-2020 Jean-Luc Thiffeault <jeanluc@mailaps.org>
+//
+// See the file LICENSE for copying permission.
+//
+
+#include <iostream>
+#include <vector>
+#include <atomic>
+#include <cstdlib>
+#include <cmath>
+#include <stdexcept>
+#include <jlt/thread_pool.hpp>
+#include <jlt/mathmatrix.hpp>
+#include "test_helpers.hpp"
+
+
+int main()
+{
+  using std::cout;
+  using std::endl;
+  using jlt::mathmatrix;
+  using jlt::mathvector;
+
+  jlt::set_num_threads(4);
+  cout << "Threads: " << jlt::num_threads() << endl;
+
+  // Every index is visited exactly once, and short ranges stay in the
+  // calling thread.
+  std::vector<int> hits(100000);
+  std::atomic<int> calls(0);
+  jlt::parallel_for(0,hits.size(),1000,[&](std::size_t i0, std::size_t i1)
+		    {
+		      ++calls;
+		      for (auto i = i0; i < i1; ++i) ++hits[i];
+		    });
+  bool once = true;
+  for (auto h : hits) once = once && (h == 1);
+  cout << "parallel_for covers the range once: " << once
+       << " (" << calls << " ranges)" << endl;
+
+  calls = 0;
+  jlt::parallel_for(0,1500,1000,[&](std::size_t, std::size_t) { ++calls; });
+  cout << "Below the grain: " << calls << " range" << endl;
+
+  // Exceptions are passed back to the caller.
+  try
+    {
+      jlt::parallel_for(0,100,1,[](std::size_t i0, std::size_t)
+			{
+			  if (i0 > 0) throw std::runtime_error("worker");
+			});
+      cout << "No exception!" << endl;
+    }
+  catch (std::runtime_error& e)
+    {
+      cout << "Caught exception from " << e.what() << endl;
+    }
+
+  // A parallel_for inside another runs serially, in the range of the
+  // calling thread as in those of the workers.
+  std::atomic<int> inner(0);
+  jlt::parallel_for(0,4,1,[&](std::size_t, std::size_t)
+		    {
+		      jlt::parallel_for(0,100000,1000,
+					[&](std::size_t, std::size_t) { ++inner; });
+		    });
+  cout << "Nested parallel_for is serial: " << (inner == 4) << endl;
+
+  // Same results on one and on four threads.
+  const int n = 600;
+  mathmatrix<double> A(n,n), B(n,n), C1, C4, At1, At4, R(n,n+7), Rt1, Rt4;
+  mathvector<double> x(n), y1, y4, z1, z4;
+  randomize(A);
+  randomize(B);
+  randomize(R);
+  randomize(x);
+  for (int i = 0; i < n; ++i) A(i,i) += n;	// Well-conditioned.
+
+  jlt::set_num_threads(1);
+  C1 = A*B;
+  y1 = A*x;
+  z1 = 2.0*x - y1;
+  auto Ai1 = A.inverse();
+  A.transpose(At1);
+  R.transpose(Rt1);
+
+  jlt::set_num_threads(4);
+  C4 = A*B;
+  y4 = A*x;
+  z4 = 2.0*x - y4;
+  auto Ai4 = A.inverse();
+  A.transpose(At4);
+  R.transpose(Rt4);
+
+  cout << "A*B: " << (maxdiff(C1,C4) < 1e-12) << endl;
+  cout << "A*x: " << (maxdiff(y1,y4) < 1e-12) << endl;
+  cout << "2*x - y: " << (maxdiff(z1,z4) == 0) << endl;
+  cout << "inverse: " << (maxdiff(Ai1,Ai4) == 0) << endl;
+  cout << "transpose: " << (maxdiff(At1,At4) == 0) << " "
+       << (maxdiff(Rt1,Rt4) == 0) << endl;
+
+  mathmatrix<double> I = A*Ai4;
+  I -= 1.0;
+  double err = 0;
+  for (auto e : I) err = std::max(err,std::abs(e));
+  cout << "A*inverse(A) = 1: " << (err < 1e-12) << endl;
+}
@@ -0,0 +1,138 @@
+//
+// Copyright (c) 2004-2020 Jean-Luc Thiffeault <jeanluc@mailaps.org>
+//
+// See the file LICENSE for copying permission.
+//
+
+#include <iostream>
+#include <complex>
+#include <vector>
+#include <cstdlib>
+#include <cmath>
+#include <jlt/mathmatrix.hpp>
+#include <jlt/mathvector.hpp>
+#include <jlt/transposed.hpp>
+#include <jlt/lapack.hpp>
+#include "test_helpers.hpp"
+
+
+int main()
+{
+  using std::cout;
+  using std::endl;
+  using jlt::mathmatrix;
+  using jlt::mathvector;
+  using jlt::trans;
+  using jlt::adj;
+
+  // A small least-squares problem: fit y = c0 + c1 t + c2 t^2.
+  const int m = 6;
+  mathmatrix<double> A(m,3);
+  mathvector<double> y(m);
+  for (int i = 0; i < m; ++i)
+    {
+      double t = i;
+      A(i,0) = 1; A(i,1) = t; A(i,2) = t*t;
+      y[i] = 1 - 2*t + 0.5*t*t;
+    }
+
+  // Normal equations, without forming a transposed copy of A.
+  mathmatrix<double> N = trans(A)*A;
+  mathvector<double> c = trans(A)*y;
+  cout << "trans(A)*A =\n";
+  N.printMatrixForm(cout);
+  cout << "trans(A)*y = " << c << endl;
+
+  // Solve with the LU factors of N.
+  int row_index[3], perm;
+  jlt::LUdecomp<double>(N,row_index,&perm);
+  jlt::LUbacksub<double>(N,row_index,c.data());
+  cout << "coefficients = " << c << endl;
+
+  // Compare all the products with the same products on explicit
+  // transposes.
+  mathmatrix<double> B(4,3), E(4,6), At, Bt, Et;
+  for (auto& x : B) x = (double)rand()/RAND_MAX - 0.5;
+  for (auto& x : E) x = (double)rand()/RAND_MAX - 0.5;
+  A.transpose(At);
+  B.transpose(Bt);
+  E.transpose(Et);
+  mathvector<double> z{1,-1,1,-1,1,-1};
+
+  cout << "\nAgreement with products of explicit transposes:\n";
+  cout << "  trans(A)*A:        " << (maxdiff(trans(A)*A,At*A) < 1e-12) << endl;
+  cout << "  A*trans(B):        " << (maxdiff(A*trans(B),A*Bt) < 1e-12) << endl;
+  cout << "  trans(A)*trans(E): " << (maxdiff(trans(A)*trans(E),At*Et) < 1e-12) << endl;
+  cout << "  trans(A)*z:        " << (abs(trans(A)*z - At*z) < 1e-12) << endl;
+  cout << "  block of A:        "
+       << (maxdiff(A.view().block(1,0,3,3)*trans(B.view().block(0,0,2,3)),
+		   A.view().block(1,0,3,3)*Bt.view().block(0,0,3,2)) < 1e-12) << endl;
+  cout << "  trans(block)*row:  "
+       << (abs(trans(A.view().block(0,0,3,3))*B.view().row(1)
+	       - At.view().block(0,0,3,3)*mathvector<double>(B.row(1))) < 1e-12)
+       << endl;
+
+  // Solve trans(M) u = v and M u = v with the same factors.
+  mathmatrix<double> M(4,4), LU;
+  for (auto& x : M) x = (double)rand()/RAND_MAX - 0.5;
+  LU = M;
+  int ri[4];
+  jlt::LUdecomp<double>(LU,ri,&perm);
+  mathvector<double> v{1,2,3,4}, u(v);
+  jlt::LUbacksub(trans(LU),ri,u.data());
+  cout << "\nResidual of trans(M) u = v with LUbacksub: "
+       << (abs(trans(M)*u - v) < 1e-12) << endl;
+
+  // The same with LAPACK, which is told to use the transpose rather
+  // than being given one.
+  {
+    LU = M;
+    int n = 4, nrhs = 1, info;
+    std::vector<int> ipiv(n);
+    jlt::lapack::getrf(&n,&n,LU.data(),&n,ipiv.data(),&info);
+
+    char tr = jlt::lapack_trans(trans(M)), tn = jlt::lapack_trans(M);
+    mathvector<double> ut(v), un(v);
+    jlt::lapack::getrs(&tr,&n,&nrhs,LU.data(),&n,ipiv.data(),ut.data(),&n,&info);
+    jlt::lapack::getrs(&tn,&n,&nrhs,LU.data(),&n,ipiv.data(),un.data(),&n,&info);
+
+    cout << "LAPACK flags for trans(M) and M: " << tr << " " << tn << endl;
+    cout << "Residual of trans(M) u = v with getrs: "
+	 << (abs(trans(M)*ut - v) < 1e-12) << endl;
+    cout << "Residual of M u = v with getrs: "
+	 << (abs(M*un - v) < 1e-12) << endl;
+  }
+
+  // The adjoint conjugates complex entries.
+  using cplx = std::complex<double>;
+  mathmatrix<cplx> C(2,2,{cplx(1,1), cplx(0,2),
+			  cplx(3,0), cplx(1,-1)});
+  cout << "\nadj(C)*C =\n";
+  (adj(C)*C).printMatrixForm(cout);
+  cout << "trans(C)*C =\n";
+  (trans(C)*C).printMatrixForm(cout);
+
+  // Integer elements use the plain loops rather than gemm().
+  {
+    mathmatrix<int> P(3,2,{1, 2,
+			   3, 4,
+			   5, 6});
+    mathmatrix<int> Q(2,3,{1, 0, -1,
+			   2, 1,  0});
+    mathmatrix<int> Pt(2,3,{1, 3, 5,
+			    2, 4, 6});
+    mathmatrix<int> Qt(3,2,{ 1, 2,
+			     0, 1,
+			    -1, 0});
+    mathvector<int> x{1, -1, 2};
+    cout << "\nInteger trans(P)*trans(Q): " << (trans(P)*trans(Q) == Pt*Qt)
+	 << ", trans(P)*x: " << (trans(P)*x == Pt*x) << endl;
+
+    // An empty inner dimension gives zeros.
+    mathmatrix<int> E(0,2), F(3,0), EF = trans(E)*trans(F);
+    mathvector<int> z = trans(E)*mathvector<int>(0);
+    cout << "Empty inner dimension: "
+	 << (EF.rows() == 2 && EF.columns() == 3 && EF == mathmatrix<int>(2,3))
+	 << " " << (z == mathvector<int>(2)) << endl;
+  }
+}
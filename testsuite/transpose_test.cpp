@@ -0,0 +1,79 @@
+//
+// Copyright (c) 2004-2020 Jean-Luc Thiffeault <jeanluc@mailaps.org>
+//
+// See the file LICENSE for copying permission.
+//
+
+#include <iostream>
+#include <jlt/matrix.hpp>
+#include <jlt/mathmatrix.hpp>
+
+
+// Check that At is the transpose of A, and return the number of
+// mismatched elements.
+template<class Matrix>
+int check_transpose(const Matrix& A, const Matrix& At)
+{
+  if (At.rows() != A.columns() || At.columns() != A.rows()) return -1;
+
+  int bad = 0;
+  for (unsigned i = 0; i < A.rows(); ++i)
+    for (unsigned j = 0; j < A.columns(); ++j)
+      if (At(j,i) != A(i,j)) ++bad;
+
+  return bad;
+}
+
+template<class Matrix>
+void test_shapes(const char *name)
+{
+  // Shapes smaller than, equal to, and straddling the tile size.
+  const int shapes[][2] = {{1,7}, {7,1}, {5,5}, {3,8}, {32,32}, {33,31},
+			   {64,100}, {100,64}, {257,130}, {600,600},
+			   {700,450}};
+
+  std::cout << "\n" << name << ":\n";
+  for (auto& s : shapes)
+    {
+      int m = s[0], n = s[1];
+      Matrix A(m,n);
+      for (int i = 0; i < m; ++i)
+	for (int j = 0; j < n; ++j) A(i,j) = 1000*i + j;
+
+      Matrix B(A), C(A), D, E;
+      B.transpose();		// In place if square, else new buffer.
+      C.transpose_in_place();	// Cycle-following, no second buffer.
+      A.transpose(D);		// Out of place.
+      A.transpose(E,4);		// Out of place, 4 threads.
+
+      std::cout << "  " << m << " x " << n << ":  mismatches = "
+		<< check_transpose(A,B) << " " << check_transpose(A,C) << " "
+		<< check_transpose(A,D) << " " << check_transpose(A,E) << "\n";
+    }
+}
+
+int main()
+{
+  using std::cout;
+  using jlt::matrix;
+  using jlt::colmajor_matrix;
+
+  matrix<int> A(2,3,{1,2,3,
+		     4,5,6});
+
+  cout << "A =\n";
+  A.printMatrixForm(cout);
+  cout << "\ntranspose(A) =\n";
+  A.transpose().printMatrixForm(cout);
+  cout << "\ntranspose(transpose(A)) =\n";
+  A.transpose_in_place().printMatrixForm(cout);
+
+  colmajor_matrix<int> Ac(2,3,{1,2,3,
+			       4,5,6});
+  cout << "\nColumn-major: transpose(A) =\n";
+  Ac.transpose().printMatrixForm(cout);
+
+  test_shapes<matrix<double>>("Row-major");
+  test_shapes<colmajor_matrix<double>>("Column-major");
+  test_shapes<jlt::mathmatrix<float>>("mathmatrix<float>");
+}